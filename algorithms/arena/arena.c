@@ -0,0 +1,251 @@
+/* Copyright or © or Copr. 2012, Jean-François Hren
+ *
+ * Author e-mail: jean-francois.hren@inria.fr
+ *
+ * This software is a computer program whose purpose is to control
+ * deterministic systems using optimistic planning.
+ *
+ * This software is governed by the CeCILL license under French law and
+ * abiding by the rules of distribution of free software.  You can  use, 
+ * modify and/ or redistribute the software under the terms of the CeCILL
+ * license as circulated by CEA, CNRS and INRIA at the following URL
+ * "http://www.cecill.info". 
+ *
+ * As a counterpart to the access to the source code and  rights to copy,
+ * modify and redistribute granted by the license, users are provided only
+ * with a limited warranty  and the software's author,  the holder of the
+ * economic rights,  and the successive licensors  have only  limited
+ * liability. 
+ *
+ * In this respect, the user's attention is drawn to the risks associated
+ * with loading,  using,  modifying and/or developing or reproducing the
+ * software by the user in light of its specific status of free software,
+ * that may mean  that it is complicated to manipulate,  and  that  also
+ * therefore means  that it is reserved for developers  and  experienced
+ * professionals having in-depth computer knowledge. Users are therefore
+ * encouraged to load and test the software's suitability as regards their
+ * requirements in conditions enabling the security of their systems and/or 
+ * data to be ensured and,  more generally, to use and operate it in the 
+ * same conditions as regards security. 
+ *
+ * The fact that you are presently reading this means that you have had
+ * knowledge of the CeCILL license and that you accept its terms.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "arena.h"
+
+#define SLAB_HEADER_SIZE (((sizeof(arena_slab) + ARENA_ALIGNMENT - 1) / ARENA_ALIGNMENT) * ARENA_ALIGNMENT)
+#define SLAB_DATA(slab) ((char*)(slab) + SLAB_HEADER_SIZE)
+
+/*+------------------------------------------+
+  | Compute the size class of a block and    |
+  | the size actually reserved for it        |
+  +------------------------------------------+*/
+
+static unsigned int getSizeClass(size_t size, size_t* classSize) {
+
+    unsigned int sizeClass = 0;
+
+    if(size == 0)
+        size = 1;
+
+    if(size <= ARENA_SMALL_LIMIT) {
+        sizeClass = (size - 1) / ARENA_ALIGNMENT;
+        *classSize = (sizeClass + 1) * ARENA_ALIGNMENT;
+    } else {
+        *classSize = ARENA_SMALL_LIMIT * 2;
+        sizeClass = ARENA_NB_SMALL_CLASSES;
+        while(*classSize < size) {
+            *classSize <<= 1;
+            sizeClass++;
+        }
+    }
+
+    return sizeClass;
+
+}
+
+
+/*+------------------------------------------+
+  | Allocate a new slab and chain it after   |
+  | the current one                          |
+  +------------------------------------------+*/
+
+static arena_slab* addSlab(arena* memory, size_t size) {
+
+    arena_slab* slab = (arena_slab*)malloc(SLAB_HEADER_SIZE + size);
+
+    slab->size = size;
+    slab->used = 0;
+
+    if(memory->crtSlab == NULL) {
+        slab->next = memory->slabs;
+        memory->slabs = slab;
+    } else {
+        slab->next = memory->crtSlab->next;
+        memory->crtSlab->next = slab;
+    }
+
+    memory->bytesReserved += size;
+    memory->nbAllocations++;
+
+    return slab;
+
+}
+
+
+/*+------------------------------------------+
+  | Initialize an arena                      |
+  +------------------------------------------+*/
+
+arena* arena_init(size_t slabSize) {
+
+    arena* memory = (arena*)malloc(sizeof(arena));
+
+    memory->slabSize = ((slabSize + ARENA_ALIGNMENT - 1) / ARENA_ALIGNMENT) * ARENA_ALIGNMENT;
+    memory->slabs = NULL;
+    memory->crtSlab = NULL;
+    memory->bytesInUse = 0;
+    memory->bytesReserved = 0;
+    memory->nbAllocations = 0;
+    memset(memory->freeLists, 0, sizeof(memory->freeLists));
+
+    memory->crtSlab = addSlab(memory, memory->slabSize);
+
+    return memory;
+
+}
+
+
+/*+------------------------------------------+
+  | Allocate a block of at least size bytes  |
+  | aligned on ARENA_ALIGNMENT               |
+  +------------------------------------------+*/
+
+void* arena_alloc(arena* memory, size_t size) {
+
+    size_t classSize = 0;
+    unsigned int sizeClass = getSizeClass(size, &classSize);
+    void* block = NULL;
+
+    memory->bytesInUse += classSize;
+
+    if(memory->freeLists[sizeClass] != NULL) {
+        block = memory->freeLists[sizeClass];
+        memory->freeLists[sizeClass] = memory->freeLists[sizeClass]->next;
+        return block;
+    }
+
+    if((memory->crtSlab->used + classSize) > memory->crtSlab->size) {
+        arena_slab* next = memory->crtSlab->next;
+
+        if((next != NULL) && (next->size >= classSize)) {
+            next->used = 0;
+            memory->crtSlab = next;
+        } else {
+            memory->crtSlab = addSlab(memory, classSize > memory->slabSize ? classSize : memory->slabSize);
+        }
+    }
+
+    block = SLAB_DATA(memory->crtSlab) + memory->crtSlab->used;
+    memory->crtSlab->used += classSize;
+
+    return block;
+
+}
+
+
+/*+------------------------------------------+
+  | Resize a block. The last block handed    |
+  | out of the current slab grows in place.  |
+  +------------------------------------------+*/
+
+void* arena_realloc(arena* memory, void* block, size_t oldSize, size_t newSize) {
+
+    size_t oldClassSize = 0;
+    size_t newClassSize = 0;
+    void* newBlock = NULL;
+
+    if(block == NULL)
+        return arena_alloc(memory, newSize);
+
+    getSizeClass(oldSize, &oldClassSize);
+    getSizeClass(newSize, &newClassSize);
+
+    if(newClassSize == oldClassSize)
+        return block;
+
+    if(((char*)block + oldClassSize) == (SLAB_DATA(memory->crtSlab) + memory->crtSlab->used) && ((memory->crtSlab->used - oldClassSize + newClassSize) <= memory->crtSlab->size)) {
+        memory->crtSlab->used = memory->crtSlab->used - oldClassSize + newClassSize;
+        memory->bytesInUse = memory->bytesInUse - oldClassSize + newClassSize;
+        return block;
+    }
+
+    newBlock = arena_alloc(memory, newSize);
+    memcpy(newBlock, block, oldSize < newSize ? oldSize : newSize);
+    arena_free(memory, block, oldSize);
+
+    return newBlock;
+
+}
+
+
+/*+------------------------------------------+
+  | Give back a block of the given size so   |
+  | that it can be reused before the reset   |
+  +------------------------------------------+*/
+
+void arena_free(arena* memory, void* block, size_t size) {
+
+    size_t classSize = 0;
+    unsigned int sizeClass = 0;
+
+    if(block == NULL)
+        return;
+
+    sizeClass = getSizeClass(size, &classSize);
+
+    ((arena_block*)block)->next = memory->freeLists[sizeClass];
+    memory->freeLists[sizeClass] = (arena_block*)block;
+    memory->bytesInUse -= classSize;
+
+}
+
+
+/*+------------------------------------------+
+  | Release every block at once. The slabs   |
+  | are kept for the next use of the arena.  |
+  +------------------------------------------+*/
+
+void arena_reset(arena* memory) {
+
+    memory->crtSlab = memory->slabs;
+    memory->crtSlab->used = 0;
+    memory->bytesInUse = 0;
+    memset(memory->freeLists, 0, sizeof(memory->freeLists));
+
+}
+
+
+/*+------------------------------------------+
+  | Uninit an arena and give its slabs back  |
+  | to the system                            |
+  +------------------------------------------+*/
+
+void arena_uninit(arena** memory) {
+
+    arena_slab* slab = (*memory)->slabs;
+
+    while(slab != NULL) {
+        arena_slab* next = slab->next;
+        free(slab);
+        slab = next;
+    }
+
+    free(*memory);
+    *memory = NULL;
+
+}
@@ -0,0 +1,99 @@
+/* Copyright or © or Copr. 2012, Jean-François Hren
+ *
+ * Author e-mail: jean-francois.hren@inria.fr
+ *
+ * This software is a computer program whose purpose is to control
+ * deterministic systems using optimistic planning.
+ *
+ * This software is governed by the CeCILL license under French law and
+ * abiding by the rules of distribution of free software.  You can  use, 
+ * modify and/ or redistribute the software under the terms of the CeCILL
+ * license as circulated by CEA, CNRS and INRIA at the following URL
+ * "http://www.cecill.info". 
+ *
+ * As a counterpart to the access to the source code and  rights to copy,
+ * modify and redistribute granted by the license, users are provided only
+ * with a limited warranty  and the software's author,  the holder of the
+ * economic rights,  and the successive licensors  have only  limited
+ * liability. 
+ *
+ * In this respect, the user's attention is drawn to the risks associated
+ * with loading,  using,  modifying and/or developing or reproducing the
+ * software by the user in light of its specific status of free software,
+ * that may mean  that it is complicated to manipulate,  and  that  also
+ * therefore means  that it is reserved for developers  and  experienced
+ * professionals having in-depth computer knowledge. Users are therefore
+ * encouraged to load and test the software's suitability as regards their
+ * requirements in conditions enabling the security of their systems and/or 
+ * data to be ensured and,  more generally, to use and operate it in the 
+ * same conditions as regards security. 
+ *
+ * The fact that you are presently reading this means that you have had
+ * knowledge of the CeCILL license and that you accept its terms.
+ */
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+#define ARENA_SLAB_SIZE 1048576                             /* Default size in bytes of a slab */
+#define ARENA_ALIGNMENT 16                                  /* Every block is aligned on and rounded up to this size */
+#define ARENA_SMALL_LIMIT 1024                              /* Blocks up to this size are recycled by exact size class */
+#define ARENA_NB_SMALL_CLASSES (ARENA_SMALL_LIMIT / ARENA_ALIGNMENT)
+#define ARENA_NB_LARGE_CLASSES 48                           /* Larger blocks are recycled by power of two size class */
+
+
+/*+-------------------------------------+
+  | A slab of memory from which blocks  |
+  | are bump-allocated.                 |
+  +-------------------------------------+*/
+
+typedef struct arena_slab {
+
+    struct arena_slab* next;                                /* The next slab in the chain */
+    size_t size;                                            /* The number of bytes available in this slab */
+    size_t used;                                            /* The number of bytes already handed out */
+
+} arena_slab;
+
+
+/*+-------------------------------------+
+  | A freed block waiting to be reused. |
+  +-------------------------------------+*/
+
+typedef struct arena_block {
+
+    struct arena_block* next;
+
+} arena_block;
+
+
+/*+-------------------------------------+
+  | Represents an arena: blocks live    |
+  | until the whole arena is reset.     |
+  +-------------------------------------+*/
+
+typedef struct {
+
+    size_t slabSize;                                        /* The size of a regular slab */
+    arena_slab* slabs;                                      /* The chain of slabs, kept across resets */
+    arena_slab* crtSlab;                                    /* The slab currently bump-allocated from */
+
+    arena_block* freeLists[ARENA_NB_SMALL_CLASSES + ARENA_NB_LARGE_CLASSES]; /* Freed blocks by size class */
+
+    size_t bytesInUse;                                      /* Statistic about the number of bytes currently handed out */
+    size_t bytesReserved;                                   /* Statistic about the number of bytes obtained from the system */
+    unsigned int nbAllocations;                             /* Statistic about the number of calls to malloc done by the arena */
+
+} arena;
+
+
+arena* arena_init(size_t slabSize);
+void* arena_alloc(arena* memory, size_t size);
+void* arena_realloc(arena* memory, void* block, size_t oldSize, size_t newSize);
+void arena_free(arena* memory, void* block, size_t size);
+void arena_reset(arena* memory);
+void arena_uninit(arena** memory);
+
+#endif
@@ -0,0 +1,144 @@
+/* Copyright or © or Copr. 2012, Jean-François Hren
+ *
+ * Author e-mail: jean-francois.hren@inria.fr
+ *
+ * This software is a computer program whose purpose is to control
+ * deterministic systems using optimistic planning.
+ *
+ * This software is governed by the CeCILL license under French law and
+ * abiding by the rules of distribution of free software.  You can  use, 
+ * modify and/ or redistribute the software under the terms of the CeCILL
+ * license as circulated by CEA, CNRS and INRIA at the following URL
+ * "http://www.cecill.info". 
+ *
+ * As a counterpart to the access to the source code and  rights to copy,
+ * modify and redistribute granted by the license, users are provided only
+ * with a limited warranty  and the software's author,  the holder of the
+ * economic rights,  and the successive licensors  have only  limited
+ * liability. 
+ *
+ * In this respect, the user's attention is drawn to the risks associated
+ * with loading,  using,  modifying and/or developing or reproducing the
+ * software by the user in light of its specific status of free software,
+ * that may mean  that it is complicated to manipulate,  and  that  also
+ * therefore means  that it is reserved for developers  and  experienced
+ * professionals having in-depth computer knowledge. Users are therefore
+ * encouraged to load and test the software's suitability as regards their
+ * requirements in conditions enabling the security of their systems and/or 
+ * data to be ensured and,  more generally, to use and operate it in the 
+ * same conditions as regards security. 
+ *
+ * The fact that you are presently reading this means that you have had
+ * knowledge of the CeCILL license and that you accept its terms.
+ */
+
+#include <math.h>
+
+#include "box_geometry.h"
+
+/* 3^i at index i, folded by the compiler */
+static const double powersOfThree[BOX_GEOMETRY_NB_LEVELS] = {
+    1.0,
+    3.0,
+    9.0,
+    27.0,
+    81.0,
+    243.0,
+    729.0,
+    2187.0,
+    6561.0,
+    19683.0,
+    59049.0,
+    177147.0,
+    531441.0,
+    1594323.0,
+    4782969.0,
+    14348907.0,
+    43046721.0,
+    129140163.0,
+    387420489.0,
+    1162261467.0,
+    3486784401.0,
+    10460353203.0,
+    31381059609.0,
+    94143178827.0,
+    282429536481.0,
+    847288609443.0,
+    2541865828329.0,
+    7625597484987.0,
+    22876792454961.0,
+    68630377364883.0,
+    205891132094649.0,
+    617673396283947.0,
+    1853020188851841.0,
+    5559060566555523.0
+};
+
+/* 1/3^(i+1) at index i, folded by the compiler */
+static const double shifts[BOX_GEOMETRY_NB_LEVELS] = {
+    1.0 / 3.0,
+    1.0 / 9.0,
+    1.0 / 27.0,
+    1.0 / 81.0,
+    1.0 / 243.0,
+    1.0 / 729.0,
+    1.0 / 2187.0,
+    1.0 / 6561.0,
+    1.0 / 19683.0,
+    1.0 / 59049.0,
+    1.0 / 177147.0,
+    1.0 / 531441.0,
+    1.0 / 1594323.0,
+    1.0 / 4782969.0,
+    1.0 / 14348907.0,
+    1.0 / 43046721.0,
+    1.0 / 129140163.0,
+    1.0 / 387420489.0,
+    1.0 / 1162261467.0,
+    1.0 / 3486784401.0,
+    1.0 / 10460353203.0,
+    1.0 / 31381059609.0,
+    1.0 / 94143178827.0,
+    1.0 / 282429536481.0,
+    1.0 / 847288609443.0,
+    1.0 / 2541865828329.0,
+    1.0 / 7625597484987.0,
+    1.0 / 22876792454961.0,
+    1.0 / 68630377364883.0,
+    1.0 / 205891132094649.0,
+    1.0 / 617673396283947.0,
+    1.0 / 1853020188851841.0,
+    1.0 / 5559060566555523.0,
+    1.0 / 16677181699666569.0
+};
+
+
+/*+------------------------------------------+
+  | Return 3^level, looked up in the table   |
+  | unless the level is beyond it            |
+  +------------------------------------------+*/
+
+double box_geometry_getPowerOfThree(unsigned int level) {
+
+    if(level < BOX_GEOMETRY_NB_LEVELS)
+        return powersOfThree[level];
+
+    return pow(3, level);
+
+}
+
+
+/*+------------------------------------------+
+  | Return 1/3^(level+1), the distance from  |
+  | the center of a box of the given level   |
+  | to the centers of its side children      |
+  +------------------------------------------+*/
+
+double box_geometry_getShift(unsigned int level) {
+
+    if(level < BOX_GEOMETRY_NB_LEVELS)
+        return shifts[level];
+
+    return 1.0 / pow(3, level + 1);
+
+}
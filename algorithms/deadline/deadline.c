@@ -0,0 +1,86 @@
+/* Copyright or © or Copr. 2012, Jean-François Hren
+ *
+ * Author e-mail: jean-francois.hren@inria.fr
+ *
+ * This software is a computer program whose purpose is to control
+ * deterministic systems using optimistic planning.
+ *
+ * This software is governed by the CeCILL license under French law and
+ * abiding by the rules of distribution of free software.  You can  use, 
+ * modify and/ or redistribute the software under the terms of the CeCILL
+ * license as circulated by CEA, CNRS and INRIA at the following URL
+ * "http://www.cecill.info". 
+ *
+ * As a counterpart to the access to the source code and  rights to copy,
+ * modify and redistribute granted by the license, users are provided only
+ * with a limited warranty  and the software's author,  the holder of the
+ * economic rights,  and the successive licensors  have only  limited
+ * liability. 
+ *
+ * In this respect, the user's attention is drawn to the risks associated
+ * with loading,  using,  modifying and/or developing or reproducing the
+ * software by the user in light of its specific status of free software,
+ * that may mean  that it is complicated to manipulate,  and  that  also
+ * therefore means  that it is reserved for developers  and  experienced
+ * professionals having in-depth computer knowledge. Users are therefore
+ * encouraged to load and test the software's suitability as regards their
+ * requirements in conditions enabling the security of their systems and/or 
+ * data to be ensured and,  more generally, to use and operate it in the 
+ * same conditions as regards security. 
+ *
+ * The fact that you are presently reading this means that you have had
+ * knowledge of the CeCILL license and that you accept its terms.
+ */
+
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <time.h>
+
+#include "deadline.h"
+
+/*+------------------------------------------+
+  | Return the time of the monotonic clock   |
+  | in seconds                               |
+  +------------------------------------------+*/
+
+double deadline_now() {
+
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return now.tv_sec + (now.tv_nsec * 1e-9);
+
+}
+
+
+/*+------------------------------------------+
+  | Start a budget of the given number of    |
+  | seconds from now                         |
+  +------------------------------------------+*/
+
+void deadline_start(deadline* budget, double seconds) {
+
+    budget->end = deadline_now() + seconds;
+    budget->nextCheck = 0;
+    budget->isOver = 0;
+
+}
+
+
+/*+------------------------------------------+
+  | Tell whether the budget is spent once    |
+  | nbEvaluations evaluations have been done |
+  +------------------------------------------+*/
+
+char deadline_isOver(deadline* budget, unsigned int nbEvaluations) {
+
+    if(!budget->isOver && (nbEvaluations >= budget->nextCheck)) {
+        budget->isOver = deadline_now() >= budget->end;
+        budget->nextCheck = nbEvaluations + DEADLINE_CHECK_PERIOD;
+    }
+
+    return budget->isOver;
+
+}
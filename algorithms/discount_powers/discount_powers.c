@@ -0,0 +1,163 @@
+/* Copyright or © or Copr. 2012, Jean-François Hren
+ *
+ * Author e-mail: jean-francois.hren@inria.fr
+ *
+ * This software is a computer program whose purpose is to control
+ * deterministic systems using optimistic planning.
+ *
+ * This software is governed by the CeCILL license under French law and
+ * abiding by the rules of distribution of free software.  You can  use, 
+ * modify and/ or redistribute the software under the terms of the CeCILL
+ * license as circulated by CEA, CNRS and INRIA at the following URL
+ * "http://www.cecill.info". 
+ *
+ * As a counterpart to the access to the source code and  rights to copy,
+ * modify and redistribute granted by the license, users are provided only
+ * with a limited warranty  and the software's author,  the holder of the
+ * economic rights,  and the successive licensors  have only  limited
+ * liability. 
+ *
+ * In this respect, the user's attention is drawn to the risks associated
+ * with loading,  using,  modifying and/or developing or reproducing the
+ * software by the user in light of its specific status of free software,
+ * that may mean  that it is complicated to manipulate,  and  that  also
+ * therefore means  that it is reserved for developers  and  experienced
+ * professionals having in-depth computer knowledge. Users are therefore
+ * encouraged to load and test the software's suitability as regards their
+ * requirements in conditions enabling the security of their systems and/or 
+ * data to be ensured and,  more generally, to use and operate it in the 
+ * same conditions as regards security. 
+ *
+ * The fact that you are presently reading this means that you have had
+ * knowledge of the CeCILL license and that you accept its terms.
+ */
+
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "discount_powers.h"
+
+static discount_powers* tables = NULL;                      /* The tables in use */
+static pthread_mutex_t tablesLock = PTHREAD_MUTEX_INITIALIZER;  /* Protects the tables and their content */
+
+
+/*+------------------------------------------+
+  | Return the table of the given discount   |
+  | factor, created if no instance uses it   |
+  | yet                                      |
+  +------------------------------------------+*/
+
+discount_powers* discount_powers_acquire(double gamma) {
+
+    discount_powers* table = NULL;
+
+    pthread_mutex_lock(&tablesLock);
+
+    for(table = tables; table != NULL; table = table->next) {
+        if(table->gamma == gamma)
+            break;
+    }
+
+    if(table == NULL) {
+        table = (discount_powers*)malloc(sizeof(discount_powers));
+        table->gamma = gamma;
+        table->powers = NULL;
+        table->nbPowers = 0;
+        table->retired = NULL;
+        table->nbRetired = 0;
+        table->nbUsers = 0;
+        table->next = tables;
+        tables = table;
+    }
+
+    table->nbUsers++;
+
+    pthread_mutex_unlock(&tablesLock);
+
+    return table;
+
+}
+
+
+/*+------------------------------------------+
+  | Return the powers of the table with at   |
+  | least the first nbPowers computed, their |
+  | number being put in nbAvailable. The     |
+  | returned array stays valid until the     |
+  | table is released even if it grows.      |
+  +------------------------------------------+*/
+
+double* discount_powers_reserve(discount_powers* table, unsigned int nbPowers, unsigned int* nbAvailable) {
+
+    double* powers = NULL;
+
+    pthread_mutex_lock(&tablesLock);
+
+    if(nbPowers > table->nbPowers) {
+        unsigned int newNbPowers = table->nbPowers < DISCOUNT_POWERS_INITIAL_SIZE ? DISCOUNT_POWERS_INITIAL_SIZE : table->nbPowers * 2;
+        unsigned int i = table->nbPowers;
+
+        if(newNbPowers < nbPowers)
+            newNbPowers = nbPowers;
+
+        powers = (double*)malloc(sizeof(double) * newNbPowers);
+
+        if(table->powers != NULL) {
+            memcpy(powers, table->powers, sizeof(double) * table->nbPowers);
+            table->retired = (double**)realloc(table->retired, sizeof(double*) * (table->nbRetired + 1));
+            table->retired[table->nbRetired++] = table->powers;
+        } else {
+            powers[0] = 1.0;
+            i = 1;
+        }
+
+        for(; i < newNbPowers; i++)
+            powers[i] = powers[i - 1] * table->gamma;
+
+        table->powers = powers;
+        table->nbPowers = newNbPowers;
+    }
+
+    powers = table->powers;
+    *nbAvailable = table->nbPowers;
+
+    pthread_mutex_unlock(&tablesLock);
+
+    return powers;
+
+}
+
+
+/*+------------------------------------------+
+  | Release a table, freed once no instance  |
+  | uses it anymore                          |
+  +------------------------------------------+*/
+
+void discount_powers_release(discount_powers** table) {
+
+    pthread_mutex_lock(&tablesLock);
+
+    if(--(*table)->nbUsers == 0) {
+        discount_powers** crt = &tables;
+        unsigned int i = 0;
+
+        while(*crt != *table)
+            crt = &(*crt)->next;
+        *crt = (*table)->next;
+
+        for(; i < (*table)->nbRetired; i++)
+            free((*table)->retired[i]);
+        free((*table)->retired);
+        free((*table)->powers);
+        free(*table);
+    }
+
+    pthread_mutex_unlock(&tablesLock);
+
+    *table = NULL;
+
+}
@@ -2,13 +2,14 @@ CC_OPTIONS := -O3
 USE_SDL := 1
 CC := gcc
 FLAGS := -W -Wall $(CC_OPTIONS) -ansi -std=c99 -pedantic -Werror$(if $(USE_SDL), -DUSE_SDL)
-LIBS := -lm$(if $(USE_SDL), -lSDL -lSDLmain /usr/lib/libSDL_gfx.so) -largtable2 -lgsl -lgslcblas
+REGISTRY_FLAGS := -W -Wall $(CC_OPTIONS) -ansi -std=c99 -pedantic -Werror -DUSE_REGISTRY
+LIBS := -lm$(if $(USE_SDL), -lSDL -lSDLmain /usr/lib/libSDL_gfx.so) -largtable2 -lgsl -lgslcblas -lpthread
 BIN_DIR := ../bin
 OBJ_DIR := ../obj
 
-all:  $(addprefix $(BIN_DIR)/lipschitzian_,$(PROBLEMS)) $(foreach i,2 3 4 5,$(BIN_DIR)/lipschitzian_$i_swimmer)
+all:  $(addprefix $(BIN_DIR)/lipschitzian_,$(PROBLEMS)) $(foreach i,2 3 4 5,$(BIN_DIR)/lipschitzian_$i_swimmer) $(foreach i,1 2 3 4 5,$(BIN_DIR)/lipschitzian_registry_$i)
 
-$(BIN_DIR)/lipschitzian_double_cart_pole: $(OBJ_DIR)/lipschitzian_2.o $(OBJ_DIR)/main_lipschitzian_2.o $(OBJ_DIR)/double_cart_pole.o $(if $(USE_SDL), $(OBJ_DIR)/viewer_double_cart_pole.o)
+$(BIN_DIR)/lipschitzian_double_cart_pole: $(OBJ_DIR)/deadline.o $(OBJ_DIR)/discount_powers.o $(OBJ_DIR)/worker_pool.o $(OBJ_DIR)/arena.o $(OBJ_DIR)/transition_cache.o $(OBJ_DIR)/lipschitzian_2.o $(OBJ_DIR)/main_lipschitzian_2.o $(OBJ_DIR)/double_cart_pole.o $(OBJ_DIR)/generative_model.o $(if $(USE_SDL), $(OBJ_DIR)/viewer_double_cart_pole.o)
 	$(CC) $(FLAGS) $(LIBS) $^ -o $@
 
 .SECONDARY: #Marked as secondary file that should not be deleted because of the chaining of implicit rule
@@ -18,9 +19,30 @@ $(OBJ_DIR)/lipschitzian_%.o: lipschitzian/lipschitzian.c lipschitzian/lipschitzi
 $(OBJ_DIR)/main_lipschitzian_%.o: lipschitzian/main_lipschitzian.c
 	$(CC) -c $(FLAGS) -D NUMBER_OF_DIMENSIONS_OF_ACTION=$* $< -o $@
 
+$(OBJ_DIR)/main_lipschitzian_registry_%.o: lipschitzian/main_lipschitzian.c
+	$(CC) -c $(REGISTRY_FLAGS) -D NUMBER_OF_DIMENSIONS_OF_ACTION=$* $< -o $@
+
+$(OBJ_DIR)/arena.o: arena/arena.c arena/arena.h
+	$(CC) -c $(FLAGS) $< -o $@
+
+$(OBJ_DIR)/transition_cache.o: transition_cache/transition_cache.c transition_cache/transition_cache.h
+	$(CC) -c $(FLAGS) $< -o $@
+
+$(OBJ_DIR)/deadline.o: deadline/deadline.c deadline/deadline.h
+	$(CC) -c $(FLAGS) $< -o $@
+
+$(OBJ_DIR)/discount_powers.o: discount_powers/discount_powers.c discount_powers/discount_powers.h
+	$(CC) -c $(FLAGS) $< -o $@
+
+$(OBJ_DIR)/worker_pool.o: worker_pool/worker_pool.c worker_pool/worker_pool.h
+	$(CC) -c $(FLAGS) $< -o $@
+
 .SECONDEXPANSION:
-$(BIN_DIR)/lipschitzian_%_swimmer: $(OBJ_DIR)/lipschitzian_$$*.o $(OBJ_DIR)/main_lipschitzian_$$*.o $(OBJ_DIR)/swimmer_$$*.o $$(if $(USE_SDL), $(OBJ_DIR)/viewer_swimmer_$$*.o)
+$(BIN_DIR)/lipschitzian_%_swimmer: $(OBJ_DIR)/deadline.o $(OBJ_DIR)/discount_powers.o $(OBJ_DIR)/worker_pool.o $(OBJ_DIR)/arena.o $(OBJ_DIR)/transition_cache.o $(OBJ_DIR)/lipschitzian_$$*.o $(OBJ_DIR)/main_lipschitzian_$$*.o $(OBJ_DIR)/swimmer_$$*.o $(OBJ_DIR)/generative_model.o $$(if $(USE_SDL), $(OBJ_DIR)/viewer_swimmer_$$*.o)
 	$(CC) $(FLAGS) $(LIBS) $^ -o $@
 
-$(BIN_DIR)/lipschitzian_%: $(OBJ_DIR)/lipschitzian_1.o $(OBJ_DIR)/main_lipschitzian_1.o $(OBJ_DIR)/$$*.o $$(if $(USE_SDL),$(OBJ_DIR)/viewer_$$*.o)
+$(BIN_DIR)/lipschitzian_%: $(OBJ_DIR)/deadline.o $(OBJ_DIR)/discount_powers.o $(OBJ_DIR)/worker_pool.o $(OBJ_DIR)/arena.o $(OBJ_DIR)/transition_cache.o $(OBJ_DIR)/lipschitzian_1.o $(OBJ_DIR)/main_lipschitzian_1.o $(OBJ_DIR)/$$*.o $(OBJ_DIR)/generative_model.o $$(if $(USE_SDL),$(OBJ_DIR)/viewer_$$*.o)
 	$(CC) $(FLAGS) $(LIBS) $^ -o $@
+
+$(BIN_DIR)/lipschitzian_registry_%: $(OBJ_DIR)/deadline.o $(OBJ_DIR)/discount_powers.o $(OBJ_DIR)/worker_pool.o $(OBJ_DIR)/arena.o $(OBJ_DIR)/transition_cache.o $(OBJ_DIR)/lipschitzian_$$*.o $(OBJ_DIR)/main_lipschitzian_registry_$$*.o $(OBJ_DIR)/registry.o
+	$(CC) $(FLAGS) $(LIBS) -ldl $^ -o $@
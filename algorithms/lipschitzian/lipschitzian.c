@@ -34,6 +34,7 @@
 
 #include <stdlib.h>
 #include <string.h>
+#include <float.h>
 #define __USE_GNU
 #include <math.h>
 #undef __USE_GNU
@@ -45,27 +46,398 @@
 
 #include "lipschitzian.h"
 
-#define INCREMENT_STEP_SUBSPACES_ARRAY 32
+#define SUBSPACE(subset, i) ((subset)->chunks[(i) / SUBSPACES_CHUNK_SIZE]->subspaces + ((i) % SUBSPACES_CHUNK_SIZE))
+
+/*+-----------------------------------------+
+  | Allocate a zeroed state that is filled  |
+  | by nextStateRewardInto                  |
+  +-----------------------------------------+*/
+
+static state* newState(lipschitzian_instance* instance) {
+
+    /* The padding the model leaves untouched must not make equal states differ in the cache */
+    state* s = (state*)arena_alloc(instance->memory, stateSize());
+    memset(s, 0, stateSize());
+
+    return s;
+
+}
+
+
+/*+-----------------------------------------+
+  | Copy a state into the arena             |
+  +-----------------------------------------+*/
+
+static state* duplicateState(lipschitzian_instance* instance, state* s) {
+
+    state* copy = newState(instance);
+    memcpy(copy, s, stateSize());
+
+    return copy;
+
+}
+
+
+/*+-----------------------------------------+
+  | Allocate the siblings of a state with   |
+  | room for maxNbPoints actions            |
+  +-----------------------------------------+*/
+
+static lipschitzian_siblings* newSiblings(lipschitzian_instance* instance, unsigned int maxNbPoints, double maxSlope) {
+
+    lipschitzian_siblings* siblings = (lipschitzian_siblings*)arena_alloc(instance->memory, sizeof(lipschitzian_siblings));
+
+    if(maxNbPoints < SIBLINGS_INITIAL_NB_POINTS)
+        maxNbPoints = SIBLINGS_INITIAL_NB_POINTS;
+
+    siblings->points = (lipschitzian_sibling*)arena_alloc(instance->memory, sizeof(lipschitzian_sibling) * maxNbPoints);
+    siblings->nbPoints = 0;
+    siblings->maxNbPoints = maxNbPoints;
+    siblings->maxSlope = maxSlope;
+
+    return siblings;
+
+}
+
+
+/*+-----------------------------------------+
+  | Make room for one more action among the |
+  | siblings                                |
+  +-----------------------------------------+*/
+
+static void reserveSibling(lipschitzian_instance* instance, lipschitzian_siblings* siblings) {
+
+    if(siblings->nbPoints == siblings->maxNbPoints) {
+        siblings->points = (lipschitzian_sibling*)arena_realloc(instance->memory, siblings->points, sizeof(lipschitzian_sibling) * siblings->maxNbPoints, sizeof(lipschitzian_sibling) * siblings->maxNbPoints * 2);
+        siblings->maxNbPoints *= 2;
+    }
+
+}
+
+
+/* Raise the largest slope of the siblings to the one between a point and a new action */
+static void compareSibling(lipschitzian_siblings* siblings, lipschitzian_sibling* other, double coordinate, double reward) {
+
+    double slope = fabs(other->reward - reward) / fabs(other->coordinate - coordinate);
+
+    if(slope > siblings->maxSlope)
+        siblings->maxSlope = slope;
+
+}
+
+
+/*+-----------------------------------------+
+  | Add the action of a subspace, once      |
+  | simulated, to the siblings of its state |
+  | and compare it with the actions of the  |
+  | closest first coordinates on each side. |
+  | Actions with the same first coordinate  |
+  | give no slope.                          |
+  +-----------------------------------------+*/
+
+static void addSibling(lipschitzian_instance* instance, lipschitzian_subspace* subspace) {
+
+    lipschitzian_siblings* siblings = subspace->siblings;
+    double coordinate = subspace->action[0];
+    unsigned int low = 0;
+    unsigned int high = siblings->nbPoints;
+    unsigned int i = 0;
+
+    /* The first point with a greater first coordinate */
+    while(low < high) {
+        unsigned int middle = (low + high) / 2;
+
+        if(siblings->points[middle].coordinate > coordinate)
+            high = middle;
+        else
+            low = middle + 1;
+    }
+
+    for(i = low; (i > 0) && (siblings->points[i - 1].coordinate == coordinate); i--);
+
+    if(i > 0) {
+        double closest = siblings->points[i - 1].coordinate;
+
+        for(; (i > 0) && (siblings->points[i - 1].coordinate == closest); i--)
+            compareSibling(siblings, siblings->points + i - 1, coordinate, subspace->reward);
+    }
+
+    for(i = low; (i < siblings->nbPoints) && (siblings->points[i].coordinate == siblings->points[low].coordinate); i++)
+        compareSibling(siblings, siblings->points + i, coordinate, subspace->reward);
+
+    reserveSibling(instance, siblings);
+
+    memmove(siblings->points + low + 1, siblings->points + low, sizeof(lipschitzian_sibling) * (siblings->nbPoints - low));
+    siblings->points[low].coordinate = coordinate;
+    siblings->points[low].reward = subspace->reward;
+    siblings->nbPoints++;
+
+}
+
+
+static lipschitzian_siblings* copySiblings(lipschitzian_instance* instance, lipschitzian_siblings* siblings) {
+
+    lipschitzian_siblings* copy = newSiblings(instance, siblings->nbPoints, siblings->maxSlope);
+
+    memcpy(copy->points, siblings->points, sizeof(lipschitzian_sibling) * siblings->nbPoints);
+    copy->nbPoints = siblings->nbPoints;
+
+    return copy;
+
+}
+
+
+/*+-----------------------------------------+
+  | Allocate a chunk that only owner may    |
+  | modify in place                         |
+  +-----------------------------------------+*/
+
+static lipschitzian_chunk* newChunk(lipschitzian_instance* instance, lipschitzian_subset* owner) {
+
+    lipschitzian_chunk* chunk = (lipschitzian_chunk*)arena_alloc(instance->memory, sizeof(lipschitzian_chunk));
+    chunk->owner = owner;
+
+    return chunk;
+
+}
+
+
+/*+-----------------------------------------+
+  | Return the i-th subspace of a subset to |
+  | modify it. Its chunk is copied first if |
+  | it is shared and missing chunks are     |
+  | appended.                               |
+  +-----------------------------------------+*/
+
+static lipschitzian_subspace* writableSubspace(lipschitzian_instance* instance, lipschitzian_subset* subset, unsigned int i) {
+
+    unsigned int chunkIndex = i / SUBSPACES_CHUNK_SIZE;
+
+    if(chunkIndex >= subset->nbChunks) {
+        subset->chunks = (lipschitzian_chunk**)arena_realloc(instance->memory, subset->chunks, sizeof(lipschitzian_chunk*) * subset->nbChunks, sizeof(lipschitzian_chunk*) * (chunkIndex + 1));
+
+        for(; subset->nbChunks <= chunkIndex; subset->nbChunks++)
+            subset->chunks[subset->nbChunks] = newChunk(instance, subset);
+    }
+
+    if(subset->chunks[chunkIndex]->owner != subset) {
+        lipschitzian_chunk* copy = newChunk(instance, subset);
+        memcpy(copy->subspaces, subset->chunks[chunkIndex]->subspaces, sizeof(copy->subspaces));
+        subset->chunks[chunkIndex] = copy;
+    }
+
+    return subset->chunks[chunkIndex]->subspaces + (i % SUBSPACES_CHUNK_SIZE);
+
+}
+
+
+/*+-----------------------------------------+
+  | Make a subset start with the same       |
+  | subspaces as another one without        |
+  | copying them                            |
+  +-----------------------------------------+*/
+
+static void shareSubspaces(lipschitzian_instance* instance, lipschitzian_subset* from, lipschitzian_subset* to) {
+
+    to->chunks = (lipschitzian_chunk**)arena_alloc(instance->memory, sizeof(lipschitzian_chunk*) * from->nbChunks);
+    memcpy(to->chunks, from->chunks, sizeof(lipschitzian_chunk*) * from->nbChunks);
+    to->nbChunks = from->nbChunks;
+
+}
+
+
+/*+-----------------------------------------------------+
+  | Tell whether a subset has to be above another in    |
+  | the frontier. Among equal bounds, the subsets are   |
+  | ordered as in the tree the frontier replaced, which |
+  | was filled level by level in creation order: the    |
+  | root and the right children come before their       |
+  | descendants, the left children after them, and a    |
+  | right subtree comes before its left sibling.        |
+  +-----------------------------------------------------+*/
+
+static char isAbove(lipschitzian_subset* a, lipschitzian_subset* b) {
+
+    unsigned int nodeA = a->order + 1;
+    unsigned int nodeB = b->order + 1;
+    int depthA = 0;
+    int depthB = 0;
+
+    if(a->bound != b->bound)
+        return a->bound > b->bound;
+
+    depthA = ilogb(nodeA);
+    depthB = ilogb(nodeB);
+
+    if(depthA > depthB)
+        nodeA >>= depthA - depthB;
+    else
+        nodeB >>= depthB - depthA;
+
+    /* One is an ancestor of the other, both nodes being now the older one */
+    if(nodeA == nodeB)
+        return (a->order < b->order) == ((nodeA % 2) == 1);
+
+    /* At the same depth, the greater node is on the right of the first fork */
+    return nodeA > nodeB;
+
+}
+
+
+/*+-----------------------------------------------------+
+  | Put a subset at the given position of the frontier  |
+  +-----------------------------------------------------+*/
+
+static void placeInFrontier(lipschitzian_instance* instance, lipschitzian_subset* subset, unsigned int index) {
+
+    instance->frontier[index] = subset;
+    subset->frontierIndex = index;
+
+}
+
+
+/*+-----------------------------------------------------+
+  | Move a subset up the frontier while it is above its |
+  | parent                                              |
+  +-----------------------------------------------------+*/
+
+static void siftUp(lipschitzian_instance* instance, lipschitzian_subset* subset) {
+
+    unsigned int index = subset->frontierIndex;
+
+    while(index > 0) {
+        unsigned int parent = (index - 1) / FRONTIER_ARITY;
+
+        if(!isAbove(subset, instance->frontier[parent]))
+            break;
+
+        placeInFrontier(instance, instance->frontier[parent], index);
+        index = parent;
+    }
+
+    placeInFrontier(instance, subset, index);
+
+}
+
+
+/*+-----------------------------------------------------+
+  | Move a subset down the frontier while one of its    |
+  | children is above it                                |
+  +-----------------------------------------------------+*/
+
+static void siftDown(lipschitzian_instance* instance, lipschitzian_subset* subset) {
+
+    unsigned int index = subset->frontierIndex;
+
+    for(;;) {
+        unsigned int firstChild = (index * FRONTIER_ARITY) + 1;
+        unsigned int lastChild = firstChild + FRONTIER_ARITY < instance->frontierSize ? firstChild + FRONTIER_ARITY : instance->frontierSize;
+        unsigned int maxChild = firstChild;
+        unsigned int i = firstChild + 1;
+
+        if(firstChild >= instance->frontierSize)
+            break;
+
+        for(; i < lastChild; i++) {
+            if(isAbove(instance->frontier[i], instance->frontier[maxChild]))
+                maxChild = i;
+        }
+
+        if(!isAbove(instance->frontier[maxChild], subset))
+            break;
+
+        placeInFrontier(instance, instance->frontier[maxChild], index);
+        index = maxChild;
+    }
+
+    placeInFrontier(instance, subset, index);
+
+}
+
+
+/*+-----------------------------------------------------+
+  | Add a new subset to the frontier                    |
+  +-----------------------------------------------------+*/
+
+static void pushIntoFrontier(lipschitzian_instance* instance, lipschitzian_subset* subset) {
+
+    if(instance->frontierSize == instance->maxFrontierSize) {
+        unsigned int newMaxFrontierSize = instance->maxFrontierSize == 0 ? INITIAL_FRONTIER_SIZE : instance->maxFrontierSize * 2;
+
+        instance->frontier = (lipschitzian_subset**)arena_realloc(instance->memory, instance->frontier, sizeof(lipschitzian_subset*) * instance->maxFrontierSize, sizeof(lipschitzian_subset*) * newMaxFrontierSize);
+        instance->maxFrontierSize = newMaxFrontierSize;
+    }
+
+    placeInFrontier(instance, subset, instance->frontierSize++);
+    siftUp(instance, subset);
+
+}
+
+
+/*+-----------------------------------------------------+
+  | Restore the frontier after the bound of a subset    |
+  | has increased or decreased                          |
+  +-----------------------------------------------------+*/
+
+static void updateFrontier(lipschitzian_instance* instance, lipschitzian_subset* subset) {
+
+    siftUp(instance, subset);
+    siftDown(instance, subset);
+
+}
+
+
+/*+-----------------------------------------------------+
+  | Make sure the powers of the discount factor go far  |
+  | enough for the deepest sequence, whose bound reads  |
+  | up to the power of index maxDepth + 1               |
+  +-----------------------------------------------------+*/
+
+static void reserveGammaPowers(lipschitzian_instance* instance) {
+
+    if((instance->maxDepth + 2) > instance->nbGammaPowers)
+        instance->gammaPowers = discount_powers_reserve(instance->discountPowers, instance->maxDepth + 2, &instance->nbGammaPowers);
+
+}
+
 
 /*+------------------------------------------------------+
   | Initialize an instance of the lipschitzian algorithm |
   +------------------------------------------------------+*/
 
-lipschitzian_instance* lipschitzian_initInstance(state* initial, double discountFactor, double L) {
+lipschitzian_instance* lipschitzian_initInstance(model_context* context, state* initial, double discountFactor, double L) {
 
     lipschitzian_instance* instance = (lipschitzian_instance*)malloc(sizeof(lipschitzian_instance));
-    unsigned int i = 1;
 
-    instance->gammaPowers[0] = 1.0;
-
-    for(; i < NB_COMPUTED_POWER; i++)
-        instance->gammaPowers[i] = instance->gammaPowers[i - 1] * discountFactor;
+    instance->discountPowers = discount_powers_acquire(discountFactor);
+    instance->gammaPowers = NULL;
+    instance->nbGammaPowers = 0;
 
+    instance->context = context;
     instance->L = L;
     instance->gamma = discountFactor;
 
     instance->subsets = NULL;
     instance->list = NULL;
+    instance->memory = arena_init(ARENA_SLAB_SIZE);
+    instance->cache = NULL;
+
+    instance->loweringSums = NULL;
+    instance->loweringPowers = NULL;
+    instance->estimatedNewBounds = NULL;
+    instance->maxNbLowerings = 0;
+
+    instance->isLAdaptive = 0;
+
+    instance->maxBytes = 0;
+    instance->nbPrunedSubsets = 0;
+    instance->isMemoryExhausted = 0;
+    instance->isPrunedByBound = 0;
+
+    instance->pool = NULL;
+    instance->nbSubsetsPerRound = 0;
+    instance->discretizations = NULL;
+    instance->transitions = NULL;
 
     if(initial != NULL)
         lipschitzian_resetInstance(instance, initial);
@@ -75,23 +447,114 @@ lipschitzian_instance* lipschitzian_initInstance(state* initial, double discount
 }
 
 
-/*+--------------------------+
-  | Free the tree of subsets |
-  +--------------------------+*/
+/*+--------------------------------------------+
+  | Serve the transitions of a batch from the  |
+  | cache, if any                              |
+  +--------------------------------------------+*/
+
+static void lookupTransitions(lipschitzian_instance* instance, lipschitzian_transition* transition) {
+
+    unsigned int i = 0;
 
-static void freeSubsets(lipschitzian_subset* subset) {
+    for(; (i < transition->k) && (i < MAX_NB_TRANSITIONS); i++)
+        transition->isCached[i] = (instance->cache != NULL) && transition_cache_lookup(instance->cache, transition->s, transition->actions + (i * NUMBER_OF_DIMENSIONS_OF_ACTION), transition->nextStates[i], transition->rewards + i, transition->isTerminal + i);
 
-    while(subset != NULL) {
-        unsigned int i = 0;
-        lipschitzian_subset* next = subset->next;
+}
 
-        for(; i <= (subset->n+1); i++)
-          freeState(subset->subspaces[i].s);
 
-        free(subset->subspaces);
-        free(subset);
+/*+--------------------------------------------+
+  | Simulate together the transitions of a     |
+  | batch the cache did not serve. Only the    |
+  | batch is modified so that several batches  |
+  | can be simulated concurrently.             |
+  +--------------------------------------------+*/
 
-        subset = next;
+static void simulateTransitions(model_context* context, lipschitzian_transition* transition) {
+
+    double missedActions[MAX_NB_TRANSITIONS * NUMBER_OF_DIMENSIONS_OF_ACTION];
+    state* missedNextStates[MAX_NB_TRANSITIONS];
+    double missedRewards[MAX_NB_TRANSITIONS];
+    char missedIsTerminal[MAX_NB_TRANSITIONS];
+    unsigned int missedIndices[MAX_NB_TRANSITIONS];
+    unsigned int nbMissed = 0;
+    unsigned int i = 0;
+
+    for(; (i < transition->k) && (i < MAX_NB_TRANSITIONS); i++) {
+        if(!transition->isCached[i]) {
+            memcpy(missedActions + (nbMissed * NUMBER_OF_DIMENSIONS_OF_ACTION), transition->actions + (i * NUMBER_OF_DIMENSIONS_OF_ACTION), sizeof(double) * NUMBER_OF_DIMENSIONS_OF_ACTION);
+            missedNextStates[nbMissed] = transition->nextStates[i];
+            missedIndices[nbMissed] = i;
+            nbMissed++;
+        }
+    }
+
+    if(nbMissed == 0)
+        return;
+
+    if(transition->k == 1)
+        missedIsTerminal[0] = nextStateRewardIntoWithContext(context, transition->s, missedActions, missedNextStates[0], missedRewards);
+    else
+        nextStateRewardMultiWithContext(context, transition->s, nbMissed, missedActions, missedNextStates, missedRewards, missedIsTerminal);
+
+    for(i = 0; i < nbMissed; i++) {
+        transition->rewards[missedIndices[i]] = missedRewards[i];
+        transition->isTerminal[missedIndices[i]] = missedIsTerminal[i];
+    }
+
+}
+
+
+/*+--------------------------------------------+
+  | Keep the simulated transitions of a batch  |
+  | in the cache, if any                       |
+  +--------------------------------------------+*/
+
+static void storeTransitions(lipschitzian_instance* instance, lipschitzian_transition* transition) {
+
+    unsigned int i = 0;
+
+    if(instance->cache == NULL)
+        return;
+
+    for(; (i < transition->k) && (i < MAX_NB_TRANSITIONS); i++) {
+        if(!transition->isCached[i])
+            transition_cache_insert(instance->cache, transition->s, transition->actions + (i * NUMBER_OF_DIMENSIONS_OF_ACTION), transition->nextStates[i], transition->rewards[i], transition->isTerminal[i]);
+    }
+
+}
+
+
+static void simulate(lipschitzian_instance* instance, lipschitzian_transition* transition) {
+
+    lookupTransitions(instance, transition);
+    simulateTransitions(instance->context, transition);
+    storeTransitions(instance, transition);
+
+}
+
+
+static void simulateTransitionsTask(void* data, unsigned int index) {
+
+    lipschitzian_instance* instance = (lipschitzian_instance*)data;
+
+    simulateTransitions(instance->context, instance->transitions + index);
+
+}
+
+
+/*+--------------------------------------------+
+  | Set L to the estimation from the tree about |
+  | to be dropped, if adaptive                 |
+  +--------------------------------------------+*/
+
+static void adaptL(lipschitzian_instance* instance) {
+
+    if(instance->isLAdaptive) {
+        double L = lipschitzian_computeNextL(instance);
+
+        /* No two subsets with different rewards: nothing to learn from */
+        if(L > 0.0)
+            instance->L = L;
     }
 
 }
@@ -104,50 +567,78 @@ static void freeSubsets(lipschitzian_subset* subset) {
 void lipschitzian_resetInstance(lipschitzian_instance* instance, state* initial) {
 
     unsigned int i = 0;
+    lipschitzian_transition transition;
+    lipschitzian_subspace* first = NULL;
+    lipschitzian_subspace* second = NULL;
 
-    if(instance->subsets != NULL)
-        freeSubsets(instance->list);
+    if(instance->subsets != NULL) {
+        adaptL(instance);
 
-    instance->subsets = (lipschitzian_subset*)malloc(sizeof(lipschitzian_subset));
+        /* The slabs kept by a reset would leave the instance over its memory limit */
+        if((instance->maxBytes > 0) && (lipschitzian_getMemoryUsage(instance) > instance->maxBytes)) {
+            size_t slabSize = instance->memory->slabSize;
+
+            arena_uninit(&instance->memory);
+            instance->memory = arena_init(slabSize);
+        } else {
+            arena_reset(instance->memory);
+        }
+    }
+
+    instance->subsets = (lipschitzian_subset*)arena_alloc(instance->memory, sizeof(lipschitzian_subset));
 
     instance->list = instance->subsets;
 
-    instance->subsets->subspaces = (lipschitzian_subspace*)malloc(sizeof(lipschitzian_subspace) * INCREMENT_STEP_SUBSPACES_ARRAY);
+    instance->subsets->order = 0;
+    instance->nbCreatedSubsets = 1;
 
-    instance->subsets->maxCrtNbSubspaces = INCREMENT_STEP_SUBSPACES_ARRAY;
+    instance->subsets->chunks = NULL;
+    instance->subsets->nbChunks = 0;
     instance->subsets->n = 0;
 
-    instance->subsets->maxBoundedChild = NULL;
-    instance->subsets->father = NULL;
-    instance->subsets->leftChild = NULL;
-    instance->subsets->rightChild = NULL;
+    instance->frontier = NULL;
+    instance->frontierSize = 0;
+    instance->maxFrontierSize = 0;
+
+    first = writableSubspace(instance, instance->subsets, 0);
+    second = writableSubspace(instance, instance->subsets, 1);
 
-    instance->subsets->subspaces[0].s = copyState(initial);
+    first->s = duplicateState(instance, initial);
 
     for(; i < NUMBER_OF_DIMENSIONS_OF_ACTION; i++) {
-        instance->subsets->subspaces[0].action[i] = 0.5;
-        instance->subsets->subspaces[0].halfSidesLength[i] = 0.5;
+        first->action[i] = 0.5;
+        first->halfSidesLength[i] = 0.5;
     }
 
-    instance->subsets->subspaces[0].delta = 0.5*sqrt(NUMBER_OF_DIMENSIONS_OF_ACTION);
+    first->delta = 0.5*sqrt(NUMBER_OF_DIMENSIONS_OF_ACTION);
+
+    first->nextCutDimension = 0;
+    first->nextDelta = sqrt((0.25 * (NUMBER_OF_DIMENSIONS_OF_ACTION - 1)) + (1.0 / 36.0));
 
-    instance->subsets->subspaces[0].nextCutDimension = 0;
-    instance->subsets->subspaces[0].nextDelta = sqrt((0.25 * (NUMBER_OF_DIMENSIONS_OF_ACTION - 1)) + (1.0 / 36.0));
+    second->s = newState(instance);
 
-    instance->subsets->subspaces[1].isClosedPath = nextStateReward(initial, instance->subsets->subspaces[0].action, &(instance->subsets->subspaces[1].s), &(instance->subsets->subspaces[0].reward)) < 0 ? 1 : 0;
+    transition.s = initial;
+    transition.k = 1;
+    memcpy(transition.actions, first->action, sizeof(double) * NUMBER_OF_DIMENSIONS_OF_ACTION);
+    transition.nextStates[0] = second->s;
+    simulate(instance, &transition);
 
-    instance->subsets->subspaces[0].discountedSumOfRewards = instance->subsets->subspaces[0].reward;
+    first->reward = transition.rewards[0];
+    second->isClosedPath = transition.isTerminal[0] < 0 ? 1 : 0;
 
-    instance->subsets->bound = (instance->subsets->subspaces[0].reward + (instance->L * instance->subsets->subspaces[0].delta) < 1.0 ? instance->subsets->subspaces[0].reward + (instance->L * instance->subsets->subspaces[0].delta) : 1.0) + (instance->gamma / (1.0 - instance->gamma));
+    first->discountedSumOfRewards = first->reward;
 
+    instance->subsets->bound = (first->reward + (instance->L * first->delta) < 1.0 ? first->reward + (instance->L * first->delta) : 1.0) + (instance->gamma / (1.0 - instance->gamma));
+
+    pushIntoFrontier(instance, instance->subsets);
     instance->nextSubsetToDiscretize = instance->subsets;
-    instance->nextNodeToAppendTo = instance->subsets;
 
-    instance->maxDiscountedSumOfRewards = instance->subsets->subspaces[0].reward;
-    memcpy(instance->crtOptimalAction, instance->subsets->subspaces[0].action, sizeof(double) * NUMBER_OF_DIMENSIONS_OF_ACTION);
+    instance->maxDiscountedSumOfRewards = first->reward;
+    memcpy(instance->crtOptimalAction, first->action, sizeof(double) * NUMBER_OF_DIMENSIONS_OF_ACTION);
     instance->crtOptimalSequence = instance->subsets;
 
     instance->maxDepth = 1;	
+    reserveGammaPowers(instance);
 
     instance->crtNbSubspaces = 1;
     instance->crtNbSubsets = 1;
@@ -156,70 +647,712 @@ void lipschitzian_resetInstance(lipschitzian_instance* instance, state* initial)
 
     instance->list->next = NULL;
 
-    instance->subsets->subspaces[0].headsSameState = instance->subsets;
-    instance->subsets->subspaces[0].nextsSameState = NULL;
+    first->siblings = newSiblings(instance, SIBLINGS_INITIAL_NB_POINTS, 0.0);
+    addSibling(instance, first);
 
 }
 
 
-/*+-----------------------------------------------------+
-  | Propagate the new bound through the tree of subsets |
-  +-----------------------------------------------------+*/
+/*+-----------------------------------------+
+  | Maps the pointers of the tree being     |
+  | rebased, alone or by pair, to their     |
+  | copies in the new tree                  |
+  +-----------------------------------------+*/
+
+typedef struct {
+
+    const void* first;                                      /* The pointer in the rebased tree, NULL for an empty entry */
+    const void* second;                                     /* The pointer completing the key, NULL if alone */
+    void* copy;                                             /* The copy in the new tree */
+
+} rebase_entry;
+
+typedef struct {
+
+    rebase_entry* entries;                                  /* Open addressing table of the entries */
+    size_t mask;                                            /* The number of entries minus one, a power of two minus one */
+
+} rebase_map;
+
+
+static void initRebaseMap(rebase_map* map, size_t nbKeys) {
+
+    size_t nbEntries = 16;
+
+    while(nbEntries < (nbKeys * 2))
+        nbEntries *= 2;
+
+    map->entries = (rebase_entry*)calloc(nbEntries, sizeof(rebase_entry));
+    map->mask = nbEntries - 1;
+
+}
+
+
+/*+-----------------------------------------+
+  | Return the entry of a key, empty if it  |
+  | has not been inserted yet               |
+  +-----------------------------------------+*/
+
+static rebase_entry* findInRebaseMap(rebase_map* map, const void* first, const void* second) {
+
+    size_t i = (((size_t)first >> 4) ^ ((size_t)second >> 3)) * 2654435761u;
+
+    for(i &= map->mask; map->entries[i].first != NULL; i = (i + 1) & map->mask) {
+        if((map->entries[i].first == first) && (map->entries[i].second == second))
+            break;
+    }
+
+    return map->entries + i;
+
+}
+
+
+/*+-----------------------------------------+
+  | Compute the bound of a subset from its  |
+  | subspaces                               |
+  +-----------------------------------------+*/
+
+static double computeBound(lipschitzian_instance* instance, lipschitzian_subset* subset) {
+
+    unsigned int i = 0;
+    double sumDelta = 0.0;
+    double bound = 0.0;
+
+    for(; i <= subset->n; i++) {
+        sumDelta = (sumDelta + SUBSPACE(subset, i)->delta) * instance->L;
+
+        if((SUBSPACE(subset, i)->reward + sumDelta) > 1.0)
+            break;
+
+        bound += (instance->gammaPowers[i] * (SUBSPACE(subset, i)->reward + sumDelta));
+    }
+
+    return bound + (instance->gammaPowers[i] / (1.0 - instance->gamma));
+
+}
+
+
+static char startsWith(lipschitzian_subset* subset, double* action) {
+
+    unsigned int i = 0;
+
+    if(subset->n == 0)
+        return 0;
+
+    for(; i < NUMBER_OF_DIMENSIONS_OF_ACTION; i++) {
+        if(SUBSPACE(subset, 0)->action[i] != action[i])
+            return 0;
+    }
+
+    return 1;
+
+}
+
+
+/*+--------------------------------------------+
+  | Rebase an instance on the state reached by |
+  | applying action, as returned by the last   |
+  | planning, to its initial state. The        |
+  | subsets starting with this action are kept |
+  | without their first subspace and the       |
+  | others are freed. The model has to be      |
+  | deterministic: if initial is not the state |
+  | the kept subsets predicted, the instance   |
+  | is reset on it instead.                    |
+  +--------------------------------------------+*/
+
+void lipschitzian_rebaseInstance(lipschitzian_instance* instance, state* initial, double* action) {
+
+    unsigned int i = 0;
+    lipschitzian_subset* previousList = instance->list;
+    arena* previousMemory = instance->memory;
+    lipschitzian_subset* crt = NULL;
+    lipschitzian_subset* last = NULL;
+    lipschitzian_subset* kept = NULL;
+    size_t nbKept = 0;
+    size_t nbStates = 0;
+    size_t nbChunks = 0;
+    rebase_map subsets;
+    rebase_map states;
+    rebase_map chunks;
+    rebase_map siblings;
+
+    for(crt = previousList; crt != NULL; crt = crt->next) {
+        if(startsWith(crt, action)) {
+            kept = crt;
+            nbKept++;
+            nbStates += crt->n + 1;
+            nbChunks += crt->nbChunks;
+        }
+    }
+
+    /* All the kept subsets share the state reached by action, which is the new root */
+    if((nbKept == 0) || (memcmp(SUBSPACE(kept, 1)->s, initial, stateSize()) != 0)) {
+        lipschitzian_resetInstance(instance, initial);
+        return;
+    }
+
+    adaptL(instance);
+
+    instance->memory = arena_init(previousMemory->slabSize);
+
+    initRebaseMap(&subsets, nbKept);
+    initRebaseMap(&states, nbStates);
+    initRebaseMap(&chunks, nbChunks);
+    initRebaseMap(&siblings, nbStates);
+
+    instance->list = NULL;
+
+    instance->frontier = NULL;
+    instance->frontierSize = 0;
+    instance->maxFrontierSize = 0;
+
+    instance->crtOptimalSequence = NULL;
+    instance->maxDepth = 0;
+    instance->crtNbSubspaces = 0;
+    instance->crtNbSubsets = nbKept;
+
+    /* The kept subsets are ranked again in creation order, the list going from the newest to the oldest */
+    instance->nbCreatedSubsets = 0;
+
+    /* The copies are allocated first so that the list keeps its order */
+    for(crt = previousList; crt != NULL; crt = crt->next) {
+        if(startsWith(crt, action)) {
+            lipschitzian_subset* copy = (lipschitzian_subset*)arena_alloc(instance->memory, sizeof(lipschitzian_subset));
+            rebase_entry* entry = findInRebaseMap(&subsets, crt, NULL);
+
+            copy->n = crt->n - 1;
+            copy->order = nbKept - 1 - instance->nbCreatedSubsets++;
+            copy->constrainedUntil = crt->constrainedUntil > 0 ? crt->constrainedUntil - 1 : 0;
+            copy->nbChunks = crt->nbChunks;
+            copy->chunks = (lipschitzian_chunk**)arena_alloc(instance->memory, sizeof(lipschitzian_chunk*) * copy->nbChunks);
+            copy->next = NULL;
+
+            if(last == NULL)
+                instance->list = copy;
+            else
+                last->next = copy;
+            last = copy;
+
+            entry->first = crt;
+            entry->copy = copy;
+        }
+    }
+
+    for(crt = previousList; crt != NULL; crt = crt->next) {
+        lipschitzian_subset* copy = NULL;
+
+        if(!startsWith(crt, action))
+            continue;
+
+        copy = (lipschitzian_subset*)findInRebaseMap(&subsets, crt, NULL)->copy;
+
+        /* The i-th new chunk is made of the end of the i-th chunk and the start of the next one, thus shared by the subsets sharing both */
+        for(i = 0; i < copy->nbChunks; i++) {
+            lipschitzian_chunk* current = crt->chunks[i];
+            lipschitzian_chunk* following = (i + 1) < crt->nbChunks ? crt->chunks[i + 1] : NULL;
+            rebase_entry* entry = findInRebaseMap(&chunks, current, following);
+
+            if(entry->first == NULL) {
+                lipschitzian_chunk* chunk = newChunk(instance, copy);
+
+                memcpy(chunk->subspaces, current->subspaces + 1, sizeof(lipschitzian_subspace) * (SUBSPACES_CHUNK_SIZE - 1));
+                if(following != NULL)
+                    chunk->subspaces[SUBSPACES_CHUNK_SIZE - 1] = following->subspaces[0];
+
+                entry->first = current;
+                entry->second = following;
+                entry->copy = chunk;
+            } else {
+                ((lipschitzian_chunk*)entry->copy)->owner = NULL;
+            }
+
+            copy->chunks[i] = (lipschitzian_chunk*)entry->copy;
+        }
+
+        /* Only the subspaces up to n + 1 hold pointers of the old tree which are used */
+        for(i = 0; i <= (copy->n + 1); i++) {
+            lipschitzian_subspace* previous = SUBSPACE(crt, i + 1);
+            lipschitzian_subspace* subspace = SUBSPACE(copy, i);
+            rebase_entry* entry = findInRebaseMap(&states, previous->s, NULL);
+
+            if(entry->first == NULL) {
+                entry->first = previous->s;
+                entry->copy = duplicateState(instance, previous->s);
+            }
+
+            subspace->s = (state*)entry->copy;
+
+            if(i <= copy->n) {
+                entry = findInRebaseMap(&siblings, previous->siblings, NULL);
+
+                if(entry->first == NULL) {
+                    entry->first = previous->siblings;
+                    entry->copy = copySiblings(instance, previous->siblings);
+                }
+
+                subspace->siblings = (lipschitzian_siblings*)entry->copy;
+
+                if(i == 0)
+                    subspace->discountedSumOfRewards = subspace->reward;
+                else
+                    subspace->discountedSumOfRewards = SUBSPACE(copy, i - 1)->discountedSumOfRewards + (instance->gammaPowers[i] * subspace->reward);
+            }
+        }
+
+        copy->bound = computeBound(instance, copy);
+        pushIntoFrontier(instance, copy);
+
+        if((instance->crtOptimalSequence == NULL) || (SUBSPACE(copy, copy->n)->discountedSumOfRewards > instance->maxDiscountedSumOfRewards)) {
+            instance->maxDiscountedSumOfRewards = SUBSPACE(copy, copy->n)->discountedSumOfRewards;
+            memcpy(instance->crtOptimalAction, SUBSPACE(copy, 0)->action, sizeof(double) * NUMBER_OF_DIMENSIONS_OF_ACTION);
+            instance->crtOptimalSequence = copy;
+        }
+
+        if((copy->n + 1) > instance->maxDepth)
+            instance->maxDepth = copy->n + 1;
+
+        instance->crtNbSubspaces += copy->n + 1;
+    }
+
+    /* The oldest kept subset is the one all the others were trisected from */
+    instance->subsets = last;
+    instance->nextSubsetToDiscretize = instance->frontier[0];
+
+    free(subsets.entries);
+    free(states.entries);
+    free(chunks.entries);
+    free(siblings.entries);
+
+    arena_uninit(&previousMemory);
+
+}
+
+
+/*+-----------------------------------------+
+  | Tell whether a subset is kept by a      |
+  | pruning: the current optimal sequence   |
+  | always is, the others if they may still |
+  | hold the optimal sequence and their     |
+  | bound is above minBound. Only the first |
+  | nbTiesLeft subsets whose bound equals   |
+  | minBound are kept.                      |
+  +-----------------------------------------+*/
+
+static char isPromising(lipschitzian_instance* instance, lipschitzian_subset* subset, double minBound, unsigned int* nbTiesLeft) {
+
+    if(subset == instance->crtOptimalSequence)
+        return 1;
+
+    if((subset->bound < instance->maxDiscountedSumOfRewards) || (subset->bound < minBound))
+        return 0;
+
+    if(subset->bound > minBound)
+        return 1;
+
+    if(*nbTiesLeft == 0)
+        return 0;
+
+    (*nbTiesLeft)--;
+
+    return 1;
+
+}
+
+
+/*+-----------------------------------------+
+  | Order the bounds by decreasing value    |
+  +-----------------------------------------+*/
+
+static int compareBounds(const void* a, const void* b) {
+
+    double boundA = *(const double*)a;
+    double boundB = *(const double*)b;
+
+    return (boundA < boundB) - (boundA > boundB);
+
+}
+
+
+/*+-----------------------------------------+
+  | Return the lowest bound a subset must   |
+  | reach to be kept by a pruning bringing  |
+  | the subsets down to about targetBytes   |
+  | bytes, and in nbTies the number of the  |
+  | subsets with this very bound to keep.   |
+  | The subsets are assumed to take the     |
+  | same memory each, and only those with   |
+  | the highest bounds are kept.            |
+  +-----------------------------------------+*/
+
+static double computeMinBound(lipschitzian_instance* instance, size_t targetBytes, unsigned int* nbTies) {
+
+    double* bounds = NULL;
+    double minBound = 0.0;
+    unsigned int nbKept = 0;
+    unsigned int i = 0;
+    lipschitzian_subset* crt = NULL;
+
+    *nbTies = 0;
+
+    if(targetBytes >= instance->memory->bytesInUse)
+        return -INFINITY;
+
+    nbKept = (unsigned int)(((double)instance->crtNbSubsets * targetBytes) / instance->memory->bytesInUse);
+    if(nbKept == 0)
+        return INFINITY;
+
+    bounds = (double*)malloc(sizeof(double) * instance->crtNbSubsets);
+    for(crt = instance->list; crt != NULL; crt = crt->next)
+        bounds[i++] = crt->bound;
+
+    qsort(bounds, i, sizeof(double), compareBounds);
+    minBound = bounds[nbKept - 1];
+
+    /* Many subsets may share a bound, those not needed to reach nbKept are pruned too */
+    for(i = nbKept; (i > 0) && (bounds[i - 1] == minBound); i--)
+        (*nbTies)++;
+
+    free(bounds);
+
+    return minBound;
+
+}
+
+
+static int compareSiblings(const void* a, const void* b) {
+
+    double first = ((const lipschitzian_sibling*)a)->coordinate;
+    double second = ((const lipschitzian_sibling*)b)->coordinate;
+
+    return first < second ? -1 : (first > second ? 1 : 0);
+
+}
+
+
+/*+-----------------------------------------+
+  | Move the subsets kept as told by        |
+  | isPromising to a new arena and drop the |
+  | others with the old one. The chunks and |
+  | states are shared as before. Return the |
+  | number of subsets dropped.              |
+  +-----------------------------------------+*/
+
+static unsigned int pruneSubsets(lipschitzian_instance* instance, double minBound, unsigned int nbTies) {
+
+    unsigned int i = 0;
+    lipschitzian_subset* previousList = instance->list;
+    lipschitzian_subset* previousOptimalSequence = instance->crtOptimalSequence;
+    arena* previousMemory = instance->memory;
+    lipschitzian_subset* crt = NULL;
+    lipschitzian_subset* last = NULL;
+    size_t nbKept = 0;
+    unsigned int nbPruned = 0;
+    size_t nbStates = 0;
+    size_t nbChunks = 0;
+    rebase_map subsets;
+    rebase_map states;
+    rebase_map chunks;
+    rebase_map siblings;                                    /* Only the actions of the kept subsets stay among the siblings */
+    unsigned int nbTiesLeft = nbTies;
+
+    for(crt = previousList; crt != NULL; crt = crt->next) {
+        if(isPromising(instance, crt, minBound, &nbTiesLeft)) {
+            nbKept++;
+            nbStates += crt->n + 2;
+            nbChunks += crt->nbChunks;
+        }
+    }
+
+    nbPruned = instance->crtNbSubsets - nbKept;
+    if(nbPruned == 0)
+        return 0;
+
+    instance->memory = arena_init(previousMemory->slabSize);
+
+    initRebaseMap(&subsets, nbKept);
+    initRebaseMap(&states, nbStates);
+    initRebaseMap(&chunks, nbChunks);
+    initRebaseMap(&siblings, nbStates);
+
+    instance->list = NULL;
+
+    instance->frontier = NULL;
+    instance->frontierSize = 0;
+    instance->maxFrontierSize = 0;
+
+    instance->maxDepth = 0;
+    instance->crtNbSubspaces = 0;
+    instance->nbPrunedSubsets += nbPruned;
+    instance->crtNbSubsets = nbKept;
+
+    nbTiesLeft = nbTies;
+    for(crt = previousList; crt != NULL; crt = crt->next) {
+        if(isPromising(instance, crt, minBound, &nbTiesLeft)) {
+            lipschitzian_subset* copy = (lipschitzian_subset*)arena_alloc(instance->memory, sizeof(lipschitzian_subset));
+            rebase_entry* entry = findInRebaseMap(&subsets, crt, NULL);
+
+            copy->n = crt->n;
+            copy->order = crt->order;
+            copy->bound = crt->bound;
+            copy->constrainedUntil = crt->constrainedUntil;
+            copy->nbChunks = crt->nbChunks;
+            copy->chunks = (lipschitzian_chunk**)arena_alloc(instance->memory, sizeof(lipschitzian_chunk*) * copy->nbChunks);
+            copy->next = NULL;
+
+            if(last == NULL)
+                instance->list = copy;
+            else
+                last->next = copy;
+            last = copy;
+
+            entry->first = crt;
+            entry->copy = copy;
+        }
+    }
+
+    nbTiesLeft = nbTies;
+    for(crt = previousList; crt != NULL; crt = crt->next) {
+        lipschitzian_subset* copy = NULL;
+
+        if(!isPromising(instance, crt, minBound, &nbTiesLeft))
+            continue;
+
+        copy = (lipschitzian_subset*)findInRebaseMap(&subsets, crt, NULL)->copy;
+
+        for(i = 0; i < copy->nbChunks; i++) {
+            rebase_entry* entry = findInRebaseMap(&chunks, crt->chunks[i], NULL);
+
+            if(entry->first == NULL) {
+                lipschitzian_chunk* chunk = newChunk(instance, copy);
+
+                memcpy(chunk->subspaces, crt->chunks[i]->subspaces, sizeof(lipschitzian_subspace) * SUBSPACES_CHUNK_SIZE);
+
+                entry->first = crt->chunks[i];
+                entry->copy = chunk;
+            } else {
+                ((lipschitzian_chunk*)entry->copy)->owner = NULL;
+            }
+
+            copy->chunks[i] = (lipschitzian_chunk*)entry->copy;
+        }
+
+        for(i = 0; i <= (copy->n + 1); i++) {
+            lipschitzian_subspace* previous = SUBSPACE(crt, i);
+            lipschitzian_subspace* subspace = SUBSPACE(copy, i);
+            rebase_entry* entry = findInRebaseMap(&states, previous->s, NULL);
+
+            if(entry->first == NULL) {
+                entry->first = previous->s;
+                entry->copy = duplicateState(instance, previous->s);
+            }
+
+            subspace->s = (state*)entry->copy;
+
+            if(i <= copy->n) {
+                lipschitzian_siblings* group = NULL;
+
+                entry = findInRebaseMap(&siblings, previous->siblings, NULL);
+
+                if(entry->first == NULL) {
+                    entry->first = previous->siblings;
+                    entry->copy = newSiblings(instance, SIBLINGS_INITIAL_NB_POINTS, previous->siblings->maxSlope);
+                }
+
+                group = (lipschitzian_siblings*)entry->copy;
+                subspace->siblings = group;
+
+                /* The action is met again by every kept subset going through it, it is added with the state it leads to */
+                if(findInRebaseMap(&states, SUBSPACE(crt, i + 1)->s, NULL)->first == NULL) {
+                    reserveSibling(instance, group);
+                    group->points[group->nbPoints].coordinate = subspace->action[0];
+                    group->points[group->nbPoints].reward = subspace->reward;
+                    group->nbPoints++;
+                }
+            }
+        }
+
+        pushIntoFrontier(instance, copy);
+
+        if((copy->n + 1) > instance->maxDepth)
+            instance->maxDepth = copy->n + 1;
+
+        instance->crtNbSubspaces += copy->n + 1;
+    }
+
+    instance->crtOptimalSequence = (lipschitzian_subset*)findInRebaseMap(&subsets, previousOptimalSequence, NULL)->copy;
+
+    for(i = 0; i <= siblings.mask; i++) {
+        lipschitzian_siblings* group = (lipschitzian_siblings*)siblings.entries[i].copy;
+
+        if(group != NULL)
+            qsort(group->points, group->nbPoints, sizeof(lipschitzian_sibling), compareSiblings);
+    }
+
+    /* The oldest kept subset is the closest to the one all the others were trisected from */
+    instance->subsets = last;
+    instance->nextSubsetToDiscretize = instance->frontier[0];
+
+    free(subsets.entries);
+    free(states.entries);
+    free(chunks.entries);
+    free(siblings.entries);
+
+    arena_uninit(&previousMemory);
+
+    return nbPruned;
+
+}
+
+
+/*+----------------------------------------------+
+  | Keep the memory held by the instance, as     |
+  | given by lipschitzian_getMemoryUsage, under  |
+  | about maxBytes bytes by pruning the subsets  |
+  | which cannot hold the optimal sequence       |
+  | anymore, and those with the lowest bounds if |
+  | lipschitzian_usePruningByBound allows it. A  |
+  | pruning temporarily needs the memory of the  |
+  | kept subsets on top. The planning stops      |
+  | early, setting isMemoryExhausted, if the     |
+  | subsets cannot be pruned enough. 0 removes   |
+  | the limit.                                   |
+  +----------------------------------------------+*/
+
+void lipschitzian_setMemoryLimit(lipschitzian_instance* instance, size_t maxBytes) {
+
+    instance->maxBytes = maxBytes;
+
+    /* Smaller slabs keep the memory held close to the memory used by the subsets, the arenas to come take their size */
+    if((maxBytes > 0) && ((maxBytes / MEMORY_LIMIT_NB_SLABS) < instance->memory->slabSize)) {
+        size_t slabSize = maxBytes / MEMORY_LIMIT_NB_SLABS;
+
+        instance->memory->slabSize = slabSize > ARENA_SMALL_LIMIT ? (slabSize / ARENA_ALIGNMENT) * ARENA_ALIGNMENT : ARENA_SMALL_LIMIT;
+    }
+
+}
+
+
+/*+----------------------------------------------+
+  | Let the memory limit also prune the subsets  |
+  | with the lowest bounds, which may still hold |
+  | the optimal sequence: the plan may then be   |
+  | worse than an unlimited one                  |
+  +----------------------------------------------+*/
+
+void lipschitzian_usePruningByBound(lipschitzian_instance* instance, char isPrunedByBound) {
+
+    instance->isPrunedByBound = isPrunedByBound;
+
+}
+
+
+/*+----------------------------------------------+
+  | Return the number of bytes currently held by |
+  | an instance, the powers of the discount      |
+  | factor shared with other instances aside     |
+  +----------------------------------------------+*/
+
+size_t lipschitzian_getMemoryUsage(lipschitzian_instance* instance) {
+
+    size_t bytes = sizeof(lipschitzian_instance) + instance->memory->bytesReserved + (sizeof(double) * 3 * instance->maxNbLowerings);
+
+    if(instance->cache != NULL)
+        bytes += sizeof(transition_cache) + (sizeof(unsigned int) * instance->cache->nbBuckets) + (instance->cache->entrySize * instance->cache->maxNbEntries);
+
+    if(instance->pool != NULL)
+        bytes += instance->nbSubsetsPerRound * (sizeof(lipschitzian_discretization) + sizeof(lipschitzian_transition));
+
+    return bytes;
+
+}
+
+
+/*+----------------------------------------------+
+  | Serve the repeated transitions from a cache  |
+  | of at most about maxBytes bytes. The model   |
+  | has to be deterministic and its context left |
+  | unchanged while the cache is used.           |
+  +----------------------------------------------+*/
+
+void lipschitzian_useTransitionCache(lipschitzian_instance* instance, size_t maxBytes) {
+
+    if(instance->cache != NULL)
+        transition_cache_uninit(&instance->cache);
+
+    if(maxBytes > 0)
+        instance->cache = transition_cache_init(maxBytes, stateSize(), NUMBER_OF_DIMENSIONS_OF_ACTION);
+
+}
+
+
+/*+----------------------------------------------+
+  | Estimate L again before each reset or rebase |
+  | with lipschitzian_computeNextL               |
+  +----------------------------------------------+*/
 
-static void propagateBound(lipschitzian_instance* instance, lipschitzian_subset* startingPoint) {
+void lipschitzian_useAdaptiveL(lipschitzian_instance* instance, char isAdaptive) {
 
-    lipschitzian_subset* crt = startingPoint;
-    while(crt != NULL) {
-        if(crt->rightChild != NULL) {
-            crt->maxBoundedChild = crt->rightChild;
+    instance->isLAdaptive = isAdaptive;
 
-            if(crt->rightChild->maxBoundedChild != NULL) {
-                if(crt->rightChild->maxBoundedChild->bound > crt->maxBoundedChild->bound)
-                    crt->maxBoundedChild = crt->rightChild->maxBoundedChild;
+}
 
-                if(crt->leftChild->maxBoundedChild->bound > crt->maxBoundedChild->bound)
-                    crt->maxBoundedChild = crt->leftChild->maxBoundedChild;
-            } else {
-                if((crt->leftChild->maxBoundedChild != NULL) && (crt->leftChild->maxBoundedChild->bound > crt->maxBoundedChild->bound))
-                    crt->maxBoundedChild = crt->leftChild->maxBoundedChild;
-            }
 
-            if(crt->leftChild->bound > crt->maxBoundedChild->bound)
-                crt->maxBoundedChild = crt->leftChild;
-        }
+/*+----------------------------------------------+
+  | Discretize nbSubsetsPerRound subsets a round |
+  | and simulate their transitions on nbThreads  |
+  | threads, the calling one included. 0 for     |
+  | either goes back to one subset at a time on  |
+  | the calling thread.                          |
+  +----------------------------------------------+*/
 
-        crt = crt->father;
+void lipschitzian_useThreads(lipschitzian_instance* instance, unsigned int nbThreads, unsigned int nbSubsetsPerRound) {
+
+    if(instance->pool != NULL) {
+        worker_pool_uninit(&instance->pool);
+        free(instance->discretizations);
+        free(instance->transitions);
+        instance->discretizations = NULL;
+        instance->transitions = NULL;
+        instance->nbSubsetsPerRound = 0;
     }
 
-    if((instance->subsets->maxBoundedChild != NULL) && (instance->subsets->maxBoundedChild->bound > instance->subsets->bound))
-        instance->nextSubsetToDiscretize = instance->subsets->maxBoundedChild;
-    else
-        instance->nextSubsetToDiscretize = instance->subsets;
+    if((nbThreads > 0) && (nbSubsetsPerRound > 0)) {
+        instance->pool = worker_pool_init(nbThreads);
+        instance->nbSubsetsPerRound = nbSubsetsPerRound;
+        instance->discretizations = (lipschitzian_discretization*)malloc(sizeof(lipschitzian_discretization) * nbSubsetsPerRound);
+        instance->transitions = (lipschitzian_transition*)malloc(sizeof(lipschitzian_transition) * nbSubsetsPerRound);
+    }
 
 }
 
 
-/*+--------------------+
-  | Trisect a subspace |
-  +--------------------+*/
+/*+-------------------------------------------+
+  | Trisect a subspace up to the simulation   |
+  | of the two subsets it creates             |
+  +-------------------------------------------+*/
 
-static void trisectSubspace(lipschitzian_instance* instance, unsigned int min, double minPartialSumDelta, double minPartialNewBound, unsigned int* crtNbEvaluations) {
+static void prepareTrisection(lipschitzian_instance* instance, lipschitzian_discretization* discretization, lipschitzian_transition* transition) {
 
     unsigned int i = 0;
+    unsigned int min = discretization->min;
 
-    double tentativelySumDelta = 0.0;
-    double tentativelyNewBound = 0.0;
+    lipschitzian_subset* discretizedSubset = discretization->subset;
 
-    lipschitzian_subset* crtNode = instance->nextNodeToAppendTo->father;
-    lipschitzian_subset* prevNode = instance->nextNodeToAppendTo;
+    lipschitzian_subset* leftSubset = (lipschitzian_subset*)arena_alloc(instance->memory, sizeof(lipschitzian_subset));
+    lipschitzian_subset* rightSubset = (lipschitzian_subset*)arena_alloc(instance->memory, sizeof(lipschitzian_subset));
 
-    lipschitzian_subset* discretizedSubset = instance->nextSubsetToDiscretize;
+    lipschitzian_subspace* trisected = NULL;
+    lipschitzian_subspace* left = NULL;
+    lipschitzian_subspace* right = NULL;
+    lipschitzian_subspace* leftNext = NULL;
+    lipschitzian_subspace* rightNext = NULL;
 
-    lipschitzian_subset* leftSubset = (lipschitzian_subset*)malloc(sizeof(lipschitzian_subset));
-    lipschitzian_subset* rightSubset = (lipschitzian_subset*)malloc(sizeof(lipschitzian_subset));
+    double shift = (SUBSPACE(discretizedSubset, min)->halfSidesLength[SUBSPACE(discretizedSubset, min)->nextCutDimension] * 2.0) / 3.0;
+    unsigned int cutDimension = SUBSPACE(discretizedSubset, min)->nextCutDimension;
 
-    double shift = (discretizedSubset->subspaces[min].halfSidesLength[discretizedSubset->subspaces[min].nextCutDimension] * 2.0) / 3.0;
-    unsigned int cutDimension = discretizedSubset->subspaces[min].nextCutDimension;
+    leftSubset->order = instance->nbCreatedSubsets++;
+    rightSubset->order = instance->nbCreatedSubsets++;
 
     leftSubset->constrainedUntil = 0;
     rightSubset->constrainedUntil = 0;
@@ -234,104 +1367,142 @@ static void trisectSubspace(lipschitzian_instance* instance, unsigned int min, d
         rightSubset->constrainedUntil = discretizedSubset->constrainedUntil;
     }
 
-    leftSubset->subspaces = (lipschitzian_subspace*)malloc(sizeof(lipschitzian_subspace) * discretizedSubset->maxCrtNbSubspaces);
-    rightSubset->subspaces = (lipschitzian_subspace*)malloc(sizeof(lipschitzian_subspace) * discretizedSubset->maxCrtNbSubspaces);
-
-    leftSubset->maxCrtNbSubspaces = discretizedSubset->maxCrtNbSubspaces;
-    rightSubset->maxCrtNbSubspaces = discretizedSubset->maxCrtNbSubspaces;
+    trisected = writableSubspace(instance, discretizedSubset, min);
 
-    discretizedSubset->subspaces[min].delta = discretizedSubset->subspaces[min].nextDelta;
-    discretizedSubset->subspaces[min].halfSidesLength[cutDimension] /= 3.0;
+    trisected->delta = trisected->nextDelta;
+    trisected->halfSidesLength[cutDimension] /= 3.0;
 
     if(NUMBER_OF_DIMENSIONS_OF_ACTION == 1) {
-        discretizedSubset->subspaces[min].nextDelta = discretizedSubset->subspaces[min].halfSidesLength[0] / 3.0;
+        trisected->nextDelta = trisected->halfSidesLength[0] / 3.0;
     } else {
-        discretizedSubset->subspaces[min].nextCutDimension++;
+        trisected->nextCutDimension++;
     
-        if(discretizedSubset->subspaces[min].nextCutDimension == NUMBER_OF_DIMENSIONS_OF_ACTION)
-            discretizedSubset->subspaces[min].nextCutDimension = 0;
+        if(trisected->nextCutDimension == NUMBER_OF_DIMENSIONS_OF_ACTION)
+            trisected->nextCutDimension = 0;
 
-        if(discretizedSubset->subspaces[min].nextCutDimension == (NUMBER_OF_DIMENSIONS_OF_ACTION - 1)) {
-            discretizedSubset->subspaces[min].nextDelta = discretizedSubset->subspaces[min].halfSidesLength[0] * sqrt(NUMBER_OF_DIMENSIONS_OF_ACTION);
+        if(trisected->nextCutDimension == (NUMBER_OF_DIMENSIONS_OF_ACTION - 1)) {
+            trisected->nextDelta = trisected->halfSidesLength[0] * sqrt(NUMBER_OF_DIMENSIONS_OF_ACTION);
         } else {
-            discretizedSubset->subspaces[min].nextDelta = 0.0;
+            trisected->nextDelta = 0.0;
 
-            for(; i < discretizedSubset->subspaces[min].nextCutDimension; i++)
-                discretizedSubset->subspaces[min].nextDelta += (discretizedSubset->subspaces[min].halfSidesLength[i] * discretizedSubset->subspaces[min].halfSidesLength[i]);
+            for(; i < trisected->nextCutDimension; i++)
+                trisected->nextDelta += (trisected->halfSidesLength[i] * trisected->halfSidesLength[i]);
 
-            discretizedSubset->subspaces[min].nextDelta += ((discretizedSubset->subspaces[min].halfSidesLength[i] * discretizedSubset->subspaces[min].halfSidesLength[i]) / 9.0);
+            trisected->nextDelta += ((trisected->halfSidesLength[i] * trisected->halfSidesLength[i]) / 9.0);
 
             for(i+=1; i < NUMBER_OF_DIMENSIONS_OF_ACTION; i++)
-                discretizedSubset->subspaces[min].nextDelta += (discretizedSubset->subspaces[min].halfSidesLength[i] * discretizedSubset->subspaces[min].halfSidesLength[i]);
+                trisected->nextDelta += (trisected->halfSidesLength[i] * trisected->halfSidesLength[i]);
 
-            discretizedSubset->subspaces[min].nextDelta = sqrt(discretizedSubset->subspaces[min].nextDelta);
+            trisected->nextDelta = sqrt(trisected->nextDelta);
         }
     }
 
-    if(discretizedSubset->n < leftSubset->constrainedUntil) {
-        memcpy(leftSubset->subspaces, discretizedSubset->subspaces, sizeof(lipschitzian_subspace) * (leftSubset->constrainedUntil + 1));
-        memcpy(rightSubset->subspaces, discretizedSubset->subspaces, sizeof(lipschitzian_subspace) * (leftSubset->constrainedUntil + 1));
-    } else {
-        memcpy(leftSubset->subspaces, discretizedSubset->subspaces, sizeof(lipschitzian_subspace) * (discretizedSubset->n + 1));
-        memcpy(rightSubset->subspaces, discretizedSubset->subspaces, sizeof(lipschitzian_subspace) * (discretizedSubset->n + 1));
-    }
+    /* The children share every chunk with the discretized subset, which thus has to copy them too before any later modification */
+    for(i = 0; i < discretizedSubset->nbChunks; i++)
+        discretizedSubset->chunks[i]->owner = NULL;
 
-    leftSubset->subspaces[min].action[cutDimension] -= shift;
-    rightSubset->subspaces[min].action[cutDimension] += shift;
+    shareSubspaces(instance, discretizedSubset, leftSubset);
+    shareSubspaces(instance, discretizedSubset, rightSubset);
 
+    left = writableSubspace(instance, leftSubset, min);
+    right = writableSubspace(instance, rightSubset, min);
+    leftNext = writableSubspace(instance, leftSubset, min + 1);
+    rightNext = writableSubspace(instance, rightSubset, min + 1);
 
-    for(i = 0; i <= min; i++) {
-        leftSubset->subspaces[i].s = copyState(discretizedSubset->subspaces[i].s);
-        rightSubset->subspaces[i].s = copyState(discretizedSubset->subspaces[i].s);
-    }
+    left->action[cutDimension] -= shift;
+    right->action[cutDimension] += shift;
+
+    /* Both children leave the same state so they are simulated together */
+    transition->s = trisected->s;
+    transition->k = 2;
+    memcpy(transition->actions, left->action, sizeof(double) * NUMBER_OF_DIMENSIONS_OF_ACTION);
+    memcpy(transition->actions + NUMBER_OF_DIMENSIONS_OF_ACTION, right->action, sizeof(double) * NUMBER_OF_DIMENSIONS_OF_ACTION);
+    transition->nextStates[0] = leftNext->s = newState(instance);
+    transition->nextStates[1] = rightNext->s = newState(instance);
+
+    leftSubset->n = min;
+    rightSubset->n = min;
+
+    discretization->children[0] = leftSubset;
+    discretization->children[1] = rightSubset;
+
+    instance->crtNbSubspaces += ((min + 1) * 2);
+    instance->crtNbSubsets += 2;
+
+    leftSubset->next = instance->list;
+    rightSubset->next = leftSubset;
+    instance->list = rightSubset;
+
+}
+
+
+/*+-------------------------------------------+
+  | Complete a trisection once the subsets it |
+  | created are simulated                     |
+  +-------------------------------------------+*/
+
+static void finishTrisection(lipschitzian_instance* instance, lipschitzian_discretization* discretization, lipschitzian_transition* transition) {
+
+    unsigned int i = 0;
+    unsigned int min = discretization->min;
+    double minPartialSumDelta = discretization->minPartialSumDelta;
+    double minPartialNewBound = discretization->minPartialNewBound;
 
-    leftSubset->subspaces[min + 1].isClosedPath = nextStateReward(leftSubset->subspaces[min].s, leftSubset->subspaces[min].action, &(leftSubset->subspaces[min + 1].s), &(leftSubset->subspaces[min].reward)) < 0 ? 1 : 0;
-    rightSubset->subspaces[min + 1].isClosedPath = nextStateReward(rightSubset->subspaces[min].s, rightSubset->subspaces[min].action, &(rightSubset->subspaces[min + 1].s), &(rightSubset->subspaces[min].reward)) < 0 ? 1 : 0;
-    (*crtNbEvaluations) += 2;
+    double tentativelySumDelta = 0.0;
+    double tentativelyNewBound = 0.0;
+
+    lipschitzian_subset* discretizedSubset = discretization->subset;
+    lipschitzian_subset* leftSubset = discretization->children[0];
+    lipschitzian_subset* rightSubset = discretization->children[1];
+
+    lipschitzian_subspace* left = writableSubspace(instance, leftSubset, min);
+    lipschitzian_subspace* right = writableSubspace(instance, rightSubset, min);
+
+    left->reward = transition->rewards[0];
+    right->reward = transition->rewards[1];
+    writableSubspace(instance, leftSubset, min + 1)->isClosedPath = transition->isTerminal[0] < 0 ? 1 : 0;
+    writableSubspace(instance, rightSubset, min + 1)->isClosedPath = transition->isTerminal[1] < 0 ? 1 : 0;
 
     if(min == 0) {
-        leftSubset->subspaces[0].discountedSumOfRewards = leftSubset->subspaces[0].reward;
-        rightSubset->subspaces[0].discountedSumOfRewards = rightSubset->subspaces[0].reward;
+        left->discountedSumOfRewards = left->reward;
+        right->discountedSumOfRewards = right->reward;
     } else {
-        leftSubset->subspaces[min].discountedSumOfRewards = leftSubset->subspaces[min - 1].discountedSumOfRewards + (instance->gammaPowers[min] * leftSubset->subspaces[min].reward);
-        rightSubset->subspaces[min].discountedSumOfRewards = rightSubset->subspaces[min - 1].discountedSumOfRewards + (instance->gammaPowers[min] * rightSubset->subspaces[min].reward);
+        left->discountedSumOfRewards = SUBSPACE(leftSubset, min - 1)->discountedSumOfRewards + (instance->gammaPowers[min] * left->reward);
+        right->discountedSumOfRewards = SUBSPACE(rightSubset, min - 1)->discountedSumOfRewards + (instance->gammaPowers[min] * right->reward);
     }
 
-    if(leftSubset->subspaces[min].discountedSumOfRewards > instance->maxDiscountedSumOfRewards) {
-        instance->maxDiscountedSumOfRewards = leftSubset->subspaces[min].discountedSumOfRewards;
-        memcpy(instance->crtOptimalAction, leftSubset->subspaces[0].action, sizeof(double) * NUMBER_OF_DIMENSIONS_OF_ACTION);
+    if(SUBSPACE(leftSubset, min)->discountedSumOfRewards > instance->maxDiscountedSumOfRewards) {
+        instance->maxDiscountedSumOfRewards = SUBSPACE(leftSubset, min)->discountedSumOfRewards;
+        memcpy(instance->crtOptimalAction, SUBSPACE(leftSubset, 0)->action, sizeof(double) * NUMBER_OF_DIMENSIONS_OF_ACTION);
         instance->crtOptimalSequence = leftSubset;
     }
-    if(rightSubset->subspaces[min].discountedSumOfRewards > instance->maxDiscountedSumOfRewards) {
-        instance->maxDiscountedSumOfRewards = rightSubset->subspaces[min].discountedSumOfRewards;
-        memcpy(instance->crtOptimalAction, rightSubset->subspaces[0].action, sizeof(double) * NUMBER_OF_DIMENSIONS_OF_ACTION);
+    if(SUBSPACE(rightSubset, min)->discountedSumOfRewards > instance->maxDiscountedSumOfRewards) {
+        instance->maxDiscountedSumOfRewards = SUBSPACE(rightSubset, min)->discountedSumOfRewards;
+        memcpy(instance->crtOptimalAction, SUBSPACE(rightSubset, 0)->action, sizeof(double) * NUMBER_OF_DIMENSIONS_OF_ACTION);
         instance->crtOptimalSequence = rightSubset;
     }
 
-    leftSubset->n = min;
-    rightSubset->n = min;
-
-    tentativelySumDelta = (minPartialSumDelta + discretizedSubset->subspaces[min].delta) * instance->L;
+    tentativelySumDelta = (minPartialSumDelta + SUBSPACE(discretizedSubset, min)->delta) * instance->L;
 
 
-    if((tentativelySumDelta + leftSubset->subspaces[min].reward) > 1.0)
+    if((tentativelySumDelta + SUBSPACE(leftSubset, min)->reward) > 1.0)
         leftSubset->bound = minPartialNewBound + (instance->gammaPowers[min] / (1.0 - instance->gamma));
     else
-        leftSubset->bound = minPartialNewBound + (instance->gammaPowers[min] * (tentativelySumDelta + leftSubset->subspaces[min].reward)) + (instance->gammaPowers[min + 1] / (1.0 - instance->gamma));
+        leftSubset->bound = minPartialNewBound + (instance->gammaPowers[min] * (tentativelySumDelta + SUBSPACE(leftSubset, min)->reward)) + (instance->gammaPowers[min + 1] / (1.0 - instance->gamma));
 
-    if((tentativelySumDelta + rightSubset->subspaces[min].reward) > 1.0)
+    if((tentativelySumDelta + SUBSPACE(rightSubset, min)->reward) > 1.0)
         rightSubset->bound = minPartialNewBound + (instance->gammaPowers[min] / (1.0 - instance->gamma));
     else
-        rightSubset->bound = minPartialNewBound + (instance->gammaPowers[min] * (tentativelySumDelta + rightSubset->subspaces[min].reward)) + (instance->gammaPowers[min + 1] / (1.0 - instance->gamma));
+        rightSubset->bound = minPartialNewBound + (instance->gammaPowers[min] * (tentativelySumDelta + SUBSPACE(rightSubset, min)->reward)) + (instance->gammaPowers[min + 1] / (1.0 - instance->gamma));
 
 
 /*************************** NOT SURE AT ALL IT'S A GOOD IDEA ****************************************************/
 
-    /*if((tentativelySumDelta + leftSubset->subspaces[min].reward) < 1.0) {
-        tentativelyNewBound = minPartialNewBound + (instance->gammaPowers[min] * (tentativelySumDelta + leftSubset->subspaces[min].reward));
+    /*if((tentativelySumDelta + SUBSPACE(leftSubset, min)->reward) < 1.0) {
+        tentativelyNewBound = minPartialNewBound + (instance->gammaPowers[min] * (tentativelySumDelta + SUBSPACE(leftSubset, min)->reward));
         
         for(i = min + 1; i < leftSubset->constrainedUntil; i++) {
-            tentativelySumDelta = (tentativelySumDelta + (leftSubset->subspaces[i].delta * 2.0)) * instance->L;
+            tentativelySumDelta = (tentativelySumDelta + (SUBSPACE(leftSubset, i)->delta * 2.0)) * instance->L;
 
             if(tentativelySumDelta > 1.0)
                 break;
@@ -345,11 +1516,11 @@ static void trisectSubspace(lipschitzian_instance* instance, unsigned int min, d
 
     leftSubset->bound = tentativelyNewBound;
 
-    if((tentativelySumDelta + rightSubset->subspaces[min].reward) < 1.0) {
-        tentativelyNewBound = minPartialNewBound + (instance->gammaPowers[min] * (tentativelySumDelta + rightSubset->subspaces[min].reward));
+    if((tentativelySumDelta + SUBSPACE(rightSubset, min)->reward) < 1.0) {
+        tentativelyNewBound = minPartialNewBound + (instance->gammaPowers[min] * (tentativelySumDelta + SUBSPACE(rightSubset, min)->reward));
 
         for(i = min + 1; i < rightSubset->constrainedUntil; i++) {
-            tentativelySumDelta = (tentativelySumDelta + (rightSubset->subspaces[i].delta * 2.0)) * instance->L;
+            tentativelySumDelta = (tentativelySumDelta + (SUBSPACE(rightSubset, i)->delta * 2.0)) * instance->L;
     
             if(tentativelySumDelta > 1.0)
                 break;
@@ -365,19 +1536,19 @@ static void trisectSubspace(lipschitzian_instance* instance, unsigned int min, d
 
 /*****************************************************************************************************************/
 
-    tentativelyNewBound = minPartialNewBound + (instance->gammaPowers[min] * (tentativelySumDelta + discretizedSubset->subspaces[min].reward));
+    tentativelyNewBound = minPartialNewBound + (instance->gammaPowers[min] * (tentativelySumDelta + SUBSPACE(discretizedSubset, min)->reward));
     for(i = min + 1; i <= discretizedSubset->n; i++) {
-        tentativelySumDelta = (tentativelySumDelta + discretizedSubset->subspaces[i].delta) * instance->L;
-        if((tentativelySumDelta + discretizedSubset->subspaces[i].reward) > 1.0)
+        tentativelySumDelta = (tentativelySumDelta + SUBSPACE(discretizedSubset, i)->delta) * instance->L;
+        if((tentativelySumDelta + SUBSPACE(discretizedSubset, i)->reward) > 1.0)
             break;
-        tentativelyNewBound += (instance->gammaPowers[i] * (tentativelySumDelta + discretizedSubset->subspaces[i].reward));
+        tentativelyNewBound += (instance->gammaPowers[i] * (tentativelySumDelta + SUBSPACE(discretizedSubset, i)->reward));
     }
 
 /*************************** NOT SURE AT ALL IT'S A GOOD IDEA ****************************************************/
 
     /*if(i > discretizedSubset->n) {
         for(; i <= discretizedSubset->constrainedUntil; i++) {
-        tentativelySumDelta = (tentativelySumDelta + (discretizedSubset->subspaces[i].delta * 2.0)) * instance->L;
+        tentativelySumDelta = (tentativelySumDelta + (SUBSPACE(discretizedSubset, i)->delta * 2.0)) * instance->L;
         if(tentativelySumDelta > 1.0)
             break;
             tentativelyNewBound += (instance->gammaPowers[i] * tentativelySumDelta);
@@ -388,48 +1559,21 @@ static void trisectSubspace(lipschitzian_instance* instance, unsigned int min, d
 
     discretizedSubset->bound = tentativelyNewBound + (instance->gammaPowers[i] / (1.0 - instance->gamma));
 
-    instance->nextNodeToAppendTo->leftChild = leftSubset;
-    instance->nextNodeToAppendTo->rightChild = rightSubset;
-
-    leftSubset->maxBoundedChild = NULL;
-    rightSubset->maxBoundedChild = NULL;
-
-    leftSubset->leftChild = NULL;
-    leftSubset->rightChild = NULL;
-    rightSubset->leftChild = NULL;
-    rightSubset->rightChild = NULL;
-
-    leftSubset->father = instance->nextNodeToAppendTo;
-    rightSubset->father = instance->nextNodeToAppendTo;
-
-    propagateBound(instance, instance->nextNodeToAppendTo);
-    propagateBound(instance, discretizedSubset);
-
-    while((crtNode != NULL) && (crtNode->rightChild == prevNode)) {
-        prevNode = crtNode;
-        crtNode = crtNode->father;
-    }
-
-    if(crtNode == NULL)
-        crtNode = instance->subsets;
-    else
-        crtNode = crtNode->rightChild;
-
-    while(crtNode->leftChild != NULL)
-        crtNode = crtNode->leftChild;
+}
 
-    instance->nextNodeToAppendTo = crtNode;		
 
-    instance->crtNbSubspaces += ((min + 1) * 2);
-    instance->crtNbSubsets += 2;
+/*+-------------------------------------------+
+  | Account for the slopes between the two    |
+  | subsets created by a trisection and the   |
+  | actions already tried from their state.   |
+  | Only the closest actions on each side are |
+  | compared with each new one.               |
+  +-------------------------------------------+*/
 
-    leftSubset->next = instance->list;
-    rightSubset->next = leftSubset;
-    instance->list = rightSubset;
+static void updateSlopes(lipschitzian_instance* instance, lipschitzian_discretization* discretization) {
 
-    rightSubset->subspaces[min].nextsSameState = leftSubset;
-    leftSubset->subspaces[min].nextsSameState = discretizedSubset->subspaces[min].headsSameState->subspaces[min].nextsSameState;
-    discretizedSubset->subspaces[min].headsSameState->subspaces[min].nextsSameState = rightSubset;
+    addSibling(instance, SUBSPACE(discretization->children[0], discretization->min));
+    addSibling(instance, SUBSPACE(discretization->children[1], discretization->min));
 
 }
 
@@ -448,8 +1592,8 @@ double lipschitzian_computeNextL(lipschitzian_instance* instance) {
         lipschitzian_subset* crt2 = crt1->next;
 
         while(crt2 != NULL) {
-            if(crt1->subspaces[0].action[0] != crt2->subspaces[0].action[0]) {
-                double computedL = fabs(crt1->subspaces[0].reward - crt2->subspaces[0].reward) / fabs(crt1->subspaces[0].action[0] - crt2->subspaces[0].action[0]);
+            if(SUBSPACE(crt1, 0)->action[0] != SUBSPACE(crt2, 0)->action[0]) {
+                double computedL = fabs(SUBSPACE(crt1, 0)->reward - SUBSPACE(crt2, 0)->reward) / fabs(SUBSPACE(crt1, 0)->action[0] - SUBSPACE(crt2, 0)->action[0]);
 
                 if(computedL > L)
                     L = computedL;
@@ -467,92 +1611,166 @@ double lipschitzian_computeNextL(lipschitzian_instance* instance) {
     double L = 0.0;
     unsigned int depth = 0;
 
+    /* The slopes are maintained by addSibling as the actions are simulated */
     for(; depth <= instance->crtOptimalSequence->n; depth++) {
-        lipschitzian_subset* crt = instance->crtOptimalSequence->subspaces[depth].headsSameState;
+        lipschitzian_siblings* siblings = SUBSPACE(instance->crtOptimalSequence, depth)->siblings;
+
+        if(siblings->maxSlope > L)
+            L = siblings->maxSlope;
+    }
 
-        while(crt != NULL) {
-            lipschitzian_subset* other = crt->subspaces[depth].nextsSameState;
+    return L;
 
-            while(other != NULL) {
-                if(crt->subspaces[depth].action[0] != other->subspaces[depth].action[0]) {
-                    double computedL = fabs(crt->subspaces[depth].reward - other->subspaces[depth].reward) / fabs(crt->subspaces[depth].action[0] - other->subspaces[depth].action[0]);
-                    if(computedL > L)
-                        L = computedL;
-                }
+}
 
-                other = other->subspaces[depth].nextsSameState;
-            }
 
-            crt = crt->subspaces[depth].nextsSameState;
-        }
+/* The bound obtained by trisecting the i-th subspace of a subset, going through the rest of its sequence */
+static double rescanNewBound(lipschitzian_instance* instance, lipschitzian_subset* subset, unsigned int i, double partialSumDelta, double partialNewBound) {
+
+    unsigned int j = i + 1;
+    double tentativelySumDelta = (partialSumDelta + SUBSPACE(subset, i)->nextDelta) * instance->L;
+    double tentativelyNewBound = partialNewBound + (instance->gammaPowers[i] * (SUBSPACE(subset, i)->reward + tentativelySumDelta));
+
+    for(; j <= subset->n; j++) {
+        tentativelySumDelta = (tentativelySumDelta + SUBSPACE(subset, j)->delta) * instance->L;
+
+        if((SUBSPACE(subset, j)->reward + tentativelySumDelta) > 1.0)
+            break;
+
+        tentativelyNewBound += (instance->gammaPowers[j] * (SUBSPACE(subset, j)->reward + tentativelySumDelta));
     }
 
-    return L;
+/*************************** NOT SURE AT ALL IT'S A GOOD IDEA ****************************************************/
+
+    /*if(j > subset->n) {
+    for(; j <= subset->constrainedUntil; j++) {
+        tentativelySumDelta = (tentativelySumDelta + (SUBSPACE(subset, j)->delta * 2.0)) * instance->L;
+        if(tentativelySumDelta > 1.0)
+            break;
+        tentativelyNewBound += (instance->gammaPower[j] * tentativelySumDelta);
+    }
+    }*/
+
+/*****************************************************************************************************************/
+
+    return tentativelyNewBound + (instance->gammaPowers[j] / (1.0 - instance->gamma));
 
 }
 
 
-/*+------------------------------------------------------------------------+
-  | Launch the lipschitzian algorithm with a limited number of evaluations |
-  +------------------------------------------------------------------------+*/
+/*+--------------------------------------------+
+  | Choose how to discretize a subset: the     |
+  | subspace whose trisection lowers the bound |
+  | the most or the extension of the sequence. |
+  | The bounds are first estimated from suffix |
+  | sums, then only the candidates which may   |
+  | be the lowest are evaluated by going       |
+  | through the sequence, so that the choice   |
+  | and the bounds are the ones of a full scan.|
+  +--------------------------------------------+*/
 
-double* lipschitzian_planning(lipschitzian_instance* instance, unsigned int maxNbEvaluations) {
+static void chooseDiscretization(lipschitzian_instance* instance, lipschitzian_subset* subset, lipschitzian_discretization* discretization) {
 
-    unsigned int crtNbEvaluations = 0;
-    double* optimalAction = (double*)malloc(sizeof(double) * NUMBER_OF_DIMENSIONS_OF_ACTION);
+    unsigned int T = 0;
+    double partialSumDelta = 0.0;
+    double partialNewBound = 0.0;
+    double minNewBound = 1.0 / (1.0 - instance->gamma);
+    unsigned int min = 0;
+    double minPartialNewBound = 0.0;
+    double minPartialSumDelta = 0.0;
+    unsigned int i = 0;
+    unsigned int firstSaturated = 0;
+    double saturationSumDelta = 0.0;
+    double saturationNewBound = 0.0;
+    char isCloseToSaturation = 0;
+    double minEstimatedNewBound = DBL_MAX;
+    double estimationError = LOWERING_TOLERANCE / (1.0 - instance->gamma);
+
+    for(; T <= subset->n; T++) {
+        partialSumDelta = (partialSumDelta + SUBSPACE(subset, T)->delta) * instance->L;
+        
+        if(SUBSPACE(subset, T)->reward + partialSumDelta > 1.0)
+          break;
 
-    while(crtNbEvaluations <= maxNbEvaluations) {
-        lipschitzian_subset* discretizedSubset = instance->nextSubsetToDiscretize;
+        if((SUBSPACE(subset, T)->reward + partialSumDelta) > (1.0 - LOWERING_TOLERANCE))
+            isCloseToSaturation = 1;
 
-        unsigned int T = 0;
-        double partialSumDelta = 0.0;
-        double partialNewBound = 0.0;
-        double minNewBound = 1.0 / (1.0 - instance->gamma);
-        unsigned int min = 0;
-        double minPartialNewBound = 0.0;
-        double minPartialSumDelta = 0.0;
-        unsigned int i = 0;
+        saturationSumDelta = partialSumDelta;
+        saturationNewBound += (instance->gammaPowers[T] * (SUBSPACE(subset, T)->reward + partialSumDelta));
+    }
 
-        for(; T <= discretizedSubset->n; T++) {
-            partialSumDelta = (partialSumDelta + discretizedSubset->subspaces[T].delta) * instance->L;
-            
-            if(discretizedSubset->subspaces[T].reward + partialSumDelta > 1.0)
-              break;
-        }
+    firstSaturated = T;
 
-        if(T != 0)
-            T--;
+    if(T != 0)
+        T--;
 
-        partialSumDelta = 0.0;
+    if((subset->n + 1) > instance->maxNbLowerings) {
+        instance->maxNbLowerings = subset->n + 1 + INCREMENT_STEP_LOWERINGS;
+        instance->loweringSums = (double*)realloc(instance->loweringSums, sizeof(double) * instance->maxNbLowerings);
+        instance->loweringPowers = (double*)realloc(instance->loweringPowers, sizeof(double) * instance->maxNbLowerings);
+        instance->estimatedNewBounds = (double*)realloc(instance->estimatedNewBounds, sizeof(double) * instance->maxNbLowerings);
+    }
 
-        for(; i <= T; i++) {
-            unsigned int j = 0;
-            double tentativelySumDelta = (partialSumDelta + discretizedSubset->subspaces[i].nextDelta) * instance->L;
-            double tentativelyNewBound = partialNewBound + (instance->gammaPowers[i] * (discretizedSubset->subspaces[i].reward + tentativelySumDelta));
+    /* Suffix sums from which trisecting the i-th subspace is estimated up to the first saturated one without going through the sequence */
+    if(firstSaturated >= 2) {
+        instance->loweringSums[firstSaturated - 2] = instance->gammaPowers[firstSaturated - 1] * instance->L * instance->L;
+        instance->loweringPowers[firstSaturated - 2] = instance->L * instance->L;
 
-            for(j = i + 1; j <= discretizedSubset->n; j++) {
-                tentativelySumDelta = (tentativelySumDelta + discretizedSubset->subspaces[j].delta) * instance->L;
+        for(i = firstSaturated - 2; i > 0; i--) {
+            instance->loweringSums[i - 1] = instance->L * ((instance->gammaPowers[i] * instance->L) + instance->loweringSums[i]);
+            instance->loweringPowers[i - 1] = instance->L * instance->loweringPowers[i];
+        }
+    }
 
-                if((discretizedSubset->subspaces[j].reward + tentativelySumDelta) > 1.0)
-                    break;
+    partialSumDelta = 0.0;
+    partialNewBound = 0.0;
 
-                tentativelyNewBound += (instance->gammaPowers[j] * (discretizedSubset->subspaces[j].reward + tentativelySumDelta));
-            }
+    for(i = 0; i <= T; i++) {
+        lipschitzian_subspace* crt = SUBSPACE(subset, i);
+        unsigned int j = firstSaturated;
+        double nextPartialSumDelta = (partialSumDelta + crt->delta) * instance->L;
+        double nextPartialNewBound = partialNewBound + (instance->gammaPowers[i] * (crt->reward + nextPartialSumDelta));
+        char isExact = isCloseToSaturation || (firstSaturated <= (i + 1));
 
-/*************************** NOT SURE AT ALL IT'S A GOOD IDEA ****************************************************/
+        /* Before the first saturated subspace, trisecting the i-th one lowers the j-th sum of deltas by (delta - nextDelta) * L^(j - i + 1) */
+        if(!isExact) {
+            double estimatedSumDelta = saturationSumDelta - ((crt->delta - crt->nextDelta) * instance->loweringPowers[i]);
+            double estimatedNewBound = partialNewBound + (instance->gammaPowers[i] * (crt->reward + ((partialSumDelta + crt->nextDelta) * instance->L)));
 
-            /*if(j > discretizedSubset->n) {
-            for(; j <= discretizedSubset->constrainedUntil; j++) {
-                tentativelySumDelta = (tentativelySumDelta + (discretizedSubset->subspaces[j].delta * 2.0)) * instance->L;
-                if(tentativelySumDelta > 1.0)
+            estimatedNewBound += (saturationNewBound - nextPartialNewBound) - ((crt->delta - crt->nextDelta) * instance->loweringSums[i]);
+
+            /* A saturation test too close to call may go the other way when going through the sequence */
+            for(; !isExact && (j <= subset->n); j++) {
+                estimatedSumDelta = (estimatedSumDelta + SUBSPACE(subset, j)->delta) * instance->L;
+
+                if(fabs(SUBSPACE(subset, j)->reward + estimatedSumDelta - 1.0) < LOWERING_TOLERANCE)
+                    isExact = 1;
+                else if((SUBSPACE(subset, j)->reward + estimatedSumDelta) > 1.0)
                     break;
-                tentativelyNewBound += (instance->gammaPower[j] * tentativelySumDelta);
+                else
+                    estimatedNewBound += (instance->gammaPowers[j] * (SUBSPACE(subset, j)->reward + estimatedSumDelta));
             }
-            }*/
 
-/*****************************************************************************************************************/
+            instance->estimatedNewBounds[i] = estimatedNewBound + (instance->gammaPowers[j] / (1.0 - instance->gamma));
+        }
+
+        if(isExact)
+            instance->estimatedNewBounds[i] = rescanNewBound(instance, subset, i, partialSumDelta, partialNewBound);
+
+        if(instance->estimatedNewBounds[i] < minEstimatedNewBound)
+            minEstimatedNewBound = instance->estimatedNewBounds[i];
+
+        partialSumDelta = nextPartialSumDelta;
+        partialNewBound = nextPartialNewBound;
+    }
+
+    /* Only a candidate estimated within twice the error of the lowest estimate may be the lowest once the sequence is gone through */
+    partialSumDelta = 0.0;
+    partialNewBound = 0.0;
 
-            tentativelyNewBound += (instance->gammaPowers[j] / (1.0 - instance->gamma));
+    for(i = 0; i <= T; i++) {
+        if(instance->estimatedNewBounds[i] <= (minEstimatedNewBound + (2.0 * estimationError))) {
+            double tentativelyNewBound = rescanNewBound(instance, subset, i, partialSumDelta, partialNewBound);
 
             if(tentativelyNewBound < minNewBound) {
                 minNewBound = tentativelyNewBound;
@@ -560,123 +1778,377 @@ double* lipschitzian_planning(lipschitzian_instance* instance, unsigned int maxN
                 minPartialNewBound = partialNewBound;
                 min = i;
             }
+        }
+
+        partialSumDelta = (partialSumDelta + SUBSPACE(subset, i)->delta) * instance->L;
+        partialNewBound += (instance->gammaPowers[i] * (SUBSPACE(subset, i)->reward + partialSumDelta));
+    }
+
+    if((T == subset->n) && !SUBSPACE(subset, subset->n + 1)->isClosedPath) {
+        double tentativelySumDelta = (partialSumDelta + (subset->constrainedUntil > T ? (SUBSPACE(subset, T + 1)->delta * 2.0) : sqrt(NUMBER_OF_DIMENSIONS_OF_ACTION) )) * instance->L;
+        double tentativelyNewBound = partialNewBound + (tentativelySumDelta > 1.0 ? instance->gammaPowers[T + 1] / (1.0 - instance->gamma) : (instance->gammaPowers[T + 1] * tentativelySumDelta) + (instance->gammaPowers[T + 2] / (1.0 - instance->gamma)));
+
+/*************************** NOT SURE AT ALL IT'S A GOOD IDEA ****************************************************/
+
+        /*double tentativelyNewBound = partialNewBound + (instance->gammaPowers[T + 1] * (tentativelySumDelta > 1.0 ? 1.0 : tentativelySumDelta));
+
+        if((tentativelySumDelta < 1.0) && (subset->constrainedUntil > (T + 1) )) {
+        for(i = T + 2; i < subset->constrainedUntil; i++) {
+        tentativelySumDelta = (tentativelySumDelta + (SUBSPACE(subset, i)->delta * 2.0)) * instance->L;
+        if(tentativelySumDelta > 1.0)
+        break;
+        tentativelyNewBound += (instance->gammaPowers[i] * tentativelySumDelta);
+        }
+        tentativelyNewBound += (instance->gammaPowers[i] / (1.0 - instance->gamma));
+        } else {
+        tentativelyNewBound += (instance->gammaPowers[T + 2] / (1.0 - instance->gamma));
+        }*/
+
+/*****************************************************************************************************************/
+
+        discretization->isExtension = tentativelyNewBound < minNewBound ? 1 : 0;
+    } else {
+        discretization->isExtension = 0;
+    }
+
+    discretization->subset = subset;
+    discretization->min = min;
+    discretization->minPartialSumDelta = minPartialSumDelta;
+    discretization->minPartialNewBound = minPartialNewBound;
+    discretization->partialSumDelta = partialSumDelta;
+    discretization->partialNewBound = partialNewBound;
+
+}
+
+
+/*+--------------------------------------------+
+  | Add a new subspace to a subset up to the   |
+  | simulation of its action                   |
+  +--------------------------------------------+*/
+
+static void prepareExtension(lipschitzian_instance* instance, lipschitzian_discretization* discretization, lipschitzian_transition* transition) {
+
+    unsigned int i = 0;
+    lipschitzian_subset* subset = discretization->subset;
+    char isConstrained = subset->constrainedUntil > subset->n ? 1 : 0;
+
+    lipschitzian_subspace* added = NULL;
+    lipschitzian_subspace* following = NULL;
 
-            partialSumDelta = (partialSumDelta + discretizedSubset->subspaces[i].delta) * instance->L;
-            partialNewBound += (instance->gammaPowers[i] * (discretizedSubset->subspaces[i].reward + partialSumDelta));
+    subset->n++;
 
+    added = writableSubspace(instance, subset, subset->n);
+    following = writableSubspace(instance, subset, subset->n + 1);
+
+    if(!isConstrained) {
+        for(i = 0; i < NUMBER_OF_DIMENSIONS_OF_ACTION; i++) {
+            added->action[i] = 0.5;
+            added->halfSidesLength[i] = 0.5;
         }
 
-        if((T == discretizedSubset->n) && !discretizedSubset->subspaces[discretizedSubset->n + 1].isClosedPath) {
-            double tentativelySumDelta = (partialSumDelta + (discretizedSubset->constrainedUntil > T ? (discretizedSubset->subspaces[T + 1].delta * 2.0) : sqrt(NUMBER_OF_DIMENSIONS_OF_ACTION) )) * instance->L;
-            double tentativelyNewBound = partialNewBound + (tentativelySumDelta > 1.0 ? instance->gammaPowers[T + 1] / (1.0 - instance->gamma) : (instance->gammaPowers[T + 1] * tentativelySumDelta) + (instance->gammaPowers[T + 2] / (1.0 - instance->gamma)));
+        added->delta = 0.5 * sqrt(NUMBER_OF_DIMENSIONS_OF_ACTION);
+        added->nextCutDimension = 0;
+        added->nextDelta = sqrt((0.25 * (NUMBER_OF_DIMENSIONS_OF_ACTION - 1)) + (1.0 / 36.0));
+
+    }
+
+    following->s = newState(instance);
+
+    transition->s = added->s;
+    transition->k = 1;
+    memcpy(transition->actions, added->action, sizeof(double) * NUMBER_OF_DIMENSIONS_OF_ACTION);
+    transition->nextStates[0] = following->s;
+
+    if((subset->n + 1) > instance->maxDepth) {
+        instance->maxDepth = subset->n + 1;
+        reserveGammaPowers(instance);
+    }
+
+    instance->crtNbSubspaces++;
+
+    /* No action has been tried yet from the state the sequence now reaches */
+    added->siblings = newSiblings(instance, SIBLINGS_INITIAL_NB_POINTS, 0.0);
+
+}
+
+
+/*+--------------------------------------------+
+  | Complete an extension once the action of   |
+  | the new subspace is simulated              |
+  +--------------------------------------------+*/
+
+static void finishExtension(lipschitzian_instance* instance, lipschitzian_discretization* discretization, lipschitzian_transition* transition) {
+
+    lipschitzian_subset* subset = discretization->subset;
+    double partialSumDelta = discretization->partialSumDelta;
+    double partialNewBound = discretization->partialNewBound;
+    double tentativelySumDelta = 0.0;
+
+    lipschitzian_subspace* added = writableSubspace(instance, subset, subset->n);
+
+    added->reward = transition->rewards[0];
+    writableSubspace(instance, subset, subset->n + 1)->isClosedPath = transition->isTerminal[0] < 0 ? 1 : 0;
+    addSibling(instance, added);
+
+    added->discountedSumOfRewards = SUBSPACE(subset, subset->n - 1)->discountedSumOfRewards + (instance->gammaPowers[subset->n] * added->reward);
+
+    if(added->discountedSumOfRewards > instance->maxDiscountedSumOfRewards) {
+        instance->maxDiscountedSumOfRewards = added->discountedSumOfRewards;
+        memcpy(instance->crtOptimalAction, SUBSPACE(subset, 0)->action, sizeof(double) * NUMBER_OF_DIMENSIONS_OF_ACTION);
+        instance->crtOptimalSequence = subset;
+    }
+
+    tentativelySumDelta = (partialSumDelta + SUBSPACE(subset, subset->n)->delta) * instance->L;
+
+    if(tentativelySumDelta + SUBSPACE(subset, subset->n)->reward > 1.0)
+        subset->bound = partialNewBound + (instance->gammaPowers[subset->n] / (1.0 - instance->gamma));
+    else
+        subset->bound = partialNewBound + (instance->gammaPowers[subset->n] * (tentativelySumDelta + SUBSPACE(subset, subset->n)->reward)) + (instance->gammaPowers[subset->n + 1] / (1.0 - instance->gamma));
 
 /*************************** NOT SURE AT ALL IT'S A GOOD IDEA ****************************************************/
 
-            /*double tentativelyNewBound = partialNewBound + (instance->gammaPowers[T + 1] * (tentativelySumDelta > 1.0 ? 1.0 : tentativelySumDelta));
+        /*if(tentativelySumDelta + SUBSPACE(subset, subset->n)->reward < 1.0) {
+            tentativelyNewBound = partialNewBound + (instance->gammaPowers[subset->n] * (tentativelySumDelta + SUBSPACE(subset, subset->n)->reward));
 
-            if((tentativelySumDelta < 1.0) && (discretizedSubset->constrainedUntil > (T + 1) )) {
-            for(i = T + 2; i < discretizedSubset->constrainedUntil; i++) {
-            tentativelySumDelta = (tentativelySumDelta + (discretizedSubset->subspaces[i].delta * 2.0)) * instance->L;
-            if(tentativelySumDelta > 1.0)
-            break;
-            tentativelyNewBound += (instance->gammaPowers[i] * tentativelySumDelta);
+            for(i = T + 2; i < subset->constrainedUntil; i++) {
+                tentativelySumDelta = (tentativelySumDelta + (SUBSPACE(subset, i)->delta * 2.0)) * instance->L;
+
+                if(tentativelySumDelta > 1.0)
+                    break;
+
+                tentativelyNewBound += (instance->gammaPowers[i] * tentativelySumDelta);
             }
+            
             tentativelyNewBound += (instance->gammaPowers[i] / (1.0 - instance->gamma));
-            } else {
-            tentativelyNewBound += (instance->gammaPowers[T + 2] / (1.0 - instance->gamma));
-            }*/
+        } else {
+            tentativelyNewBound = partialNewBound + (instance->gammaPowers[subset->n] / (1.0 - instance->gamma));
+        }
+
+        subset->bound = tentativelyNewBound;*/
 
 /*****************************************************************************************************************/
 
-            if(tentativelyNewBound < minNewBound) {		/* A new subspace will be added to the discretized subset */
+}
 
-                double tmp = -1;
 
-                discretizedSubset->n++;
+/*+--------------------------------------------+
+  | Discretize the subset with the highest     |
+  | bound on the calling thread                |
+  +--------------------------------------------+*/
 
-                if((discretizedSubset->n + 1) == discretizedSubset->maxCrtNbSubspaces) {
-                    discretizedSubset->maxCrtNbSubspaces += INCREMENT_STEP_SUBSPACES_ARRAY;
-                    discretizedSubset->subspaces = (lipschitzian_subspace*)realloc(discretizedSubset->subspaces, sizeof(lipschitzian_subspace) * discretizedSubset->maxCrtNbSubspaces);
-                }
+static unsigned int discretize(lipschitzian_instance* instance) {
 
-                if(discretizedSubset->constrainedUntil <= T) {
-                    for(i = 0; i < NUMBER_OF_DIMENSIONS_OF_ACTION; i++) {
-                        discretizedSubset->subspaces[discretizedSubset->n].action[i] = 0.5;
-                        discretizedSubset->subspaces[discretizedSubset->n].halfSidesLength[i] = 0.5;
-                    }
+    lipschitzian_discretization discretization;
+    lipschitzian_transition transition;
 
-                    discretizedSubset->subspaces[discretizedSubset->n].delta = 0.5 * sqrt(NUMBER_OF_DIMENSIONS_OF_ACTION);
-                    discretizedSubset->subspaces[discretizedSubset->n].nextCutDimension = 0;
-                    discretizedSubset->subspaces[discretizedSubset->n].nextDelta = sqrt((0.25 * (NUMBER_OF_DIMENSIONS_OF_ACTION - 1)) + (1.0 / 36.0));
+    chooseDiscretization(instance, instance->nextSubsetToDiscretize, &discretization);
 
-                }
+    if(discretization.isExtension) {
+        prepareExtension(instance, &discretization, &transition);
+        simulate(instance, &transition);
+        finishExtension(instance, &discretization, &transition);
+        updateFrontier(instance, discretization.subset);
+    } else {
+        prepareTrisection(instance, &discretization, &transition);
+        simulate(instance, &transition);
+        finishTrisection(instance, &discretization, &transition);
+        updateSlopes(instance, &discretization);
+        updateFrontier(instance, discretization.subset);
+        pushIntoFrontier(instance, discretization.children[0]);
+        pushIntoFrontier(instance, discretization.children[1]);
+    }
 
-                tmp = discretizedSubset->subspaces[discretizedSubset->n].action[0];
+    instance->nextSubsetToDiscretize = instance->frontier[0];
 
+    return transition.k;
 
-                discretizedSubset->subspaces[discretizedSubset->n + 1].isClosedPath = nextStateReward(discretizedSubset->subspaces[discretizedSubset->n].s, discretizedSubset->subspaces[discretizedSubset->n].action, &(discretizedSubset->subspaces[discretizedSubset->n + 1].s), &(discretizedSubset->subspaces[discretizedSubset->n].reward)) < 0 ? 1 : 0;
-                crtNbEvaluations++;
+}
 
-                discretizedSubset->subspaces[discretizedSubset->n].discountedSumOfRewards = discretizedSubset->subspaces[discretizedSubset->n - 1].discountedSumOfRewards + (instance->gammaPowers[discretizedSubset->n] * discretizedSubset->subspaces[discretizedSubset->n].reward);
 
-                if(discretizedSubset->subspaces[discretizedSubset->n].discountedSumOfRewards > instance->maxDiscountedSumOfRewards) {
-                    instance->maxDiscountedSumOfRewards = discretizedSubset->subspaces[discretizedSubset->n].discountedSumOfRewards;
-                    memcpy(instance->crtOptimalAction, discretizedSubset->subspaces[0].action, sizeof(double) * NUMBER_OF_DIMENSIONS_OF_ACTION);
-                    instance->crtOptimalSequence = discretizedSubset;
-                }
+/*+--------------------------------------------+
+  | Remove the subset with the highest bound   |
+  | from the frontier                          |
+  +--------------------------------------------+*/
 
-                tentativelySumDelta = (partialSumDelta + discretizedSubset->subspaces[discretizedSubset->n].delta) * instance->L;
+static lipschitzian_subset* popFromFrontier(lipschitzian_instance* instance) {
 
-                if(tentativelySumDelta + discretizedSubset->subspaces[discretizedSubset->n].reward > 1.0)
-                    discretizedSubset->bound = partialNewBound + (instance->gammaPowers[discretizedSubset->n] / (1.0 - instance->gamma));
-                else				
-                    discretizedSubset->bound = partialNewBound + (instance->gammaPowers[discretizedSubset->n] * (tentativelySumDelta + discretizedSubset->subspaces[discretizedSubset->n].reward)) + (instance->gammaPowers[discretizedSubset->n + 1] / (1.0 - instance->gamma));
+    lipschitzian_subset* top = instance->frontier[0];
 
-/*************************** NOT SURE AT ALL IT'S A GOOD IDEA ****************************************************/
+    instance->frontierSize--;
 
-                /*if(tentativelySumDelta + discretizedSubset->subspaces[discretizedSubset->n].reward < 1.0) {
-                    tentativelyNewBound = partialNewBound + (instance->gammaPowers[discretizedSubset->n] * (tentativelySumDelta + discretizedSubset->subspaces[discretizedSubset->n].reward));
+    if(instance->frontierSize > 0) {
+        placeInFrontier(instance, instance->frontier[instance->frontierSize], 0);
+        siftDown(instance, instance->frontier[0]);
+    }
 
-                    for(i = T + 2; i < discretizedSubset->constrainedUntil; i++) {
-                        tentativelySumDelta = (tentativelySumDelta + (discretizedSubset->subspaces[i].delta * 2.0)) * instance->L;
+    return top;
 
-                        if(tentativelySumDelta > 1.0)
-                            break;
+}
 
-                        tentativelyNewBound += (instance->gammaPowers[i] * tentativelySumDelta);
-                    }
-                    
-                    tentativelyNewBound += (instance->gammaPowers[i] / (1.0 - instance->gamma));
-                } else {
-                    tentativelyNewBound = partialNewBound + (instance->gammaPowers[discretizedSubset->n] / (1.0 - instance->gamma));
-                }
 
-                discretizedSubset->bound = tentativelyNewBound;*/
+/*+--------------------------------------------+
+  | Discretize in a round the subsets with the |
+  | highest bounds, at most nbSubsets of them. |
+  | Only the simulations run on the threads:   |
+  | the subsets are chosen, modified and put   |
+  | back in the frontier in the order they     |
+  | were taken out, so the result does not     |
+  | depend on the number of threads.           |
+  +--------------------------------------------+*/
 
-/*****************************************************************************************************************/
+static unsigned int discretizeInParallel(lipschitzian_instance* instance, unsigned int nbSubsets) {
 
-                propagateBound(instance, discretizedSubset);
+    unsigned int nbEvaluations = 0;
+    unsigned int i = 0;
 
-                if((discretizedSubset->n + 1) > instance->maxDepth)
-                    instance->maxDepth = discretizedSubset->n + 1;
+    if(nbSubsets > instance->frontierSize)
+        nbSubsets = instance->frontierSize;
 
-                instance->crtNbSubspaces++;
+    for(; i < nbSubsets; i++)
+        chooseDiscretization(instance, popFromFrontier(instance), instance->discretizations + i);
 
-                discretizedSubset->subspaces[discretizedSubset->n].headsSameState = discretizedSubset;
-                discretizedSubset->subspaces[discretizedSubset->n].nextsSameState = NULL;
-            } else {						/* The min-th subspace will be trisected and 2 new subsets will be created */
-                trisectSubspace(instance, min, minPartialSumDelta, minPartialNewBound, &crtNbEvaluations);
-            }
-        } else {							/* The min-th subspace will be trisected and 2 new subsets will be created */
-            trisectSubspace(instance, min, minPartialSumDelta, minPartialNewBound, &crtNbEvaluations);
+    for(i = 0; i < nbSubsets; i++) {
+        if(instance->discretizations[i].isExtension)
+            prepareExtension(instance, instance->discretizations + i, instance->transitions + i);
+        else
+            prepareTrisection(instance, instance->discretizations + i, instance->transitions + i);
+        lookupTransitions(instance, instance->transitions + i);
+    }
+
+    worker_pool_run(instance->pool, simulateTransitionsTask, instance, nbSubsets);
+
+    for(i = 0; i < nbSubsets; i++) {
+        lipschitzian_discretization* discretization = instance->discretizations + i;
+
+        storeTransitions(instance, instance->transitions + i);
+
+        if(discretization->isExtension) {
+            finishExtension(instance, discretization, instance->transitions + i);
+            pushIntoFrontier(instance, discretization->subset);
+        } else {
+            finishTrisection(instance, discretization, instance->transitions + i);
+            pushIntoFrontier(instance, discretization->subset);
+            pushIntoFrontier(instance, discretization->children[0]);
+            pushIntoFrontier(instance, discretization->children[1]);
+        }
+
+        nbEvaluations += instance->transitions[i].k;
+    }
+
+    /* Once every subset of the round holds its reward */
+    for(i = 0; i < nbSubsets; i++) {
+        if(!instance->discretizations[i].isExtension)
+            updateSlopes(instance, instance->discretizations + i);
+    }
+
+    instance->nextSubsetToDiscretize = instance->frontier[0];
+
+    return nbEvaluations;
+
+}
+
+
+/*+---------------------------------------------------------+
+  | Prune the subsets if the instance holds more memory     |
+  | than its limit, until it holds no more than             |
+  | PRUNING_TARGET_RATIO of it. Return 1 if the instance    |
+  | ends up under its limit.                                |
+  +---------------------------------------------------------+*/
+
+static char fitMemoryLimit(lipschitzian_instance* instance) {
+
+    size_t targetBytes = (size_t)(instance->maxBytes * PRUNING_TARGET_RATIO);
+    size_t usage = lipschitzian_getMemoryUsage(instance);
+
+    if(usage <= instance->maxBytes)
+        return 1;
+
+    while(usage > targetBytes) {
+        /* Only the subsets can be pruned, the rest of the memory is taken from the target */
+        size_t otherBytes = usage - instance->memory->bytesReserved;
+        unsigned int nbTies = 0;
+        double minBound = -INFINITY;
+
+        /* Otherwise only the subsets which cannot hold the optimal sequence anymore are pruned */
+        if(instance->isPrunedByBound)
+            minBound = computeMinBound(instance, targetBytes > otherBytes ? targetBytes - otherBytes : 0, &nbTies);
+
+        if(pruneSubsets(instance, minBound, nbTies) == 0)
+            break;
+
+        usage = lipschitzian_getMemoryUsage(instance);
+    }
+
+    return usage <= instance->maxBytes;
+
+}
+
+
+/*+---------------------------------------------------------+
+  | Run the lipschitzian algorithm until either the number  |
+  | of evaluations or the time budget, if any, is exhausted |
+  +---------------------------------------------------------+*/
+
+static double* planUntil(lipschitzian_instance* instance, unsigned int maxNbEvaluations, deadline* budget, unsigned int* nbEvaluations) {
+
+    unsigned int crtNbEvaluations = 0;
+    double* optimalAction = (double*)malloc(sizeof(double) * NUMBER_OF_DIMENSIONS_OF_ACTION);
+
+    instance->isMemoryExhausted = 0;
+
+    while((crtNbEvaluations <= maxNbEvaluations) && ((budget == NULL) || !deadline_isOver(budget, crtNbEvaluations))) {
+        /* A subset needs at most 2 evaluations, a round stops short of overshooting the budget by more than that */
+        unsigned int nbSubsets = ((maxNbEvaluations - crtNbEvaluations) / 2) + 1;
+
+        if((instance->maxBytes > 0) && !fitMemoryLimit(instance)) {
+            instance->isMemoryExhausted = 1;
+            break;
         }
+
+        if(nbSubsets > instance->nbSubsetsPerRound)
+            nbSubsets = instance->nbSubsetsPerRound;
+
+        if((instance->pool == NULL) || (nbSubsets <= 1))
+            crtNbEvaluations += discretize(instance);
+        else
+            crtNbEvaluations += discretizeInParallel(instance, nbSubsets);
     }
 
+    if(nbEvaluations != NULL)
+        *nbEvaluations = crtNbEvaluations;
+
     return memcpy(optimalAction, instance->crtOptimalAction, sizeof(double) * NUMBER_OF_DIMENSIONS_OF_ACTION);
 
 }
 
 
+/*+------------------------------------------------------------------------+
+  | Launch the lipschitzian algorithm with a limited number of evaluations |
+  +------------------------------------------------------------------------+*/
+
+double* lipschitzian_planning(lipschitzian_instance* instance, unsigned int maxNbEvaluations) {
+
+    return planUntil(instance, maxNbEvaluations, NULL, NULL);
+
+}
+
+
+/*+------------------------------------------------------------------------+
+  | Launch the lipschitzian algorithm for at most timeBudget seconds and   |
+  | maxNbEvaluations evaluations. nbEvaluations receives the number of     |
+  | evaluations done.                                                      |
+  +------------------------------------------------------------------------+*/
+
+double* lipschitzian_planningWithDeadline(lipschitzian_instance* instance, unsigned int maxNbEvaluations, double timeBudget, unsigned int* nbEvaluations) {
+
+    deadline budget;
+    deadline_start(&budget, timeBudget);
+
+    return planUntil(instance, maxNbEvaluations, &budget, nbEvaluations);
+
+}
+
+
 /*+----------------------------------------+
   | Compute the mean depth of the instance |
   +----------------------------------------+*/
@@ -702,8 +2174,14 @@ double lipschitzian_getMeanDepth(lipschitzian_instance* instance) {
 
 void lipschitzian_uninitInstance(lipschitzian_instance** instance) {
 
-    if((*instance)->subsets != NULL)
-        freeSubsets((*instance)->list);
+    arena_uninit(&(*instance)->memory);
+    discount_powers_release(&(*instance)->discountPowers);
+    free((*instance)->loweringSums);
+    free((*instance)->loweringPowers);
+    free((*instance)->estimatedNewBounds);
+    if((*instance)->cache != NULL)
+        transition_cache_uninit(&(*instance)->cache);
+    lipschitzian_useThreads(*instance, 0, 0);
 
     free(*instance);
     *instance = NULL;
@@ -720,16 +2198,11 @@ static void drawSubspaces(SDL_Surface* screen, int halfScreenWidth, lipschitzian
 
 	unsigned int i = 0;
 	
-	filledCircleRGBA(screen, halfScreenWidth * (1 + node->subspaces[0].action[0]), 10, 2, 0, 0, 0, 255);
+	filledCircleRGBA(screen, halfScreenWidth * (1 + SUBSPACE(node, 0)->action[0]), 10, 2, 0, 0, 0, 255);
 	
 	for(; i < node->n; i++) {
-		aalineRGBA(screen, halfScreenWidth * (1 + node->subspaces[i].action[0]), 10 + (i * hSpace), halfScreenWidth * (1 + node->subspaces[i+1].action[0]), 10 + ((i + 1) * hSpace), 0, 0, 0, 255);
-		filledCircleRGBA(screen, halfScreenWidth * (1 + node->subspaces[i+1].action[0]), 10 + ((i + 1) * hSpace), 2, 0, 0, 0, 255);
-	}
-
-	if(node->leftChild) {
-		drawSubspaces(screen, halfScreenWidth, node->leftChild, hSpace);
-		drawSubspaces(screen, halfScreenWidth, node->rightChild, hSpace);
+		aalineRGBA(screen, halfScreenWidth * (1 + SUBSPACE(node, i)->action[0]), 10 + (i * hSpace), halfScreenWidth * (1 + SUBSPACE(node, i+1)->action[0]), 10 + ((i + 1) * hSpace), 0, 0, 0, 255);
+		filledCircleRGBA(screen, halfScreenWidth * (1 + SUBSPACE(node, i+1)->action[0]), 10 + ((i + 1) * hSpace), 2, 0, 0, 0, 255);
 	}
 
 }
@@ -742,7 +2215,10 @@ static void drawSubspaces(SDL_Surface* screen, int halfScreenWidth, lipschitzian
 void lipschitzian_drawingProcedure(SDL_Surface* screen, int screenWidth, int screenHeight, void* instance) {
 
     #if NUMBER_OF_DIMENSIONS_OF_ACTION == 1
-    drawSubspaces(screen, screenWidth / 2.0, ((lipschitzian_instance*)instance)->subsets, (screenHeight - 10) / ((lipschitzian_instance*)instance)->maxDepth);
+    lipschitzian_subset* crt = ((lipschitzian_instance*)instance)->list;
+
+    for(; crt != NULL; crt = crt->next)
+        drawSubspaces(screen, screenWidth / 2.0, crt, (screenHeight - 10) / ((lipschitzian_instance*)instance)->maxDepth);
     #else
     (void)screen;
     (void)screenWidth;
@@ -40,6 +40,44 @@
 #endif
 
 #include "../../problems/generative_model.h"
+#include "../arena/arena.h"
+#include "../transition_cache/transition_cache.h"
+#include "../deadline/deadline.h"
+#include "../discount_powers/discount_powers.h"
+#include "../worker_pool/worker_pool.h"
+
+
+/*+--------------------------------------+
+  | The actions tried from a same state, |
+  | from which the next L is estimated:  |
+  | the first coordinate and the reward  |
+  | of each action, sorted by the former,|
+  | and the largest slope of the reward  |
+  | between two of them. A new action    |
+  | only needs to be compared with the   |
+  | closest ones on each side, the slope |
+  | to a farther one being at most the   |
+  | largest of the slopes through one in |
+  | between.                             |
+  +--------------------------------------+*/
+
+#define SIBLINGS_INITIAL_NB_POINTS 4
+
+typedef struct {
+
+    double coordinate;                                      /* The first coordinate of the action */
+    double reward;                                          /* The reward obtained by applying the action on the state */
+
+} lipschitzian_sibling;
+
+typedef struct {
+
+    lipschitzian_sibling* points;                           /* The actions, by increasing first coordinate */
+    unsigned int nbPoints;
+    unsigned int maxNbPoints;
+    double maxSlope;                                        /* The largest slope of the reward along the first dimension between two actions */
+
+} lipschitzian_siblings;
 
 
 /*+--------------------------------------+
@@ -66,13 +104,29 @@ typedef struct {
     double reward;                                          /* The reward obtained by applying the action on the state. */
     char isClosedPath;
 
-    /* Pointers used for estimating the next L */
-    struct lipschitzian_subset* nextsSameState;
-    struct lipschitzian_subset* headsSameState;
+    lipschitzian_siblings* siblings;                        /* The actions tried from the same state as this subspace, for estimating the next L */
 
 } lipschitzian_subspace;
 
 
+/*+-------------------------------------+
+  | A fixed number of consecutive       |
+  | subspaces of a sequence. A chunk is |
+  | shared by a subset and the subsets  |
+  | trisected from it until one of them |
+  | modifies it and gets its own copy.  |
+  +-------------------------------------+*/
+
+#define SUBSPACES_CHUNK_SIZE 8
+
+typedef struct {
+
+    lipschitzian_subspace subspaces[SUBSPACES_CHUNK_SIZE];
+    struct lipschitzian_subset* owner;                      /* The subset allowed to modify this chunk in place, NULL once it is shared */
+
+} lipschitzian_chunk;
+
+
 /*+-------------------------------------+
   | Represents a sequence as a space of |
   | infinite dimension which possesses	|
@@ -81,19 +135,16 @@ typedef struct {
 
 typedef struct lipschitzian_subset {
 
-    lipschitzian_subspace* subspaces;                              /* Keeps track of the subspaces properties for each of the action along the sequence */
-    unsigned int maxCrtNbSubspaces;                         /* Contains the number of lipschitzian_subspace item allocated */
+    lipschitzian_chunk** chunks;                            /* Keeps track of the subspaces properties for each of the action along the sequence, SUBSPACES_CHUNK_SIZE at a time */
+    unsigned int nbChunks;                                  /* Contains the number of chunks of the sequence */
 
     unsigned int n;                                         /* The current cardinality of this subset */
     double bound;                                           /* THE bound of this subset */
     unsigned int constrainedUntil;                          /* The index of the subspaces until which they are constrained by a previous trisecting, 0 being none. */
 
 
-    /* Tree sorting of the bounded subsets */
-    struct lipschitzian_subset* maxBoundedChild;                   /* The maximum bounded child under this one */
-    struct lipschitzian_subset* father;                            /* Link to the father of this node. NULL if this node is the root */
-    struct lipschitzian_subset* leftChild;                         /* Left child */
-    struct lipschitzian_subset* rightChild;                        /* Right child */
+    unsigned int frontierIndex;                             /* The position of this subset in the frontier of the instance */
+    unsigned int order;                                     /* Rank of creation, from which subsets with equal bounds are ordered in the frontier */
 
     /* Pointer to the next subset in the instance list */
     struct lipschitzian_subset* next;
@@ -101,27 +152,83 @@ typedef struct lipschitzian_subset {
 } lipschitzian_subset;
 
 
+/*+-------------------------------------+
+  | How a subset is discretized: either |
+  | extended by a new subspace or its   |
+  | min-th subspace is trisected.       |
+  +-------------------------------------+*/
+
+typedef struct {
+
+    lipschitzian_subset* subset;                            /* The discretized subset */
+    char isExtension;                                       /* 1 if a new subspace is added, 0 if the min-th one is trisected */
+
+    unsigned int min;                                       /* The subspace to be trisected */
+    double minPartialSumDelta;                              /* The partial sum of deltas before the min-th subspace */
+    double minPartialNewBound;                              /* The partial bound before the min-th subspace */
+
+    double partialSumDelta;                                 /* The partial sum of deltas before the added subspace */
+    double partialNewBound;                                 /* The partial bound before the added subspace */
+
+    lipschitzian_subset* children[2];                       /* The left and right subsets created by a trisection */
+
+} lipschitzian_discretization;
+
+
+#define MAX_NB_TRANSITIONS 2                                /* The most transitions a discretization needs, those of the two children of a trisection */
+
+
+/*+-------------------------------------+
+  | The transitions a discretization    |
+  | needs, all leaving the same state.  |
+  +-------------------------------------+*/
+
+typedef struct {
+
+    state* s;                                               /* The state the actions are applied on */
+    unsigned int k;                                         /* The number of actions, 1 for an extension and 2 for a trisection, at most MAX_NB_TRANSITIONS */
+    double actions[MAX_NB_TRANSITIONS * NUMBER_OF_DIMENSIONS_OF_ACTION];    /* The actions one after the other */
+    state* nextStates[MAX_NB_TRANSITIONS];                  /* Where the next states are written */
+    double rewards[MAX_NB_TRANSITIONS];                     /* The rewards obtained */
+    char isTerminal[MAX_NB_TRANSITIONS];                    /* As returned by the generative model */
+    char isCached[MAX_NB_TRANSITIONS];                      /* 1 if the transition was served by the cache */
+
+} lipschitzian_transition;
+
+
 /*+-------------------------------------+
   | Represents an instance of the       |
   | lipschitzian planning algorithm.    |
   +-------------------------------------+*/
 
-#define NB_COMPUTED_POWER 32768
+#define FRONTIER_ARITY 4
+#define INITIAL_FRONTIER_SIZE 256
+#define INCREMENT_STEP_LOWERINGS 32
+#define LOWERING_TOLERANCE 1e-9                            /* Above the rounding error of the bounds estimated from suffix sums, relative to 1 / (1 - gamma) */
+#define PRUNING_TARGET_RATIO 0.75                          /* A pruning brings the memory of the instance down to this ratio of the limit */
+#define MEMORY_LIMIT_NB_SLABS 16                           /* Under a memory limit, the slabs of the arenas take at most this fraction of it */
 
 typedef struct {
 
+    model_context* context;                                 /* The parameters of the model to plan for */
     double L;                                               /* The lipschitz constant of this instance */
     double gamma;                                           /* The discount factor of this instance */
 
-    double gammaPowers[NB_COMPUTED_POWER];                  /* Array with power of the discount factor */
+    discount_powers* discountPowers;                        /* The powers of the discount factor, shared with the instances using the same one */
+    double* gammaPowers;                                    /* Array with power of the discount factor, read from discountPowers */
+    unsigned int nbGammaPowers;                             /* The number of powers in gammaPowers, grown with maxDepth */
 
-    lipschitzian_subset* subsets;                                  /* Binary tree of the subsets for finding the maximum bounded subset */
+    lipschitzian_subset* subsets;                                  /* The subset all the others were trisected from, the whole space after a reset */
 
     /* List of subsets */
     lipschitzian_subset* list;                                     /* Linked list of the subsets */
 
+    /* Max-heap of the subsets on their bound */
+    lipschitzian_subset** frontier;                                /* The heap itself, FRONTIER_ARITY children per node */
+    unsigned int frontierSize;                                     /* The number of subsets in the heap */
+    unsigned int maxFrontierSize;                                  /* The number of subsets the heap can hold before growing */
+
     lipschitzian_subset* nextSubsetToDiscretize;                   /* The next subset that will be discretized (typicaly the maximum bounded one) */
-    lipschitzian_subset* nextNodeToAppendTo;                       /* Where in the binary we are going to put it */
 
     unsigned int maxDepth;                                  /* The maximum length of an encountered action sequence */
 
@@ -131,14 +238,42 @@ typedef struct {
 
     unsigned int crtNbSubspaces;                            /* Statistic about the number of subspaces created */
     unsigned int crtNbSubsets;                              /* Statistic about the number of subsets created */
+    unsigned int nbCreatedSubsets;                          /* The rank of creation of the next subset */
+
+    arena* memory;                                          /* Holds the subsets and their states. Emptied at once by a reset, replaced by a rebase or a pruning. */
+    size_t maxBytes;                                        /* The number of bytes held by the instance above which the subsets are pruned, 0 if not limited */
+    unsigned int nbPrunedSubsets;                           /* Statistic about the number of subsets pruned */
+    char isMemoryExhausted;                                 /* 1 if the last planning stopped early as the subsets could not be pruned under the memory limit */
+    char isPrunedByBound;                                   /* 1 if the subsets with the lowest bounds are pruned too when those which cannot win do not free enough memory */
+    transition_cache* cache;                                /* The transitions already simulated, kept across resets. NULL if not used. */
+
+    double* loweringSums;                                   /* Scratch space of the planning: sum over j of gamma^j * L^(j - i + 1) up to the first saturated subspace */
+    double* loweringPowers;                                 /* Scratch space of the planning: L^(j - i) for j the first saturated subspace */
+    double* estimatedNewBounds;                             /* Scratch space of the planning: the bound estimated for the trisection of each subspace */
+    unsigned int maxNbLowerings;                            /* The number of items allocated in the three scratch spaces */
+
+    char isLAdaptive;                                       /* 1 if L is set to lipschitzian_computeNextL before each reset or rebase */
+
+    worker_pool* pool;                                      /* The threads simulating the transitions of a round. NULL if planning on the calling thread only. */
+    unsigned int nbSubsetsPerRound;                         /* The number of subsets with the highest bounds discretized in a round */
+    lipschitzian_discretization* discretizations;           /* Scratch space of a round, one per subset */
+    lipschitzian_transition* transitions;                   /* Scratch space of a round, one per subset */
 
 } lipschitzian_instance;
 
 
-lipschitzian_instance* lipschitzian_initInstance(state* initial, double discountFactor, double L);
+lipschitzian_instance* lipschitzian_initInstance(model_context* context, state* initial, double discountFactor, double L);
 void lipschitzian_resetInstance(lipschitzian_instance* instance, state* initial);
+void lipschitzian_rebaseInstance(lipschitzian_instance* instance, state* initial, double* action);
+void lipschitzian_useTransitionCache(lipschitzian_instance* instance, size_t maxBytes);
+void lipschitzian_useThreads(lipschitzian_instance* instance, unsigned int nbThreads, unsigned int nbSubsetsPerRound);
+void lipschitzian_setMemoryLimit(lipschitzian_instance* instance, size_t maxBytes);
+void lipschitzian_usePruningByBound(lipschitzian_instance* instance, char isPrunedByBound);
+size_t lipschitzian_getMemoryUsage(lipschitzian_instance* instance);
+void lipschitzian_useAdaptiveL(lipschitzian_instance* instance, char isAdaptive);
 double lipschitzian_computeNextL(lipschitzian_instance* instance);
 double* lipschitzian_planning(lipschitzian_instance* instance, unsigned int maxNbEvaluations);
+double* lipschitzian_planningWithDeadline(lipschitzian_instance* instance, unsigned int maxNbEvaluations, double timeBudget, unsigned int* nbEvaluations);
 double lipschitzian_getMeanDepth();
 void lipschitzian_uninitInstance(lipschitzian_instance** instance);
 
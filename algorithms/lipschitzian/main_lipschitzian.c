@@ -43,16 +43,37 @@
     #include "../../problems/viewer.h"
 #endif
 
+#ifdef USE_REGISTRY
+    #if defined(USE_SDL)
+        #error "The viewers are not available through the problem registry"
+    #endif
+    #include "../../problems/registry.h"
+#endif
+
 #include "lipschitzian.h"
 
 
 int main(int argc, char* argv[]) {
 
+    model_context* context = NULL;
+#ifdef USE_REGISTRY
+    problem* selectedProblem = NULL;
+#endif
     double discountFactor;
     unsigned int maxNbEvaluations;
     char isTerminal = 0;
     int nbTimestep = -1;
     double L;
+    unsigned int cacheSize = 0;
+    char isReused = 0;
+    char hasDeadline = 0;
+    double timeBudget = 0.0;
+    unsigned int nbThreads = 0;
+    unsigned int nbSubsetsPerRound = 0;
+    char isLAdaptive = 0;
+    unsigned int memoryLimit = 0;
+    char isPrunedByBound = 0;
+    unsigned int nbEvaluations = 0;
 
 #ifdef USE_SDL
     char isDisplayed = 1;
@@ -75,31 +96,51 @@ int main(int argc, char* argv[]) {
     struct arg_int* s = arg_int0("s", "nbtimestep", "<n>", "The number of timestep");
     struct arg_str* i = arg_str0(NULL, "state", "<s>", "The initial state to use");
     struct arg_dbl* l = arg_dbl1("L", NULL, "<d>", "The Lipschitz coefficient");
+    struct arg_int* c = arg_int0(NULL, "cache", "<n>", "The size in megabytes of the transition cache, 0 to disable it");
+    struct arg_lit* u = arg_lit0(NULL, "reuse", "Keep the subsets starting with the executed action for the next step");
+    struct arg_dbl* b = arg_dbl0(NULL, "deadline", "<d>", "The time budget in seconds of each step, the number of evaluations being then an upper bound");
+    struct arg_int* w = arg_int0(NULL, "threads", "<n>", "The number of threads simulating the transitions, 0 to plan on the main thread only");
+    struct arg_int* k = arg_int0(NULL, "round", "<n>", "The number of subsets discretized in a round when using threads");
+    struct arg_int* m = arg_int0(NULL, "memory", "<n>", "The memory in megabytes above which the subsets which cannot hold the optimal sequence are pruned, 0 for no limit");
+    struct arg_lit* o = arg_lit0(NULL, "pruneByBound", "Also prune the subsets with the lowest bounds when above the memory limit, the plan may then be worse");
+    struct arg_lit* a = arg_lit0(NULL, "adaptive", "Estimate L again from the observed rewards before each step, L being the first estimation");
 
 #ifdef USE_SDL
     struct arg_lit* d = arg_lit0("d", NULL, "Display the viewer");
     struct arg_lit* v = arg_lit0("v", NULL, "Verbose");
     struct arg_str* r = arg_str0(NULL, "resolution", "<s>", "The resolution of the display window");
     struct arg_lit* f = arg_lit0("f", NULL, "Fullscreen");
-    void* argtable[10];
-    int nbArgs = 9;
+    void* argtable[18];
+    int nbArgs = 17;
+#elif defined(USE_REGISTRY)
+    struct arg_str* p = arg_str1("p", "problem", "<s>", "The problem to solve");
+    void* argtable[15];
+    int nbArgs = 14;
 #else
-    void* argtable[6];
-    int nbArgs = 5;
+    void* argtable[14];
+    int nbArgs = 13;
 #endif
 
     struct arg_end* end = arg_end(nbArgs+1);
     int nerrors = 0;
 
     s->ival[0] = -1;
+    c->ival[0] = 0;
+    m->ival[0] = 0;
+    w->ival[0] = 0;
+    k->ival[0] = 16;
 
-    argtable[0] = g; argtable[1] = n; argtable[2] = l; argtable[3] = s; argtable[4] = i;
+    argtable[0] = g; argtable[1] = n; argtable[2] = l; argtable[3] = s; argtable[4] = i; argtable[5] = c; argtable[6] = u; argtable[7] = b; argtable[8] = w; argtable[9] = k; argtable[10] = a; argtable[11] = m; argtable[12] = o;
 
 #ifdef USE_SDL
-    argtable[5] = d;
-    argtable[6] = v;
-    argtable[7] = r;
-    argtable[8] = f;
+    argtable[13] = d;
+    argtable[14] = v;
+    argtable[15] = r;
+    argtable[16] = f;
+#endif
+
+#ifdef USE_REGISTRY
+    argtable[13] = p;
 #endif
 
     argtable[nbArgs] = end;
@@ -123,13 +164,33 @@ int main(int argc, char* argv[]) {
     discountFactor = g->dval[0];
     maxNbEvaluations = n->ival[0];
     L = l->dval[0];
+    cacheSize = c->ival[0] > 0 ? c->ival[0] : 0;
+    isReused = u->count;
+    hasDeadline = b->count;
+    timeBudget = b->count ? b->dval[0] : 0.0;
+    nbThreads = w->ival[0] > 0 ? w->ival[0] : 0;
+    nbSubsetsPerRound = k->ival[0] > 0 ? k->ival[0] : 1;
+    isLAdaptive = a->count;
+    memoryLimit = m->ival[0] > 0 ? m->ival[0] : 0;
+    isPrunedByBound = o->count;
+
+#ifdef USE_REGISTRY
+    selectedProblem = selectProblem(p->sval[0]);
+    if(selectedProblem == NULL || selectedProblem->actionDimension != NUMBER_OF_DIMENSIONS_OF_ACTION) {
+        printf("error: the problem has to be one of those with an action dimension of %u:\n", NUMBER_OF_DIMENSIONS_OF_ACTION);
+        printProblems();
+        arg_freetable(argtable, nbArgs+1);
+        return EXIT_FAILURE;
+    }
+#endif
 
     initGenerativeModelParameters();
     initGenerativeModel();
+    context = initModelContext();
     if(i->count)
-        crtState = makeState(i->sval[0]);
+        crtState = makeStateWithContext(context, i->sval[0]);
     else
-        crtState = initState();
+        crtState = initStateWithContext(context);
 
 #ifdef USE_SDL
     if(r->count)
@@ -142,7 +203,12 @@ int main(int argc, char* argv[]) {
     nbTimestep = s->ival[0];
     arg_freetable(argtable, nbArgs+1);
 
-    instance = lipschitzian_initInstance(crtState, discountFactor, L);
+    instance = lipschitzian_initInstance(context, crtState, discountFactor, L);
+    lipschitzian_useTransitionCache(instance, (size_t)cacheSize * 1048576);
+    lipschitzian_useThreads(instance, nbThreads, nbSubsetsPerRound);
+    lipschitzian_useAdaptiveL(instance, isLAdaptive);
+    lipschitzian_setMemoryLimit(instance, (size_t)memoryLimit * 1048576);
+    lipschitzian_usePruningByBound(instance, isPrunedByBound);
 
 #ifdef USE_SDL
     if(isDisplayed) {
@@ -153,19 +219,34 @@ int main(int argc, char* argv[]) {
 #endif
 
     do {
+        if(isReused && (optimalAction != NULL))
+            lipschitzian_rebaseInstance(instance, crtState, optimalAction);
+        else
+            lipschitzian_resetInstance(instance, crtState);
         free(optimalAction);
-        lipschitzian_resetInstance(instance, crtState);
 
-        optimalAction = lipschitzian_planning(instance, maxNbEvaluations);
+        if(hasDeadline)
+            optimalAction = lipschitzian_planningWithDeadline(instance, maxNbEvaluations, timeBudget, &nbEvaluations);
+        else
+            optimalAction = lipschitzian_planning(instance, maxNbEvaluations);
 
-        isTerminal = nextStateReward(crtState, optimalAction, &nextState, &reward);
+        isTerminal = nextStateRewardWithContext(context, crtState, optimalAction, &nextState, &reward);
         freeState(crtState);
         crtState = nextState;
 
         if(verbose) {
             printState(crtState);
             printAction(optimalAction);
-            printf("reward: %f mean depth: %f\n", reward, lipschitzian_getMeanDepth(instance));
+            printf("reward: %f mean depth: %f", reward, lipschitzian_getMeanDepth(instance));
+            if(hasDeadline)
+                printf(" evaluations: %u", nbEvaluations);
+            if(instance->cache != NULL)
+                printf(" cache hit rate: %f", transition_cache_getHitRate(instance->cache));
+            if(isLAdaptive)
+                printf(" L: %f", instance->L);
+            if(memoryLimit > 0)
+                printf(" memory: %lu pruned: %u%s", (unsigned long)lipschitzian_getMemoryUsage(instance), instance->nbPrunedSubsets, instance->isMemoryExhausted ? " exhausted" : "");
+            printf("\n");
         }
 #ifdef USE_SDL
     } while(!isTerminal && (nbTimestep < 0 || --nbTimestep) && (isDisplayed || !viewer(crtState, optimalAction, reward, instance)));
@@ -178,9 +259,14 @@ int main(int argc, char* argv[]) {
 
     lipschitzian_uninitInstance(&instance);
 
+    freeModelContext(context);
     freeGenerativeModel();
     freeGenerativeModelParameters();
 
+#ifdef USE_REGISTRY
+    freeProblems();
+#endif
+
     return EXIT_SUCCESS;
 
 }
@@ -41,14 +41,30 @@
 #ifdef USE_SDL
     #include "../../problems/viewer.h"
 #endif
+
+#ifdef USE_REGISTRY
+    #if defined(USE_SDL)
+        #error "The viewers are not available through the problem registry"
+    #endif
+    #include "../../problems/registry.h"
+#endif
 #include "random_search.h"
 
 int main(int argc, char* argv[]) {
 
+    model_context* context = NULL;
+#ifdef USE_REGISTRY
+    problem* selectedProblem = NULL;
+#endif
     double discountFactor;
     unsigned int maxNbEvaluations;
     char isTerminal = 0;
     int nbTimestep = -1;
+    char hasDeadline = 0;
+    double timeBudget = 0.0;
+    unsigned int nbEvaluations = 0;
+    unsigned int nbThreads = 0;
+    unsigned long seed = 0;
 
     random_search_instance* instance = NULL;
 
@@ -69,31 +85,44 @@ int main(int argc, char* argv[]) {
     struct arg_dbl* g = arg_dbl1("g", "discountFactor", "<d>", "The discount factor for the problem");
     struct arg_int* n = arg_int1("n", "nbEvaluations", "<n>", "The number of evaluations");
     struct arg_int* s = arg_int0("s", "nbtimestep", "<n>", "The number of timestep");
+    struct arg_dbl* b = arg_dbl0(NULL, "deadline", "<d>", "The time budget in seconds of each step, the number of evaluations being then an upper bound");
+    struct arg_int* w = arg_int0(NULL, "threads", "<n>", "The number of threads drawing the trajectories, 0 to plan on the main thread only");
+    struct arg_int* e = arg_int0(NULL, "seed", "<n>", "The seed of the random draws of the planner and the problem, 0 to seed them from the clock");
 
 #ifdef USE_SDL
     struct arg_lit* d = arg_lit0("d", NULL, "Display the viewer");
     struct arg_lit* v = arg_lit0("v", NULL, "Verbose");
     struct arg_str* r = arg_str0(NULL, "resolution", "<s>", "The resolution of the display window");
     struct arg_lit* f = arg_lit0("f", NULL, "Fullscreen");
-    void* argtable[9];
-    int nbArgs = 8;
+    void* argtable[11];
+    int nbArgs = 10;
+#elif defined(USE_REGISTRY)
+    struct arg_str* p = arg_str1("p", "problem", "<s>", "The problem to solve");
+    void* argtable[8];
+    int nbArgs = 7;
 #else
-    void* argtable[4];
-    int nbArgs = 3;
+    void* argtable[7];
+    int nbArgs = 6;
 #endif
 
     struct arg_end* end = arg_end(nbArgs+1);
     int nerrors = 0;
 
     s->ival[0] = -1;
+    w->ival[0] = 0;
+    e->ival[0] = 0;
 
-    argtable[0] = g; argtable[1] = n; argtable[2] = s;
+    argtable[0] = g; argtable[1] = n; argtable[2] = s; argtable[3] = b; argtable[4] = w; argtable[5] = e;
 
 #ifdef USE_SDL
-    argtable[3] = d;
-    argtable[4] = v;
-    argtable[5] = r;
-    argtable[6] = f;
+    argtable[6] = d;
+    argtable[7] = v;
+    argtable[8] = r;
+    argtable[9] = f;
+#endif
+
+#ifdef USE_REGISTRY
+    argtable[6] = p;
 #endif
 
     argtable[nbArgs] = end;
@@ -117,10 +146,26 @@ int main(int argc, char* argv[]) {
 
     discountFactor = g->dval[0];
     maxNbEvaluations = n->ival[0];
+    hasDeadline = b->count;
+    timeBudget = b->count ? b->dval[0] : 0.0;
+    nbThreads = w->ival[0] > 0 ? w->ival[0] : 0;
+    seed = e->ival[0] > 0 ? (unsigned long)e->ival[0] : 0;
+
+#ifdef USE_REGISTRY
+    selectedProblem = selectProblem(p->sval[0]);
+    if(selectedProblem == NULL || selectedProblem->actionDimension != NUMBER_OF_DIMENSIONS_OF_ACTION) {
+        printf("error: the problem has to be one of those with an action dimension of %u:\n", NUMBER_OF_DIMENSIONS_OF_ACTION);
+        printProblems();
+        arg_freetable(argtable, nbArgs+1);
+        return EXIT_FAILURE;
+    }
+#endif
 
+    setModelSeed(seed);
     initGenerativeModelParameters();
     initGenerativeModel();
-    crtState = initState();
+    context = initModelContext();
+    crtState = initStateWithContext(context);
     nbTimestep = s->ival[0];
 
 #ifdef SDL_USE
@@ -133,7 +178,9 @@ int main(int argc, char* argv[]) {
 
     arg_freetable(argtable, nbArgs+1);
 
-    instance = random_search_initInstance(crtState, discountFactor);
+    instance = random_search_initInstance(context, crtState, discountFactor);
+    random_search_useThreads(instance, nbThreads);
+    random_search_setSeed(instance, seed);
 
 #ifdef USE_SDL
     if(isDisplayed) {    
@@ -146,16 +193,22 @@ int main(int argc, char* argv[]) {
     do {
         random_search_resetInstance(instance, crtState);
 
-        optimalAction = random_search_planning(instance, maxNbEvaluations);
+        if(hasDeadline)
+            optimalAction = random_search_planningWithDeadline(instance, maxNbEvaluations, timeBudget, &nbEvaluations);
+        else
+            optimalAction = random_search_planning(instance, maxNbEvaluations);
 
-        isTerminal = nextStateReward(crtState, optimalAction, &nextState, &reward);
+        isTerminal = nextStateRewardWithContext(context, crtState, optimalAction, &nextState, &reward);
         freeState(crtState);
         crtState = nextState;
 
         if(verbose) {
             printState(crtState);
             printAction(optimalAction);
-            printf("Reward: %f depth: %u\n", reward, random_search_getMaxDepth(instance));
+            if(hasDeadline)
+                printf("Reward: %f depth: %u evaluations: %u\n", reward, random_search_getMaxDepth(instance), nbEvaluations);
+            else
+                printf("Reward: %f depth: %u\n", reward, random_search_getMaxDepth(instance));
         }
 #ifdef USE_SDL
     } while(!isTerminal && (nbTimestep < 0 || --nbTimestep) && (!isDisplayed || !viewer(crtState, optimalAction, reward, instance)));
@@ -167,9 +220,14 @@ int main(int argc, char* argv[]) {
 
     random_search_uninitInstance(&instance);
 
+    freeModelContext(context);
     freeGenerativeModel();
     freeGenerativeModelParameters();
 
+#ifdef USE_REGISTRY
+    freeProblems();
+#endif
+
     return EXIT_SUCCESS;
 
 }
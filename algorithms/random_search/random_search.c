@@ -56,18 +56,45 @@ unsigned int h_max_default(random_search_instance* instance) {
 
 unsigned int (*h_max)(random_search_instance*) = h_max_default;
 
-random_search_instance* random_search_initInstance(state* initial, double discountFactor) {
+/* Seed the stream of each worker from the rng of the instance, in the order of the workers */
+static void seedWorkers(random_search_instance* instance) {
+
+    unsigned int i = 0;
+    for(; i < instance->nbWorkers; i++)
+        gsl_rng_set(instance->workers[i].rng, gsl_rng_get(instance->rng));
+
+}
+
+
+/* A trajectory reads the powers up to the one of index crtDepthLimit */
+static void reserveGammaPowers(random_search_instance* instance) {
+
+    if(instance->crtDepthLimit >= instance->nbGammaPowers)
+        instance->gammaPowers = discount_powers_reserve(instance->discountPowers, instance->crtDepthLimit + 1, &instance->nbGammaPowers);
+
+}
+
+
+random_search_instance* random_search_initInstance(model_context* context, state* initial, double discountFactor) {
 
-    unsigned int i = 1;
     random_search_instance* instance = (random_search_instance*)malloc(sizeof(random_search_instance));
 
+    instance->context = context;
     instance->rng = NULL;
+    instance->seed = 0;
     instance->initial = NULL;
+    instance->buffers[0] = (state*)malloc(stateSize());
+    instance->buffers[1] = (state*)malloc(stateSize());
 
     instance->gamma = discountFactor;
-    instance->gammaPowers[0] = 1.0;
-    for(;i < RANDOM_SEARCH_MAX_DEPTH; i++)
-        instance->gammaPowers[i] = instance->gammaPowers[i - 1] * discountFactor;
+    instance->discountPowers = discount_powers_acquire(discountFactor);
+    instance->gammaPowers = NULL;
+    instance->nbGammaPowers = 0;
+
+    instance->pool = NULL;
+    instance->workers = NULL;
+    instance->nbWorkers = 0;
+    instance->nbEvaluationsPerWorker = 0;
 
     if(initial != NULL)
         random_search_resetInstance(instance, initial);
@@ -85,11 +112,14 @@ void random_search_resetInstance(random_search_instance* instance, state* initia
     if(instance->rng == NULL)
         instance->rng = gsl_rng_alloc(gsl_rng_mt19937);
 
-    gsl_rng_set(instance->rng, time(NULL));
+    if(instance->seed == 0)
+        gsl_rng_set(instance->rng, time(NULL));
+    seedWorkers(instance);
 
     instance->initial = copyState(initial);
 
     instance->crtDepthLimit = 1;
+    reserveGammaPowers(instance);
     instance->crtNbEvaluations = 0;
     instance->crtMaxDepth = 0;
     instance->crtOptimalValue = 0.0;
@@ -99,70 +129,254 @@ void random_search_resetInstance(random_search_instance* instance, state* initia
 }
 
 
-double* random_search_planning(random_search_instance* instance, unsigned int maxNbEvaluations) {
+/* Seed rng once, the following resets going on with its stream instead of
+   the clock, so that a sequence of plannings can be replayed. 0 goes back to
+   seeding from the clock at each reset. */
+void random_search_setSeed(random_search_instance* instance, unsigned long seed) {
 
-    double* optimalAction = (double*)malloc(sizeof(double) * NUMBER_OF_DIMENSIONS_OF_ACTION);
+    instance->seed = seed;
+
+    if(seed != 0) {
+        if(instance->rng == NULL)
+            instance->rng = gsl_rng_alloc(gsl_rng_mt19937);
+        gsl_rng_set(instance->rng, seed);
+        seedWorkers(instance);
+    }
+
+}
+
+
+/* Draw a random trajectory of at most crtDepthLimit + 1 steps from the initial
+   state using the given rng and buffers. Its first action is put in firstAction,
+   nbEvaluations is increased by the evaluations done and its discounted sum of
+   rewards is returned. */
+static double drawTrajectory(random_search_instance* instance, gsl_rng* rng, state** buffers, double* firstAction, unsigned int* nbEvaluations) {
+
+    state* crt = buffers[0];
+    state* next = buffers[1];
+    double reward = 0.0;
+    unsigned int crtDepth = 1;
+    double discountedSum = 0.0;
+    unsigned int i = 0;
+    for(; i < NUMBER_OF_DIMENSIONS_OF_ACTION; i++)
+        firstAction[i] = gsl_rng_uniform(rng);
+
+    nextStateRewardIntoWithContext(instance->context, instance->initial, firstAction, crt, &discountedSum);
+    (*nbEvaluations)++;
 
-    while(instance->crtNbEvaluations < maxNbEvaluations) {
-        state* crt = instance->initial;
-        state* next = NULL;
-        double reward = 0.0;
-        double firstAction[NUMBER_OF_DIMENSIONS_OF_ACTION];
-        unsigned int crtDepth = 1;
-        double discountedSum = 0.0;
-        unsigned int i = 0;
-        for(; i < NUMBER_OF_DIMENSIONS_OF_ACTION; i++)
-            firstAction[i] = gsl_rng_uniform(instance->rng);
+    while(crtDepth <= instance->crtDepthLimit) {
+        double crtAction[NUMBER_OF_DIMENSIONS_OF_ACTION];
+        char isTerminal = 0;
+        state* tmp = NULL;
+        for(i = 0; i < NUMBER_OF_DIMENSIONS_OF_ACTION; i++)
+            crtAction[i] = gsl_rng_uniform(rng);
 
-        nextStateReward(crt, firstAction, &next, &discountedSum);
-        instance->crtNbEvaluations++;
+        isTerminal = nextStateRewardIntoWithContext(instance->context, crt, crtAction, next, &reward) < 0 ? 1 : 0;
+        (*nbEvaluations)++;
+        discountedSum += instance->gammaPowers[crtDepth] * reward;
 
+        tmp = crt;
         crt = next;
+        next = tmp;
+
+        if(isTerminal)
+            break;
+
+        crtDepth++;
+    }
+
+    return discountedSum;
+
+}
+
+
+/* Start a trajectory from the initial state in the place i of the batch of a worker */
+static void startTrajectory(random_search_instance* instance, random_search_worker* worker, unsigned int i) {
+
+    setStateOfBatch(worker->states, i, instance->initial);
+    worker->lengths[i] = 0;
+
+}
 
-        while(crtDepth <= instance->crtDepthLimit) {
-            double crtAction[NUMBER_OF_DIMENSIONS_OF_ACTION];
-            char isTerminal = 0;
-            for(i = 0; i < NUMBER_OF_DIMENSIONS_OF_ACTION; i++)
-                crtAction[i] = gsl_rng_uniform(instance->rng);
 
-            isTerminal = nextStateReward(crt, crtAction, &next, &reward) < 0 ? 1 : 0;
-            instance->crtNbEvaluations++;
-            discountedSum += instance->gammaPowers[crtDepth] * reward;
+/* Move the trajectory in the place i of the batch of a worker to the place j */
+static void moveTrajectory(random_search_worker* worker, unsigned int i, unsigned int j) {
 
-            freeState(crt);
-            crt = next;
+    getStateOfBatch(worker->states, i, worker->buffer);
+    setStateOfBatch(worker->states, j, worker->buffer);
+    memcpy(worker->firstActions + (j * NUMBER_OF_DIMENSIONS_OF_ACTION), worker->firstActions + (i * NUMBER_OF_DIMENSIONS_OF_ACTION), sizeof(double) * NUMBER_OF_DIMENSIONS_OF_ACTION);
+    worker->discountedSums[j] = worker->discountedSums[i];
+    worker->rewards[j] = worker->rewards[i];
+    worker->isTerminal[j] = worker->isTerminal[i];
+    worker->lengths[j] = worker->lengths[i];
 
-            if(isTerminal)
-                break;
+}
+
+
+/* Draw trajectories with the stream of a worker until it did its share of the
+   round. Up to RANDOM_SEARCH_NB_TRAJECTORIES_PER_BATCH of them are stepped
+   together, each one stopping as drawTrajectory does. A trajectory starts in
+   the place of a stopped one as long as the share cannot be overshot by more
+   than a trajectory, otherwise the last running one takes that place, so that
+   the running ones come first in the batch. The actions of a step are drawn in
+   the order of the running trajectories, so the stream is not read in the
+   order of drawTrajectory with more than one trajectory per batch. */
+static void drawTrajectoriesTask(void* data, unsigned int index) {
+
+    random_search_instance* instance = (random_search_instance*)data;
+    random_search_worker* worker = instance->workers + index;
+    unsigned int maxLength = instance->crtDepthLimit + 1;
+    unsigned int nbRunning = 0;
+    unsigned int nbPending = 0;                         /* The most evaluations the running trajectories can still do */
+    unsigned int i = 0;
+    unsigned int j = 0;
+
+    /* Allocated on the first round, the initial state being known by then */
+    if(worker->states == NULL)
+        worker->states = initStateBatch(RANDOM_SEARCH_NB_TRAJECTORIES_PER_BATCH, instance->initial);
+
+    worker->nbEvaluations = 0;
+    worker->optimalValue = instance->crtOptimalValue;
+
+    while((nbRunning < RANDOM_SEARCH_NB_TRAJECTORIES_PER_BATCH) && ((worker->nbEvaluations + nbPending) < instance->nbEvaluationsPerWorker)) {
+        startTrajectory(instance, worker, nbRunning++);
+        nbPending += maxLength;
+    }
+
+    while(nbRunning > 0) {
+        for(j = 0; j < nbRunning; j++) {
+            for(i = 0; i < NUMBER_OF_DIMENSIONS_OF_ACTION; i++)
+                worker->actions[(j * NUMBER_OF_DIMENSIONS_OF_ACTION) + i] = gsl_rng_uniform(worker->rng);
+            if(worker->lengths[j] == 0)
+                memcpy(worker->firstActions + (j * NUMBER_OF_DIMENSIONS_OF_ACTION), worker->actions + (j * NUMBER_OF_DIMENSIONS_OF_ACTION), sizeof(double) * NUMBER_OF_DIMENSIONS_OF_ACTION);
+        }
 
-            crtDepth++;
+        nextStateRewardBatchWithContext(instance->context, worker->states, nbRunning, worker->actions, worker->rewards, worker->isTerminal);
+        worker->nbEvaluations += nbRunning;
+        nbPending -= nbRunning;
+
+        for(j = 0; j < nbRunning;) {
+            if(worker->lengths[j] == 0)
+                worker->discountedSums[j] = worker->rewards[j];
+            else
+                worker->discountedSums[j] += instance->gammaPowers[worker->lengths[j]] * worker->rewards[j];
+            worker->lengths[j]++;
+
+            /* The first step is taken even from a terminal state */
+            if((worker->lengths[j] < maxLength) && ((worker->lengths[j] == 1) || (worker->isTerminal[j] >= 0))) {
+                j++;
+                continue;
+            }
+
+            nbPending -= maxLength - worker->lengths[j];
+
+            if(worker->discountedSums[j] > worker->optimalValue) {
+                worker->optimalValue = worker->discountedSums[j];
+                memcpy(worker->optimalAction, worker->firstActions + (j * NUMBER_OF_DIMENSIONS_OF_ACTION), sizeof(double) * NUMBER_OF_DIMENSIONS_OF_ACTION);
+            }
+
+            if((worker->nbEvaluations + nbPending) < instance->nbEvaluationsPerWorker) {
+                startTrajectory(instance, worker, j++);
+                nbPending += maxLength;
+            } else {
+                moveTrajectory(worker, --nbRunning, j);
+            }
         }
+    }
 
-        freeState(crt);
+}
 
-        if(instance->crtDepthLimit > instance->crtMaxDepth)
-            instance->crtMaxDepth = instance->crtDepthLimit;
 
-        if(discountedSum > instance->crtOptimalValue) {
-            instance->crtOptimalValue = discountedSum;
-            memcpy(instance->crtOptimalAction, firstAction, sizeof(double) * NUMBER_OF_DIMENSIONS_OF_ACTION);
+/* Run a round on the threads with the depth limit of the moment and merge the
+   bests of the workers in their order, so that the result does not depend on
+   which thread ran which worker. Fewer workers are used near maxNbEvaluations
+   so that the budget is not overshot by more than a trajectory per worker. */
+static void drawTrajectories(random_search_instance* instance, unsigned int maxNbEvaluations) {
+
+    unsigned int nbRemaining = maxNbEvaluations - instance->crtNbEvaluations;
+    unsigned int nbEvaluations = instance->crtNbEvaluations / RANDOM_SEARCH_ROUND_DIVISOR;
+    unsigned int nbWorkers = (nbRemaining / (instance->crtDepthLimit + 1)) + 1;
+    unsigned int i = 0;
+
+    if(nbWorkers > instance->nbWorkers)
+        nbWorkers = instance->nbWorkers;
+    if(nbEvaluations > nbRemaining)
+        nbEvaluations = nbRemaining;
+
+    instance->nbEvaluationsPerWorker = (nbEvaluations + nbWorkers - 1) / nbWorkers;
+    if(instance->nbEvaluationsPerWorker == 0)
+        instance->nbEvaluationsPerWorker = 1;
+
+    worker_pool_run(instance->pool, drawTrajectoriesTask, instance, nbWorkers);
+
+    for(; i < nbWorkers; i++) {
+        random_search_worker* worker = instance->workers + i;
+        instance->crtNbEvaluations += worker->nbEvaluations;
+
+        if(worker->optimalValue > instance->crtOptimalValue) {
+            instance->crtOptimalValue = worker->optimalValue;
+            memcpy(instance->crtOptimalAction, worker->optimalAction, sizeof(double) * NUMBER_OF_DIMENSIONS_OF_ACTION);
         }
+    }
 
-        if(instance->crtDepthLimit < (RANDOM_SEARCH_MAX_DEPTH - 1)) {
-            instance->crtDepthLimit = h_max(instance);
-            if(instance->crtDepthLimit >= RANDOM_SEARCH_MAX_DEPTH)
-                instance->crtDepthLimit = RANDOM_SEARCH_MAX_DEPTH - 1;
-            if(instance->crtDepthLimit < 1)
-                instance->crtDepthLimit = 1;
+}
+
+
+static double* planUntil(random_search_instance* instance, unsigned int maxNbEvaluations, deadline* budget, unsigned int* nbEvaluations) {
+
+    double* optimalAction = (double*)malloc(sizeof(double) * NUMBER_OF_DIMENSIONS_OF_ACTION);
+    unsigned int initialNbEvaluations = instance->crtNbEvaluations;
+
+    while((instance->crtNbEvaluations < maxNbEvaluations) && ((budget == NULL) || !deadline_isOver(budget, instance->crtNbEvaluations))) {
+        if(instance->pool == NULL) {
+            double firstAction[NUMBER_OF_DIMENSIONS_OF_ACTION];
+            double discountedSum = drawTrajectory(instance, instance->rng, instance->buffers, firstAction, &instance->crtNbEvaluations);
+
+            if(discountedSum > instance->crtOptimalValue) {
+                instance->crtOptimalValue = discountedSum;
+                memcpy(instance->crtOptimalAction, firstAction, sizeof(double) * NUMBER_OF_DIMENSIONS_OF_ACTION);
+            }
+        } else {
+            drawTrajectories(instance, maxNbEvaluations);
         }
+
+        if(instance->crtDepthLimit > instance->crtMaxDepth)
+            instance->crtMaxDepth = instance->crtDepthLimit;
+
+        instance->crtDepthLimit = h_max(instance);
+        if(instance->crtDepthLimit < 1)
+            instance->crtDepthLimit = 1;
+        reserveGammaPowers(instance);
     }
 
+    if(nbEvaluations != NULL)
+        *nbEvaluations = instance->crtNbEvaluations - initialNbEvaluations;
+
     memcpy(optimalAction, instance->crtOptimalAction, sizeof(double) * NUMBER_OF_DIMENSIONS_OF_ACTION);
     return optimalAction;
 
 }
 
 
+double* random_search_planning(random_search_instance* instance, unsigned int maxNbEvaluations) {
+
+    return planUntil(instance, maxNbEvaluations, NULL, NULL);
+
+}
+
+
+/* Stop after timeBudget seconds if maxNbEvaluations is not reached before.
+   nbEvaluations receives the number of evaluations done by this call. */
+double* random_search_planningWithDeadline(random_search_instance* instance, unsigned int maxNbEvaluations, double timeBudget, unsigned int* nbEvaluations) {
+
+    deadline budget;
+    deadline_start(&budget, timeBudget);
+
+    return planUntil(instance, maxNbEvaluations, &budget, nbEvaluations);
+
+}
+
+
 unsigned int random_search_getMaxDepth(random_search_instance* instance) {
 
     return instance->crtMaxDepth - 1;
@@ -170,10 +384,64 @@ unsigned int random_search_getMaxDepth(random_search_instance* instance) {
 }
 
 
+/* Draw the trajectories on nbThreads threads, the calling one included, each
+   of them being a worker with its own stream seeded from the rng of the
+   instance. The trajectories drawn then depend on the number of threads but
+   not on the scheduling. A worker steps its trajectories together through
+   nextStateRewardBatch. 0 goes back to drawing them on the calling thread. */
+void random_search_useThreads(random_search_instance* instance, unsigned int nbThreads) {
+
+    unsigned int i = 0;
+
+    if(instance->pool != NULL) {
+        worker_pool_uninit(&instance->pool);
+        for(; i < instance->nbWorkers; i++) {
+            gsl_rng_free(instance->workers[i].rng);
+            if(instance->workers[i].states != NULL)
+                freeStateBatch(instance->workers[i].states);
+            free(instance->workers[i].firstActions);
+            free(instance->workers[i].actions);
+            free(instance->workers[i].rewards);
+            free(instance->workers[i].discountedSums);
+            free(instance->workers[i].isTerminal);
+            free(instance->workers[i].lengths);
+            free(instance->workers[i].buffer);
+        }
+        free(instance->workers);
+        instance->workers = NULL;
+        instance->nbWorkers = 0;
+    }
+
+    if(nbThreads > 0) {
+        instance->pool = worker_pool_init(nbThreads);
+        instance->nbWorkers = nbThreads;
+        instance->workers = (random_search_worker*)malloc(sizeof(random_search_worker) * nbThreads);
+        for(i = 0; i < nbThreads; i++) {
+            instance->workers[i].rng = gsl_rng_alloc(gsl_rng_mt19937);
+            instance->workers[i].states = NULL;
+            instance->workers[i].buffer = (state*)malloc(stateSize());
+            instance->workers[i].firstActions = (double*)malloc(sizeof(double) * NUMBER_OF_DIMENSIONS_OF_ACTION * RANDOM_SEARCH_NB_TRAJECTORIES_PER_BATCH);
+            instance->workers[i].actions = (double*)malloc(sizeof(double) * NUMBER_OF_DIMENSIONS_OF_ACTION * RANDOM_SEARCH_NB_TRAJECTORIES_PER_BATCH);
+            instance->workers[i].rewards = (double*)malloc(sizeof(double) * RANDOM_SEARCH_NB_TRAJECTORIES_PER_BATCH);
+            instance->workers[i].discountedSums = (double*)malloc(sizeof(double) * RANDOM_SEARCH_NB_TRAJECTORIES_PER_BATCH);
+            instance->workers[i].isTerminal = (char*)malloc(sizeof(char) * RANDOM_SEARCH_NB_TRAJECTORIES_PER_BATCH);
+            instance->workers[i].lengths = (unsigned int*)malloc(sizeof(unsigned int) * RANDOM_SEARCH_NB_TRAJECTORIES_PER_BATCH);
+        }
+        if(instance->rng != NULL)
+            seedWorkers(instance);
+    }
+
+}
+
+
 void random_search_uninitInstance(random_search_instance** instance) {
 
+    random_search_useThreads(*instance, 0);
     gsl_rng_free((*instance)->rng);
+    discount_powers_release(&(*instance)->discountPowers);
     freeState((*instance)->initial);
+    free((*instance)->buffers[0]);
+    free((*instance)->buffers[1]);
 
     free(*instance);
     *instance = NULL;
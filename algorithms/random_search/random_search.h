@@ -41,20 +41,43 @@
 #endif
 
 #include "../../problems/generative_model.h"
+#include "../deadline/deadline.h"
+#include "../discount_powers/discount_powers.h"
+#include "../worker_pool/worker_pool.h"
 
-#ifdef LIMITED_DEPTH
-#define RANDOM_SEARCH_MAX_DEPTH 512
-#else
-#define RANDOM_SEARCH_MAX_DEPTH 32768
-#endif
+#define RANDOM_SEARCH_ROUND_DIVISOR 16                  /* A round on the threads adds about 1/this of the evaluations already done, the depth limit being updated between rounds */
+#define RANDOM_SEARCH_NB_TRAJECTORIES_PER_BATCH 16      /* A worker draws up to this many trajectories in lockstep through nextStateRewardBatch */
+
+/* The trajectories drawn by one thread during a round */
+typedef struct {
+
+    gsl_rng* rng;                                       /* Seeded from the rng of the instance, its stream only depends on the index of the worker */
+    state_batch* states;                                /* The trajectories being drawn, RANDOM_SEARCH_NB_TRAJECTORIES_PER_BATCH at most, NULL before the first round */
+    double* firstActions;                               /* The first action of each trajectory */
+    double* actions;                                    /* The actions of the current step, one per trajectory */
+    double* rewards;
+    double* discountedSums;
+    char* isTerminal;
+    unsigned int* lengths;                              /* The steps taken by each trajectory */
+    state* buffer;                                      /* Moves a state from a place of the batch to another */
+    unsigned int nbEvaluations;                         /* The evaluations done during the round */
+    double optimalValue;                                /* The best discounted sum found during the round */
+    double optimalAction[NUMBER_OF_DIMENSIONS_OF_ACTION];
+
+}       random_search_worker;
 
 typedef struct {
 
+    model_context* context;                             /* The parameters of the model to plan for */
     state* initial;
+    state* buffers[2];                                  /* State buffers used alternately along a trajectory */
     double gamma;
-    double gammaPowers[RANDOM_SEARCH_MAX_DEPTH];
+    discount_powers* discountPowers;                    /* The powers of the discount factor, shared with the instances using the same one */
+    double* gammaPowers;                                /* Read from discountPowers */
+    unsigned int nbGammaPowers;                         /* The number of powers in gammaPowers, grown with crtDepthLimit */
 
     gsl_rng* rng;
+    unsigned long seed;                                 /* The seed given to random_search_setSeed, 0 to seed rng from the clock at each reset */
     unsigned int crtMaxDepth;
 
     unsigned int crtDepthLimit;
@@ -62,13 +85,21 @@ typedef struct {
     double crtOptimalValue;
     double crtOptimalAction[NUMBER_OF_DIMENSIONS_OF_ACTION];
 
+    worker_pool* pool;                                  /* NULL to draw the trajectories on the calling thread */
+    random_search_worker* workers;
+    unsigned int nbWorkers;
+    unsigned int nbEvaluationsPerWorker;                /* The evaluations each worker does during the current round */
+
 }       random_search_instance;
 
 extern unsigned int (*h_max)(random_search_instance*);
 
-random_search_instance* random_search_initInstance(state* initial, double discountFactor);
+random_search_instance* random_search_initInstance(model_context* context, state* initial, double discountFactor);
 void random_search_resetInstance(random_search_instance* instance, state* initial);
+void random_search_setSeed(random_search_instance* instance, unsigned long seed);
 double* random_search_planning(random_search_instance* instance, unsigned int maxNbEvaluations);
+double* random_search_planningWithDeadline(random_search_instance* instance, unsigned int maxNbEvaluations, double timeBudget, unsigned int* nbEvaluations);
+void random_search_useThreads(random_search_instance* instance, unsigned int nbThreads);
 void random_search_keepSubtree(random_search_instance* instance);
 unsigned int random_search_getMaxDepth(random_search_instance* instance);
 void random_search_uninitInstance(random_search_instance** instance);
@@ -33,12 +33,31 @@
  */
 
 #include "direct.h"
+#include "../box_geometry/box_geometry.h"
 #include <stdlib.h>
 #include <math.h>
 #include <string.h>
 
+/*l^2 diameters of the boxes by level and stage, shared by every instance*/
+static double boxSizes[BOX_GEOMETRY_NB_LEVELS][NUMBER_OF_DIMENSIONS_OF_ACTION];
+static char boxSizesComputed = 0;
+
+static double computeBoxSize(unsigned int level, unsigned int stage) {
+    return (sqrt(NUMBER_OF_DIMENSIONS_OF_ACTION - ((8.0 * stage ) / 9.0 )) / box_geometry_getPowerOfThree(level)) / 2.0;  /*l^2 diameter*/
+}
+
 double getBoxSize(unsigned int level, unsigned int stage) {
-    return (sqrt(NUMBER_OF_DIMENSIONS_OF_ACTION - ((8.0 * stage ) / 9.0 )) / pow(3, level)) / 2.0;  /*l^2 diameter*/
+    if(level < BOX_GEOMETRY_NB_LEVELS)
+        return boxSizes[level][stage];
+
+    return computeBoxSize(level, stage);
+}
+
+
+/*Slope between a group and a smaller one as used in eq. 2.29 of Lemma 2.4 of Gablonsky's Thesis*/
+
+static double getSlope(group* larger, group* smaller) {
+    return (smaller->boxes->value - larger->boxes->value) / (larger->boxesSize - smaller->boxesSize);
 }
 
 
@@ -46,10 +65,8 @@ double getBoxSize(unsigned int level, unsigned int stage) {
 
 void identifyPOGroups(direct_algo* instance) {
 
-    group* crt     = instance->groupsList->next;
-    group* crtPrev = instance->groupsList;
-    group* crtNext = NULL;
-    group* crtLastPOGroup = NULL;
+    group* crt = instance->groupsList->next;
+    group* top = instance->groupsList;
 
     if(instance->pOGroups != NULL)
         return;
@@ -57,74 +74,43 @@ void identifyPOGroups(direct_algo* instance) {
     /*The biggest box with with the biggest value of his group is potentially optimal*/
     instance->pOGroups = instance->groupsList;
     instance->pOGroups->nextPOGroup = NULL;
+    instance->pOGroups->prevOnHull = NULL;
     instance->crtMaxPOGroup = instance->pOGroups->boxes->value;
-    crtLastPOGroup = instance->pOGroups;
 
     /*If there isn't more than one box*/
     if(crt == NULL)
         return;
 
+    /*The groups being ordered by descending size, the upper hull is built in one pass: a group
+      below the segment joining its neighbours on the hull cannot verify eq. 2.29. Once a group
+      is pushed, the slope to the group below it is the high limit of eq. 2.29 for it. The
+      smallest group stays on top and has no low limit.*/
     while(crt != NULL) {
-        double hl;
-        double ll;
-
-        /*Evaluating the high limit of eq. 2.29 of Lemma 2.4 of Gablonsky's Thesis*/
-        hl = (crt->boxes->value - crtPrev->boxes->value) / (crtPrev->boxesSize - crt->boxesSize);
-
-        crtPrev = crtPrev->prev;
-        while(crtPrev != NULL) {
-            double l = (crt->boxes->value - crtPrev->boxes->value) / (crtPrev->boxesSize - crt->boxesSize);
-
-            if(l < hl)
-                hl = l;
-
-            crtPrev = crtPrev->prev;
-        }
+        while((top->prevOnHull != NULL) && (getSlope(top, crt) > getSlope(top->prevOnHull, top)))
+            top = top->prevOnHull;
 
-        /*Evaluating the low limit of eq. 2.29 of Lemma 2.4 of Gablonsky's Thesis*/
-        crtNext = crt->next;
-
-        if(crtNext != NULL) {
-            ll = (crtNext->boxes->value - crt->boxes->value) / (crt->boxesSize - crtNext->boxesSize);
-            crtNext = crtNext->next;
-
-            while(crtNext != NULL) {
-                double l = (crtNext->boxes->value - crt->boxes->value) / (crt->boxesSize - crtNext->boxesSize);
+        crt->prevOnHull = top;
+        top = crt;
+        crt = crt->next;
+    }
 
-                if(l > ll) {
-                    ll = l;
-                }
+    /*Going down the hull, the potentially optimal groups are inserted after the biggest one in
+      descending size order*/
+    for(crt = top; crt->prevOnHull != NULL; crt = crt->prevOnHull) {
+        double hl = getSlope(crt->prevOnHull, crt);
 
-                crtNext = crtNext->next;
-            }
+        if(instance->crtMax != 0) {
+            /*Verify eq. 2.30 of Lemma 2.4 of Gablonsky's Thesis*/
+            if((instance->epsilon * fabs(instance->crtMax)) > ((crt->boxes->value - instance->crtMax) + (crt->boxesSize * hl)))
+                continue;
         } else {
-            ll = hl;
-        }
-
-        /*Verify eq. 2.29 of Lemma 2.4 of Gablonsky's Thesis*/
-
-        if(ll <= hl) {
-
-            if(instance->crtMax != 0) {
-                /*Verify eq. 2.30 of Lemma 2.4 of Gablonsky's Thesis*/
-                if((instance->epsilon * fabs(instance->crtMax)) <= ((crt->boxes->value - instance->crtMax) + (crt->boxesSize * hl))) {
-                    crtLastPOGroup->nextPOGroup = crt;
-                    crt->nextPOGroup = NULL;
-                    crtLastPOGroup = crt;
-                }
-            } else {
-                /*Verify eq. 2.31 of Lemma 2.4 of Gablonsky's Thesis*/
-                if(crt->boxes->value <= (crt->boxesSize * hl)) {
-                    crtLastPOGroup->nextPOGroup = crt;
-                    crt->nextPOGroup = NULL;
-                    crtLastPOGroup = crt;
-                }
-            }
+            /*Verify eq. 2.31 of Lemma 2.4 of Gablonsky's Thesis*/
+            if(crt->boxes->value > (crt->boxesSize * hl))
+                continue;
         }
 
-        crtPrev = crt;
-        crt = crt->next;
-
+        crt->nextPOGroup = instance->pOGroups->nextPOGroup;
+        instance->pOGroups->nextPOGroup = crt;
     }
 
 }
@@ -177,7 +163,7 @@ void dividePOBoxes(direct_algo* instance) {
     group* crtGroup   = modifiedGroup->next;
     group* prevGroup  = modifiedGroup;
 
-    double shift     = 1.0 / pow(3, crt->level + 1);
+    double shift     = box_geometry_getShift(crt->level);
     unsigned int dimensionToDivide = crt->stage++;
     double boxSize = 0.0;
 
@@ -299,6 +285,15 @@ direct_algo* direct_algo_init() {
 
     direct_algo* newInstance = (direct_algo*)malloc(sizeof(direct_algo));
 
+    if(!boxSizesComputed) {
+        unsigned int level = 0;
+        for(; level < BOX_GEOMETRY_NB_LEVELS; level++)
+            for(i = 0; i < NUMBER_OF_DIMENSIONS_OF_ACTION; i++)
+                boxSizes[level][i] = computeBoxSize(level, i);
+        boxSizesComputed = 1;
+        i = 0;
+    }
+
     newInstance->groupsList = (group*)malloc(sizeof(group));
     newInstance->groupsList->boxesSize = getBoxSize(0, 0);
     newInstance->groupsList->boxes = (box*)malloc(sizeof(box));
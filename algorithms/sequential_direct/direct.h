@@ -51,6 +51,7 @@ typedef struct group_rec {
     struct group_rec* next;         /* Next group. */
     struct group_rec* prev;         /* Previous group. */
     struct group_rec* nextPOGroup;  /* Next potentialy optimal group. */
+    struct group_rec* prevOnHull;   /* Previous group on the upper hull of (boxes size, best value) while identifying the potentialy optimal groups. */
 }   group;
 
 typedef struct {
@@ -43,14 +43,29 @@
     #include "../../problems/viewer.h"
 #endif
 
+#ifdef USE_REGISTRY
+    #if defined(USE_SDL)
+        #error "The viewers are not available through the problem registry"
+    #endif
+    #include "../../problems/registry.h"
+#endif
+
 #include "sequential_direct.h"
 
 int main(int argc, char* argv[]) {
 
+    model_context* context = NULL;
+#ifdef USE_REGISTRY
+    problem* selectedProblem = NULL;
+#endif
     double discountFactor;
     unsigned int maxNbEvaluations;
     char isTerminal = 0;
     char dropTerminal = 1;
+    char isReused = 0;
+    char hasDeadline = 0;
+    double timeBudget = 0.0;
+    unsigned int nbEvaluations = 0;
     int nbTimestep = -1;
     unsigned int H = 1;
 
@@ -76,30 +91,40 @@ int main(int argc, char* argv[]) {
     struct arg_str* i = arg_str0(NULL, "state", "<s>", "The initial state to use");
     struct arg_int* h = arg_int1("h", NULL, "<n>", "The length of each path");
     struct arg_lit* t = arg_lit0(NULL,"dropterminal", "Stop the sequence if a terminal is encountered");
+    struct arg_lit* u = arg_lit0(NULL, "reuse", "Keep the optimization of the following actions for the next step");
+    struct arg_dbl* b = arg_dbl0(NULL, "deadline", "<d>", "The time budget in seconds of each step, the number of evaluations being then an upper bound");
 
 #ifdef USE_SDL
     struct arg_lit* d = arg_lit0("d", NULL, "Display the viewer");
     struct arg_lit* v = arg_lit0("v", NULL, "Verbose");
     struct arg_str* r = arg_str0(NULL, "resolution", "<s>", "The resolution of the display window");
     struct arg_lit* f = arg_lit0("f", NULL, "Fullscreen");
-    void* argtable[11];
-    int nbArgs = 10;
+    void* argtable[13];
+    int nbArgs = 12;
+#elif defined(USE_REGISTRY)
+    struct arg_str* p = arg_str1("p", "problem", "<s>", "The problem to solve");
+    void* argtable[10];
+    int nbArgs = 9;
 #else
-    void*argtable[6];
-    int nbArgs = 5;
+    void* argtable[9];
+    int nbArgs = 8;
 #endif
     struct arg_end* end = arg_end(nbArgs+1);
     int nerrors = 0;
 
     s->ival[0] = -1;
 
-    argtable[0] = g; argtable[1] = n; argtable[2] = s; argtable[3] = i; argtable[4] = h; argtable[5] = t;
+    argtable[0] = g; argtable[1] = n; argtable[2] = s; argtable[3] = i; argtable[4] = h; argtable[5] = t; argtable[6] = u; argtable[7] = b;
 
 #ifdef USE_SDL
-    argtable[6] = d;
-    argtable[7] = v;
-    argtable[8] = r;
-    argtable[9] = f;
+    argtable[8] = d;
+    argtable[9] = v;
+    argtable[10] = r;
+    argtable[11] = f;
+#endif
+
+#ifdef USE_REGISTRY
+    argtable[8] = p;
 #endif
 
     argtable[nbArgs] = end;
@@ -124,14 +149,28 @@ int main(int argc, char* argv[]) {
     maxNbEvaluations = n->ival[0];
     H = h->ival[0];
 
+#ifdef USE_REGISTRY
+    selectedProblem = selectProblem(p->sval[0]);
+    if(selectedProblem == NULL || selectedProblem->actionDimension != NUMBER_OF_DIMENSIONS_OF_ACTION) {
+        printf("error: the problem has to be one of those with an action dimension of %u:\n", NUMBER_OF_DIMENSIONS_OF_ACTION);
+        printProblems();
+        arg_freetable(argtable, nbArgs+1);
+        return EXIT_FAILURE;
+    }
+#endif
+
     initGenerativeModelParameters();
     initGenerativeModel();
+    context = initModelContext();
     if(i->count)
-        crtState = makeState(i->sval[0]);
+        crtState = makeStateWithContext(context, i->sval[0]);
     else
-        crtState = initState();
+        crtState = initStateWithContext(context);
     nbTimestep = s->ival[0];
     dropTerminal = t->count;
+    isReused = u->count;
+    hasDeadline = b->count;
+    timeBudget = b->count ? b->dval[0] : 0.0;
 
 #ifdef USE_SDL
     if(r->count)
@@ -155,20 +194,31 @@ int main(int argc, char* argv[]) {
     do {
         free(optimalAction);
 
-        if(instance != NULL)
+        if(instance == NULL)
+            instance = sequential_direct_initInstance(context, crtState, discountFactor, H, dropTerminal);
+        else if(isReused)
+            sequential_direct_rebaseInstance(instance, crtState);
+        else {
             sequential_direct_uninitInstance(&instance);
-        instance = sequential_direct_initInstance(crtState, discountFactor, H, dropTerminal);
+            instance = sequential_direct_initInstance(context, crtState, discountFactor, H, dropTerminal);
+        }
 
-        optimalAction = sequential_direct_planning(instance, maxNbEvaluations);
+        if(hasDeadline)
+            optimalAction = sequential_direct_planningWithDeadline(instance, maxNbEvaluations, timeBudget, &nbEvaluations);
+        else
+            optimalAction = sequential_direct_planning(instance, maxNbEvaluations);
 
-        isTerminal = nextStateReward(crtState, optimalAction, &nextState, &reward);
+        isTerminal = nextStateRewardWithContext(context, crtState, optimalAction, &nextState, &reward);
         freeState(crtState);
         crtState = nextState;
 
         if(verbose) {
             printState(crtState);
             printAction(optimalAction);
-            printf("reward: %f\n", reward);
+            if(hasDeadline)
+                printf("reward: %f evaluations: %u\n", reward, nbEvaluations);
+            else
+                printf("reward: %f\n", reward);
         }
 #ifdef USE_SDL
     } while(!isTerminal && (nbTimestep < 0 || --nbTimestep) && (!isDisplayed || !viewer(crtState, optimalAction, reward, instance)));
@@ -181,9 +231,14 @@ int main(int argc, char* argv[]) {
 
     sequential_direct_uninitInstance(&instance);
 
+    freeModelContext(context);
     freeGenerativeModel();
     freeGenerativeModelParameters();
 
+#ifdef USE_REGISTRY
+    freeProblems();
+#endif
+
     return EXIT_SUCCESS;
 
 }
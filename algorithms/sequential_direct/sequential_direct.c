@@ -46,13 +46,16 @@
 #include "direct.h"
 
 
-sequential_direct_instance* sequential_direct_initInstance(state* initial, double gamma, unsigned int H, char dropTerminal) {
+sequential_direct_instance* sequential_direct_initInstance(model_context* context, state* initial, double gamma, unsigned int H, char dropTerminal) {
 
     unsigned int i = 0;
     sequential_direct_instance* newInstance = (sequential_direct_instance*)malloc(sizeof(sequential_direct_instance));
+    newInstance->context = context;
     newInstance->H = H;
     newInstance->dropTerminal = dropTerminal;
     newInstance->initial = copyState(initial);
+    newInstance->buffers[0] = (state*)malloc(stateSize());
+    newInstance->buffers[1] = (state*)malloc(stateSize());
     newInstance->instances = (direct_algo**)malloc(sizeof(direct_algo*) * H);
     for(;i < H; i++)
         newInstance->instances[i] = direct_algo_init();
@@ -70,23 +73,24 @@ sequential_direct_instance* sequential_direct_initInstance(state* initial, doubl
 static void buildTrajectory(sequential_direct_instance* instance) {
 
     unsigned int i = 1;
-    state* crtState = NULL;
+    state* crtState = instance->buffers[0];
+    state* nextState = instance->buffers[1];
     double q = 0;
     double* action = direct_algo_getAnAction(instance->instances[0]);
     double* firstAction = action;
-    char isTerminal = nextStateReward(instance->initial, action, &crtState, instance->rewards) < 0 ? 1 : 0;
+    char isTerminal = nextStateRewardIntoWithContext(instance->context, instance->initial, action, crtState, instance->rewards) < 0 ? 1 : 0;
     instance->crtNbEvaluations++;
 
     while((i < instance->H) && !(instance->dropTerminal && isTerminal)) {
-        state* nextState = NULL;
+        state* tmp = NULL;
         action = direct_algo_getAnAction(instance->instances[i]);
-        isTerminal = nextStateReward(crtState, action, &nextState, instance->rewards + i) < 0 ? 1 : 0;
+        isTerminal = nextStateRewardIntoWithContext(instance->context, crtState, action, nextState, instance->rewards + i) < 0 ? 1 : 0;
         instance->crtNbEvaluations++;
-        freeState(crtState);
+        tmp = crtState;
         crtState = nextState;
+        nextState = tmp;
         i++;
     }
-    freeState(crtState);
 
     for(; i > 0; i--) {
         q = instance->rewards[i-1] + (instance->gamma * q);
@@ -100,19 +104,60 @@ static void buildTrajectory(sequential_direct_instance* instance) {
 }
 
 
-double* sequential_direct_planning(sequential_direct_instance* instance, unsigned int maxNbEvaluations) {
+static double* planUntil(sequential_direct_instance* instance, unsigned int maxNbEvaluations, deadline* budget, unsigned int* nbEvaluations) {
 
     double* optimalAction = (double*)malloc(sizeof(double) * NUMBER_OF_DIMENSIONS_OF_ACTION);
+    unsigned int initialNbEvaluations = instance->crtNbEvaluations;
 
-    while(instance->crtNbEvaluations < maxNbEvaluations)
+    while((instance->crtNbEvaluations < maxNbEvaluations) && ((budget == NULL) || !deadline_isOver(budget, instance->crtNbEvaluations)))
         buildTrajectory(instance);
 
+    if(nbEvaluations != NULL)
+        *nbEvaluations = instance->crtNbEvaluations - initialNbEvaluations;
+
     memcpy(optimalAction, instance->crtOptimalAction, sizeof(double) * NUMBER_OF_DIMENSIONS_OF_ACTION);
     return optimalAction;
 
 }
 
 
+double* sequential_direct_planning(sequential_direct_instance* instance, unsigned int maxNbEvaluations) {
+
+    return planUntil(instance, maxNbEvaluations, NULL, NULL);
+
+}
+
+
+/* Stop after timeBudget seconds if maxNbEvaluations is not reached before.
+   nbEvaluations receives the number of evaluations done by this call. */
+double* sequential_direct_planningWithDeadline(sequential_direct_instance* instance, unsigned int maxNbEvaluations, double timeBudget, unsigned int* nbEvaluations) {
+
+    deadline budget;
+    deadline_start(&budget, timeBudget);
+
+    return planUntil(instance, maxNbEvaluations, &budget, nbEvaluations);
+
+}
+
+
+/* Move the instance one step forward: the optimization of the first action
+   is dropped, each following one now optimizes the action before it and a
+   fresh one is appended. initial is the state reached by the executed action. */
+void sequential_direct_rebaseInstance(sequential_direct_instance* instance, state* initial) {
+
+    unsigned int i = 0;
+    direct_algo_uninit(instance->instances);
+    memmove(instance->instances, instance->instances + 1, sizeof(direct_algo*) * (instance->H - 1));
+    instance->instances[instance->H - 1] = direct_algo_init();
+    memcpy(instance->initial, initial, stateSize());
+    for(; i < NUMBER_OF_DIMENSIONS_OF_ACTION; i++)
+        instance->crtOptimalAction[i] = 0.5;
+    instance->crtMaxSumOfDiscountedRewards = 0.0;
+    instance->crtNbEvaluations = 0;
+
+}
+
+
 void sequential_direct_uninitInstance(sequential_direct_instance** instance) {
 
     unsigned int i = 0;
@@ -120,6 +165,8 @@ void sequential_direct_uninitInstance(sequential_direct_instance** instance) {
         direct_algo_uninit((*instance)->instances+i);
     free((*instance)->instances);
     freeState((*instance)->initial);
+    free((*instance)->buffers[0]);
+    free((*instance)->buffers[1]);
     free((*instance)->rewards);
     free((*instance));
     *instance = NULL;
@@ -41,12 +41,15 @@
 
 #include "direct.h"
 #include "../../problems/generative_model.h"
+#include "../deadline/deadline.h"
 
 typedef struct {
+    model_context* context;
     direct_algo** instances;
     unsigned int H;
     char dropTerminal;
     state* initial;
+    state* buffers[2];
     double gamma;
     double* rewards;
     unsigned int crtNbEvaluations;
@@ -54,8 +57,10 @@ typedef struct {
     double crtMaxSumOfDiscountedRewards;
 }   sequential_direct_instance;
 
-sequential_direct_instance* sequential_direct_initInstance(state* initial, double gamma, unsigned int H, char dropTerminal);
+sequential_direct_instance* sequential_direct_initInstance(model_context* context, state* initial, double gamma, unsigned int H, char dropTerminal);
 double* sequential_direct_planning(sequential_direct_instance* instance, unsigned int maxNbEvaluations);
+double* sequential_direct_planningWithDeadline(sequential_direct_instance* instance, unsigned int maxNbEvaluations, double timeBudget, unsigned int* nbEvaluations);
+void sequential_direct_rebaseInstance(sequential_direct_instance* instance, state* initial);
 void sequential_direct_uninitInstance(sequential_direct_instance** instance);
 
 #ifdef USE_SDL
@@ -52,12 +52,15 @@ static unsigned int hMax_default(unsigned int n) {
 
 unsigned int (*hMax)(unsigned int) = hMax_default;
 
-sequential_soo_instance* sequential_soo_initInstance(state* initial, double gamma, unsigned int H, char dropTerminal) {
+sequential_soo_instance* sequential_soo_initInstance(model_context* context, state* initial, double gamma, unsigned int H, char dropTerminal) {
 
     unsigned int i = 0;
     sequential_soo_instance* newInstance = (sequential_soo_instance*)malloc(sizeof(sequential_soo_instance));
+    newInstance->context = context;
     newInstance->H = H;
     newInstance->initial = copyState(initial);
+    newInstance->buffers[0] = (state*)malloc(stateSize());
+    newInstance->buffers[1] = (state*)malloc(stateSize());
     newInstance->instances = (soo**)malloc(sizeof(soo*) * H);
     for(;i < H; i++)
         newInstance->instances[i] = soo_init(hMax);
@@ -68,6 +71,13 @@ sequential_soo_instance* sequential_soo_initInstance(state* initial, double gamm
     newInstance->rewards = (double*)malloc(sizeof(double) * H);
     newInstance->crtNbEvaluations = 0;
     newInstance->dropTerminal = dropTerminal;
+    newInstance->pool = NULL;
+    newInstance->nbTrajectoriesPerBatch = 0;
+    newInstance->trajectories = NULL;
+    newInstance->groups = NULL;
+    newInstance->nbGroups = 0;
+    newInstance->crtNbTrajectories = 0;
+    newInstance->crtNbTrajectoriesPerGroup = 0;
     return newInstance;
 
 }
@@ -76,23 +86,24 @@ sequential_soo_instance* sequential_soo_initInstance(state* initial, double gamm
 static void buildTrajectory(sequential_soo_instance* instance) {
 
     unsigned int i = 1;
-    state* crtState = NULL;
+    state* crtState = instance->buffers[0];
+    state* nextState = instance->buffers[1];
     double q = 0;
     double* action = soo_getAnAction(instance->instances[0]);
     double* firstAction = action;
-    char isTerminal = nextStateReward(instance->initial, action, &crtState, instance->rewards) < 0 ? 1 : 0;
+    char isTerminal = nextStateRewardIntoWithContext(instance->context, instance->initial, action, crtState, instance->rewards) < 0 ? 1 : 0;
     instance->crtNbEvaluations++;
 
     while((i < instance->H) && !(instance->dropTerminal && isTerminal)) {
-        state* nextState = NULL;
+        state* tmp = NULL;
         action = soo_getAnAction(instance->instances[i]);
-        isTerminal = nextStateReward(crtState, action, &nextState, instance->rewards + i) < 0 ? 1 : 0;
+        isTerminal = nextStateRewardIntoWithContext(instance->context, crtState, action, nextState, instance->rewards + i) < 0 ? 1 : 0;
         instance->crtNbEvaluations++;
-        freeState(crtState);
+        tmp = crtState;
         crtState = nextState;
+        nextState = tmp;
         i++;
     }
-    freeState(crtState);
 
     for(; i > 0; i--) {
         q = instance->rewards[i-1] + (instance->gamma * q);
@@ -106,12 +117,121 @@ static void buildTrajectory(sequential_soo_instance* instance) {
 }
 
 
-double* sequential_soo_planning(sequential_soo_instance* instance, unsigned int maxNbEvaluations) {
+/* Simulate the steps of a group of trajectories of the batch in lockstep,
+   the actions being given. A trajectory stopped at a dropped terminal state
+   keeps being stepped along with the others, its results being ignored. */
+static void buildTrajectoriesTask(void* data, unsigned int index) {
+
+    sequential_soo_instance* instance = (sequential_soo_instance*)data;
+    sequential_soo_group* group = instance->groups + index;
+    sequential_soo_trajectory* trajectories = instance->trajectories + (index * instance->crtNbTrajectoriesPerGroup);
+    unsigned int nbTrajectories = instance->crtNbTrajectories - (index * instance->crtNbTrajectoriesPerGroup);
+    unsigned int nbRunning = 0;
+    unsigned int i = 0;
+    unsigned int j = 0;
+
+    if(nbTrajectories > instance->crtNbTrajectoriesPerGroup)
+        nbTrajectories = instance->crtNbTrajectoriesPerGroup;
+
+    for(j = 0; j < nbTrajectories; j++) {
+        setStateOfBatch(group->states, j, instance->initial);
+        trajectories[j].length = instance->H;
+    }
+
+    for(nbRunning = nbTrajectories; (i < instance->H) && (nbRunning > 0); i++) {
+        for(j = 0; j < nbTrajectories; j++)
+            memcpy(group->actions + (j * NUMBER_OF_DIMENSIONS_OF_ACTION), trajectories[j].actions[i], sizeof(double) * NUMBER_OF_DIMENSIONS_OF_ACTION);
+
+        nextStateRewardBatchWithContext(instance->context, group->states, nbTrajectories, group->actions, group->rewards, group->isTerminal);
+
+        for(j = 0; j < nbTrajectories; j++) {
+            if(i < trajectories[j].length) {
+                trajectories[j].rewards[i] = group->rewards[j];
+                if(instance->dropTerminal && (group->isTerminal[j] < 0)) {
+                    trajectories[j].length = i + 1;
+                    nbRunning--;
+                }
+            }
+        }
+    }
+
+}
+
+
+/* Draw the actions of up to nbTrajectories trajectories, each optimization
+   handing out its next actions, simulate them on the threads and give the
+   values back in the order the actions were drawn. The batch is cut short if
+   an optimization has no action left before it gets values. The trajectories
+   are split evenly into consecutive groups, one per thread. */
+static void buildTrajectories(sequential_soo_instance* instance, unsigned int nbTrajectories) {
+
+    unsigned int i = 0;
+    unsigned int j = 0;
+    unsigned int nbDrawn = 0;
+
+    for(; nbDrawn < nbTrajectories; nbDrawn++) {
+        sequential_soo_trajectory* trajectory = instance->trajectories + nbDrawn;
+
+        for(i = 0; i < instance->H; i++) {
+            trajectory->actions[i] = soo_getAnAction(instance->instances[i]);
+            if(trajectory->actions[i] == NULL)
+                break;
+        }
+
+        if(i < instance->H) {
+            while(i > 0)
+                soo_giveBackAnAction(instance->instances[--i]);
+            break;
+        }
+    }
+
+    instance->crtNbTrajectories = nbDrawn;
+    instance->crtNbTrajectoriesPerGroup = (nbDrawn + instance->nbGroups - 1) / instance->nbGroups;
+    worker_pool_run(instance->pool, buildTrajectoriesTask, instance, (nbDrawn + instance->crtNbTrajectoriesPerGroup - 1) / instance->crtNbTrajectoriesPerGroup);
+
+    for(j = 0; j < nbDrawn; j++) {
+        sequential_soo_trajectory* trajectory = instance->trajectories + j;
+        double q = 0;
+
+        instance->crtNbEvaluations += trajectory->length;
+
+        /* The steps after a dropped terminal state were not simulated */
+        for(i = instance->H; i > trajectory->length; i--)
+            soo_skipAnAction(instance->instances[i-1]);
+
+        for(; i > 0; i--) {
+            q = trajectory->rewards[i-1] + (instance->gamma * q);
+            soo_updateValue(instance->instances[i-1], q);
+        }
+
+        if(q > instance->crtMaxSumOfDiscountedRewards) {
+            instance->crtMaxSumOfDiscountedRewards = q;
+            memcpy(instance->crtOptimalAction, trajectory->actions[0], sizeof(double) * NUMBER_OF_DIMENSIONS_OF_ACTION);
+        }
+    }
+}
+
+
+static double* planUntil(sequential_soo_instance* instance, unsigned int maxNbEvaluations, deadline* budget, unsigned int* nbEvaluations) {
 
     double* optimalAction = (double*)malloc(sizeof(double) * NUMBER_OF_DIMENSIONS_OF_ACTION);
+    unsigned int initialNbEvaluations = instance->crtNbEvaluations;
 
-    while(instance->crtNbEvaluations < maxNbEvaluations)
-        buildTrajectory(instance);
+    while((instance->crtNbEvaluations < maxNbEvaluations) && ((budget == NULL) || !deadline_isOver(budget, instance->crtNbEvaluations))) {
+        /* A trajectory needs at most H evaluations, a batch stops short of overshooting the budget by more than that */
+        unsigned int nbTrajectories = ((maxNbEvaluations - instance->crtNbEvaluations) / instance->H) + 1;
+
+        if(nbTrajectories > instance->nbTrajectoriesPerBatch)
+            nbTrajectories = instance->nbTrajectoriesPerBatch;
+
+        if((instance->pool == NULL) || (nbTrajectories <= 1))
+            buildTrajectory(instance);
+        else
+            buildTrajectories(instance, nbTrajectories);
+    }
+
+    if(nbEvaluations != NULL)
+        *nbEvaluations = instance->crtNbEvaluations - initialNbEvaluations;
 
     memcpy(optimalAction, instance->crtOptimalAction, sizeof(double) * NUMBER_OF_DIMENSIONS_OF_ACTION);
     return optimalAction;
@@ -119,13 +239,107 @@ double* sequential_soo_planning(sequential_soo_instance* instance, unsigned int
 }
 
 
+double* sequential_soo_planning(sequential_soo_instance* instance, unsigned int maxNbEvaluations) {
+
+    return planUntil(instance, maxNbEvaluations, NULL, NULL);
+
+}
+
+
+/* Stop after timeBudget seconds if maxNbEvaluations is not reached before.
+   nbEvaluations receives the number of evaluations done by this call. */
+double* sequential_soo_planningWithDeadline(sequential_soo_instance* instance, unsigned int maxNbEvaluations, double timeBudget, unsigned int* nbEvaluations) {
+
+    deadline budget;
+    deadline_start(&budget, timeBudget);
+
+    return planUntil(instance, maxNbEvaluations, &budget, nbEvaluations);
+
+}
+
+
+/* Build nbTrajectoriesPerBatch trajectories at once, simulated on nbThreads
+   threads, the calling one included. Each thread steps its trajectories
+   together through nextStateRewardBatch. 0 for either goes back to one
+   trajectory at a time on the calling thread. */
+void sequential_soo_useThreads(sequential_soo_instance* instance, unsigned int nbThreads, unsigned int nbTrajectoriesPerBatch) {
+
+    unsigned int i = 0;
+
+    if(instance->pool != NULL) {
+        worker_pool_uninit(&instance->pool);
+        for(; i < instance->nbTrajectoriesPerBatch; i++) {
+            free(instance->trajectories[i].actions);
+            free(instance->trajectories[i].rewards);
+        }
+        for(i = 0; i < instance->nbGroups; i++) {
+            freeStateBatch(instance->groups[i].states);
+            free(instance->groups[i].actions);
+            free(instance->groups[i].rewards);
+            free(instance->groups[i].isTerminal);
+        }
+        free(instance->trajectories);
+        free(instance->groups);
+        instance->trajectories = NULL;
+        instance->groups = NULL;
+        instance->nbTrajectoriesPerBatch = 0;
+        instance->nbGroups = 0;
+    }
+
+    if((nbThreads > 0) && (nbTrajectoriesPerBatch > 0)) {
+        instance->pool = worker_pool_init(nbThreads);
+        instance->nbTrajectoriesPerBatch = nbTrajectoriesPerBatch;
+        instance->trajectories = (sequential_soo_trajectory*)malloc(sizeof(sequential_soo_trajectory) * nbTrajectoriesPerBatch);
+        for(i = 0; i < nbTrajectoriesPerBatch; i++) {
+            instance->trajectories[i].actions = (double**)malloc(sizeof(double*) * instance->H);
+            instance->trajectories[i].rewards = (double*)malloc(sizeof(double) * instance->H);
+        }
+
+        /* A smaller batch is split into as many groups, none larger than these */
+        instance->nbGroups = nbThreads < nbTrajectoriesPerBatch ? nbThreads : nbTrajectoriesPerBatch;
+        instance->crtNbTrajectoriesPerGroup = (nbTrajectoriesPerBatch + instance->nbGroups - 1) / instance->nbGroups;
+        instance->groups = (sequential_soo_group*)malloc(sizeof(sequential_soo_group) * instance->nbGroups);
+        for(i = 0; i < instance->nbGroups; i++) {
+            instance->groups[i].states = initStateBatch(instance->crtNbTrajectoriesPerGroup, instance->initial);
+            instance->groups[i].actions = (double*)malloc(sizeof(double) * NUMBER_OF_DIMENSIONS_OF_ACTION * instance->crtNbTrajectoriesPerGroup);
+            instance->groups[i].rewards = (double*)malloc(sizeof(double) * instance->crtNbTrajectoriesPerGroup);
+            instance->groups[i].isTerminal = (char*)malloc(sizeof(char) * instance->crtNbTrajectoriesPerGroup);
+        }
+    }
+
+}
+
+
+/* Move the instance one step forward: the optimization of the first action
+   is dropped, each following one now optimizes the action before it and a
+   fresh one is appended. initial is the state reached by the executed action.
+   The dropped optimization is reset to become the fresh one, keeping its memory. */
+void sequential_soo_rebaseInstance(sequential_soo_instance* instance, state* initial) {
+
+    unsigned int i = 0;
+    soo* dropped = instance->instances[0];
+    memmove(instance->instances, instance->instances + 1, sizeof(soo*) * (instance->H - 1));
+    soo_reset(dropped);
+    instance->instances[instance->H - 1] = dropped;
+    memcpy(instance->initial, initial, stateSize());
+    for(; i < NUMBER_OF_DIMENSIONS_OF_ACTION; i++)
+        instance->crtOptimalAction[i] = 0.5;
+    instance->crtMaxSumOfDiscountedRewards = 0.0;
+    instance->crtNbEvaluations = 0;
+
+}
+
+
 void sequential_soo_uninitInstance(sequential_soo_instance** instance) {
 
     unsigned int i = 0;
+    sequential_soo_useThreads(*instance, 0, 0);
     for(;i < (*instance)->H; i++)
         soo_uninit((*instance)->instances+i);
     free((*instance)->instances);
     freeState((*instance)->initial);
+    free((*instance)->buffers[0]);
+    free((*instance)->buffers[1]);
     free((*instance)->rewards);
     free((*instance));
     *instance = NULL;
@@ -145,20 +359,19 @@ void sequential_soo_drawingProcedure(SDL_Surface* screen, int screenWidth, int s
 
         for(; i < H; i++) {
             soo* sooInstance = theInstance->instances[i];
-            depth* crtDepth = sooInstance->list;
-            while(crtDepth != NULL) {
-                leaf* crtLeaf = crtDepth->list;
-                /*double shift = (1.0/(2.0*pow(3.0,crtDepth->depth))) * (WIDTH_TREE - 20);*/
+            unsigned int d = sooInstance->minDepth;
+            for(; d < sooInstance->nbDepths; d++) {
+                depth* crtDepth = sooInstance->depths + d;
+                unsigned int j = 0;
+                /*double shift = (1.0/(2.0*pow(3.0,d))) * (WIDTH_TREE - 20);*/
                 double y = 10 + (i * heightShift);
                 aalineRGBA(screen, (screenWidth / 2.0) + 10, y, screenWidth - 10, y, 0, 0, 0, 255);
-                while(crtLeaf != NULL) {
-                    double x = (screenWidth / 2.0) + 10 + (crtLeaf->centerPosition[0]*((screenWidth / 2.0) - 20));
+                for(; j < crtDepth->nbLeaves; j++) {
+                    double x = (screenWidth / 2.0) + 10 + (crtDepth->heap[j]->centerPosition[0]*((screenWidth / 2.0) - 20));
                     aalineRGBA(screen, x, y + 2, x, y - 2, 0, 0, 0, 255);
                     /*aalineRGBA(screen, x - shift, y - 4, x - shift, y + 4, 0, 0, 0, 255);
                     aalineRGBA(screen, x + shift, y - 4, x + shift, y + 4, 0, 0, 0, 255);*/
-                    crtLeaf = crtLeaf->next;
                 }
-                crtDepth = crtDepth->next;
             }
         }
     }
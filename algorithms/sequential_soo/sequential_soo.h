@@ -41,22 +41,51 @@
 
 #include "soo.h"
 #include "../../problems/generative_model.h"
+#include "../deadline/deadline.h"
+#include "../worker_pool/worker_pool.h"
 
+/* A trajectory of a batch, simulated on any thread */
 typedef struct {
+    double** actions;
+    double* rewards;
+    unsigned int length;
+}   sequential_soo_trajectory;
+
+/* Consecutive trajectories of a batch, simulated in lockstep on one thread */
+typedef struct {
+    state_batch* states;
+    double* actions;            /* The actions of the current step, one per trajectory */
+    double* rewards;
+    char* isTerminal;
+}   sequential_soo_group;
+
+typedef struct {
+    model_context* context;
     soo** instances;
     unsigned int H;
     state* initial;
+    state* buffers[2];
     double gamma;
     double* rewards;
     unsigned int crtNbEvaluations;
     double crtOptimalAction[NUMBER_OF_DIMENSIONS_OF_ACTION];
     double crtMaxSumOfDiscountedRewards;
     char dropTerminal;
+    worker_pool* pool;
+    unsigned int nbTrajectoriesPerBatch;
+    sequential_soo_trajectory* trajectories;
+    sequential_soo_group* groups;   /* One per thread, as long as each has a trajectory */
+    unsigned int nbGroups;
+    unsigned int crtNbTrajectories;         /* The trajectories of the batch being simulated */
+    unsigned int crtNbTrajectoriesPerGroup;
 }   sequential_soo_instance;
 
 extern unsigned int (*hMax)(unsigned int);
-sequential_soo_instance* sequential_soo_initInstance(state* initial, double gamma, unsigned int H, char dropTerminal);
+sequential_soo_instance* sequential_soo_initInstance(model_context* context, state* initial, double gamma, unsigned int H, char dropTerminal);
 double* sequential_soo_planning(sequential_soo_instance* instance, unsigned int maxNbEvaluations);
+double* sequential_soo_planningWithDeadline(sequential_soo_instance* instance, unsigned int maxNbEvaluations, double timeBudget, unsigned int* nbEvaluations);
+void sequential_soo_useThreads(sequential_soo_instance* instance, unsigned int nbThreads, unsigned int nbTrajectoriesPerBatch);
+void sequential_soo_rebaseInstance(sequential_soo_instance* instance, state* initial);
 void sequential_soo_uninitInstance(sequential_soo_instance** instance);
 
 #ifdef USE_SDL
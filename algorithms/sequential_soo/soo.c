@@ -33,215 +33,275 @@
  */
 
 #include "soo.h"
+#include "../box_geometry/box_geometry.h"
 
 #include <stdlib.h>
 #include <string.h>
-#include <math.h>
 #include <float.h>
 
-soo* soo_init(unsigned int(*hMax)(unsigned int)) {
+/* Tell whether a leaf has to be above another in the heap of their depth */
+static char isAbove(leaf* a, leaf* b) {
+
+    return (a->value > b->value) || ((a->value == b->value) && (a->order < b->order));
+
+}
+
+
+static void pushLeaf(soo* instance, unsigned int d, leaf* newLeaf) {
+
+    depth* crtDepth = instance->depths + d;
+    unsigned int i = crtDepth->nbLeaves;
+
+    if(crtDepth->nbLeaves == crtDepth->maxNbLeaves) {
+        unsigned int maxNbLeaves = (crtDepth->maxNbLeaves == 0) ? SOO_INITIAL_NB_LEAVES : crtDepth->maxNbLeaves * 2;
+        crtDepth->heap = (leaf**)arena_realloc(instance->memory, crtDepth->heap, sizeof(leaf*) * crtDepth->maxNbLeaves, sizeof(leaf*) * maxNbLeaves);
+        crtDepth->maxNbLeaves = maxNbLeaves;
+    }
+
+    newLeaf->order = instance->nbInsertions++;
+    newLeaf->depth = d;
+    crtDepth->nbLeaves++;
+
+    if((instance->nbLeaves == 0) || (d < instance->minDepth))
+        instance->minDepth = d;
+    instance->nbLeaves++;
+
+    while((i > 0) && isAbove(newLeaf, crtDepth->heap[(i - 1) / 2])) {
+        crtDepth->heap[i] = crtDepth->heap[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    crtDepth->heap[i] = newLeaf;
+
+}
 
+
+static leaf* popLeaf(soo* instance, unsigned int d) {
+
+    depth* crtDepth = instance->depths + d;
+    leaf* top = crtDepth->heap[0];
+    leaf* last = crtDepth->heap[--crtDepth->nbLeaves];
     unsigned int i = 0;
-    soo* newInstance = (soo*)malloc(sizeof(soo));
-    newInstance->list = (depth*)malloc(sizeof(depth));
-    newInstance->list->depth = 0;
-    newInstance->list->list = NULL;
-    newInstance->list->last = NULL;
-    newInstance->list->next = NULL;
-    newInstance->list->prev = NULL;
-    newInstance->crtMax = -DBL_MAX;
-    newInstance->crtDepth = newInstance->list;
-    newInstance->crtMaxValue = -DBL_MAX;
-    newInstance->hMax = hMax;
-    newInstance->t = 0;
-    newInstance->depthToAddTheLeaves = newInstance->list;
-    newInstance->leavesToBeAdded = (leaf*)malloc(sizeof(leaf));
-    newInstance->leavesToBeAdded->value = 0.0;
+
+    instance->nbLeaves--;
+
+    while((2 * i) + 1 < crtDepth->nbLeaves) {
+        unsigned int child = (2 * i) + 1;
+        if((child + 1 < crtDepth->nbLeaves) && isAbove(crtDepth->heap[child + 1], crtDepth->heap[child]))
+            child++;
+        if(!isAbove(crtDepth->heap[child], last))
+            break;
+        crtDepth->heap[i] = crtDepth->heap[child];
+        i = child;
+    }
+    crtDepth->heap[i] = last;
+
+    return top;
+
+}
+
+
+/* The depths are grown so that d is a valid index */
+static void reserveDepths(soo* instance, unsigned int d) {
+
+    if(d >= instance->nbDepths) {
+        unsigned int nbDepths = instance->nbDepths * 2;
+        while(d >= nbDepths)
+            nbDepths *= 2;
+        instance->depths = (depth*)arena_realloc(instance->memory, instance->depths, sizeof(depth) * instance->nbDepths, sizeof(depth) * nbDepths);
+        memset(instance->depths + instance->nbDepths, 0, sizeof(depth) * (nbDepths - instance->nbDepths));
+        instance->nbDepths = nbDepths;
+    }
+
+}
+
+
+/* The leaves already evaluated or skipped are dropped from the front of the
+   queue only when it is full */
+static void queueLeaf(soo* instance, leaf* newLeaf) {
+
+    if((instance->nbLeavesToBeAdded == instance->maxNbLeavesToBeAdded) && (instance->nbLeavesAdded > 0)) {
+        instance->nbLeavesToBeAdded -= instance->nbLeavesAdded;
+        instance->nbLeavesHandedOut -= instance->nbLeavesAdded;
+        memmove(instance->leavesToBeAdded, instance->leavesToBeAdded + instance->nbLeavesAdded, sizeof(leaf*) * instance->nbLeavesToBeAdded);
+        instance->nbLeavesAdded = 0;
+    }
+
+    if(instance->nbLeavesToBeAdded == instance->maxNbLeavesToBeAdded) {
+        instance->leavesToBeAdded = (leaf**)arena_realloc(instance->memory, instance->leavesToBeAdded, sizeof(leaf*) * instance->maxNbLeavesToBeAdded, sizeof(leaf*) * instance->maxNbLeavesToBeAdded * 2);
+        instance->maxNbLeavesToBeAdded *= 2;
+    }
+
+    instance->leavesToBeAdded[instance->nbLeavesToBeAdded++] = newLeaf;
+
+}
+
+
+/* The leaves at the front of the queue which already have their value are
+   added to their depth */
+static void addEvaluatedLeaves(soo* instance) {
+
+    while((instance->nbLeavesAdded < instance->nbLeavesToBeAdded) && instance->leavesToBeAdded[instance->nbLeavesAdded]->isEvaluated) {
+        leaf* evaluatedLeaf = instance->leavesToBeAdded[instance->nbLeavesAdded++];
+        pushLeaf(instance, evaluatedLeaf->depth, evaluatedLeaf);
+    }
+
+}
+
+
+/* The best value of the deepest depth with leaves shallower than d, -DBL_MAX if none */
+static double maxOfShallowerDepth(soo* instance, unsigned int d) {
+
+    while(d > instance->minDepth) {
+        d--;
+        if(instance->depths[d].nbLeaves > 0)
+            return instance->depths[d].heap[0]->value;
+    }
+
+    return -DBL_MAX;
+
+}
+
+
+static void plantTree(soo* instance) {
+
+    unsigned int i = 0;
+    leaf* center = (leaf*)arena_alloc(instance->memory, sizeof(leaf));
+    instance->depths = (depth*)arena_alloc(instance->memory, sizeof(depth) * SOO_INITIAL_NB_DEPTHS);
+    memset(instance->depths, 0, sizeof(depth) * SOO_INITIAL_NB_DEPTHS);
+    instance->nbDepths = SOO_INITIAL_NB_DEPTHS;
+    instance->minDepth = 0;
+    instance->nbLeaves = 0;
+    instance->crtMax = -DBL_MAX;
+    instance->crtDepth = 0;
+    instance->crtMaxValue = -DBL_MAX;
+    instance->t = 0;
+    instance->nbInsertions = 0;
+    instance->leavesToBeAdded = (leaf**)arena_alloc(instance->memory, sizeof(leaf*) * SOO_INITIAL_NB_LEAVES_TO_BE_ADDED);
+    instance->nbLeavesToBeAdded = 0;
+    instance->maxNbLeavesToBeAdded = SOO_INITIAL_NB_LEAVES_TO_BE_ADDED;
+    instance->nbLeavesHandedOut = 0;
+    instance->nbLeavesAdded = 0;
+    center->value = 0.0;
+    center->depth = 0;
+    center->isEvaluated = 0;
     for(; i < NUMBER_OF_DIMENSIONS_OF_ACTION; i++) {
-        newInstance->crtMaxLeaf[i] = 0.5;
-        newInstance->leavesToBeAdded->centerPosition[i] = 0.5;
+        instance->crtMaxLeaf[i] = 0.5;
+        center->centerPosition[i] = 0.5;
     }
-    newInstance->leavesToBeAdded->next = NULL;
-    newInstance->leavesToBeAdded->prev = NULL;
+    queueLeaf(instance, center);
+
+}
+
+
+soo* soo_init(unsigned int(*hMax)(unsigned int)) {
+
+    soo* newInstance = (soo*)malloc(sizeof(soo));
+    newInstance->hMax = hMax;
+    newInstance->memory = arena_init(SOO_SLAB_SIZE);
+    plantTree(newInstance);
 
     return newInstance;
 
 }
 
 
+/* Drop the whole tree at once and start over from the center, the memory
+   already obtained being kept for the new tree. */
+void soo_reset(soo* instance) {
+
+    arena_reset(instance->memory);
+    plantTree(instance);
+
+}
+
+
+/* Hand out the next leaf to evaluate, the values being expected in the same
+   order. Once all the leaves created are handed out, a leaf is expanded: the
+   depths are swept from the current one and the best leaf of the first depth
+   beating all the depths swept before is chosen, the sweep starting over from
+   the smallest depth once hMax or the deepest leaf is passed. The expanded
+   leaf only goes one depth down along with the values of its children, so
+   that the next expansions choose among the other leaves. NULL if no leaf is
+   left to expand. */
 double* soo_getAnAction(soo* instance) {
 
-    if(instance->leavesToBeAdded == NULL) {
+    while((instance->nbLeavesHandedOut < instance->nbLeavesToBeAdded) && instance->leavesToBeAdded[instance->nbLeavesHandedOut]->isEvaluated)
+        instance->nbLeavesHandedOut++;
+
+    if(instance->nbLeavesHandedOut == instance->nbLeavesToBeAdded) {
         unsigned int hMax = instance->hMax(instance->t);
-        depth* crtDepth = instance->crtDepth;
+        unsigned int d = instance->crtDepth;
         leaf* selectedLeaf = NULL;
+        leaf* newLeaves = NULL;
         double shift = 0.0;
         unsigned int dimensionToCut = 0;
+        unsigned int i = 0;
+
+        if(instance->nbLeaves == 0)
+            return NULL;
 
-        while((crtDepth != NULL) && (crtDepth->depth <= hMax) && (crtDepth->list->value < instance->crtMax))
-            crtDepth = crtDepth->next;
+        while((d < instance->nbDepths) && (d <= hMax) && ((instance->depths[d].nbLeaves == 0) || (instance->depths[d].heap[0]->value < instance->crtMax)))
+            d++;
 
-        if((crtDepth == NULL) || (crtDepth->depth > hMax))
-            crtDepth = instance->list;
+        if((d >= instance->nbDepths) || (d > hMax))
+            d = instance->minDepth;
 
-        selectedLeaf = crtDepth->list;
-        dimensionToCut = crtDepth->depth % NUMBER_OF_DIMENSIONS_OF_ACTION;
-        shift = 1.0 / pow(3, crtDepth->depth + 1);
+        dimensionToCut = d % NUMBER_OF_DIMENSIONS_OF_ACTION;
+        shift = box_geometry_getShift(d);
 
-        if(((crtDepth->next == NULL) || (crtDepth->next->depth != (crtDepth->depth + 1))) && (crtDepth->list->next == NULL)) {
-            crtDepth->depth++;
-            instance->depthToAddTheLeaves = crtDepth;
-            instance->crtDepth = crtDepth;
-            if(crtDepth->prev != NULL)
-                instance->crtMax = crtDepth->prev->list->value;
-            else
-                instance->crtMax = -DBL_MAX;
+        reserveDepths(instance, d + 1);
+        selectedLeaf = popLeaf(instance, d);
+        selectedLeaf->depth = d + 1;
+
+        instance->crtDepth = d + 1;
+        if(instance->depths[d].nbLeaves > 0) {
+            instance->crtMax = instance->depths[d].heap[0]->value;
         } else {
-            crtDepth->list = selectedLeaf->next;
-            if(crtDepth->list != NULL)
-                crtDepth->list->prev = NULL;
-
-            if((crtDepth->next == NULL) || (crtDepth->next->depth != (crtDepth->depth + 1))) {
-                depth* newDepth = (depth*)malloc(sizeof(depth));
-                newDepth->depth = crtDepth->depth+1;
-
-                newDepth->prev = crtDepth;
-                newDepth->next = crtDepth->next;
-                crtDepth->next = newDepth;
-                if(newDepth->next != NULL)
-                    newDepth->next->prev = newDepth;
-
-                newDepth->list = selectedLeaf;
-                newDepth->last = selectedLeaf;
-                selectedLeaf->next = NULL;
-                selectedLeaf->prev = NULL;
-
-                instance->depthToAddTheLeaves = newDepth;
-                instance->crtDepth = newDepth;
-                instance->crtMax = crtDepth->list->value;
-            } else {
-                /*
-                leaf* crtLeaf = crtDepth->next->list;
-                leaf* prevLeaf = NULL;
-
-                while((crtLeaf != NULL) && (crtLeaf->value > selectedLeaf->value)) {
-                    prevLeaf = crtLeaf;
-                    crtLeaf = crtLeaf->next;
-                }
-
-                if(prevLeaf == NULL) {
-                    crtDepth->next->list = selectedLeaf;
-                    selectedLeaf->next = crtLeaf;
-                } else { 
-                    prevLeaf->next = selectedLeaf;
-                    selectedLeaf->next = crtLeaf;
-                }*/
-                leaf* crtLeaf = crtDepth->next->last;
-                leaf* nextLeaf = NULL;
-
-                while((crtLeaf != NULL) && (crtLeaf->value < selectedLeaf->value)) {
-                    nextLeaf = crtLeaf;
-                    crtLeaf = crtLeaf->prev;
-                }
-
-                if(nextLeaf == NULL)
-                    crtDepth->next->last = selectedLeaf;
-                else
-                    nextLeaf->prev = selectedLeaf;
-                selectedLeaf->next = nextLeaf;
-
-                if(crtLeaf == NULL)
-                    crtDepth->next->list = selectedLeaf;
-                else
-                    crtLeaf->next = selectedLeaf;
-                selectedLeaf->prev = crtLeaf;
-
-
-                instance->depthToAddTheLeaves = crtDepth->next;
-                instance->crtDepth = crtDepth->next;
-                if(crtDepth->list == NULL) {
-                    if(crtDepth->prev == NULL) {
-                        instance->crtMax = -DBL_MAX;
-                        instance->list = crtDepth->next;
-                        instance->list->prev = NULL;
-                    } else {
-                        instance->crtMax = crtDepth->prev->list->value;
-                        crtDepth->prev->next = crtDepth->next;
-                        crtDepth->next->prev = crtDepth->prev;
-                    }
-                    free(crtDepth);
-                } else {
-                    instance->crtMax = crtDepth->list->value;
-                }
-            }
+            instance->crtMax = maxOfShallowerDepth(instance, d);
+            if((d == instance->minDepth) && (instance->nbLeaves > 0))
+                while(instance->depths[instance->minDepth].nbLeaves == 0)
+                    instance->minDepth++;
         }
 
-        instance->leavesToBeAdded = (leaf*)malloc(sizeof(leaf));
-        instance->leavesToBeAdded->value = 0.0;
-        memcpy(instance->leavesToBeAdded->centerPosition, selectedLeaf->centerPosition, sizeof(double) * NUMBER_OF_DIMENSIONS_OF_ACTION);
-        instance->leavesToBeAdded->centerPosition[dimensionToCut] -= shift;
-        instance->leavesToBeAdded->prev = NULL;
-
-        instance->leavesToBeAdded->next = (leaf*)malloc(sizeof(leaf));
-        instance->leavesToBeAdded->next->value = 0.0;
-        memcpy(instance->leavesToBeAdded->next->centerPosition, selectedLeaf->centerPosition, sizeof(double) * NUMBER_OF_DIMENSIONS_OF_ACTION);
-        instance->leavesToBeAdded->next->centerPosition[dimensionToCut] += shift;
-        instance->leavesToBeAdded->next->next = NULL;
-        instance->leavesToBeAdded->next->prev = NULL;
+        newLeaves = (leaf*)arena_alloc(instance->memory, sizeof(leaf) * 2);
+        for(; i < 2; i++) {
+            newLeaves[i].value = 0.0;
+            newLeaves[i].depth = d + 1;
+            newLeaves[i].isEvaluated = 0;
+            memcpy(newLeaves[i].centerPosition, selectedLeaf->centerPosition, sizeof(double) * NUMBER_OF_DIMENSIONS_OF_ACTION);
+        }
+        newLeaves[0].centerPosition[dimensionToCut] -= shift;
+        newLeaves[1].centerPosition[dimensionToCut] += shift;
+        queueLeaf(instance, selectedLeaf);
+        queueLeaf(instance, newLeaves);
+        queueLeaf(instance, newLeaves + 1);
+        instance->nbLeavesHandedOut++;
 
     }
 
-    return instance->leavesToBeAdded->centerPosition; 
+    return instance->leavesToBeAdded[instance->nbLeavesHandedOut++]->centerPosition;
 
 }
 
 
 void soo_updateValue(soo* instance, double value) {
 
-    leaf* leafToAdd = instance->leavesToBeAdded;
-/*    leaf* crtLeaf = instance->depthToAddTheLeaves->list;
-    leaf* prevLeaf = NULL;
-
-    leafToAdd->value = value;
-    instance->leavesToBeAdded = leafToAdd->next;    
-    instance->t++;
-
-    while((crtLeaf != NULL) && (crtLeaf->value > leafToAdd->value)) {
-        prevLeaf = crtLeaf;
-        crtLeaf = crtLeaf->next;
-    }
+    leaf* leafToAdd = NULL;
 
-    if(prevLeaf == NULL) {
-        leafToAdd->next = instance->depthToAddTheLeaves->list;
-        instance->depthToAddTheLeaves->list = leafToAdd;
-    } else {
-        prevLeaf->next = leafToAdd;
-        leafToAdd->next = crtLeaf;
-    }
-*/
-    leaf* crtLeaf = instance->depthToAddTheLeaves->last;
-    leaf* nextLeaf = NULL;
+    addEvaluatedLeaves(instance);
 
+    leafToAdd = instance->leavesToBeAdded[instance->nbLeavesAdded++];
     leafToAdd->value = value;
-    instance->leavesToBeAdded = leafToAdd->next;
+    leafToAdd->isEvaluated = 1;
     instance->t++;
 
-    while((crtLeaf != NULL) && (crtLeaf->value < leafToAdd->value)) {
-        nextLeaf = crtLeaf;
-        crtLeaf = crtLeaf->prev;
+    if(instance->nbLeavesAdded == instance->nbLeavesToBeAdded) {
+        instance->nbLeavesToBeAdded = 0;
+        instance->nbLeavesHandedOut = 0;
+        instance->nbLeavesAdded = 0;
     }
 
-    if(nextLeaf == NULL)
-        instance->depthToAddTheLeaves->last = leafToAdd;
-    else
-        nextLeaf->prev = leafToAdd;
-    leafToAdd->next = nextLeaf;
-
-    if(crtLeaf == NULL)
-        instance->depthToAddTheLeaves->list = leafToAdd;
-    else
-        crtLeaf->next = leafToAdd;
-    leafToAdd->prev = crtLeaf;
+    pushLeaf(instance, leafToAdd->depth, leafToAdd);
 
     if(leafToAdd->value > instance->crtMaxValue) {
         instance->crtMaxValue = leafToAdd->value;
@@ -251,28 +311,28 @@ void soo_updateValue(soo* instance, double value) {
 }
 
 
-void soo_uninit(soo** instance) {
+/* The oldest leaf handed out and not evaluated yet will be handed out again
+   after the others */
+void soo_skipAnAction(soo* instance) {
 
-    depth* crtDepth = (*instance)->list;
+    addEvaluatedLeaves(instance);
+    queueLeaf(instance, instance->leavesToBeAdded[instance->nbLeavesAdded++]);
 
-    while(crtDepth != NULL) {
-        depth* nextDepth = crtDepth->next;
-        leaf* crtLeaf = crtDepth->list;
-        while(crtLeaf != NULL) {
-            leaf* nextLeaf = crtLeaf->next;
-            free(crtLeaf);
-            crtLeaf = nextLeaf;
-        }
-        free(crtDepth);
-        crtDepth = nextDepth;
-    }
+}
 
-    if((*instance)->leavesToBeAdded != NULL){
-        free((*instance)->leavesToBeAdded->next);
-        free((*instance)->leavesToBeAdded);
-    }
 
+/* The last leaf handed out will be handed out again next */
+void soo_giveBackAnAction(soo* instance) {
+
+    instance->nbLeavesHandedOut--;
+
+}
+
+
+void soo_uninit(soo** instance) {
+
+    arena_uninit(&(*instance)->memory);
     free(*instance);
     *instance = NULL;
 
-} 
+}
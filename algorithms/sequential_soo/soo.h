@@ -35,36 +35,58 @@
 #ifndef SOO_H
 #define SOO_H
 
+#include "../arena/arena.h"
+
+#define SOO_SLAB_SIZE 65536     /* Leaves and depths are taken from slabs of this size */
+#define SOO_INITIAL_NB_DEPTHS 32
+#define SOO_INITIAL_NB_LEAVES 8
+#define SOO_INITIAL_NB_LEAVES_TO_BE_ADDED 4
+
 typedef struct leaf_rec {
     double value;
     double centerPosition[NUMBER_OF_DIMENSIONS_OF_ACTION];
-    struct leaf_rec* next;
-    struct leaf_rec* prev;
+    unsigned int order;         /* Rank of insertion: among equal values, the older leaf is above */
+    unsigned int depth;         /* The depth the leaf is in, or is added to once evaluated */
+    char isEvaluated;           /* A leaf to be added is handed out only if not */
 } leaf;
 
 typedef struct depth_rec {
-    unsigned int depth;
-    leaf* list;
-    leaf* last;
-    struct depth_rec* next;
-    struct depth_rec* prev;
+    leaf** heap;                /* Max-heap of the leaves of this depth, empty if nbLeaves is 0 */
+    unsigned int nbLeaves;
+    unsigned int maxNbLeaves;
 } depth;
 
 typedef struct {
-    depth* list;
-    depth* depthToAddTheLeaves;
-    leaf* leavesToBeAdded;
-    depth* crtDepth;
+    depth* depths;              /* Indexed by depth, the depths without leaves included */
+    unsigned int nbDepths;
+    unsigned int minDepth;      /* The smallest depth with leaves, if any */
+    unsigned int nbLeaves;      /* The leaves in the depths */
+    leaf** leavesToBeAdded;     /* The leaves to be added to the depths, in the order they are handed out */
+    unsigned int nbLeavesToBeAdded;
+    unsigned int maxNbLeavesToBeAdded;
+    unsigned int nbLeavesHandedOut;
+    unsigned int nbLeavesAdded; /* The leaves of leavesToBeAdded before this one are evaluated or skipped */
+    unsigned int crtDepth;
     double crtMax;
     double crtMaxLeaf[NUMBER_OF_DIMENSIONS_OF_ACTION];
     double crtMaxValue;
     unsigned int t;
+    unsigned int nbInsertions;
     unsigned int(*hMax)(unsigned int);
+    arena* memory;              /* Holds the leaves and the depths, released at once */
 } soo;
 
+/* soo_getAnAction may hand out several actions before their values are given to
+   soo_updateValue, in the same order. The leaf it expands moves one depth down
+   only once the values of its children arrive, so the expansions in between
+   select among the other leaves. Given one action at a time, the selection is
+   the one of the original SOO. */
 soo* soo_init(unsigned int(*hMax)(unsigned int));
 double* soo_getAnAction(soo* instance);
 void soo_updateValue(soo* instance, double value);
+void soo_skipAnAction(soo* instance);
+void soo_giveBackAnAction(soo* instance);
+void soo_reset(soo* instance);
 void soo_uninit(soo** instance);
 
 #endif
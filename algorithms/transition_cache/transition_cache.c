@@ -0,0 +1,265 @@
+/* Copyright or © or Copr. 2012, Jean-François Hren
+ *
+ * Author e-mail: jean-francois.hren@inria.fr
+ *
+ * This software is a computer program whose purpose is to control
+ * deterministic systems using optimistic planning.
+ *
+ * This software is governed by the CeCILL license under French law and
+ * abiding by the rules of distribution of free software.  You can  use, 
+ * modify and/ or redistribute the software under the terms of the CeCILL
+ * license as circulated by CEA, CNRS and INRIA at the following URL
+ * "http://www.cecill.info". 
+ *
+ * As a counterpart to the access to the source code and  rights to copy,
+ * modify and redistribute granted by the license, users are provided only
+ * with a limited warranty  and the software's author,  the holder of the
+ * economic rights,  and the successive licensors  have only  limited
+ * liability. 
+ *
+ * In this respect, the user's attention is drawn to the risks associated
+ * with loading,  using,  modifying and/or developing or reproducing the
+ * software by the user in light of its specific status of free software,
+ * that may mean  that it is complicated to manipulate,  and  that  also
+ * therefore means  that it is reserved for developers  and  experienced
+ * professionals having in-depth computer knowledge. Users are therefore
+ * encouraged to load and test the software's suitability as regards their
+ * requirements in conditions enabling the security of their systems and/or 
+ * data to be ensured and,  more generally, to use and operate it in the 
+ * same conditions as regards security. 
+ *
+ * The fact that you are presently reading this means that you have had
+ * knowledge of the CeCILL license and that you accept its terms.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "transition_cache.h"
+
+#define ENTRY(cache, index) ((transition_cache_entry*)((cache)->entries + ((size_t)(index) * (cache)->entrySize)))
+#define ENTRY_ACTION(entry) ((char*)(entry) + sizeof(transition_cache_entry))
+#define ENTRY_STATE(cache, entry) (ENTRY_ACTION(entry) + (cache)->actionBytes)
+#define ENTRY_NEXT_STATE(cache, entry) (ENTRY_STATE(cache, entry) + (cache)->stateBytes)
+
+/*+------------------------------------------+
+  | Mix a word into a hash                   |
+  +------------------------------------------+*/
+
+static unsigned long long mix(unsigned long long hash, unsigned long long word) {
+
+    hash ^= word;
+    hash *= 0x9E3779B97F4A7C15ULL;
+
+    return hash ^ (hash >> 29);
+
+}
+
+
+/*+------------------------------------------+
+  | Hash the bytes of a key word by word     |
+  +------------------------------------------+*/
+
+static unsigned long long hashBytes(unsigned long long hash, const void* key, size_t size) {
+
+    const char* bytes = (const char*)key;
+    unsigned long long word = 0;
+
+    for(; size >= sizeof(word); size -= sizeof(word), bytes += sizeof(word)) {
+        memcpy(&word, bytes, sizeof(word));
+        hash = mix(hash, word);
+    }
+
+    if(size > 0) {
+        word = 0;
+        memcpy(&word, bytes, size);
+        hash = mix(hash, word);
+    }
+
+    return hash;
+
+}
+
+
+/*+------------------------------------------+
+  | Hash a state and an action               |
+  +------------------------------------------+*/
+
+static unsigned long long hashTransition(transition_cache* cache, const void* s, const double* action) {
+
+    return hashBytes(hashBytes(0xCBF29CE484222325ULL, s, cache->stateBytes), action, cache->actionBytes);
+
+}
+
+
+/*+------------------------------------------+
+  | Initialize a cache using at most about   |
+  | maxBytes bytes                           |
+  +------------------------------------------+*/
+
+transition_cache* transition_cache_init(size_t maxBytes, size_t stateBytes, unsigned int actionDimension) {
+
+    transition_cache* cache = (transition_cache*)malloc(sizeof(transition_cache));
+    size_t entrySize = sizeof(transition_cache_entry) + (sizeof(double) * actionDimension) + (2 * stateBytes);
+
+    cache->stateBytes = stateBytes;
+    cache->actionBytes = sizeof(double) * actionDimension;
+    cache->entrySize = ((entrySize + sizeof(unsigned long long) - 1) / sizeof(unsigned long long)) * sizeof(unsigned long long);
+
+    /* Each entry also costs up to two bucket heads since the number of buckets is rounded up */
+    cache->maxNbEntries = maxBytes / (cache->entrySize + (2 * sizeof(unsigned int)));
+    if(cache->maxNbEntries == 0)
+        cache->maxNbEntries = 1;
+
+    cache->nbBuckets = 1;
+    while(cache->nbBuckets < cache->maxNbEntries)
+        cache->nbBuckets <<= 1;
+
+    cache->buckets = (unsigned int*)calloc(cache->nbBuckets, sizeof(unsigned int));
+    cache->entries = (char*)malloc(cache->entrySize * cache->maxNbEntries);
+
+    cache->nbEntries = 0;
+    cache->clockHand = 0;
+
+    cache->nbHits = 0;
+    cache->nbMisses = 0;
+    cache->nbEvictions = 0;
+
+    return cache;
+
+}
+
+
+/*+------------------------------------------+
+  | Look for the transition from s with      |
+  | action. On a hit, the next state, the    |
+  | reward and the terminal flag are copied  |
+  | out and 1 is returned.                   |
+  +------------------------------------------+*/
+
+char transition_cache_lookup(transition_cache* cache, const void* s, const double* action, void* nextState, double* reward, char* isTerminal) {
+
+    unsigned long long hash = hashTransition(cache, s, action);
+    unsigned int index = cache->buckets[hash & (cache->nbBuckets - 1)];
+
+    while(index != 0) {
+        transition_cache_entry* entry = ENTRY(cache, index - 1);
+
+        if((entry->hash == hash) && (memcmp(ENTRY_ACTION(entry), action, cache->actionBytes) == 0) && (memcmp(ENTRY_STATE(cache, entry), s, cache->stateBytes) == 0)) {
+            memcpy(nextState, ENTRY_NEXT_STATE(cache, entry), cache->stateBytes);
+            *reward = entry->reward;
+            *isTerminal = entry->isTerminal;
+            entry->isReferenced = 1;
+            cache->nbHits++;
+            return 1;
+        }
+
+        index = entry->next;
+    }
+
+    cache->nbMisses++;
+
+    return 0;
+
+}
+
+
+/*+------------------------------------------+
+  | Remove an entry from its bucket          |
+  +------------------------------------------+*/
+
+static void unlinkEntry(transition_cache* cache, unsigned int index) {
+
+    transition_cache_entry* entry = ENTRY(cache, index);
+    unsigned int* link = cache->buckets + (entry->hash & (cache->nbBuckets - 1));
+
+    while(*link != index + 1)
+        link = &(ENTRY(cache, *link - 1)->next);
+
+    *link = entry->next;
+
+}
+
+
+/*+------------------------------------------+
+  | Store a transition, evicting with the    |
+  | clock algorithm once the cache is full   |
+  +------------------------------------------+*/
+
+void transition_cache_insert(transition_cache* cache, const void* s, const double* action, const void* nextState, double reward, char isTerminal) {
+
+    unsigned long long hash = hashTransition(cache, s, action);
+    unsigned int* bucket = cache->buckets + (hash & (cache->nbBuckets - 1));
+    transition_cache_entry* entry = NULL;
+    unsigned int index = 0;
+
+    if(cache->nbEntries < cache->maxNbEntries) {
+        index = cache->nbEntries++;
+    } else {
+        while(ENTRY(cache, cache->clockHand)->isReferenced) {
+            ENTRY(cache, cache->clockHand)->isReferenced = 0;
+            cache->clockHand = (cache->clockHand + 1) % cache->maxNbEntries;
+        }
+
+        index = cache->clockHand;
+        cache->clockHand = (cache->clockHand + 1) % cache->maxNbEntries;
+
+        unlinkEntry(cache, index);
+        cache->nbEvictions++;
+    }
+
+    entry = ENTRY(cache, index);
+    entry->hash = hash;
+    entry->isTerminal = isTerminal;
+    entry->isReferenced = 0;
+    entry->reward = reward;
+    memcpy(ENTRY_ACTION(entry), action, cache->actionBytes);
+    memcpy(ENTRY_STATE(cache, entry), s, cache->stateBytes);
+    memcpy(ENTRY_NEXT_STATE(cache, entry), nextState, cache->stateBytes);
+
+    entry->next = *bucket;
+    *bucket = index + 1;
+
+}
+
+
+/*+------------------------------------------+
+  | Return the ratio of lookups served from  |
+  | the cache                                |
+  +------------------------------------------+*/
+
+double transition_cache_getHitRate(transition_cache* cache) {
+
+    unsigned long nbLookups = cache->nbHits + cache->nbMisses;
+
+    return nbLookups == 0 ? 0.0 : (double)cache->nbHits / (double)nbLookups;
+
+}
+
+
+/*+------------------------------------------+
+  | Forget every transition, for instance    |
+  | when the parameters of the model change  |
+  +------------------------------------------+*/
+
+void transition_cache_clear(transition_cache* cache) {
+
+    memset(cache->buckets, 0, sizeof(unsigned int) * cache->nbBuckets);
+    cache->nbEntries = 0;
+    cache->clockHand = 0;
+
+}
+
+
+/*+------------------------------------------+
+  | Free a cache                             |
+  +------------------------------------------+*/
+
+void transition_cache_uninit(transition_cache** cache) {
+
+    free((*cache)->buckets);
+    free((*cache)->entries);
+    free(*cache);
+    *cache = NULL;
+
+}
@@ -0,0 +1,96 @@
+/* Copyright or © or Copr. 2012, Jean-François Hren
+ *
+ * Author e-mail: jean-francois.hren@inria.fr
+ *
+ * This software is a computer program whose purpose is to control
+ * deterministic systems using optimistic planning.
+ *
+ * This software is governed by the CeCILL license under French law and
+ * abiding by the rules of distribution of free software.  You can  use, 
+ * modify and/ or redistribute the software under the terms of the CeCILL
+ * license as circulated by CEA, CNRS and INRIA at the following URL
+ * "http://www.cecill.info". 
+ *
+ * As a counterpart to the access to the source code and  rights to copy,
+ * modify and redistribute granted by the license, users are provided only
+ * with a limited warranty  and the software's author,  the holder of the
+ * economic rights,  and the successive licensors  have only  limited
+ * liability. 
+ *
+ * In this respect, the user's attention is drawn to the risks associated
+ * with loading,  using,  modifying and/or developing or reproducing the
+ * software by the user in light of its specific status of free software,
+ * that may mean  that it is complicated to manipulate,  and  that  also
+ * therefore means  that it is reserved for developers  and  experienced
+ * professionals having in-depth computer knowledge. Users are therefore
+ * encouraged to load and test the software's suitability as regards their
+ * requirements in conditions enabling the security of their systems and/or 
+ * data to be ensured and,  more generally, to use and operate it in the 
+ * same conditions as regards security. 
+ *
+ * The fact that you are presently reading this means that you have had
+ * knowledge of the CeCILL license and that you accept its terms.
+ */
+
+#ifndef TRANSITION_CACHE_H
+#define TRANSITION_CACHE_H
+
+#include <stddef.h>
+
+
+/*+-------------------------------------+
+  | The header of a cached transition.  |
+  | It is followed in memory by the     |
+  | action, the state and the next      |
+  | state, all stored as raw bytes.     |
+  +-------------------------------------+*/
+
+typedef struct {
+
+    unsigned long long hash;                                /* The hash of the state and action bytes */
+    unsigned int next;                                      /* The index plus one of the next entry in the same bucket, 0 being none */
+    char isTerminal;                                        /* The value returned by the model for this transition */
+    char isReferenced;                                      /* Set on every hit, cleared by the clock hand before eviction */
+    double reward;                                          /* The reward of this transition */
+
+} transition_cache_entry;
+
+
+/*+-------------------------------------+
+  | Represents a bounded cache of the   |
+  | transitions of a deterministic      |
+  | model keyed on the exact bytes of   |
+  | the state and the action. Equal     |
+  | states only match if their padding  |
+  | is zeroed.                          |
+  +-------------------------------------+*/
+
+typedef struct {
+
+    size_t stateBytes;                                      /* The size in bytes of a state */
+    size_t actionBytes;                                     /* The size in bytes of an action */
+    size_t entrySize;                                       /* The size in bytes of an entry including its payload */
+
+    unsigned int maxNbEntries;                              /* The number of entries fitting in the memory given at initialization */
+    unsigned int nbEntries;                                 /* The number of entries currently used */
+    unsigned int clockHand;                                 /* The next entry considered for eviction */
+
+    unsigned int nbBuckets;                                 /* The number of buckets, a power of two */
+    unsigned int* buckets;                                  /* The index plus one of the first entry of each bucket, 0 being none */
+    char* entries;                                          /* The entries, maxNbEntries * entrySize bytes */
+
+    unsigned long nbHits;                                   /* Statistic about the number of lookups served from the cache */
+    unsigned long nbMisses;                                 /* Statistic about the number of lookups not found in the cache */
+    unsigned long nbEvictions;                              /* Statistic about the number of entries replaced */
+
+} transition_cache;
+
+
+transition_cache* transition_cache_init(size_t maxBytes, size_t stateBytes, unsigned int actionDimension);
+char transition_cache_lookup(transition_cache* cache, const void* s, const double* action, void* nextState, double* reward, char* isTerminal);
+void transition_cache_insert(transition_cache* cache, const void* s, const double* action, const void* nextState, double reward, char isTerminal);
+double transition_cache_getHitRate(transition_cache* cache);
+void transition_cache_clear(transition_cache* cache);
+void transition_cache_uninit(transition_cache** cache);
+
+#endif
@@ -0,0 +1,196 @@
+/* Copyright or © or Copr. 2012, Jean-François Hren
+ *
+ * Author e-mail: jean-francois.hren@inria.fr
+ *
+ * This software is a computer program whose purpose is to control
+ * deterministic systems using optimistic planning.
+ *
+ * This software is governed by the CeCILL license under French law and
+ * abiding by the rules of distribution of free software.  You can  use, 
+ * modify and/ or redistribute the software under the terms of the CeCILL
+ * license as circulated by CEA, CNRS and INRIA at the following URL
+ * "http://www.cecill.info". 
+ *
+ * As a counterpart to the access to the source code and  rights to copy,
+ * modify and redistribute granted by the license, users are provided only
+ * with a limited warranty  and the software's author,  the holder of the
+ * economic rights,  and the successive licensors  have only  limited
+ * liability. 
+ *
+ * In this respect, the user's attention is drawn to the risks associated
+ * with loading,  using,  modifying and/or developing or reproducing the
+ * software by the user in light of its specific status of free software,
+ * that may mean  that it is complicated to manipulate,  and  that  also
+ * therefore means  that it is reserved for developers  and  experienced
+ * professionals having in-depth computer knowledge. Users are therefore
+ * encouraged to load and test the software's suitability as regards their
+ * requirements in conditions enabling the security of their systems and/or 
+ * data to be ensured and,  more generally, to use and operate it in the 
+ * same conditions as regards security. 
+ *
+ * The fact that you are presently reading this means that you have had
+ * knowledge of the CeCILL license and that you accept its terms.
+ */
+
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdlib.h>
+
+#include "worker_pool.h"
+
+/*+------------------------------------------+
+  | Claim and run items of the current run   |
+  | until none is left                       |
+  +------------------------------------------+*/
+
+static void runItems(worker_pool* pool) {
+
+    for(;;) {
+        unsigned int first = 0;
+        unsigned int last = 0;
+
+        pthread_mutex_lock(&pool->lock);
+        first = pool->nextItem;
+        last = (pool->nbItems - first) > pool->itemsPerClaim ? first + pool->itemsPerClaim : pool->nbItems;
+        pool->nextItem = last;
+        pthread_mutex_unlock(&pool->lock);
+
+        if(first >= last)
+            return;
+
+        for(; first < last; first++)
+            pool->task(pool->data, first);
+    }
+
+}
+
+
+static void* work(void* arg) {
+
+    worker_pool* pool = (worker_pool*)arg;
+    unsigned long generation = 0;
+
+    pthread_mutex_lock(&pool->lock);
+
+    for(;;) {
+        while(!pool->isStopping && (pool->generation == generation))
+            pthread_cond_wait(&pool->hasWork, &pool->lock);
+
+        if(pool->isStopping)
+            break;
+
+        generation = pool->generation;
+        pthread_mutex_unlock(&pool->lock);
+
+        runItems(pool);
+
+        pthread_mutex_lock(&pool->lock);
+        if(--pool->nbBusy == 0)
+            pthread_cond_signal(&pool->isDone);
+    }
+
+    pthread_mutex_unlock(&pool->lock);
+
+    return NULL;
+
+}
+
+
+/*+------------------------------------------+
+  | Initialize a pool of nbThreads threads,  |
+  | the calling one included                 |
+  +------------------------------------------+*/
+
+worker_pool* worker_pool_init(unsigned int nbThreads) {
+
+    unsigned int i = 0;
+    worker_pool* pool = (worker_pool*)malloc(sizeof(worker_pool));
+
+    pool->nbThreads = nbThreads > 1 ? nbThreads - 1 : 0;
+    pool->threads = (pthread_t*)malloc(sizeof(pthread_t) * (pool->nbThreads + 1));
+
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->hasWork, NULL);
+    pthread_cond_init(&pool->isDone, NULL);
+
+    pool->task = NULL;
+    pool->data = NULL;
+    pool->nbItems = 0;
+    pool->nextItem = 0;
+    pool->itemsPerClaim = 1;
+    pool->nbBusy = 0;
+    pool->generation = 0;
+    pool->isStopping = 0;
+
+    for(; i < pool->nbThreads; i++)
+        pthread_create(pool->threads + i, NULL, work, pool);
+
+    return pool;
+
+}
+
+
+/*+------------------------------------------+
+  | Run task on every item from 0 to         |
+  | nbItems - 1 and return once all are done |
+  +------------------------------------------+*/
+
+void worker_pool_run(worker_pool* pool, worker_pool_task task, void* data, unsigned int nbItems) {
+
+    unsigned int i = 0;
+
+    if((pool->nbThreads == 0) || (nbItems <= 1)) {
+        for(; i < nbItems; i++)
+            task(data, i);
+        return;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    pool->task = task;
+    pool->data = data;
+    pool->nbItems = nbItems;
+    pool->nextItem = 0;
+    pool->itemsPerClaim = nbItems / ((pool->nbThreads + 1) * WORKER_POOL_ITEMS_PER_CLAIM_DIVISOR);
+    if(pool->itemsPerClaim == 0)
+        pool->itemsPerClaim = 1;
+    pool->nbBusy = pool->nbThreads;
+    pool->generation++;
+    pthread_cond_broadcast(&pool->hasWork);
+    pthread_mutex_unlock(&pool->lock);
+
+    runItems(pool);
+
+    pthread_mutex_lock(&pool->lock);
+    while(pool->nbBusy > 0)
+        pthread_cond_wait(&pool->isDone, &pool->lock);
+    pthread_mutex_unlock(&pool->lock);
+
+}
+
+
+/*+------------------------------------------+
+  | Stop the threads and free the pool       |
+  +------------------------------------------+*/
+
+void worker_pool_uninit(worker_pool** pool) {
+
+    unsigned int i = 0;
+
+    pthread_mutex_lock(&(*pool)->lock);
+    (*pool)->isStopping = 1;
+    pthread_cond_broadcast(&(*pool)->hasWork);
+    pthread_mutex_unlock(&(*pool)->lock);
+
+    for(; i < (*pool)->nbThreads; i++)
+        pthread_join((*pool)->threads[i], NULL);
+
+    pthread_mutex_destroy(&(*pool)->lock);
+    pthread_cond_destroy(&(*pool)->hasWork);
+    pthread_cond_destroy(&(*pool)->isDone);
+
+    free((*pool)->threads);
+    free(*pool);
+    *pool = NULL;
+
+}
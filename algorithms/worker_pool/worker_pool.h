@@ -0,0 +1,78 @@
+/* Copyright or © or Copr. 2012, Jean-François Hren
+ *
+ * Author e-mail: jean-francois.hren@inria.fr
+ *
+ * This software is a computer program whose purpose is to control
+ * deterministic systems using optimistic planning.
+ *
+ * This software is governed by the CeCILL license under French law and
+ * abiding by the rules of distribution of free software.  You can  use, 
+ * modify and/ or redistribute the software under the terms of the CeCILL
+ * license as circulated by CEA, CNRS and INRIA at the following URL
+ * "http://www.cecill.info". 
+ *
+ * As a counterpart to the access to the source code and  rights to copy,
+ * modify and redistribute granted by the license, users are provided only
+ * with a limited warranty  and the software's author,  the holder of the
+ * economic rights,  and the successive licensors  have only  limited
+ * liability. 
+ *
+ * In this respect, the user's attention is drawn to the risks associated
+ * with loading,  using,  modifying and/or developing or reproducing the
+ * software by the user in light of its specific status of free software,
+ * that may mean  that it is complicated to manipulate,  and  that  also
+ * therefore means  that it is reserved for developers  and  experienced
+ * professionals having in-depth computer knowledge. Users are therefore
+ * encouraged to load and test the software's suitability as regards their
+ * requirements in conditions enabling the security of their systems and/or 
+ * data to be ensured and,  more generally, to use and operate it in the 
+ * same conditions as regards security. 
+ *
+ * The fact that you are presently reading this means that you have had
+ * knowledge of the CeCILL license and that you accept its terms.
+ */
+
+
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <pthread.h>
+
+#define WORKER_POOL_ITEMS_PER_CLAIM_DIVISOR 4               /* Each claim takes about 1/(nbThreads * this) of the items so that threads finish together */
+
+typedef void (*worker_pool_task)(void* data, unsigned int index);
+
+
+/*+-------------------------------------+
+  | Represents a pool of threads        |
+  | running a task on a range of items. |
+  | The calling thread works along with |
+  | them.                               |
+  +-------------------------------------+*/
+
+typedef struct {
+
+    pthread_t* threads;                                     /* The threads in addition to the calling one */
+    unsigned int nbThreads;                                 /* The number of threads in addition to the calling one */
+
+    pthread_mutex_t lock;                                   /* Protects every following field */
+    pthread_cond_t hasWork;                                 /* Signaled when a run starts or the pool stops */
+    pthread_cond_t isDone;                                  /* Signaled when the last thread is done with a run */
+
+    worker_pool_task task;                                  /* The task of the current run */
+    void* data;                                             /* The data given to the task */
+    unsigned int nbItems;                                   /* The number of items of the current run */
+    unsigned int nextItem;                                  /* The first item not claimed yet */
+    unsigned int itemsPerClaim;                             /* The number of items claimed at once */
+    unsigned int nbBusy;                                    /* The number of threads not done with the current run */
+    unsigned long generation;                               /* The number of runs started, telling a waiting thread a new one is there */
+    char isStopping;                                        /* Set to make the threads exit */
+
+} worker_pool;
+
+
+worker_pool* worker_pool_init(unsigned int nbThreads);
+void worker_pool_run(worker_pool* pool, worker_pool_task task, void* data, unsigned int nbItems);
+void worker_pool_uninit(worker_pool** pool);
+
+#endif
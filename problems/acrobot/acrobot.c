@@ -120,12 +120,14 @@ void freeGenerativeModelParameters() {
 
 
 /* Returns an allocated state initialized from the parsed string */
-state* makeState(const char* str) {
+state* makeStateWithContext(model_context* context, const char* str) {
 
     char* end = NULL;
     char* crt = (char*)str;
     char tmp[255];    
-    state* s = (state*)malloc(sizeof(state));
+    state* s = (state*)calloc(1, sizeof(state));
+
+    (void)context;
 
     end = strchr(str, ',');
     memcpy(tmp, crt, end - crt);
@@ -156,9 +158,11 @@ state* makeState(const char* str) {
 
 /* Returns an allocated initial state of the model. */
 
-state* initState() {
+state* initStateWithContext(model_context* context) {
+
+    state* init = (state*)calloc(1, sizeof(state));
 
-    state* init = (state*)malloc(sizeof(state));
+    (void)context;
 
     init->angularPosition1 = M_PIl;
 
@@ -175,11 +179,20 @@ state* initState() {
 }
 
 
-/* Returns a triplet containing the next state, the applied action and the reward given the current state and action. */
+/* Returns the size in bytes of a state. */
+
+size_t stateSize() {
+
+    return sizeof(state);
 
-char nextStateReward(state* s, double* a, state** nextState,double* reward) {
+}
+
+
+/* Writes into nextState the next state given the current state and action and returns the reward. nextState must not be s. */
 
-    *nextState = copyState(s);
+char nextStateRewardIntoWithContext(model_context* context, state* s, double* a, state* nextState, double* reward) {
+
+    memcpy(nextState, s, sizeof(state));
 
     if(s->isTerminal < 0) {
         *reward = 0.0;
@@ -187,12 +200,12 @@ char nextStateReward(state* s, double* a, state** nextState,double* reward) {
         double x = 0.0;
         double y = 0.0;
 
-        double m1 = parameters[1];
-        double l1 = parameters[0];
-        double mu1 = parameters[2];
-        double m2 = parameters[4];
-        double l2 = parameters[3];
-        double mu2 = parameters[5];
+        double m1 = context->parameters[1];
+        double l1 = context->parameters[0];
+        double mu1 = context->parameters[2];
+        double m2 = context->parameters[4];
+        double l2 = context->parameters[3];
+        double mu2 = context->parameters[5];
 
         double a11 = ((4.0 / 3.0) * m1 + 4 * m2) * l1 * l1;
         double a22 = (4.0 / 3.0) * m2 * l2 * l2;
@@ -200,52 +213,242 @@ char nextStateReward(state* s, double* a, state** nextState,double* reward) {
         double coef1 = (m1 + 2 * m2) * l1 * 9.81;
         double coef2 = m2 * l2 * 9.81;
 
-        double a12 = m2l2l12 * cos((*nextState)->angularPosition2 - (*nextState)->angularPosition1);
+        double a12 = m2l2l12 * cos(nextState->angularPosition2 - nextState->angularPosition1);
         double Det = a11 * a22 - a12 * a12;
 
-        double s = sin((*nextState)->angularPosition2 - (*nextState)->angularPosition1);
-        double appliedTorque = ((parameters[7] + parameters[7]) * a[0]) - parameters[7];
-        double b1 = coef1 * sin((*nextState)->angularPosition1) + m2l2l12 * (*nextState)->angularVelocity2 * (*nextState)->angularVelocity2 * s - appliedTorque - mu1 * (*nextState)->angularVelocity1;
-        double b2 = coef2 * sin((*nextState)->angularPosition2) - m2l2l12 * (*nextState)->angularVelocity1 * (*nextState)->angularVelocity1 * s + appliedTorque - mu2 * (*nextState)->angularVelocity2;
+        double s = sin(nextState->angularPosition2 - nextState->angularPosition1);
+        double appliedTorque = ((context->parameters[7] + context->parameters[7]) * a[0]) - context->parameters[7];
+        double b1 = coef1 * sin(nextState->angularPosition1) + m2l2l12 * nextState->angularVelocity2 * nextState->angularVelocity2 * s - appliedTorque - mu1 * nextState->angularVelocity1;
+        double b2 = coef2 * sin(nextState->angularPosition2) - m2l2l12 * nextState->angularVelocity1 * nextState->angularVelocity1 * s + appliedTorque - mu2 * nextState->angularVelocity2;
 
-        (*nextState)->angularPosition1 += (*nextState)->angularVelocity1 * timeStep;  
-        (*nextState)->angularPosition2 += (*nextState)->angularVelocity2 * timeStep;
-        (*nextState)->angularVelocity1 += ((a22 * b1 - a12 * b2) / Det) * timeStep;
-        (*nextState)->angularVelocity2 += ((-a12 * b1 + a11 * b2) / Det) * timeStep;
+        nextState->angularPosition1 += nextState->angularVelocity1 * context->timeStep;  
+        nextState->angularPosition2 += nextState->angularVelocity2 * context->timeStep;
+        nextState->angularVelocity1 += ((a22 * b1 - a12 * b2) / Det) * context->timeStep;
+        nextState->angularVelocity2 += ((-a12 * b1 + a11 * b2) / Det) * context->timeStep;
 
-        if((*nextState)->angularVelocity1 > parameters[8])
-            (*nextState)->angularVelocity1 = parameters[8];
+        if(nextState->angularVelocity1 > context->parameters[8])
+            nextState->angularVelocity1 = context->parameters[8];
 
-        if((*nextState)->angularVelocity1 < -parameters[8])
-            (*nextState)->angularVelocity1 = -parameters[8];
+        if(nextState->angularVelocity1 < -context->parameters[8])
+            nextState->angularVelocity1 = -context->parameters[8];
 
-        if((*nextState)->angularVelocity2 > parameters[8])
-            (*nextState)->angularVelocity2 = parameters[8];
+        if(nextState->angularVelocity2 > context->parameters[8])
+            nextState->angularVelocity2 = context->parameters[8];
 
-        if((*nextState)->angularVelocity2 < -parameters[8])
-            (*nextState)->angularVelocity2 = -parameters[8];
+        if(nextState->angularVelocity2 < -context->parameters[8])
+            nextState->angularVelocity2 = -context->parameters[8];
 
 
-        if((*nextState)->angularPosition1 > (2.0 * M_PIl))
-            (*nextState)->angularPosition1 -= 2.0 * M_PIl;
+        if(nextState->angularPosition1 > (2.0 * M_PIl))
+            nextState->angularPosition1 -= 2.0 * M_PIl;
 
-        if((*nextState)->angularPosition1 < 0.0)
-            (*nextState)->angularPosition1 += 2.0 * M_PIl;
+        if(nextState->angularPosition1 < 0.0)
+            nextState->angularPosition1 += 2.0 * M_PIl;
 
-        if((*nextState)->angularPosition2 > (2.0 * M_PIl))
-            (*nextState)->angularPosition2 -= 2.0 * M_PIl;
+        if(nextState->angularPosition2 > (2.0 * M_PIl))
+            nextState->angularPosition2 -= 2.0 * M_PIl;
 
-        if((*nextState)->angularPosition2 < 0.0)
-            (*nextState)->angularPosition2 += 2.0 * M_PIl;
+        if(nextState->angularPosition2 < 0.0)
+            nextState->angularPosition2 += 2.0 * M_PIl;
 
-        x = (sin((*nextState)->angularPosition1) * l1) + (sin((*nextState)->angularPosition2) * l2);
-        y = (cos((*nextState)->angularPosition1) * l1) + (cos((*nextState)->angularPosition2) * l2);
+        x = (sin(nextState->angularPosition1) * l1) + (sin(nextState->angularPosition2) * l2);
+        y = (cos(nextState->angularPosition1) * l1) + (cos(nextState->angularPosition2) * l2);
 
         *reward = 1.0 - (sqrt(((y - (l1 + l2)) * (y - (l1 + l2))) + (x * x)) / (2.0 * (l1 + l2)));
 
     }
 
-    return (*nextState)->isTerminal;
+    return nextState->isTerminal;
+
+}
+
+
+/* Returns a triplet containing the next state, the applied action and the reward given the current state and action. */
+
+char nextStateRewardWithContext(model_context* context, state* s, double* a, state** nextState, double* reward) {
+
+    *nextState = (state*)calloc(1, sizeof(state));
+
+    return nextStateRewardIntoWithContext(context, s, a, *nextState, reward);
+
+}
+
+
+/* The arithmetic of nextStateRewardInto on n states stored as arrays, without branches so that it can be vectorized. The arrays must not overlap. */
+
+static void accelerateBatch(model_context* context, unsigned int n, const double* restrict actions, const double* restrict angularPosition1, const double* restrict angularVelocity1, const double* restrict angularPosition2, const double* restrict angularVelocity2, const double* restrict cosDifference, const double* restrict sinDifference, const double* restrict sinAngle1, const double* restrict sinAngle2, double* restrict nextAngularPosition1, double* restrict nextAngularVelocity1, double* restrict nextAngularPosition2, double* restrict nextAngularVelocity2) {
+
+    double m1 = context->parameters[1];
+    double l1 = context->parameters[0];
+    double mu1 = context->parameters[2];
+    double m2 = context->parameters[4];
+    double l2 = context->parameters[3];
+    double mu2 = context->parameters[5];
+
+    double a11 = ((4.0 / 3.0) * m1 + 4 * m2) * l1 * l1;
+    double a22 = (4.0 / 3.0) * m2 * l2 * l2;
+    double m2l2l12 = 2 * m2 * l1 * l2;
+    double coef1 = (m1 + 2 * m2) * l1 * 9.81;
+    double coef2 = m2 * l2 * 9.81;
+    double maxTorque = context->parameters[7];
+    double maxAngularVelocity = context->parameters[8];
+    double timeStep = context->timeStep;
+    unsigned int i = 0;
+
+    for(; i < n; i++) {
+        double a12 = m2l2l12 * cosDifference[i];
+        double Det = a11 * a22 - a12 * a12;
+        double s = sinDifference[i];
+        double appliedTorque = ((maxTorque + maxTorque) * actions[i * NUMBER_OF_DIMENSIONS_OF_ACTION]) - maxTorque;
+        double b1 = coef1 * sinAngle1[i] + m2l2l12 * angularVelocity2[i] * angularVelocity2[i] * s - appliedTorque - mu1 * angularVelocity1[i];
+        double b2 = coef2 * sinAngle2[i] - m2l2l12 * angularVelocity1[i] * angularVelocity1[i] * s + appliedTorque - mu2 * angularVelocity2[i];
+        double newAngularVelocity1 = angularVelocity1[i] + ((a22 * b1 - a12 * b2) / Det) * timeStep;
+        double newAngularVelocity2 = angularVelocity2[i] + ((-a12 * b1 + a11 * b2) / Det) * timeStep;
+
+        newAngularVelocity1 = newAngularVelocity1 > maxAngularVelocity ? maxAngularVelocity : newAngularVelocity1;
+        newAngularVelocity1 = newAngularVelocity1 < -maxAngularVelocity ? -maxAngularVelocity : newAngularVelocity1;
+        newAngularVelocity2 = newAngularVelocity2 > maxAngularVelocity ? maxAngularVelocity : newAngularVelocity2;
+        newAngularVelocity2 = newAngularVelocity2 < -maxAngularVelocity ? -maxAngularVelocity : newAngularVelocity2;
+
+        nextAngularPosition1[i] = angularPosition1[i] + angularVelocity1[i] * timeStep;
+        nextAngularPosition2[i] = angularPosition2[i] + angularVelocity2[i] * timeStep;
+        nextAngularVelocity1[i] = newAngularVelocity1;
+        nextAngularVelocity2[i] = newAngularVelocity2;
+    }
+
+}
+
+
+/* Batched version of nextStateRewardInto. The next states are computed for every state, then the ones of the terminal states are discarded. */
+
+void nextStateRewardBatchWithContext(model_context* context, state_batch* batch, unsigned int n, double* actions, double* rewards, char* isTerminal) {
+
+    double l1 = context->parameters[0];
+    double l2 = context->parameters[3];
+    unsigned int i = 0;
+
+    for(i = 0; i < n; i++) {
+        batch->cosDifference[i] = cos(batch->angularPosition2[i] - batch->angularPosition1[i]);
+        batch->sinDifference[i] = sin(batch->angularPosition2[i] - batch->angularPosition1[i]);
+        batch->sinAngle1[i] = sin(batch->angularPosition1[i]);
+        batch->sinAngle2[i] = sin(batch->angularPosition2[i]);
+    }
+
+    accelerateBatch(context, n, actions, batch->angularPosition1, batch->angularVelocity1, batch->angularPosition2, batch->angularVelocity2, batch->cosDifference, batch->sinDifference, batch->sinAngle1, batch->sinAngle2, batch->nextAngularPosition1, batch->nextAngularVelocity1, batch->nextAngularPosition2, batch->nextAngularVelocity2);
+
+    for(i = 0; i < n; i++) {
+        if(batch->isTerminal[i] < 0) {
+            rewards[i] = 0.0;
+        } else {
+            double angularPosition1 = batch->nextAngularPosition1[i];
+            double angularPosition2 = batch->nextAngularPosition2[i];
+            double x = 0.0;
+            double y = 0.0;
+
+            if(angularPosition1 > (2.0 * M_PIl))
+                angularPosition1 -= 2.0 * M_PIl;
+
+            if(angularPosition1 < 0.0)
+                angularPosition1 += 2.0 * M_PIl;
+
+            if(angularPosition2 > (2.0 * M_PIl))
+                angularPosition2 -= 2.0 * M_PIl;
+
+            if(angularPosition2 < 0.0)
+                angularPosition2 += 2.0 * M_PIl;
+
+            batch->angularPosition1[i] = angularPosition1;
+            batch->angularVelocity1[i] = batch->nextAngularVelocity1[i];
+            batch->angularPosition2[i] = angularPosition2;
+            batch->angularVelocity2[i] = batch->nextAngularVelocity2[i];
+
+            x = (sin(angularPosition1) * l1) + (sin(angularPosition2) * l2);
+            y = (cos(angularPosition1) * l1) + (cos(angularPosition2) * l2);
+
+            rewards[i] = 1.0 - (sqrt(((y - (l1 + l2)) * (y - (l1 + l2))) + (x * x)) / (2.0 * (l1 + l2)));
+        }
+
+        isTerminal[i] = batch->isTerminal[i];
+    }
+
+}
+
+
+/* Multi-action version of nextStateRewardInto. Nothing is shared between the actions for this model. */
+
+void nextStateRewardMultiWithContext(model_context* context, state* s, unsigned int k, double* actions, state** nextStates, double* rewards, char* isTerminal) {
+
+    unsigned int i = 0;
+
+    for(; i < k; i++)
+        isTerminal[i] = nextStateRewardIntoWithContext(context, s, actions + (i * NUMBER_OF_DIMENSIONS_OF_ACTION), nextStates[i], rewards + i);
+
+}
+
+
+/* Returns an allocated batch of n states, each a copy of s. The fields and the scratch space share one allocation. */
+
+state_batch* initStateBatch(unsigned int n, state* s) {
+
+    state_batch* batch = (state_batch*)malloc(sizeof(state_batch));
+    double* fields = (double*)malloc(sizeof(double) * 12 * n);
+    unsigned int i = 0;
+
+    batch->angularPosition1 = fields;
+    batch->angularVelocity1 = fields + n;
+    batch->angularPosition2 = fields + (2 * n);
+    batch->angularVelocity2 = fields + (3 * n);
+    batch->nextAngularPosition1 = fields + (4 * n);
+    batch->nextAngularVelocity1 = fields + (5 * n);
+    batch->nextAngularPosition2 = fields + (6 * n);
+    batch->nextAngularVelocity2 = fields + (7 * n);
+    batch->cosDifference = fields + (8 * n);
+    batch->sinDifference = fields + (9 * n);
+    batch->sinAngle1 = fields + (10 * n);
+    batch->sinAngle2 = fields + (11 * n);
+    batch->isTerminal = (char*)malloc(sizeof(char) * n);
+
+    for(; i < n; i++)
+        setStateOfBatch(batch, i, s);
+
+    return batch;
+
+}
+
+
+/* Copies s into the i-th state of the batch. */
+
+void setStateOfBatch(state_batch* batch, unsigned int i, state* s) {
+
+    batch->angularPosition1[i] = s->angularPosition1;
+    batch->angularVelocity1[i] = s->angularVelocity1;
+    batch->angularPosition2[i] = s->angularPosition2;
+    batch->angularVelocity2[i] = s->angularVelocity2;
+    batch->isTerminal[i] = s->isTerminal;
+
+}
+
+
+/* Copies the i-th state of the batch into s. */
+
+void getStateOfBatch(state_batch* batch, unsigned int i, state* s) {
+
+    s->angularPosition1 = batch->angularPosition1[i];
+    s->angularVelocity1 = batch->angularVelocity1[i];
+    s->angularPosition2 = batch->angularPosition2[i];
+    s->angularVelocity2 = batch->angularVelocity2[i];
+    s->isTerminal = batch->isTerminal[i];
+
+}
+
+
+/* Free the batch */
+
+void freeStateBatch(state_batch* batch) {
+
+    free(batch->angularPosition1);
+    free(batch->isTerminal);
+    free(batch);
 
 }
 
@@ -254,7 +457,7 @@ char nextStateReward(state* s, double* a, state** nextState,double* reward) {
 
 state* copyState(state* s) {
 
-    state* newState = (state*)malloc(sizeof(state));
+    state* newState = (state*)calloc(1, sizeof(state));
     memcpy(newState, s, sizeof(state));
 
     return newState;
@@ -45,4 +45,20 @@ struct state {
     char isTerminal;
 };
 
+struct state_batch {
+    double* angularPosition1;
+    double* angularVelocity1;
+    double* angularPosition2;
+    double* angularVelocity2;
+    char* isTerminal;
+    double* nextAngularPosition1;   /* Scratch space of the transitions, from here on */
+    double* nextAngularVelocity1;
+    double* nextAngularPosition2;
+    double* nextAngularVelocity2;
+    double* cosDifference;
+    double* sinDifference;
+    double* sinAngle1;
+    double* sinAngle2;
+};
+
 #endif
@@ -39,7 +39,6 @@
 #undef __USE_GNU
 #include <string.h>
 #include <gsl/gsl_rng.h>
-#include <time.h>
 
 #include "boat.h"
 
@@ -52,6 +51,8 @@ double timeStep = 0.1;							/* Time step between two state */
 double* parameters = NULL;						/* Model's parameters */
 unsigned int nbParameters = 10;					/* Number of model's parameters */
 
+static gsl_rng* initialStatesRng = NULL;				/* Draws the initial states, seeded from getModelSeed on first use */
+
 /*+------------Model's parameters----------+
   |                                        |
   | parameters[0]: force of the current    |
@@ -110,7 +111,10 @@ void initGenerativeModel() {
 
 void freeGenerativeModel() {
 
-    return;
+    if(initialStatesRng != NULL) {
+        gsl_rng_free(initialStatesRng);
+        initialStatesRng = NULL;
+    }
 
 }
 
@@ -125,12 +129,14 @@ void freeGenerativeModelParameters() {
 
 
 /* Returns an allocated state initialized from the parsed string */
-state* makeState(const char* str) {
+state* makeStateWithContext(model_context* context, const char* str) {
 
     char* end = NULL;
     char* crt = (char*)str;
     char tmp[255];    
-    state* s = (state*)malloc(sizeof(state));
+    state* s = (state*)calloc(1, sizeof(state));
+
+    (void)context;
 
     end = strchr(str, ',');
     memcpy(tmp, crt, end - crt);
@@ -173,16 +179,21 @@ state* makeState(const char* str) {
 
 /* Returns an allocated initial state of the model. */
 
-state* initState() {
-    gsl_rng* rng = gsl_rng_alloc(gsl_rng_mt19937);
-    gsl_rng_set(rng, time(NULL));
+state* initStateWithContext(model_context* context) {
+
+    state* init = (state*)calloc(1, sizeof(state));
+
+    (void)context;
 
-    state* init = (state*)malloc(sizeof(state));
+    if(initialStatesRng == NULL) {
+        initialStatesRng = gsl_rng_alloc(gsl_rng_mt19937);
+        gsl_rng_set(initialStatesRng, getModelSeed());
+    }
 
     init->xPosition = 0.0;
-    init->yPosition = gsl_rng_uniform(rng) * 200;
+    init->yPosition = gsl_rng_uniform(initialStatesRng) * 200;
 
-    init->boatAngle = (gsl_rng_uniform(rng) * M_PIl) - (M_PIl/2.0);
+    init->boatAngle = (gsl_rng_uniform(initialStatesRng) * M_PIl) - (M_PIl/2.0);
     init->rudderAngle = 0.0;
 
     init->velocity = 0.0;
@@ -194,53 +205,262 @@ state* initState() {
 }
 
 
-char nextStateReward(state* s, double* a, state** nextState,double* reward) {
+/* Returns the size in bytes of a state. */
+
+size_t stateSize() {
+
+    return sizeof(state);
+
+}
+
+
+/* Writes into nextState the next state given the current state and action and returns the reward. nextState must not be s. */
+
+char nextStateRewardIntoWithContext(model_context* context, state* s, double* a, state* nextState, double* reward) {
 
     if(s->isTerminal) {	
-        *nextState = copyState(s);
+        memcpy(nextState, s, sizeof(state));
         *reward = s->isTerminal < 0 ? 0.0 : 1.0;
     } else {
         double quarterPI = M_PIl / 4.0;
         double distance = 0;
 
-        *nextState = (state*)malloc(sizeof(state));
-
-        (*nextState)->rudderAngle = parameters[4] * (((*a * (parameters[9] - parameters[8])) + parameters[8]) - s->boatAngle);
-        if((*nextState)->rudderAngle < -quarterPI)
-            (*nextState)->rudderAngle = -quarterPI;
-        else if((*nextState)->rudderAngle > quarterPI)
-            (*nextState)->rudderAngle = quarterPI;
-
-        (*nextState)->velocity = s->velocity + ((parameters[3] - s->velocity) * parameters[1]);
-        (*nextState)->omega = s->omega + (((*nextState)->rudderAngle - s->omega) * ((*nextState)->velocity / parameters[2]));
-        (*nextState)->boatAngle = s->boatAngle + (parameters[1] * (*nextState)->omega);
-        (*nextState)->xPosition = s->xPosition + ((*nextState)->velocity * cos((*nextState)->boatAngle));
-        if((*nextState)->xPosition < 0)
-            (*nextState)->xPosition = 0;
-        else if((*nextState)->xPosition > 200)
-            (*nextState)->xPosition = 200;
-
-        (*nextState)->yPosition = s->yPosition - ((*nextState)->velocity * sin((*nextState)->boatAngle)) - (parameters[0] * (((*nextState)->xPosition / 50.0) - ((*nextState)->xPosition * (*nextState)->xPosition / 10000.0)));
-        if((*nextState)->yPosition < 0)
-            (*nextState)->yPosition = 0;
-        else if((*nextState)->yPosition > 200)
-            (*nextState)->yPosition = 200;
-
-        distance = sqrt(((parameters[5] - (*nextState)->xPosition) * (parameters[5] - (*nextState)->xPosition)) + ((parameters[6] - (*nextState)->yPosition) * (parameters[6] - (*nextState)->yPosition)));
-
-        if(((*nextState)->xPosition == parameters[5]) && (distance > parameters[7])) {
-            (*nextState)->isTerminal = -1;
+        nextState->rudderAngle = context->parameters[4] * (((*a * (context->parameters[9] - context->parameters[8])) + context->parameters[8]) - s->boatAngle);
+        if(nextState->rudderAngle < -quarterPI)
+            nextState->rudderAngle = -quarterPI;
+        else if(nextState->rudderAngle > quarterPI)
+            nextState->rudderAngle = quarterPI;
+
+        nextState->velocity = s->velocity + ((context->parameters[3] - s->velocity) * context->parameters[1]);
+        nextState->omega = s->omega + ((nextState->rudderAngle - s->omega) * (nextState->velocity / context->parameters[2]));
+        nextState->boatAngle = s->boatAngle + (context->parameters[1] * nextState->omega);
+        nextState->xPosition = s->xPosition + (nextState->velocity * cos(nextState->boatAngle));
+        if(nextState->xPosition < 0)
+            nextState->xPosition = 0;
+        else if(nextState->xPosition > 200)
+            nextState->xPosition = 200;
+
+        nextState->yPosition = s->yPosition - (nextState->velocity * sin(nextState->boatAngle)) - (context->parameters[0] * ((nextState->xPosition / 50.0) - (nextState->xPosition * nextState->xPosition / 10000.0)));
+        if(nextState->yPosition < 0)
+            nextState->yPosition = 0;
+        else if(nextState->yPosition > 200)
+            nextState->yPosition = 200;
+
+        distance = sqrt(((context->parameters[5] - nextState->xPosition) * (context->parameters[5] - nextState->xPosition)) + ((context->parameters[6] - nextState->yPosition) * (context->parameters[6] - nextState->yPosition)));
+
+        if((nextState->xPosition == context->parameters[5]) && (distance > context->parameters[7])) {
+            nextState->isTerminal = -1;
             *reward = 0.0;
-        } else if(((*nextState)->xPosition == parameters[5]) && (distance < parameters[7])) {
-            (*nextState)->isTerminal = 1;
+        } else if((nextState->xPosition == context->parameters[5]) && (distance < context->parameters[7])) {
+            nextState->isTerminal = 1;
             *reward = 1.0;
         } else {
-            (*nextState)->isTerminal = 0;
+            nextState->isTerminal = 0;
             *reward = 1.0 - (distance / sqrt((200 * 200) + (200 * 200)));
         }
     }
 
-    return (*nextState)->isTerminal;
+    return nextState->isTerminal;
+
+}
+
+
+char nextStateRewardWithContext(model_context* context, state* s, double* a, state** nextState, double* reward) {
+
+    *nextState = (state*)calloc(1, sizeof(state));
+
+    return nextStateRewardIntoWithContext(context, s, a, *nextState, reward);
+
+}
+
+
+/* The arithmetic of nextStateRewardInto up to the new angle of the boat, on n states stored as arrays, without branches so that it can be vectorized. The arrays must not overlap. */
+
+static void steerBatch(model_context* context, unsigned int n, const double* restrict actions, const double* restrict boatAngle, const double* restrict velocity, const double* restrict omega, double* restrict nextBoatAngle, double* restrict nextRudderAngle, double* restrict nextVelocity, double* restrict nextOmega) {
+
+    double quarterPI = M_PIl / 4.0;
+    double timeStepFactor = context->parameters[1];
+    double inertia = context->parameters[2];
+    double maxVelocity = context->parameters[3];
+    double rudderGain = context->parameters[4];
+    double minAngle = context->parameters[8];
+    double maxAngle = context->parameters[9];
+    unsigned int i = 0;
+
+    for(; i < n; i++) {
+        double rudderAngle = rudderGain * (((actions[i * NUMBER_OF_DIMENSIONS_OF_ACTION] * (maxAngle - minAngle)) + minAngle) - boatAngle[i]);
+        double newVelocity = velocity[i] + ((maxVelocity - velocity[i]) * timeStepFactor);
+        double newOmega = 0.0;
+
+        rudderAngle = rudderAngle < -quarterPI ? -quarterPI : rudderAngle;
+        rudderAngle = rudderAngle > quarterPI ? quarterPI : rudderAngle;
+        newOmega = omega[i] + ((rudderAngle - omega[i]) * (newVelocity / inertia));
+
+        nextRudderAngle[i] = rudderAngle;
+        nextVelocity[i] = newVelocity;
+        nextOmega[i] = newOmega;
+        nextBoatAngle[i] = boatAngle[i] + (timeStepFactor * newOmega);
+    }
+
+}
+
+
+/* The arithmetic of nextStateRewardInto from the new angle of the boat to its new position. Same requirements as steerBatch. The position along x is clamped in a loop of its own, otherwise the compiler duplicates the arithmetic that follows into the branches of the clamp and no longer vectorizes it. */
+
+static void moveBatch(model_context* context, unsigned int n, const double* restrict xPosition, const double* restrict yPosition, const double* restrict nextVelocity, const double* restrict cosAngle, const double* restrict sinAngle, double* restrict nextXPosition, double* restrict nextYPosition) {
+
+    double current = context->parameters[0];
+    unsigned int i = 0;
+
+    for(i = 0; i < n; i++) {
+        double newXPosition = xPosition[i] + (nextVelocity[i] * cosAngle[i]);
+
+        newXPosition = newXPosition < 0 ? 0 : newXPosition;
+        newXPosition = newXPosition > 200 ? 200 : newXPosition;
+
+        nextXPosition[i] = newXPosition;
+    }
+
+    for(i = 0; i < n; i++) {
+        double newYPosition = yPosition[i] - (nextVelocity[i] * sinAngle[i]) - (current * ((nextXPosition[i] / 50.0) - (nextXPosition[i] * nextXPosition[i] / 10000.0)));
+
+        newYPosition = newYPosition < 0 ? 0 : newYPosition;
+        newYPosition = newYPosition > 200 ? 200 : newYPosition;
+
+        nextYPosition[i] = newYPosition;
+    }
+
+}
+
+
+/* Batched version of nextStateRewardInto. The next states are computed for every state, then the ones of the terminal states are discarded. */
+
+void nextStateRewardBatchWithContext(model_context* context, state_batch* batch, unsigned int n, double* actions, double* rewards, char* isTerminal) {
+
+    unsigned int i = 0;
+
+    steerBatch(context, n, actions, batch->boatAngle, batch->velocity, batch->omega, batch->nextBoatAngle, batch->nextRudderAngle, batch->nextVelocity, batch->nextOmega);
+
+    for(i = 0; i < n; i++) {
+        batch->cosAngle[i] = cos(batch->nextBoatAngle[i]);
+        batch->sinAngle[i] = sin(batch->nextBoatAngle[i]);
+    }
+
+    moveBatch(context, n, batch->xPosition, batch->yPosition, batch->nextVelocity, batch->cosAngle, batch->sinAngle, batch->nextXPosition, batch->nextYPosition);
+
+    for(i = 0; i < n; i++) {
+        if(batch->isTerminal[i]) {
+            rewards[i] = batch->isTerminal[i] < 0 ? 0.0 : 1.0;
+        } else {
+            double distance = 0;
+
+            batch->xPosition[i] = batch->nextXPosition[i];
+            batch->yPosition[i] = batch->nextYPosition[i];
+            batch->boatAngle[i] = batch->nextBoatAngle[i];
+            batch->rudderAngle[i] = batch->nextRudderAngle[i];
+            batch->velocity[i] = batch->nextVelocity[i];
+            batch->omega[i] = batch->nextOmega[i];
+
+            distance = sqrt(((context->parameters[5] - batch->xPosition[i]) * (context->parameters[5] - batch->xPosition[i])) + ((context->parameters[6] - batch->yPosition[i]) * (context->parameters[6] - batch->yPosition[i])));
+
+            if((batch->xPosition[i] == context->parameters[5]) && (distance > context->parameters[7])) {
+                batch->isTerminal[i] = -1;
+                rewards[i] = 0.0;
+            } else if((batch->xPosition[i] == context->parameters[5]) && (distance < context->parameters[7])) {
+                batch->isTerminal[i] = 1;
+                rewards[i] = 1.0;
+            } else {
+                rewards[i] = 1.0 - (distance / sqrt((200 * 200) + (200 * 200)));
+            }
+        }
+
+        isTerminal[i] = batch->isTerminal[i];
+    }
+
+}
+
+
+/* Multi-action version of nextStateRewardInto. Nothing is shared between the actions for this model. */
+
+void nextStateRewardMultiWithContext(model_context* context, state* s, unsigned int k, double* actions, state** nextStates, double* rewards, char* isTerminal) {
+
+    unsigned int i = 0;
+
+    for(; i < k; i++)
+        isTerminal[i] = nextStateRewardIntoWithContext(context, s, actions + (i * NUMBER_OF_DIMENSIONS_OF_ACTION), nextStates[i], rewards + i);
+
+}
+
+
+/* Returns an allocated batch of n states, each a copy of s. The fields and the scratch space share one allocation. */
+
+state_batch* initStateBatch(unsigned int n, state* s) {
+
+    state_batch* batch = (state_batch*)malloc(sizeof(state_batch));
+    double* fields = (double*)malloc(sizeof(double) * 14 * n);
+    unsigned int i = 0;
+
+    batch->xPosition = fields;
+    batch->yPosition = fields + n;
+    batch->boatAngle = fields + (2 * n);
+    batch->rudderAngle = fields + (3 * n);
+    batch->velocity = fields + (4 * n);
+    batch->omega = fields + (5 * n);
+    batch->nextXPosition = fields + (6 * n);
+    batch->nextYPosition = fields + (7 * n);
+    batch->nextBoatAngle = fields + (8 * n);
+    batch->nextRudderAngle = fields + (9 * n);
+    batch->nextVelocity = fields + (10 * n);
+    batch->nextOmega = fields + (11 * n);
+    batch->cosAngle = fields + (12 * n);
+    batch->sinAngle = fields + (13 * n);
+    batch->isTerminal = (char*)malloc(sizeof(char) * n);
+
+    for(; i < n; i++)
+        setStateOfBatch(batch, i, s);
+
+    return batch;
+
+}
+
+
+/* Copies s into the i-th state of the batch. */
+
+void setStateOfBatch(state_batch* batch, unsigned int i, state* s) {
+
+    batch->xPosition[i] = s->xPosition;
+    batch->yPosition[i] = s->yPosition;
+    batch->boatAngle[i] = s->boatAngle;
+    batch->rudderAngle[i] = s->rudderAngle;
+    batch->velocity[i] = s->velocity;
+    batch->omega[i] = s->omega;
+    batch->isTerminal[i] = s->isTerminal;
+
+}
+
+
+/* Copies the i-th state of the batch into s. */
+
+void getStateOfBatch(state_batch* batch, unsigned int i, state* s) {
+
+    s->xPosition = batch->xPosition[i];
+    s->yPosition = batch->yPosition[i];
+    s->boatAngle = batch->boatAngle[i];
+    s->rudderAngle = batch->rudderAngle[i];
+    s->velocity = batch->velocity[i];
+    s->omega = batch->omega[i];
+    s->isTerminal = batch->isTerminal[i];
+
+}
+
+
+/* Free the batch */
+
+void freeStateBatch(state_batch* batch) {
+
+    free(batch->xPosition);
+    free(batch->isTerminal);
+    free(batch);
 
 }
 
@@ -249,7 +469,7 @@ char nextStateReward(state* s, double* a, state** nextState,double* reward) {
 
 state* copyState(state* s) {
 
-    state* newState = (state*)malloc(sizeof(state));
+    state* newState = (state*)calloc(1, sizeof(state));
     memcpy(newState, s, sizeof(state));
 
     return newState;
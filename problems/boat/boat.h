@@ -47,4 +47,22 @@ struct state {
     char isTerminal;
 };
 
+struct state_batch {
+    double* xPosition;
+    double* yPosition;
+    double* boatAngle;
+    double* rudderAngle;
+    double* velocity;
+    double* omega;
+    char* isTerminal;
+    double* nextXPosition;          /* Scratch space of the transitions, from here on */
+    double* nextYPosition;
+    double* nextBoatAngle;
+    double* nextRudderAngle;
+    double* nextVelocity;
+    double* nextOmega;
+    double* cosAngle;
+    double* sinAngle;
+};
+
 #endif
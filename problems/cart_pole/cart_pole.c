@@ -123,12 +123,14 @@ void freeGenerativeModelParameters() {
 
 
 /* Returns an allocated state initialized from the parsed string */
-state* makeState(const char* str) {
+state* makeStateWithContext(model_context* context, const char* str) {
 
     char* end = NULL;
     char* crt = (char*)str;
     char tmp[255];    
-    state* s = (state*)malloc(sizeof(state));
+    state* s = (state*)calloc(1, sizeof(state));
+
+    (void)context;
 
     end = strchr(str, ',');
     memcpy(tmp, crt, end - crt);
@@ -159,9 +161,11 @@ state* makeState(const char* str) {
 
 /* Returns an allocated initial state of the model. */
 
-state* initState() {
+state* initStateWithContext(model_context* context) {
+
+    state* init = (state*)calloc(1, sizeof(state));
 
-    state* init = (state*)malloc(sizeof(state));
+    (void)context;
 
     init->xPosition = 0.0;
     init->xVelocity = 0.0;
@@ -176,49 +180,226 @@ state* initState() {
 }
 
 
-char nextStateReward(state* s, double* a, state** nextState,double* reward) {
+/* Returns the size in bytes of a state. */
+
+size_t stateSize() {
+
+    return sizeof(state);
+
+}
+
+
+/* Writes into nextState the next state given the current state and action and returns the reward. nextState must not be s. */
+
+char nextStateRewardIntoWithContext(model_context* context, state* s, double* a, state* nextState, double* reward) {
 
     if(s->isTerminal) {	
-        *nextState = copyState(s);
+        memcpy(nextState, s, sizeof(state));
         *reward = 0.0;
     } else {
-        double a11 = (4.0 * parameters[2]) / 3.0;
-        double a22 = -(parameters[3] + parameters[4]);
+        double a11 = (4.0 * context->parameters[2]) / 3.0;
+        double a22 = -(context->parameters[3] + context->parameters[4]);
         double a12 = -cos(s->angularPosition);
-        double a21 = parameters[2] * parameters[4] * cos(s->angularPosition);
-        double b1 = parameters[0] * sin(s->angularPosition) - ((parameters[6] * s->angularVelocity) / (parameters[2] * parameters[4]));
-        double b2 = (parameters[2] * parameters[4] * s->angularVelocity * s->angularVelocity * sin(s->angularPosition)) - (((parameters[7] + parameters[7]) * a[0]) - parameters[7]) + (s->xVelocity == 0 ? 0: (s->xVelocity > 0.0 ? -parameters[5] : parameters[5]));
+        double a21 = context->parameters[2] * context->parameters[4] * cos(s->angularPosition);
+        double b1 = context->parameters[0] * sin(s->angularPosition) - ((context->parameters[6] * s->angularVelocity) / (context->parameters[2] * context->parameters[4]));
+        double b2 = (context->parameters[2] * context->parameters[4] * s->angularVelocity * s->angularVelocity * sin(s->angularPosition)) - (((context->parameters[7] + context->parameters[7]) * a[0]) - context->parameters[7]) + (s->xVelocity == 0 ? 0: (s->xVelocity > 0.0 ? -context->parameters[5] : context->parameters[5]));
         double angularAcceleration = ((b2 * a12) - (a22 * b1)) / ((a12 * a21) - (a11 * a22));
         double xAcceleration = (b1 - (a11 * angularAcceleration)) / a12;
 
-        *nextState = (state*)malloc(sizeof(state));
-
-        (*nextState)->angularVelocity = s->angularVelocity + (timeStep * angularAcceleration);
-        if(fabs((*nextState)->angularVelocity) > parameters[9])
-            (*nextState)->angularVelocity = (*nextState)->angularVelocity > 0.0 ? parameters[9] : - parameters[9];
+        nextState->angularVelocity = s->angularVelocity + (context->timeStep * angularAcceleration);
+        if(fabs(nextState->angularVelocity) > context->parameters[9])
+            nextState->angularVelocity = nextState->angularVelocity > 0.0 ? context->parameters[9] : - context->parameters[9];
 
-        (*nextState)->xVelocity = s->xVelocity + (timeStep * xAcceleration);
-        if(fabs((*nextState)->xVelocity) > parameters[8])
-            (*nextState)->xVelocity = (*nextState)->xVelocity > 0.0 ? parameters[8] : - parameters[8];
+        nextState->xVelocity = s->xVelocity + (context->timeStep * xAcceleration);
+        if(fabs(nextState->xVelocity) > context->parameters[8])
+            nextState->xVelocity = nextState->xVelocity > 0.0 ? context->parameters[8] : - context->parameters[8];
 
-        (*nextState)->angularPosition = s->angularPosition + (timeStep * (*nextState)->angularVelocity);
-        if((*nextState)->angularPosition > (2.0 * M_PIl))
-            (*nextState)->angularPosition = (*nextState)->angularPosition - (2.0 * M_PIl);
-        if((*nextState)->angularPosition < 0.0)
-            (*nextState)->angularPosition = (*nextState)->angularPosition + (2.0 * M_PIl);
+        nextState->angularPosition = s->angularPosition + (context->timeStep * nextState->angularVelocity);
+        if(nextState->angularPosition > (2.0 * M_PIl))
+            nextState->angularPosition = nextState->angularPosition - (2.0 * M_PIl);
+        if(nextState->angularPosition < 0.0)
+            nextState->angularPosition = nextState->angularPosition + (2.0 * M_PIl);
 
-        (*nextState)->xPosition = s->xPosition + (timeStep * (*nextState)->xVelocity);
+        nextState->xPosition = s->xPosition + (context->timeStep * nextState->xVelocity);
 
-        if(fabs((*nextState)->xPosition) > parameters[1]) {
-            (*nextState)->isTerminal = -1;
+        if(fabs(nextState->xPosition) > context->parameters[1]) {
+            nextState->isTerminal = -1;
             *reward = 0.0;
         } else {
-            (*nextState)->isTerminal = 0;
-            *reward = (1.0 + cos((*nextState)->angularPosition)) / 2.0;
+            nextState->isTerminal = 0;
+            *reward = (1.0 + cos(nextState->angularPosition)) / 2.0;
         }
     }
 
-    return (*nextState)->isTerminal;
+    return nextState->isTerminal;
+
+}
+
+
+char nextStateRewardWithContext(model_context* context, state* s, double* a, state** nextState, double* reward) {
+
+    *nextState = (state*)calloc(1, sizeof(state));
+
+    return nextStateRewardIntoWithContext(context, s, a, *nextState, reward);
+
+}
+
+
+/* The arithmetic of nextStateRewardInto on n states stored as arrays, without branches so that it can be vectorized. The arrays must not overlap. */
+
+static void accelerateBatch(model_context* context, unsigned int n, const double* restrict actions, const double* restrict xPosition, const double* restrict xVelocity, const double* restrict angularPosition, const double* restrict angularVelocity, const double* restrict cosAngle, const double* restrict sinAngle, double* restrict nextXPosition, double* restrict nextXVelocity, double* restrict nextAngularPosition, double* restrict nextAngularVelocity) {
+
+    double a11 = (4.0 * context->parameters[2]) / 3.0;
+    double a22 = -(context->parameters[3] + context->parameters[4]);
+    double poleFactor = context->parameters[2] * context->parameters[4];
+    double gravity = context->parameters[0];
+    double cartFriction = context->parameters[5];
+    double poleFriction = context->parameters[6];
+    double maxAcceleration = context->parameters[7];
+    double maxVelocity = context->parameters[8];
+    double maxAngularVelocity = context->parameters[9];
+    double timeStep = context->timeStep;
+    unsigned int i = 0;
+
+    for(; i < n; i++) {
+        double force = ((maxAcceleration + maxAcceleration) * actions[i * NUMBER_OF_DIMENSIONS_OF_ACTION]) - maxAcceleration;
+        double a12 = -cosAngle[i];
+        double a21 = poleFactor * cosAngle[i];
+        double b1 = gravity * sinAngle[i] - ((poleFriction * angularVelocity[i]) / poleFactor);
+        double b2 = (poleFactor * angularVelocity[i] * angularVelocity[i] * sinAngle[i]) - force + (xVelocity[i] == 0 ? 0: (xVelocity[i] > 0.0 ? -cartFriction : cartFriction));
+        double angularAcceleration = ((b2 * a12) - (a22 * b1)) / ((a12 * a21) - (a11 * a22));
+        double xAcceleration = (b1 - (a11 * angularAcceleration)) / a12;
+        double newAngularVelocity = angularVelocity[i] + (timeStep * angularAcceleration);
+        double newXVelocity = xVelocity[i] + (timeStep * xAcceleration);
+
+        newAngularVelocity = fabs(newAngularVelocity) > maxAngularVelocity ? (newAngularVelocity > 0.0 ? maxAngularVelocity : - maxAngularVelocity) : newAngularVelocity;
+        newXVelocity = fabs(newXVelocity) > maxVelocity ? (newXVelocity > 0.0 ? maxVelocity : - maxVelocity) : newXVelocity;
+
+        nextAngularVelocity[i] = newAngularVelocity;
+        nextXVelocity[i] = newXVelocity;
+        nextAngularPosition[i] = angularPosition[i] + (timeStep * newAngularVelocity);
+        nextXPosition[i] = xPosition[i] + (timeStep * newXVelocity);
+    }
+
+}
+
+
+/* Batched version of nextStateRewardInto. The next states are computed for every state, then the ones of the terminal states are discarded. */
+
+void nextStateRewardBatchWithContext(model_context* context, state_batch* batch, unsigned int n, double* actions, double* rewards, char* isTerminal) {
+
+    unsigned int i = 0;
+
+    for(i = 0; i < n; i++) {
+        batch->cosAngle[i] = cos(batch->angularPosition[i]);
+        batch->sinAngle[i] = sin(batch->angularPosition[i]);
+    }
+
+    accelerateBatch(context, n, actions, batch->xPosition, batch->xVelocity, batch->angularPosition, batch->angularVelocity, batch->cosAngle, batch->sinAngle, batch->nextXPosition, batch->nextXVelocity, batch->nextAngularPosition, batch->nextAngularVelocity);
+
+    for(i = 0; i < n; i++) {
+        if(batch->isTerminal[i]) {
+            rewards[i] = 0.0;
+        } else {
+            double angularPosition = batch->nextAngularPosition[i];
+
+            if(angularPosition > (2.0 * M_PIl))
+                angularPosition = angularPosition - (2.0 * M_PIl);
+            if(angularPosition < 0.0)
+                angularPosition = angularPosition + (2.0 * M_PIl);
+
+            batch->xPosition[i] = batch->nextXPosition[i];
+            batch->xVelocity[i] = batch->nextXVelocity[i];
+            batch->angularPosition[i] = angularPosition;
+            batch->angularVelocity[i] = batch->nextAngularVelocity[i];
+
+            if(fabs(batch->xPosition[i]) > context->parameters[1]) {
+                batch->isTerminal[i] = -1;
+                rewards[i] = 0.0;
+            } else {
+                rewards[i] = (1.0 + cos(angularPosition)) / 2.0;
+            }
+        }
+
+        isTerminal[i] = batch->isTerminal[i];
+    }
+
+}
+
+
+/* Multi-action version of nextStateRewardInto. Nothing is shared between the actions for this model. */
+
+void nextStateRewardMultiWithContext(model_context* context, state* s, unsigned int k, double* actions, state** nextStates, double* rewards, char* isTerminal) {
+
+    unsigned int i = 0;
+
+    for(; i < k; i++)
+        isTerminal[i] = nextStateRewardIntoWithContext(context, s, actions + (i * NUMBER_OF_DIMENSIONS_OF_ACTION), nextStates[i], rewards + i);
+
+}
+
+
+/* Returns an allocated batch of n states, each a copy of s. The fields and the scratch space share one allocation. */
+
+state_batch* initStateBatch(unsigned int n, state* s) {
+
+    state_batch* batch = (state_batch*)malloc(sizeof(state_batch));
+    double* fields = (double*)malloc(sizeof(double) * 10 * n);
+    unsigned int i = 0;
+
+    batch->xPosition = fields;
+    batch->xVelocity = fields + n;
+    batch->angularPosition = fields + (2 * n);
+    batch->angularVelocity = fields + (3 * n);
+    batch->nextXPosition = fields + (4 * n);
+    batch->nextXVelocity = fields + (5 * n);
+    batch->nextAngularPosition = fields + (6 * n);
+    batch->nextAngularVelocity = fields + (7 * n);
+    batch->cosAngle = fields + (8 * n);
+    batch->sinAngle = fields + (9 * n);
+    batch->isTerminal = (char*)malloc(sizeof(char) * n);
+
+    for(; i < n; i++)
+        setStateOfBatch(batch, i, s);
+
+    return batch;
+
+}
+
+
+/* Copies s into the i-th state of the batch. */
+
+void setStateOfBatch(state_batch* batch, unsigned int i, state* s) {
+
+    batch->xPosition[i] = s->xPosition;
+    batch->xVelocity[i] = s->xVelocity;
+    batch->angularPosition[i] = s->angularPosition;
+    batch->angularVelocity[i] = s->angularVelocity;
+    batch->isTerminal[i] = s->isTerminal;
+
+}
+
+
+/* Copies the i-th state of the batch into s. */
+
+void getStateOfBatch(state_batch* batch, unsigned int i, state* s) {
+
+    s->xPosition = batch->xPosition[i];
+    s->xVelocity = batch->xVelocity[i];
+    s->angularPosition = batch->angularPosition[i];
+    s->angularVelocity = batch->angularVelocity[i];
+    s->isTerminal = batch->isTerminal[i];
+
+}
+
+
+/* Free the batch */
+
+void freeStateBatch(state_batch* batch) {
+
+    free(batch->xPosition);
+    free(batch->isTerminal);
+    free(batch);
 
 }
 
@@ -227,7 +408,7 @@ char nextStateReward(state* s, double* a, state** nextState,double* reward) {
 
 state* copyState(state* s) {
 
-    state* newState = (state*)malloc(sizeof(state));
+    state* newState = (state*)calloc(1, sizeof(state));
     memcpy(newState, s, sizeof(state));
 
     return newState;
@@ -45,4 +45,18 @@ struct state {
     char isTerminal;
 };
 
+struct state_batch {
+    double* xPosition;
+    double* xVelocity;
+    double* angularPosition;
+    double* angularVelocity;
+    char* isTerminal;
+    double* nextXPosition;          /* Scratch space of the transitions, from here on */
+    double* nextXVelocity;
+    double* nextAngularPosition;
+    double* nextAngularVelocity;
+    double* cosAngle;
+    double* sinAngle;
+};
+
 #endif
@@ -137,12 +137,12 @@ void freeGenerativeModelParameters() {
 
 
 /* Returns an allocated state initialized from the parsed string */
-state* makeState(const char* str) {
+state* makeStateWithContext(model_context* context, const char* str) {
 
     char* end = NULL;
     char* crt = (char*)str;
     char tmp[255];    
-    state* s = (state*)malloc(sizeof(state));
+    state* s = (state*)calloc(1, sizeof(state));
 
     end = strchr(str, ',');
     memcpy(tmp, crt, end - crt);
@@ -188,8 +188,8 @@ state* makeState(const char* str) {
 
     s->angularVelocity2 = strtod(crt, NULL);
 
-    if((s->xPosition2 <= s->xPosition1) || (fabs(s->xPosition2 - s->xPosition1) < parameters[14]) || (fabs(s->xPosition2 - s->xPosition1) > parameters[15]))
-        s->xPosition2 = s->xPosition1 + parameters[14] + 0.01;
+    if((s->xPosition2 <= s->xPosition1) || (fabs(s->xPosition2 - s->xPosition1) < context->parameters[14]) || (fabs(s->xPosition2 - s->xPosition1) > context->parameters[15]))
+        s->xPosition2 = s->xPosition1 + context->parameters[14] + 0.01;
 
     if((s->xVelocity1 > 0.0) && (s->xVelocity2 < 0.0))
         s->xVelocity2 = s->xVelocity1;
@@ -203,16 +203,16 @@ state* makeState(const char* str) {
 
 /* Returns an allocated initial state of the model. */
 
-state* initState() {
+state* initStateWithContext(model_context* context) {
 
-    state* initial = (state*)malloc(sizeof(state));
+    state* initial = (state*)calloc(1, sizeof(state));
 
     initial->xPosition1 = 0.0;
     initial->angularPosition1 = M_PIl;
     initial->xVelocity1 = 0.0;
     initial->angularVelocity1 = 0.0;
 
-    initial->xPosition2 = initial->xPosition1 + parameters[14] + 0.01;
+    initial->xPosition2 = initial->xPosition1 + context->parameters[14] + 0.01;
     initial->angularPosition2 = M_PIl;
     initial->xVelocity2 = 0.0;
     initial->angularVelocity2 = 0.0;
@@ -224,74 +224,168 @@ state* initState() {
 }
 
 
-char nextStateReward(state* s, double* a, state** nextState,double* reward) {
+/* Returns the size in bytes of a state. */
 
-    *nextState = copyState(s);
+size_t stateSize() {
+
+    return sizeof(state);
+
+}
+
+
+/* Writes into nextState the next state given the current state and action and returns the reward. nextState must not be s. */
+
+char nextStateRewardIntoWithContext(model_context* context, state* s, double* a, state* nextState, double* reward) {
+
+    memcpy(nextState, s, sizeof(state));
     *reward = 0.0;
 
-    if(!(*nextState)->isTerminal) {
-        double a11_1 = (4.0 * parameters[2]) / 3.0;
-        double a22_1 = -(parameters[4] + parameters[6]);
-        double a11_2 = (4.0 * parameters[3]) / 3.0;
-        double a22_2 = -(parameters[5] + parameters[7]);
-        double xForce = (((parameters[16] + parameters[16]) * a[0]) - parameters[16]) - (parameters[12] * (parameters[13] - fabs((*nextState)->xPosition2 - (*nextState)->xPosition1)));
-        double a12 = -cos((*nextState)->angularPosition1);
-        double a21 = parameters[2] * parameters[6] * cos((*nextState)->angularPosition1);
-        double b1 = parameters[0] * sin((*nextState)->angularPosition1) - ((parameters[10] * (*nextState)->angularVelocity1) / (parameters[2] * parameters[6]));
-        double b2 = (parameters[2] * parameters[6] * (*nextState)->angularVelocity1 * (*nextState)->angularVelocity1 * sin((*nextState)->angularPosition1)) - xForce + ((*nextState)->xVelocity1 > 0.0 ? -parameters[8] : parameters[8]);
+    if(!nextState->isTerminal) {
+        double a11_1 = (4.0 * context->parameters[2]) / 3.0;
+        double a22_1 = -(context->parameters[4] + context->parameters[6]);
+        double a11_2 = (4.0 * context->parameters[3]) / 3.0;
+        double a22_2 = -(context->parameters[5] + context->parameters[7]);
+        double xForce = (((context->parameters[16] + context->parameters[16]) * a[0]) - context->parameters[16]) - (context->parameters[12] * (context->parameters[13] - fabs(nextState->xPosition2 - nextState->xPosition1)));
+        double a12 = -cos(nextState->angularPosition1);
+        double a21 = context->parameters[2] * context->parameters[6] * cos(nextState->angularPosition1);
+        double b1 = context->parameters[0] * sin(nextState->angularPosition1) - ((context->parameters[10] * nextState->angularVelocity1) / (context->parameters[2] * context->parameters[6]));
+        double b2 = (context->parameters[2] * context->parameters[6] * nextState->angularVelocity1 * nextState->angularVelocity1 * sin(nextState->angularPosition1)) - xForce + (nextState->xVelocity1 > 0.0 ? -context->parameters[8] : context->parameters[8]);
 
         double angularAcceleration1 = ((b2 * a12) - (a22_1 * b1)) / ((a12 * a21) - (a11_1 * a22_1));
         double xAcceleration1 = (b1 - (a11_1 * angularAcceleration1)) / a12;
 
-        (*nextState)->angularVelocity1 = (*nextState)->angularVelocity1 + (timeStep * angularAcceleration1);
-        if(fabs((*nextState)->angularVelocity1) > parameters[20])
-            (*nextState)->angularVelocity1 = (*nextState)->angularVelocity1 > 0.0 ? parameters[20] : - parameters[20];
+        nextState->angularVelocity1 = nextState->angularVelocity1 + (context->timeStep * angularAcceleration1);
+        if(fabs(nextState->angularVelocity1) > context->parameters[20])
+            nextState->angularVelocity1 = nextState->angularVelocity1 > 0.0 ? context->parameters[20] : - context->parameters[20];
 
-        (*nextState)->xVelocity1 = (*nextState)->xVelocity1 + (timeStep * xAcceleration1);
-        if(fabs((*nextState)->xVelocity1) > parameters[18])
-            (*nextState)->xVelocity1 = (*nextState)->xVelocity1 > 0.0 ? parameters[18] : - parameters[18];
+        nextState->xVelocity1 = nextState->xVelocity1 + (context->timeStep * xAcceleration1);
+        if(fabs(nextState->xVelocity1) > context->parameters[18])
+            nextState->xVelocity1 = nextState->xVelocity1 > 0.0 ? context->parameters[18] : - context->parameters[18];
 
-        (*nextState)->angularPosition1 = (*nextState)->angularPosition1 + (timeStep * (*nextState)->angularVelocity1);
-        if((*nextState)->angularPosition1 > (2.0 * M_PIl))
-            (*nextState)->angularPosition1 = (*nextState)->angularPosition1 - (2.0 * M_PIl);
-        if((*nextState)->angularPosition1 < 0.0)
-            (*nextState)->angularPosition1 = (*nextState)->angularPosition1 + (2.0 * M_PIl);
+        nextState->angularPosition1 = nextState->angularPosition1 + (context->timeStep * nextState->angularVelocity1);
+        if(nextState->angularPosition1 > (2.0 * M_PIl))
+            nextState->angularPosition1 = nextState->angularPosition1 - (2.0 * M_PIl);
+        if(nextState->angularPosition1 < 0.0)
+            nextState->angularPosition1 = nextState->angularPosition1 + (2.0 * M_PIl);
 
-        (*nextState)->xPosition1 = (*nextState)->xPosition1 + (timeStep * (*nextState)->xVelocity1);
+        nextState->xPosition1 = nextState->xPosition1 + (context->timeStep * nextState->xVelocity1);
 
 
-        xForce = (((parameters[17] + parameters[17]) * a[1]) - parameters[17]) + (parameters[12] * (parameters[13] - fabs((*nextState)->xPosition2 - (*nextState)->xPosition1)));
-        a12 = -cos((*nextState)->angularPosition2);
-        a21 = parameters[3] * parameters[7] * cos((*nextState)->angularPosition2);
-        b1 = parameters[0] * sin((*nextState)->angularPosition2) - ((parameters[11] * (*nextState)->angularVelocity2) / (parameters[3] * parameters[7]));
-        b2 = (parameters[3] * parameters[7] * (*nextState)->angularVelocity2 * (*nextState)->angularVelocity2 * sin((*nextState)->angularPosition2)) - xForce + ((*nextState)->xVelocity2 > 0.0 ? -parameters[9] : parameters[9]);
+        xForce = (((context->parameters[17] + context->parameters[17]) * a[1]) - context->parameters[17]) + (context->parameters[12] * (context->parameters[13] - fabs(nextState->xPosition2 - nextState->xPosition1)));
+        a12 = -cos(nextState->angularPosition2);
+        a21 = context->parameters[3] * context->parameters[7] * cos(nextState->angularPosition2);
+        b1 = context->parameters[0] * sin(nextState->angularPosition2) - ((context->parameters[11] * nextState->angularVelocity2) / (context->parameters[3] * context->parameters[7]));
+        b2 = (context->parameters[3] * context->parameters[7] * nextState->angularVelocity2 * nextState->angularVelocity2 * sin(nextState->angularPosition2)) - xForce + (nextState->xVelocity2 > 0.0 ? -context->parameters[9] : context->parameters[9]);
 
         double angularAcceleration2 = ((b2 * a12) - (a22_2 * b1)) / ((a12 * a21) - (a11_2 * a22_2));
         double xAcceleration2 = (b1 - (a11_2 * angularAcceleration2)) / a12;
 
-        (*nextState)->angularVelocity2 = (*nextState)->angularVelocity2 + (timeStep * angularAcceleration2);
-        if(fabs((*nextState)->angularVelocity2) > parameters[20])
-            (*nextState)->angularVelocity2 = (*nextState)->angularVelocity2 > 0.0 ? parameters[20] : - parameters[20];
+        nextState->angularVelocity2 = nextState->angularVelocity2 + (context->timeStep * angularAcceleration2);
+        if(fabs(nextState->angularVelocity2) > context->parameters[20])
+            nextState->angularVelocity2 = nextState->angularVelocity2 > 0.0 ? context->parameters[20] : - context->parameters[20];
 
-        (*nextState)->xVelocity2 = (*nextState)->xVelocity2 + (timeStep * xAcceleration2);
-        if(fabs((*nextState)->xVelocity2) > parameters[18])
-            (*nextState)->xVelocity2 = (*nextState)->xVelocity2 > 0.0 ? parameters[18] : - parameters[18];
+        nextState->xVelocity2 = nextState->xVelocity2 + (context->timeStep * xAcceleration2);
+        if(fabs(nextState->xVelocity2) > context->parameters[18])
+            nextState->xVelocity2 = nextState->xVelocity2 > 0.0 ? context->parameters[18] : - context->parameters[18];
 
-        (*nextState)->angularPosition2 = (*nextState)->angularPosition2 + (timeStep * (*nextState)->angularVelocity2);
-        if((*nextState)->angularPosition2 > (2.0 * M_PIl))
-            (*nextState)->angularPosition2 = (*nextState)->angularPosition2 - (2.0 * M_PIl);
-        if((*nextState)->angularPosition2 < 0.0)
-            (*nextState)->angularPosition2 = (*nextState)->angularPosition2 + (2.0 * M_PIl);
+        nextState->angularPosition2 = nextState->angularPosition2 + (context->timeStep * nextState->angularVelocity2);
+        if(nextState->angularPosition2 > (2.0 * M_PIl))
+            nextState->angularPosition2 = nextState->angularPosition2 - (2.0 * M_PIl);
+        if(nextState->angularPosition2 < 0.0)
+            nextState->angularPosition2 = nextState->angularPosition2 + (2.0 * M_PIl);
 
-        (*nextState)->xPosition2 = (*nextState)->xPosition2 + (timeStep * (*nextState)->xVelocity2);
+        nextState->xPosition2 = nextState->xPosition2 + (context->timeStep * nextState->xVelocity2);
 
-        if((fabs((*nextState)->xPosition1) >= parameters[1]) || (fabs((*nextState)->xPosition2) >= parameters[1]) || ((*nextState)->xPosition2 <= (*nextState)->xPosition1) || (fabs((*nextState)->xPosition2 - (*nextState)->xPosition1) < parameters[14]) || (fabs((*nextState)->xPosition2 - (*nextState)->xPosition1) > parameters[15]))
-            (*nextState)->isTerminal = -1;
+        if((fabs(nextState->xPosition1) >= context->parameters[1]) || (fabs(nextState->xPosition2) >= context->parameters[1]) || (nextState->xPosition2 <= nextState->xPosition1) || (fabs(nextState->xPosition2 - nextState->xPosition1) < context->parameters[14]) || (fabs(nextState->xPosition2 - nextState->xPosition1) > context->parameters[15]))
+            nextState->isTerminal = -1;
         else
-            *reward = ((1.0 + cos((*nextState)->angularPosition1)) / 4.0) + ((1.0 + cos((*nextState)->angularPosition2)) / 4.0);
+            *reward = ((1.0 + cos(nextState->angularPosition1)) / 4.0) + ((1.0 + cos(nextState->angularPosition2)) / 4.0);
     }
 
-    return (*nextState)->isTerminal;
+    return nextState->isTerminal;
+
+}
+
+
+char nextStateRewardWithContext(model_context* context, state* s, double* a, state** nextState, double* reward) {
+
+    *nextState = (state*)calloc(1, sizeof(state));
+
+    return nextStateRewardIntoWithContext(context, s, a, *nextState, reward);
+
+}
+
+
+/* Multi-action version of nextStateRewardInto. Nothing is shared between the actions for this model. */
+
+void nextStateRewardMultiWithContext(model_context* context, state* s, unsigned int k, double* actions, state** nextStates, double* rewards, char* isTerminal) {
+
+    unsigned int i = 0;
+
+    for(; i < k; i++)
+        isTerminal[i] = nextStateRewardIntoWithContext(context, s, actions + (i * NUMBER_OF_DIMENSIONS_OF_ACTION), nextStates[i], rewards + i);
+
+}
+
+
+/* Batched version of nextStateRewardInto. The states are stepped one by one through nextStateRewardInto. */
+
+void nextStateRewardBatchWithContext(model_context* context, state_batch* batch, unsigned int n, double* actions, double* rewards, char* isTerminal) {
+
+    state nextState;
+    unsigned int i = 0;
+
+    memset(&nextState, 0, sizeof(state));
+
+    for(; i < n; i++) {
+        isTerminal[i] = nextStateRewardIntoWithContext(context, batch->states + i, actions + (i * NUMBER_OF_DIMENSIONS_OF_ACTION), &nextState, rewards + i);
+        memcpy(batch->states + i, &nextState, sizeof(state));
+    }
+
+}
+
+
+/* Returns an allocated batch of n states, each a copy of s. */
+
+state_batch* initStateBatch(unsigned int n, state* s) {
+
+    state_batch* batch = (state_batch*)malloc(sizeof(state_batch));
+    unsigned int i = 0;
+
+    batch->states = (state*)calloc(n, sizeof(state));
+
+    for(; i < n; i++)
+        memcpy(batch->states + i, s, sizeof(state));
+
+    return batch;
+
+}
+
+
+/* Copies s into the i-th state of the batch. */
+
+void setStateOfBatch(state_batch* batch, unsigned int i, state* s) {
+
+    memcpy(batch->states + i, s, sizeof(state));
+
+}
+
+
+/* Copies the i-th state of the batch into s. */
+
+void getStateOfBatch(state_batch* batch, unsigned int i, state* s) {
+
+    memcpy(s, batch->states + i, sizeof(state));
+
+}
+
+
+/* Free the batch */
+
+void freeStateBatch(state_batch* batch) {
+
+    free(batch->states);
+    free(batch);
 
 }
 
@@ -300,7 +394,7 @@ char nextStateReward(state* s, double* a, state** nextState,double* reward) {
 
 state* copyState(state* s) {
 
-    state* nextState = (state*)malloc(sizeof(state));
+    state* nextState = (state*)calloc(1, sizeof(state));
     memcpy(nextState, s, sizeof(state));
 
     return nextState;
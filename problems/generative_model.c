@@ -0,0 +1,155 @@
+/* Copyright or © or Copr. 2012, Jean-François Hren
+ *
+ * Author e-mail: jean-francois.hren@inria.fr
+ *
+ * This software is a computer program whose purpose is to control
+ * deterministic systems using optimistic planning.
+ *
+ * This software is governed by the CeCILL license under French law and
+ * abiding by the rules of distribution of free software.  You can  use, 
+ * modify and/ or redistribute the software under the terms of the CeCILL
+ * license as circulated by CEA, CNRS and INRIA at the following URL
+ * "http://www.cecill.info". 
+ *
+ * As a counterpart to the access to the source code and  rights to copy,
+ * modify and redistribute granted by the license, users are provided only
+ * with a limited warranty  and the software's author,  the holder of the
+ * economic rights,  and the successive licensors  have only  limited
+ * liability. 
+ *
+ * In this respect, the user's attention is drawn to the risks associated
+ * with loading,  using,  modifying and/or developing or reproducing the
+ * software by the user in light of its specific status of free software,
+ * that may mean  that it is complicated to manipulate,  and  that  also
+ * therefore means  that it is reserved for developers  and  experienced
+ * professionals having in-depth computer knowledge. Users are therefore
+ * encouraged to load and test the software's suitability as regards their
+ * requirements in conditions enabling the security of their systems and/or 
+ * data to be ensured and,  more generally, to use and operate it in the 
+ * same conditions as regards security. 
+ *
+ * The fact that you are presently reading this means that you have had
+ * knowledge of the CeCILL license and that you accept its terms.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "generative_model.h"
+
+static unsigned long modelSeed = 0;                 /* The seed of the random draws of the model, 0 for the clock */
+
+/*+-------------------------------------------+
+  | Functions working on the default context, |
+  | that is on the globals of the model.      |
+  +-------------------------------------------+*/
+
+/* Returns an allocated context holding a copy of the default parameters. To call after parameters initialisation. */
+
+model_context* initModelContext() {
+
+    model_context* context = (model_context*)malloc(sizeof(model_context));
+
+    context->timeStep = timeStep;
+    context->nbParameters = nbParameters;
+    context->parameters = (double*)malloc(sizeof(double) * nbParameters);
+    memcpy(context->parameters, parameters, sizeof(double) * nbParameters);
+
+    return context;
+
+}
+
+
+/* Free the context */
+
+void freeModelContext(model_context* context) {
+
+    free(context->parameters);
+    free(context);
+
+}
+
+
+/* Seeds the random draws of the model. 0 seeds them from the clock. */
+
+void setModelSeed(unsigned long seed) {
+
+    modelSeed = seed;
+
+}
+
+
+/* Returns the seed given to setModelSeed, or the clock if there was none. */
+
+unsigned long getModelSeed() {
+
+    return modelSeed != 0 ? modelSeed : (unsigned long)time(NULL);
+
+}
+
+
+/* Returns an allocated initial state of the model. */
+
+state* initState() {
+
+    model_context context = {timeStep, parameters, nbParameters};
+
+    return initStateWithContext(&context);
+
+}
+
+
+/* Returns an allocated state initialized from the parsed string */
+
+state* makeState(const char* str) {
+
+    model_context context = {timeStep, parameters, nbParameters};
+
+    return makeStateWithContext(&context, str);
+
+}
+
+
+/* Returns the state and the reward given the current state and action. */
+
+char nextStateReward(state* s, double* a, state** nextState, double* reward) {
+
+    model_context context = {timeStep, parameters, nbParameters};
+
+    return nextStateRewardWithContext(&context, s, a, nextState, reward);
+
+}
+
+
+/* Same as nextStateReward but writes the next state into the caller-allocated nextState, which must not be s. */
+
+char nextStateRewardInto(state* s, double* a, state* nextState, double* reward) {
+
+    model_context context = {timeStep, parameters, nbParameters};
+
+    return nextStateRewardIntoWithContext(&context, s, a, nextState, reward);
+
+}
+
+
+/* Same as k calls to nextStateRewardInto from the same state s. */
+
+void nextStateRewardMulti(state* s, unsigned int k, double* actions, state** nextStates, double* rewards, char* isTerminal) {
+
+    model_context context = {timeStep, parameters, nbParameters};
+
+    nextStateRewardMultiWithContext(&context, s, k, actions, nextStates, rewards, isTerminal);
+
+}
+
+
+/* Same as nextStateRewardInto on each of the first n states of the batch. */
+
+void nextStateRewardBatch(state_batch* batch, unsigned int n, double* actions, double* rewards, char* isTerminal) {
+
+    model_context context = {timeStep, parameters, nbParameters};
+
+    nextStateRewardBatchWithContext(&context, batch, n, actions, rewards, isTerminal);
+
+}
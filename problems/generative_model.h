@@ -35,15 +35,32 @@
 #ifndef GENERATIVE_MODEL_H
 #define GENERATIVE_MODEL_H
 
+#include <stddef.h>
+
 /* Represent a state of the model */
 typedef struct state state;
 
+/* Represent states of the model stored field by field, so that their transitions can be vectorized */
+typedef struct state_batch state_batch;
+
 /*extern unsigned int actionDimensionality;*/           /* The number of dimension making up the action */
 extern double timeStep;                             /* Time step between two state */
 
 extern double* parameters;							/* Model's parameters */
 extern unsigned int nbParameters;					/* Number of model's parameters */
 
+/*+--------------------------------------------+
+  | The parameters of a model. The globals     |
+  | above are the default context, used by the |
+  | functions without a context argument.      |
+  +--------------------------------------------+*/
+
+typedef struct {
+    double timeStep;                                /* Time step between two state */
+    double* parameters;                             /* Model's parameters */
+    unsigned int nbParameters;                      /* Number of model's parameters */
+} model_context;
+
 /* Initialisation of the parameters. To call before anything else.*/
 void initGenerativeModelParameters();
 
@@ -56,6 +73,18 @@ void freeGenerativeModel();
 /* Free the generative model parameters. To call afer everything is finished. */
 void freeGenerativeModelParameters();
 
+/* Returns an allocated context holding a copy of the default parameters. To call after parameters initialisation. */
+model_context* initModelContext();
+
+/* Free the context */
+void freeModelContext(model_context* context);
+
+/* Seeds the random draws of the model, such as random parameters or initial states, so that a run can be replayed. 0, the default, seeds them from the clock. To call before parameters initialisation. */
+void setModelSeed(unsigned long seed);
+
+/* Returns the seed given to setModelSeed, or the clock if there was none. Used by the models. */
+unsigned long getModelSeed();
+
 /* Returns an allocated initial state of the model. */
 state* initState();
 
@@ -65,6 +94,38 @@ state* makeState(const char* str);
 /* Returns the state and the reward given the current state and action. */
 char nextStateReward(state* s, double* a, state** nextState, double* reward);
 
+/* Returns the size in bytes of a state. A state holds no pointer, so a buffer of this size can be filled with memcpy. The states allocated by the model have their padding zeroed and nextStateRewardInto leaves the padding of nextState untouched, so equal states written into zeroed buffers have equal bytes. */
+size_t stateSize();
+
+/* Same as nextStateReward but writes the next state into the caller-allocated nextState, which must not be s. */
+char nextStateRewardInto(state* s, double* a, state* nextState, double* reward);
+
+/* Same as k calls to nextStateRewardInto from the same state s, the i-th action being stored at actions + (i * NUMBER_OF_DIMENSIONS_OF_ACTION). Models share the work depending only on s between the actions. */
+void nextStateRewardMulti(state* s, unsigned int k, double* actions, state** nextStates, double* rewards, char* isTerminal);
+
+/* Returns an allocated batch of n states, each a copy of s. */
+state_batch* initStateBatch(unsigned int n, state* s);
+
+/* Copies s into the i-th state of the batch. */
+void setStateOfBatch(state_batch* batch, unsigned int i, state* s);
+
+/* Copies the i-th state of the batch into the caller-allocated s. */
+void getStateOfBatch(state_batch* batch, unsigned int i, state* s);
+
+/* Same as nextStateRewardInto on each of the first n states of the batch, which are replaced by their next states. The i-th action is stored at actions + (i * NUMBER_OF_DIMENSIONS_OF_ACTION) and the i-th returned value in isTerminal[i]. */
+void nextStateRewardBatch(state_batch* batch, unsigned int n, double* actions, double* rewards, char* isTerminal);
+
+/* Free the batch */
+void freeStateBatch(state_batch* batch);
+
+/* Same as the functions above using the given context instead of the default one. */
+state* initStateWithContext(model_context* context);
+state* makeStateWithContext(model_context* context, const char* str);
+char nextStateRewardWithContext(model_context* context, state* s, double* a, state** nextState, double* reward);
+char nextStateRewardIntoWithContext(model_context* context, state* s, double* a, state* nextState, double* reward);
+void nextStateRewardMultiWithContext(model_context* context, state* s, unsigned int k, double* actions, state** nextStates, double* rewards, char* isTerminal);
+void nextStateRewardBatchWithContext(model_context* context, state_batch* batch, unsigned int n, double* actions, double* rewards, char* isTerminal);
+
 /* Return an allocated copy of the state s */
 state* copyState(state* s);
 
@@ -39,7 +39,6 @@
 #undef __USE_GNU
 #include <string.h>
 #include <gsl/gsl_rng.h>
-#include <time.h>
 
 #include "levitation.h"
 
@@ -71,7 +70,7 @@ unsigned int nbParameters = 11;                 /* Number of model's parameters
 void initGenerativeModelParameters() {
 
     gsl_rng* rng = gsl_rng_alloc(gsl_rng_mt19937);
-    gsl_rng_set(rng, time(NULL));
+    gsl_rng_set(rng, getModelSeed());
     parameters = (double*)malloc(sizeof(double) * nbParameters);
 
     parameters[0] = 0.8;
@@ -96,6 +95,8 @@ void initGenerativeModelParameters() {
 
     parameters[10] = (gsl_rng_uniform(rng) * (parameters[9] - parameters[8])) + parameters[8];
 
+    gsl_rng_free(rng);
+
 }
 
 
@@ -127,12 +128,14 @@ void freeGenerativeModelParameters() {
 
 
 /* Returns an allocated state initialized from the parsed string */
-state* makeState(const char* str) {
+state* makeStateWithContext(model_context* context, const char* str) {
 
     char* end = NULL;
     char* crt = (char*)str;
     char tmp[255];    
-    state* s = (state*)malloc(sizeof(state));
+    state* s = (state*)calloc(1, sizeof(state));
+
+    (void)context;
 
     end = strchr(str, ',');
     memcpy(tmp, crt, end - crt);
@@ -155,20 +158,20 @@ state* makeState(const char* str) {
 
 /* Returns an allocated initial state of the model. */
 
-state* initState() {
+state* initStateWithContext(model_context* context) {
 
     double reward = 0;
-    double a = (15.0 - parameters[5]) / (parameters[6] - parameters[5]) ;
+    double a = (15.0 - context->parameters[5]) / (context->parameters[6] - context->parameters[5]) ;
     unsigned int i = 0;
     state* next = NULL;
-    state* crt = (state*)malloc(sizeof(state));
+    state* crt = (state*)calloc(1, sizeof(state));
 
-    crt->position = parameters[9];
+    crt->position = context->parameters[9];
     crt->velocity = 0.0;
     crt->current = 0.0;
 
-    for(; i < (0.5 / timeStep); i++) {
-        nextStateReward(crt, &a, &next, &reward);
+    for(; i < (0.5 / context->timeStep); i++) {
+        nextStateRewardWithContext(context, crt, &a, &next, &reward);
         free(crt);
         crt = next;
         next = NULL;
@@ -179,28 +182,28 @@ state* initState() {
 }
 
 
-double alpha(state* s) {
+double alpha(model_context* context, state* s) {
 
-    return parameters[7] - (parameters[4] * s->current * s->current / (2.0 * parameters[0] * (parameters[2] + s->position) * (parameters[2] + s->position)));
+    return context->parameters[7] - (context->parameters[4] * s->current * s->current / (2.0 * context->parameters[0] * (context->parameters[2] + s->position) * (context->parameters[2] + s->position)));
 
 }
 
 
-double beta(state* s) {
+double beta(model_context* context, state* s) {
 
-    return s->current * ((parameters[4] * s->velocity) - (parameters[1] * (parameters[2] + s->position) * (parameters[2] + s->position))) / ((parameters[4] * (parameters[2] + s->position)) + (parameters[3] * (parameters[2] + s->position) * (parameters[2] + s->position)));
+    return s->current * ((context->parameters[4] * s->velocity) - (context->parameters[1] * (context->parameters[2] + s->position) * (context->parameters[2] + s->position))) / ((context->parameters[4] * (context->parameters[2] + s->position)) + (context->parameters[3] * (context->parameters[2] + s->position) * (context->parameters[2] + s->position)));
 
 }
 
 
-double gamma(state* s) {
+double gamma(model_context* context, state* s) {
 
-    return (parameters[2] + s->position) / (parameters[4] + (parameters[3] * (parameters[2] + s->position)));
+    return (context->parameters[2] + s->position) / (context->parameters[4] + (context->parameters[3] * (context->parameters[2] + s->position)));
 
 }
 
 
-void RK4OneStep(state* sIn, state* sOut, double h, double u) {
+void RK4OneStep(model_context* context, state* sIn, state* sOut, double h, double u) {
 
     state tmp;
     state k1;
@@ -209,69 +212,255 @@ void RK4OneStep(state* sIn, state* sOut, double h, double u) {
     state k4;
 
     k1.position = sIn->velocity;
-    k1.velocity = alpha(sIn);
-    k1.current = beta(sIn) + (gamma(sIn) * u);
+    k1.velocity = alpha(context, sIn);
+    k1.current = beta(context, sIn) + (gamma(context, sIn) * u);
 
     tmp.position = sIn->position + (k1.position * (h / 2.0));
     tmp.velocity = sIn->velocity + (k1.velocity * (h / 2.0));
     tmp.current = sIn->current + (k1.current * (h / 2.0));
 
     k2.position = tmp.velocity;
-    k2.velocity = alpha(&tmp);
-    k2.current = beta(&tmp) + (gamma(&tmp) * u);
+    k2.velocity = alpha(context, &tmp);
+    k2.current = beta(context, &tmp) + (gamma(context, &tmp) * u);
 
     tmp.position = sIn->position + (k2.position * (h / 2.0));
     tmp.velocity = sIn->velocity + (k2.velocity * (h / 2.0));
     tmp.current = sIn->current + (k2.current * (h / 2.0));
 
     k3.position = tmp.velocity;
-    k3.velocity = alpha(&tmp);
-    k3.current = beta(&tmp) + (gamma(&tmp) * u);
+    k3.velocity = alpha(context, &tmp);
+    k3.current = beta(context, &tmp) + (gamma(context, &tmp) * u);
 
     tmp.position = sIn->position + (k3.position * h);
     tmp.velocity = sIn->velocity + (k3.velocity * h);
     tmp.current = sIn->current + (k3.current * h);
 
     k4.position = tmp.velocity;
-    k4.velocity = alpha(&tmp);
-    k4.current = beta(&tmp) + (gamma(&tmp) * u);
+    k4.velocity = alpha(context, &tmp);
+    k4.current = beta(context, &tmp) + (gamma(context, &tmp) * u);
 
     sOut->position = sIn->position + (h * (k1.position + (2.0 * k2.position) + (2.0 * k3.position) + k4.position) / 6.0);
     sOut->velocity = sIn->velocity + (h * (k1.velocity + (2.0 * k2.velocity) + (2.0 * k3.velocity) + k4.velocity) / 6.0);
     sOut->current = sIn->current + (h * (k1.current + (2.0 * k2.current) + (2.0 * k3.current) + k4.current) / 6.0);
 
-    if(sOut->position > parameters[9]) {
-        sOut->position = parameters[9];
+    if(sOut->position > context->parameters[9]) {
+        sOut->position = context->parameters[9];
         sOut->velocity = 0.0;
-    } else if(sOut->position < parameters[8]) {
-        sOut->position = parameters[8];
+    } else if(sOut->position < context->parameters[8]) {
+        sOut->position = context->parameters[8];
         sOut->velocity = 0.0;
     }
 
 }
 
 
-char nextStateReward(state* s, double* a, state** nextState,double* reward) {
+/* Returns the size in bytes of a state. */
+
+size_t stateSize() {
+
+    return sizeof(state);
+
+}
+
 
-    double realAction = (*a * (parameters[6] - parameters[5])) + parameters[5];
-    *nextState = (state*)malloc(sizeof(state));
+/* Writes into nextState the next state given the current state and action and returns the reward. nextState must not be s. */
 
-    RK4OneStep(s, *nextState, timeStep / 3.0, realAction);
-    RK4OneStep(*nextState, *nextState, timeStep / 3.0, realAction);
-    RK4OneStep(*nextState, *nextState, timeStep / 3.0, realAction);
+char nextStateRewardIntoWithContext(model_context* context, state* s, double* a, state* nextState, double* reward) {
 
-    *reward = 1.0 - (fabs((*nextState)->position - parameters[10]) / (parameters[9] - parameters[8]));
+    double realAction = (*a * (context->parameters[6] - context->parameters[5])) + context->parameters[5];
+
+    RK4OneStep(context, s, nextState, context->timeStep / 3.0, realAction);
+    RK4OneStep(context, nextState, nextState, context->timeStep / 3.0, realAction);
+    RK4OneStep(context, nextState, nextState, context->timeStep / 3.0, realAction);
+
+    *reward = 1.0 - (fabs(nextState->position - context->parameters[10]) / (context->parameters[9] - context->parameters[8]));
 
     return 0;
 
 }
 
 
+char nextStateRewardWithContext(model_context* context, state* s, double* a, state** nextState, double* reward) {
+
+    *nextState = (state*)calloc(1, sizeof(state));
+
+    return nextStateRewardIntoWithContext(context, s, a, *nextState, reward);
+
+}
+
+
+/* Same as alpha, beta and gamma but on plain values, for the batched kernel. */
+
+static double alphaOf(const double* parameters, double position, double current) {
+
+    return parameters[7] - (parameters[4] * current * current / (2.0 * parameters[0] * (parameters[2] + position) * (parameters[2] + position)));
+
+}
+
+
+static double betaOf(const double* parameters, double position, double velocity, double current) {
+
+    return current * ((parameters[4] * velocity) - (parameters[1] * (parameters[2] + position) * (parameters[2] + position))) / ((parameters[4] * (parameters[2] + position)) + (parameters[3] * (parameters[2] + position) * (parameters[2] + position)));
+
+}
+
+
+static double gammaOf(const double* parameters, double position) {
+
+    return (parameters[2] + position) / (parameters[4] + (parameters[3] * (parameters[2] + position)));
+
+}
+
+
+/* RK4OneStep applied in place on n states stored as arrays, without branches so that it can be vectorized. The arrays must not overlap. The positions are clamped in a loop of its own, otherwise the compiler moves the integration of the velocities into the branches of the clamp and no longer vectorizes it. */
+
+static void RK4OneStepBatch(const double* restrict parameters, unsigned int n, double* restrict position, double* restrict velocity, double* restrict current, const double* restrict u, double h) {
+
+    unsigned int i = 0;
+
+    for(i = 0; i < n; i++) {
+        double k1Position = velocity[i];
+        double k1Velocity = alphaOf(parameters, position[i], current[i]);
+        double k1Current = betaOf(parameters, position[i], velocity[i], current[i]) + (gammaOf(parameters, position[i]) * u[i]);
+
+        double tmpPosition = position[i] + (k1Position * (h / 2.0));
+        double tmpVelocity = velocity[i] + (k1Velocity * (h / 2.0));
+        double tmpCurrent = current[i] + (k1Current * (h / 2.0));
+
+        double k2Position = tmpVelocity;
+        double k2Velocity = alphaOf(parameters, tmpPosition, tmpCurrent);
+        double k2Current = betaOf(parameters, tmpPosition, tmpVelocity, tmpCurrent) + (gammaOf(parameters, tmpPosition) * u[i]);
+
+        double k3Position = 0.0;
+        double k3Velocity = 0.0;
+        double k3Current = 0.0;
+
+        double k4Position = 0.0;
+        double k4Velocity = 0.0;
+        double k4Current = 0.0;
+
+        tmpPosition = position[i] + (k2Position * (h / 2.0));
+        tmpVelocity = velocity[i] + (k2Velocity * (h / 2.0));
+        tmpCurrent = current[i] + (k2Current * (h / 2.0));
+
+        k3Position = tmpVelocity;
+        k3Velocity = alphaOf(parameters, tmpPosition, tmpCurrent);
+        k3Current = betaOf(parameters, tmpPosition, tmpVelocity, tmpCurrent) + (gammaOf(parameters, tmpPosition) * u[i]);
+
+        tmpPosition = position[i] + (k3Position * h);
+        tmpVelocity = velocity[i] + (k3Velocity * h);
+        tmpCurrent = current[i] + (k3Current * h);
+
+        k4Position = tmpVelocity;
+        k4Velocity = alphaOf(parameters, tmpPosition, tmpCurrent);
+        k4Current = betaOf(parameters, tmpPosition, tmpVelocity, tmpCurrent) + (gammaOf(parameters, tmpPosition) * u[i]);
+
+        position[i] = position[i] + (h * (k1Position + (2.0 * k2Position) + (2.0 * k3Position) + k4Position) / 6.0);
+        velocity[i] = velocity[i] + (h * (k1Velocity + (2.0 * k2Velocity) + (2.0 * k3Velocity) + k4Velocity) / 6.0);
+        current[i] = current[i] + (h * (k1Current + (2.0 * k2Current) + (2.0 * k3Current) + k4Current) / 6.0);
+    }
+
+    for(i = 0; i < n; i++) {
+        velocity[i] = position[i] > parameters[9] ? 0.0 : velocity[i];
+        velocity[i] = position[i] < parameters[8] ? 0.0 : velocity[i];
+        position[i] = position[i] > parameters[9] ? parameters[9] : position[i];
+        position[i] = position[i] < parameters[8] ? parameters[8] : position[i];
+    }
+
+}
+
+
+/* Batched version of nextStateRewardInto. No state is terminal for this model, so the states are integrated in place. */
+
+void nextStateRewardBatchWithContext(model_context* context, state_batch* batch, unsigned int n, double* actions, double* rewards, char* isTerminal) {
+
+    unsigned int i = 0;
+
+    for(i = 0; i < n; i++)
+        batch->realAction[i] = (actions[i * NUMBER_OF_DIMENSIONS_OF_ACTION] * (context->parameters[6] - context->parameters[5])) + context->parameters[5];
+
+    RK4OneStepBatch(context->parameters, n, batch->position, batch->velocity, batch->current, batch->realAction, context->timeStep / 3.0);
+    RK4OneStepBatch(context->parameters, n, batch->position, batch->velocity, batch->current, batch->realAction, context->timeStep / 3.0);
+    RK4OneStepBatch(context->parameters, n, batch->position, batch->velocity, batch->current, batch->realAction, context->timeStep / 3.0);
+
+    for(i = 0; i < n; i++) {
+        rewards[i] = 1.0 - (fabs(batch->position[i] - context->parameters[10]) / (context->parameters[9] - context->parameters[8]));
+        isTerminal[i] = 0;
+    }
+
+}
+
+
+/* Multi-action version of nextStateRewardInto. Nothing is shared between the actions for this model. */
+
+void nextStateRewardMultiWithContext(model_context* context, state* s, unsigned int k, double* actions, state** nextStates, double* rewards, char* isTerminal) {
+
+    unsigned int i = 0;
+
+    for(; i < k; i++)
+        isTerminal[i] = nextStateRewardIntoWithContext(context, s, actions + (i * NUMBER_OF_DIMENSIONS_OF_ACTION), nextStates[i], rewards + i);
+
+}
+
+
+/* Returns an allocated batch of n states, each a copy of s. The fields and the scratch space share one allocation. */
+
+state_batch* initStateBatch(unsigned int n, state* s) {
+
+    state_batch* batch = (state_batch*)malloc(sizeof(state_batch));
+    double* fields = (double*)malloc(sizeof(double) * 4 * n);
+    unsigned int i = 0;
+
+    batch->position = fields;
+    batch->velocity = fields + n;
+    batch->current = fields + (2 * n);
+    batch->realAction = fields + (3 * n);
+
+    for(; i < n; i++)
+        setStateOfBatch(batch, i, s);
+
+    return batch;
+
+}
+
+
+/* Copies s into the i-th state of the batch. */
+
+void setStateOfBatch(state_batch* batch, unsigned int i, state* s) {
+
+    batch->position[i] = s->position;
+    batch->velocity[i] = s->velocity;
+    batch->current[i] = s->current;
+
+}
+
+
+/* Copies the i-th state of the batch into s. */
+
+void getStateOfBatch(state_batch* batch, unsigned int i, state* s) {
+
+    s->position = batch->position[i];
+    s->velocity = batch->velocity[i];
+    s->current = batch->current[i];
+
+}
+
+
+/* Free the batch */
+
+void freeStateBatch(state_batch* batch) {
+
+    free(batch->position);
+    free(batch);
+
+}
+
+
 /* Returns an allocated copy of the state s */
 
 state* copyState(state* s) {
 
-    state* newState = (state*)malloc(sizeof(state));
+    state* newState = (state*)calloc(1, sizeof(state));
     memcpy(newState, s, sizeof(state));
 
     return newState;
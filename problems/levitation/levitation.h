@@ -43,4 +43,11 @@ struct state {
     double current;
 };
 
+struct state_batch {
+    double* position;
+    double* velocity;
+    double* current;
+    double* realAction;             /* Scratch space of the transitions */
+};
+
 #endif
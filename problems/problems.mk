@@ -4,8 +4,14 @@ CC := gcc
 FLAGS := -W -Wall $(CC_OPTIONS) -ansi -std=c99 -pedantic -Werror
 LIBS := -lm$(if $(USE_SDL), -lSDL -lSDLmain /usr/lib/libSDL_gfx.so) -largtable2
 OBJ_DIR := ../obj
+BIN_DIR := ../bin
+SHARED_LIBS := -lm -lgsl -lgslcblas
 
-all: $(addsuffix .o,$(addprefix $(OBJ_DIR)/,$(PROBLEMS))$(if $(USE_SDL), $(addprefix $(OBJ_DIR)/viewer_,$(PROBLEMS)))) $(foreach i,2 3 4 5,$(OBJ_DIR)/swimmer_$i.o$(if $(USE_SDL), $(OBJ_DIR)/viewer_swimmer_$i.o))
+all: $(OBJ_DIR)/generative_model.o $(OBJ_DIR)/registry.o $(addprefix $(BIN_DIR)/problems/,$(addsuffix .so,$(PROBLEMS))) $(foreach i,2 3 4 5,$(BIN_DIR)/problems/$i_swimmer.so) $(addsuffix .o,$(addprefix $(OBJ_DIR)/,$(PROBLEMS))$(if $(USE_SDL), $(addprefix $(OBJ_DIR)/viewer_,$(PROBLEMS)))) $(foreach i,2 3 4 5,$(OBJ_DIR)/swimmer_$i.o $(OBJ_DIR)/swimmer_gsl_$i.o$(if $(USE_SDL), $(OBJ_DIR)/viewer_swimmer_$i.o))
+
+#Swimmers solving their system with GSL whatever their size, to compare with the dedicated LU solver
+$(OBJ_DIR)/swimmer_gsl_%.o: swimmer/swimmer.c swimmer/swimmer.h generative_model.h
+	$(CC) -c $(FLAGS) -DSWIMMER_USE_GSL -DNUMBER_OF_DIMENSIONS_OF_ACTION=$* $< -o $@
 
 $(OBJ_DIR)/swimmer_%.o: swimmer/swimmer.c swimmer/swimmer.h generative_model.h
 	$(CC) -c $(FLAGS) -DNUMBER_OF_DIMENSIONS_OF_ACTION=$* $< -o $@
@@ -13,9 +19,28 @@ $(OBJ_DIR)/swimmer_%.o: swimmer/swimmer.c swimmer/swimmer.h generative_model.h
 $(OBJ_DIR)/viewer_swimmer_%.o: swimmer/viewer_swimmer.c viewer.h
 	$(CC) -c $(FLAGS) -DNUMBER_OF_DIMENSIONS_OF_ACTION=$* $< -o $@
 
+$(OBJ_DIR)/generative_model.o: generative_model.c generative_model.h
+	$(CC) -c $(FLAGS) $< -o $@
+
+$(OBJ_DIR)/registry.o: registry.c registry.h generative_model.h
+	$(CC) -c $(FLAGS) -DPROBLEMS_DIRECTORY=\"$(abspath $(BIN_DIR))/problems\" $< -o $@
+
+#Shared objects loaded by the registry
+$(BIN_DIR)/problems/%_swimmer.so: swimmer/swimmer.c swimmer/swimmer.h generative_model.c generative_model.h
+	$(CC) $(FLAGS) -shared -fPIC -Wl,-Bsymbolic -DNUMBER_OF_DIMENSIONS_OF_ACTION=$* swimmer/swimmer.c generative_model.c $(SHARED_LIBS) -o $@
+
+$(BIN_DIR)/problems/double_cart_pole.so: double_cart_pole/double_cart_pole.c double_cart_pole/double_cart_pole.h generative_model.c generative_model.h
+	$(CC) $(FLAGS) -shared -fPIC -Wl,-Bsymbolic -DNUMBER_OF_DIMENSIONS_OF_ACTION=2 $< generative_model.c $(SHARED_LIBS) -o $@
+
 .SECONDEXPANSION:
+$(OBJ_DIR)/double_cart_pole.o: double_cart_pole/double_cart_pole.c double_cart_pole/double_cart_pole.h generative_model.h
+	$(CC) -c $(FLAGS) -DNUMBER_OF_DIMENSIONS_OF_ACTION=2 $< -o $@
+
 $(OBJ_DIR)/%.o: $$*/$$*.c $$*/$$*.h generative_model.h
-	$(CC) -c $(FLAGS) $< -o $@
+	$(CC) -c $(FLAGS) -DNUMBER_OF_DIMENSIONS_OF_ACTION=1 $< -o $@
 
 $(OBJ_DIR)/viewer_%.o: $$*/viewer_$$*.c viewer.h
 	$(CC) -c $(FLAGS) $< -o $@
+
+$(BIN_DIR)/problems/%.so: $$*/$$*.c $$*/$$*.h generative_model.c generative_model.h
+	$(CC) $(FLAGS) -shared -fPIC -Wl,-Bsymbolic -DNUMBER_OF_DIMENSIONS_OF_ACTION=1 $< generative_model.c $(SHARED_LIBS) -o $@
@@ -0,0 +1,375 @@
+/* Copyright or © or Copr. 2012, Jean-François Hren
+ *
+ * Author e-mail: jean-francois.hren@inria.fr
+ *
+ * This software is a computer program whose purpose is to control
+ * deterministic systems using optimistic planning.
+ *
+ * This software is governed by the CeCILL license under French law and
+ * abiding by the rules of distribution of free software.  You can  use, 
+ * modify and/ or redistribute the software under the terms of the CeCILL
+ * license as circulated by CEA, CNRS and INRIA at the following URL
+ * "http://www.cecill.info". 
+ *
+ * As a counterpart to the access to the source code and  rights to copy,
+ * modify and redistribute granted by the license, users are provided only
+ * with a limited warranty  and the software's author,  the holder of the
+ * economic rights,  and the successive licensors  have only  limited
+ * liability. 
+ *
+ * In this respect, the user's attention is drawn to the risks associated
+ * with loading,  using,  modifying and/or developing or reproducing the
+ * software by the user in light of its specific status of free software,
+ * that may mean  that it is complicated to manipulate,  and  that  also
+ * therefore means  that it is reserved for developers  and  experienced
+ * professionals having in-depth computer knowledge. Users are therefore
+ * encouraged to load and test the software's suitability as regards their
+ * requirements in conditions enabling the security of their systems and/or 
+ * data to be ensured and,  more generally, to use and operate it in the 
+ * same conditions as regards security. 
+ *
+ * The fact that you are presently reading this means that you have had
+ * knowledge of the CeCILL license and that you accept its terms.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <dlfcn.h>
+
+#include "registry.h"
+
+#ifndef PROBLEMS_DIRECTORY
+#define PROBLEMS_DIRECTORY "bin/problems"
+#endif
+
+#define NB_PROBLEMS 9
+
+static const char* names[NB_PROBLEMS] = {"cart_pole", "acrobot", "boat", "levitation", "double_cart_pole", "2_swimmer", "3_swimmer", "4_swimmer", "5_swimmer"};
+static const unsigned int actionDimensions[NB_PROBLEMS] = {1, 1, 1, 1, 2, 2, 3, 4, 5};
+
+static problem problems[NB_PROBLEMS];               /* The problems, filled when loaded */
+static problem* crtProblem = NULL;                  /* The problem used through generative_model.h */
+static model_context* defaultContext = NULL;        /* Context of crtProblem used by the functions without a context */
+
+
+/*+--------------------------------------------+
+  | Loading of the shared object of a problem. |
+  +--------------------------------------------+*/
+
+static char loadSymbol(void* library, const char* name, void* function, size_t size) {
+
+    void* symbol = dlsym(library, name);
+
+    if(symbol == NULL)
+        return 0;
+
+    memcpy(function, &symbol, size);
+
+    return 1;
+
+}
+
+#define LOAD_SYMBOL(p, field, name) loadSymbol((p)->library, name, &((p)->field), sizeof((p)->field))
+
+static char loadProblem(problem* p) {
+
+    char path[1024];
+
+    snprintf(path, sizeof(path), "%s/%s.so", PROBLEMS_DIRECTORY, p->name);
+    p->library = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+
+    if(p->library == NULL) {
+        printf("error: %s\n", dlerror());
+        return 0;
+    }
+
+    if(!LOAD_SYMBOL(p, initGenerativeModelParameters, "initGenerativeModelParameters") ||
+       !LOAD_SYMBOL(p, initGenerativeModel, "initGenerativeModel") ||
+       !LOAD_SYMBOL(p, freeGenerativeModel, "freeGenerativeModel") ||
+       !LOAD_SYMBOL(p, freeGenerativeModelParameters, "freeGenerativeModelParameters") ||
+       !LOAD_SYMBOL(p, initModelContext, "initModelContext") ||
+       !LOAD_SYMBOL(p, freeModelContext, "freeModelContext") ||
+       !LOAD_SYMBOL(p, setModelSeed, "setModelSeed") ||
+       !LOAD_SYMBOL(p, initState, "initStateWithContext") ||
+       !LOAD_SYMBOL(p, makeState, "makeStateWithContext") ||
+       !LOAD_SYMBOL(p, nextStateReward, "nextStateRewardWithContext") ||
+       !LOAD_SYMBOL(p, nextStateRewardInto, "nextStateRewardIntoWithContext") ||
+       !LOAD_SYMBOL(p, nextStateRewardMulti, "nextStateRewardMultiWithContext") ||
+       !LOAD_SYMBOL(p, nextStateRewardBatch, "nextStateRewardBatchWithContext") ||
+       !LOAD_SYMBOL(p, initStateBatch, "initStateBatch") ||
+       !LOAD_SYMBOL(p, setStateOfBatch, "setStateOfBatch") ||
+       !LOAD_SYMBOL(p, getStateOfBatch, "getStateOfBatch") ||
+       !LOAD_SYMBOL(p, freeStateBatch, "freeStateBatch") ||
+       !LOAD_SYMBOL(p, stateSize, "stateSize") ||
+       !LOAD_SYMBOL(p, copyState, "copyState") ||
+       !LOAD_SYMBOL(p, printState, "printState") ||
+       !LOAD_SYMBOL(p, printAction, "printAction") ||
+       !LOAD_SYMBOL(p, freeState, "freeState")) {
+        printf("error: %s\n", dlerror());
+        dlclose(p->library);
+        p->library = NULL;
+        return 0;
+    }
+
+    return 1;
+
+}
+
+
+/* Loads if needed the named problem and makes it the generative model used through generative_model.h. Returns NULL if it is unknown or can not be loaded. */
+
+problem* selectProblem(const char* name) {
+
+    unsigned int i = 0;
+
+    for(; i < NB_PROBLEMS; i++) {
+        if(strcmp(names[i], name) == 0) {
+            problems[i].name = names[i];
+            problems[i].actionDimension = actionDimensions[i];
+
+            if(problems[i].library == NULL && !loadProblem(problems + i))
+                return NULL;
+
+            crtProblem = problems + i;
+
+            return crtProblem;
+        }
+    }
+
+    return NULL;
+
+}
+
+
+/* Prints the name and action dimension of every problem of the registry */
+
+void printProblems() {
+
+    unsigned int i = 0;
+
+    for(; i < NB_PROBLEMS; i++)
+        printf("%s (action dimension %u)\n", names[i], actionDimensions[i]);
+
+}
+
+
+/* Unloads every loaded problem. The generative model of the selected problem has to be freed before. */
+
+void freeProblems() {
+
+    unsigned int i = 0;
+
+    for(; i < NB_PROBLEMS; i++) {
+        if(problems[i].library != NULL) {
+            dlclose(problems[i].library);
+            problems[i].library = NULL;
+        }
+    }
+
+    crtProblem = NULL;
+
+}
+
+
+/*+--------------------------------------------+
+  | The generative model API forwarded to the  |
+  | selected problem.                          |
+  +--------------------------------------------+*/
+
+void initGenerativeModelParameters() {
+
+    crtProblem->initGenerativeModelParameters();
+    defaultContext = crtProblem->initModelContext();
+
+}
+
+
+void initGenerativeModel() {
+
+    crtProblem->initGenerativeModel();
+
+}
+
+
+void freeGenerativeModel() {
+
+    crtProblem->freeGenerativeModel();
+
+}
+
+
+void freeGenerativeModelParameters() {
+
+    crtProblem->freeModelContext(defaultContext);
+    defaultContext = NULL;
+    crtProblem->freeGenerativeModelParameters();
+
+}
+
+
+model_context* initModelContext() {
+
+    return crtProblem->initModelContext();
+
+}
+
+
+void freeModelContext(model_context* context) {
+
+    crtProblem->freeModelContext(context);
+
+}
+
+
+void setModelSeed(unsigned long seed) {
+
+    crtProblem->setModelSeed(seed);
+
+}
+
+
+state* initState() {
+
+    return crtProblem->initState(defaultContext);
+
+}
+
+
+state* makeState(const char* str) {
+
+    return crtProblem->makeState(defaultContext, str);
+
+}
+
+
+char nextStateReward(state* s, double* a, state** nextState, double* reward) {
+
+    return crtProblem->nextStateReward(defaultContext, s, a, nextState, reward);
+
+}
+
+
+size_t stateSize() {
+
+    return crtProblem->stateSize();
+
+}
+
+
+char nextStateRewardInto(state* s, double* a, state* nextState, double* reward) {
+
+    return crtProblem->nextStateRewardInto(defaultContext, s, a, nextState, reward);
+
+}
+
+
+void nextStateRewardMulti(state* s, unsigned int k, double* actions, state** nextStates, double* rewards, char* isTerminal) {
+
+    crtProblem->nextStateRewardMulti(defaultContext, s, k, actions, nextStates, rewards, isTerminal);
+
+}
+
+
+state_batch* initStateBatch(unsigned int n, state* s) {
+
+    return crtProblem->initStateBatch(n, s);
+
+}
+
+
+void setStateOfBatch(state_batch* batch, unsigned int i, state* s) {
+
+    crtProblem->setStateOfBatch(batch, i, s);
+
+}
+
+
+void getStateOfBatch(state_batch* batch, unsigned int i, state* s) {
+
+    crtProblem->getStateOfBatch(batch, i, s);
+
+}
+
+
+void nextStateRewardBatch(state_batch* batch, unsigned int n, double* actions, double* rewards, char* isTerminal) {
+
+    crtProblem->nextStateRewardBatch(defaultContext, batch, n, actions, rewards, isTerminal);
+
+}
+
+
+void freeStateBatch(state_batch* batch) {
+
+    crtProblem->freeStateBatch(batch);
+
+}
+
+
+state* initStateWithContext(model_context* context) {
+
+    return crtProblem->initState(context);
+
+}
+
+
+state* makeStateWithContext(model_context* context, const char* str) {
+
+    return crtProblem->makeState(context, str);
+
+}
+
+
+char nextStateRewardWithContext(model_context* context, state* s, double* a, state** nextState, double* reward) {
+
+    return crtProblem->nextStateReward(context, s, a, nextState, reward);
+
+}
+
+
+char nextStateRewardIntoWithContext(model_context* context, state* s, double* a, state* nextState, double* reward) {
+
+    return crtProblem->nextStateRewardInto(context, s, a, nextState, reward);
+
+}
+
+
+void nextStateRewardMultiWithContext(model_context* context, state* s, unsigned int k, double* actions, state** nextStates, double* rewards, char* isTerminal) {
+
+    crtProblem->nextStateRewardMulti(context, s, k, actions, nextStates, rewards, isTerminal);
+
+}
+
+
+void nextStateRewardBatchWithContext(model_context* context, state_batch* batch, unsigned int n, double* actions, double* rewards, char* isTerminal) {
+
+    crtProblem->nextStateRewardBatch(context, batch, n, actions, rewards, isTerminal);
+
+}
+
+
+state* copyState(state* s) {
+
+    return crtProblem->copyState(s);
+
+}
+
+
+void printState(state* s) {
+
+    crtProblem->printState(s);
+
+}
+
+
+void printAction(double* a) {
+
+    crtProblem->printAction(a);
+
+}
+
+
+void freeState(state* s) {
+
+    crtProblem->freeState(s);
+
+}
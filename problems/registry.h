@@ -0,0 +1,84 @@
+/* Copyright or © or Copr. 2012, Jean-François Hren
+ *
+ * Author e-mail: jean-francois.hren@inria.fr
+ *
+ * This software is a computer program whose purpose is to control
+ * deterministic systems using optimistic planning.
+ *
+ * This software is governed by the CeCILL license under French law and
+ * abiding by the rules of distribution of free software.  You can  use, 
+ * modify and/ or redistribute the software under the terms of the CeCILL
+ * license as circulated by CEA, CNRS and INRIA at the following URL
+ * "http://www.cecill.info". 
+ *
+ * As a counterpart to the access to the source code and  rights to copy,
+ * modify and redistribute granted by the license, users are provided only
+ * with a limited warranty  and the software's author,  the holder of the
+ * economic rights,  and the successive licensors  have only  limited
+ * liability. 
+ *
+ * In this respect, the user's attention is drawn to the risks associated
+ * with loading,  using,  modifying and/or developing or reproducing the
+ * software by the user in light of its specific status of free software,
+ * that may mean  that it is complicated to manipulate,  and  that  also
+ * therefore means  that it is reserved for developers  and  experienced
+ * professionals having in-depth computer knowledge. Users are therefore
+ * encouraged to load and test the software's suitability as regards their
+ * requirements in conditions enabling the security of their systems and/or 
+ * data to be ensured and,  more generally, to use and operate it in the 
+ * same conditions as regards security. 
+ *
+ * The fact that you are presently reading this means that you have had
+ * knowledge of the CeCILL license and that you accept its terms.
+ */
+
+#include "generative_model.h"
+
+#ifndef REGISTRY_H
+#define REGISTRY_H
+
+/*+--------------------------------------------+
+  | A problem of the registry. Its generative  |
+  | model is loaded from <name>.so in the      |
+  | PROBLEMS_DIRECTORY directory.              |
+  +--------------------------------------------+*/
+
+typedef struct {
+    const char* name;                                   /* The name of the problem, e.g. cart_pole or 3_swimmer */
+    unsigned int actionDimension;                       /* The number of dimension making up the action */
+    void* library;                                      /* The handle of the shared object, NULL until loaded */
+
+    void (*initGenerativeModelParameters)();
+    void (*initGenerativeModel)();
+    void (*freeGenerativeModel)();
+    void (*freeGenerativeModelParameters)();
+    model_context* (*initModelContext)();
+    void (*freeModelContext)(model_context* context);
+    void (*setModelSeed)(unsigned long seed);
+    state* (*initState)(model_context* context);
+    state* (*makeState)(model_context* context, const char* str);
+    char (*nextStateReward)(model_context* context, state* s, double* a, state** nextState, double* reward);
+    char (*nextStateRewardInto)(model_context* context, state* s, double* a, state* nextState, double* reward);
+    void (*nextStateRewardMulti)(model_context* context, state* s, unsigned int k, double* actions, state** nextStates, double* rewards, char* isTerminal);
+    void (*nextStateRewardBatch)(model_context* context, state_batch* batch, unsigned int n, double* actions, double* rewards, char* isTerminal);
+    state_batch* (*initStateBatch)(unsigned int n, state* s);
+    void (*setStateOfBatch)(state_batch* batch, unsigned int i, state* s);
+    void (*getStateOfBatch)(state_batch* batch, unsigned int i, state* s);
+    void (*freeStateBatch)(state_batch* batch);
+    size_t (*stateSize)();
+    state* (*copyState)(state* s);
+    void (*printState)(state* s);
+    void (*printAction)(double* a);
+    void (*freeState)(state* s);
+} problem;
+
+/* Loads if needed the named problem and makes it the generative model used through generative_model.h. Returns NULL if it is unknown or can not be loaded. */
+problem* selectProblem(const char* name);
+
+/* Prints the name and action dimension of every problem of the registry */
+void printProblems();
+
+/* Unloads every loaded problem. The generative model of the selected problem has to be freed before. */
+void freeProblems();
+
+#endif
@@ -62,19 +62,26 @@ static int segments = NUMBER_OF_DIMENSIONS_OF_ACTION + 1;
   |                                               |
   +-----------------------------------------------+*/
 
-static double pdMatrix[((NUMBER_OF_DIMENSIONS_OF_ACTION + 1) + 2) * ((NUMBER_OF_DIMENSIONS_OF_ACTION + 1) + 3)];       // (n+2)*(n+3) system: x y Theta_1 ... Theta_n
-static double pdLU[((NUMBER_OF_DIMENSIONS_OF_ACTION + 1) + 2) * ((NUMBER_OF_DIMENSIONS_OF_ACTION + 1) + 2)];           // (n+2)*(n+2) LU decomposition matrix
-static double pdb[(NUMBER_OF_DIMENSIONS_OF_ACTION + 1) + 2];                                                           // (n+2) constant right-hand vector
-static double pdRH[(NUMBER_OF_DIMENSIONS_OF_ACTION + 1) + 2];                                                          // (n+2) right-hand when solving linear system
-static double pdSolution[(NUMBER_OF_DIMENSIONS_OF_ACTION + 1) + 2];                                                    // (n+2) linear system solution
-static double pdADotx[(NUMBER_OF_DIMENSIONS_OF_ACTION + 1) + 1];                                                       // (n+1) Array of x coordinate of joint velocity
-static double pdADoty[(NUMBER_OF_DIMENSIONS_OF_ACTION + 1) + 1];                                                       // (n+1) Array of y corrdinate of joint velocity
-static double pdGDotDotx[(NUMBER_OF_DIMENSIONS_OF_ACTION + 1) + 3];                                                    // (n+3) G acceleration (x)
-static double pdGDotDoty[(NUMBER_OF_DIMENSIONS_OF_ACTION + 1) + 3];                                                    // (n+3) G acceleration (y)
-static double pdADotDotx[((NUMBER_OF_DIMENSIONS_OF_ACTION + 1) + 1) * ((NUMBER_OF_DIMENSIONS_OF_ACTION + 1) + 3)];     // (n+1)*(n+3) equations of joint acceleration (x)
-static double pdADotDoty[((NUMBER_OF_DIMENSIONS_OF_ACTION + 1) + 1) * ((NUMBER_OF_DIMENSIONS_OF_ACTION + 1) + 3)];     // (n+1)*(n+3) equations of joint acceleration (y)
-static double pdfx[((NUMBER_OF_DIMENSIONS_OF_ACTION + 1) + 1) * ((NUMBER_OF_DIMENSIONS_OF_ACTION + 1) + 3)];           // (n+1)*(n+3) equations for internal forces (x)
-static double pdfy[((NUMBER_OF_DIMENSIONS_OF_ACTION + 1) + 1) * ((NUMBER_OF_DIMENSIONS_OF_ACTION + 1) + 3)];           // (n+1)*(n+3) equations for internal forces (y)
+/* Work arrays of a transition. They live on the stack of nextStateRewardMulti so that */
+/* several threads can step swimmers at the same time. */
+
+typedef struct {
+    double pdMatrix[((NUMBER_OF_DIMENSIONS_OF_ACTION + 1) + 2) * ((NUMBER_OF_DIMENSIONS_OF_ACTION + 1) + 3)];       // (n+2)*(n+3) system: x y Theta_1 ... Theta_n
+    double pdLU[((NUMBER_OF_DIMENSIONS_OF_ACTION + 1) + 2) * ((NUMBER_OF_DIMENSIONS_OF_ACTION + 1) + 2)];           // (n+2)*(n+2) LU decomposition matrix
+    double pdb[(NUMBER_OF_DIMENSIONS_OF_ACTION + 1) + 2];                                                           // (n+2) constant right-hand vector
+    double pdRH[(NUMBER_OF_DIMENSIONS_OF_ACTION + 1) + 2];                                                          // (n+2) right-hand when solving linear system
+    double pdSolution[(NUMBER_OF_DIMENSIONS_OF_ACTION + 1) + 2];                                                    // (n+2) linear system solution
+    double pdADotx[(NUMBER_OF_DIMENSIONS_OF_ACTION + 1) + 1];                                                       // (n+1) Array of x coordinate of joint velocity
+    double pdADoty[(NUMBER_OF_DIMENSIONS_OF_ACTION + 1) + 1];                                                       // (n+1) Array of y corrdinate of joint velocity
+    double pdGDotDotx[(NUMBER_OF_DIMENSIONS_OF_ACTION + 1) + 3];                                                    // (n+3) G acceleration (x)
+    double pdGDotDoty[(NUMBER_OF_DIMENSIONS_OF_ACTION + 1) + 3];                                                    // (n+3) G acceleration (y)
+    double pdADotDotx[((NUMBER_OF_DIMENSIONS_OF_ACTION + 1) + 1) * ((NUMBER_OF_DIMENSIONS_OF_ACTION + 1) + 3)];     // (n+1)*(n+3) equations of joint acceleration (x)
+    double pdADotDoty[((NUMBER_OF_DIMENSIONS_OF_ACTION + 1) + 1) * ((NUMBER_OF_DIMENSIONS_OF_ACTION + 1) + 3)];     // (n+1)*(n+3) equations of joint acceleration (y)
+    double pdfx[((NUMBER_OF_DIMENSIONS_OF_ACTION + 1) + 1) * ((NUMBER_OF_DIMENSIONS_OF_ACTION + 1) + 3)];           // (n+1)*(n+3) equations for internal forces (x)
+    double pdfy[((NUMBER_OF_DIMENSIONS_OF_ACTION + 1) + 1) * ((NUMBER_OF_DIMENSIONS_OF_ACTION + 1) + 3)];           // (n+1)*(n+3) equations for internal forces (y)
+    double pdCos[NUMBER_OF_DIMENSIONS_OF_ACTION + 1];                                                               // (n) cosine of the angles
+    double pdSin[NUMBER_OF_DIMENSIONS_OF_ACTION + 1];                                                               // (n) sine of the angles
+} swimmer_workspace;
 
 /* Initialisation of the parameters. To call before anything else.*/
 
@@ -152,14 +159,14 @@ static void getG(state* s, double* Gx, double* Gy) {
 
 
 /* Returns an allocated state initialized from the parsed string */
-state* makeState(const char* str) {
+state* makeStateWithContext(model_context* context, const char* str) {
 
     char* end = NULL;
     char* crt = (char*)str;
     double G[2] = {0.0,0.0};
     char tmp[255];
     int i = 0;
-    state* s = (state*)malloc(sizeof(state));
+    state* s = (state*)calloc(1, sizeof(state));
 
     end = strchr(str, ',');
     memcpy(tmp, crt, end - crt);
@@ -216,9 +223,9 @@ state* makeState(const char* str) {
         if(s->G[i] < 0.0) {
             s->G[i] = 0.0;
             s->AZero[i] = -G[i];
-        } else if (s->G[i] > parameters[6]){
-            s->G[i] = parameters[6];
-            s->AZero[i] = parameters[6] - G[i];
+        } else if (s->G[i] > context->parameters[6]){
+            s->G[i] = context->parameters[6];
+            s->AZero[i] = context->parameters[6] - G[i];
         }
     }   
 
@@ -230,10 +237,12 @@ state* makeState(const char* str) {
 
 /* Returns an allocated initial state of the model. */
 
-state* initState() {
+state* initStateWithContext(model_context* context) {
 
     int i = 0;
-    state* init = (state*)malloc(sizeof(state));
+    state* init = (state*)calloc(1, sizeof(state));
+
+    (void)context;
 
     init->AZero[0] = 0.0;
     init->AZero[1] = 0.0;
@@ -257,69 +266,66 @@ state* initState() {
 }
 
 
-static void computeMatrix(state *x) {
+/*+--------------------------------------------------+
+  | The last column of the system only depends on    |
+  | the velocities, the others only on the angles.   |
+  | computeLeftBlock fills every column but the last |
+  | one and copies the left block in pdLU,           |
+  | computeRightHand fills the last one into pdb.    |
+  +--------------------------------------------------+*/
+
+static void computeLeftBlock(model_context* context, swimmer_workspace* w, state *x) {
 
     int i = 0;
-    const double coeff = 0.5 * parameters[1] / (segments * parameters[1]);
-    double GDotx = 0.0;
-    double GDoty = 0.0;
+    const double coeff = 0.5 * context->parameters[1] / (segments * context->parameters[1]);
+    const int last = segments + 2;
 
     for (i = segments + 3; --i >= 0;) {
-        pdfx[i] = 0.0;
-        pdfy[i] = 0.0;
+        w->pdfx[i] = 0.0;
+        w->pdfy[i] = 0.0;
     }
 
-/*+----------------+
-  |ADot and ADotDot|
-  +----------------+*/
-
-    pdADotx[0] = 0.0;
-    pdADoty[0] = 0.0;
+/*+-------+
+  |ADotDot|
+  +-------+*/
 
     for (i = segments + 3; --i >= 0;){
-        pdADotDotx[i] = 0.0;
-        pdADotDoty[i] = 0.0;
-        pdGDotDotx[i] = 0.0;
-        pdGDotDoty[i] = 0.0;
+        w->pdADotDotx[i] = 0.0;
+        w->pdADotDoty[i] = 0.0;
+        w->pdGDotDotx[i] = 0.0;
+        w->pdGDotDoty[i] = 0.0;
     }
 
     for (i = 1; i <= segments; i++) {
-        int j = segments + 3;
+        int j = last;
         double c = cos(x->theta[i - 1]);
         double s = sin(x->theta[i - 1]);
-        double thetaDot = x->thetaDot[i - 1];
         const int line = i * (segments + 3);
         const int prevLine = (i - 1) * (segments + 3);
 
-        pdADotx[i] = pdADotx[i - 1] - parameters[0] * thetaDot * s;
-        pdADoty[i] = pdADoty[i - 1] + parameters[0] * thetaDot * c;
+        w->pdCos[i - 1] = c;
+        w->pdSin[i - 1] = s;
 
         for (; --j >= 0;) {
-            pdADotDotx[line + j] = pdADotDotx[prevLine + j];
-            pdADotDoty[line + j] = pdADotDoty[prevLine + j];
+            w->pdADotDotx[line + j] = w->pdADotDotx[prevLine + j];
+            w->pdADotDoty[line + j] = w->pdADotDoty[prevLine + j];
         }
-        pdADotDotx[line + i + 1] += -parameters[0] * s;
-        pdADotDoty[line + i + 1] += parameters[0] * c;
-        pdADotDotx[line + segments + 2] += parameters[0] * thetaDot * thetaDot * c;
-        pdADotDoty[line + segments + 2] += parameters[0] * thetaDot * thetaDot * s;
-
-        GDotx += coeff * (pdADotx[i - 1] + pdADotx[i]);
-        GDoty += coeff * (pdADoty[i - 1] + pdADoty[i]);
-        for (j = segments + 3; --j >= 0;) {
-            pdGDotDotx[j] += coeff * (pdADotDotx[prevLine + j] + pdADotDotx[line + j]);
-            pdGDotDoty[j] += coeff * (pdADotDoty[prevLine + j] + pdADotDoty[line + j]);
+        w->pdADotDotx[line + i + 1] += -context->parameters[0] * s;
+        w->pdADotDoty[line + i + 1] += context->parameters[0] * c;
+
+        for (j = last; --j >= 0;) {
+            w->pdGDotDotx[j] += coeff * (w->pdADotDotx[prevLine + j] + w->pdADotDotx[line + j]);
+            w->pdGDotDoty[j] += coeff * (w->pdADotDoty[prevLine + j] + w->pdADotDoty[line + j]);
         }
     }
 
     for (i = 0; i <= segments; i++) {
-        int j = segments + 3;
-        pdADotx[i] += x->GDot[0] - GDotx;
-        pdADoty[i] += x->GDot[1] - GDoty;
-        pdADotDotx[i * (segments + 3) + 0] += 1.0;
-        pdADotDoty[i * (segments + 3) + 1] += 1.0;
+        int j = last;
+        w->pdADotDotx[i * (segments + 3) + 0] += 1.0;
+        w->pdADotDoty[i * (segments + 3) + 1] += 1.0;
         for (; --j >= 0;) {
-            pdADotDotx[i * (segments + 3) + j] -= pdGDotDotx[j];
-            pdADotDoty[i * (segments + 3) + j] -= pdGDotDoty[j];
+            w->pdADotDotx[i * (segments + 3) + j] -= w->pdGDotDotx[j];
+            w->pdADotDoty[i * (segments + 3) + j] -= w->pdGDotDoty[j];
         }
     }
 
@@ -328,131 +334,421 @@ static void computeMatrix(state *x) {
   +-------------+*/
 
     for (i = 1; i <= segments; i++) {
-        double c = cos(x->theta[i - 1]);
-        double s = sin(x->theta[i - 1]);
         const int line = i * (segments + 3);
         const int prevLine = (i - 1) * (segments + 3);
-        double F = -parameters[2] * parameters[0] * 0.5 * (-(pdADotx[i] + pdADotx[i - 1]) * s + (pdADoty[i] + pdADoty[i - 1]) * c);
-        int j = segments + 3;
+        int j = last;
 
         for (; --j >= 0;) {
-            pdfx[line + j] = pdfx[prevLine + j] + parameters[1] * 0.5 * (pdADotDotx[line + j] + pdADotDotx[prevLine + j]);
-            pdfy[line + j] = pdfy[prevLine + j] + parameters[1] * 0.5 * (pdADotDoty[line + j] + pdADotDoty[prevLine + j]);
+            w->pdfx[line + j] = w->pdfx[prevLine + j] + context->parameters[1] * 0.5 * (w->pdADotDotx[line + j] + w->pdADotDotx[prevLine + j]);
+            w->pdfy[line + j] = w->pdfy[prevLine + j] + context->parameters[1] * 0.5 * (w->pdADotDoty[line + j] + w->pdADotDoty[prevLine + j]);
         }
-
-        pdfx[line + segments + 2] += -F * s;
-        pdfy[line + segments + 2] += F * c;
     }
 
-/*+--------------------------------------+
-  |Compute the linear system to be solved|
-  +--------------------------------------+*/
+/*+-------------------------------------+
+  |Compute the left block of the system |
+  +-------------------------------------+*/
 
-    for (i = segments + 3; --i >= 0;) {
-        pdMatrix[i] = pdfx[segments * (segments + 3) + i];
-        pdMatrix[i + segments + 3] = pdfy[segments * (segments + 3) + i];
+    for (i = last; --i >= 0;) {
+        w->pdMatrix[i] = w->pdfx[segments * (segments + 3) + i];
+        w->pdMatrix[i + segments + 3] = w->pdfy[segments * (segments + 3) + i];
     }
 
     for (i = 1; i <= segments; i++) {
-        double c = cos(x->theta[i - 1]);
-        double s = sin(x->theta[i - 1]);
-        double thetaDot = x->thetaDot[i - 1];
+        double c = w->pdCos[i - 1];
+        double s = w->pdSin[i - 1];
         int matrixLine = (i + 1) * (segments + 3);
         int line = i * (segments + 3);
         int prevLine = (i - 1) * (segments + 3);
-        int j = segments + 3;
+        int j = last;
 
         for (; --j >= 0;)
-            pdMatrix[matrixLine + j] = parameters[0] * 0.5 * (c * (pdfy[line + j] + pdfy[prevLine + j]) - s * (pdfx[line + j] + pdfx[prevLine + j]));
+            w->pdMatrix[matrixLine + j] = context->parameters[0] * 0.5 * (c * (w->pdfy[line + j] + w->pdfy[prevLine + j]) - s * (w->pdfx[line + j] + w->pdfx[prevLine + j]));
 
-        pdMatrix[matrixLine + segments + 2] += parameters[2] * thetaDot * parameters[0] * parameters[0] * parameters[0] / 12;
-        pdMatrix[matrixLine + i + 1] -= parameters[1] * parameters[0] / 12;
+        w->pdMatrix[matrixLine + i + 1] -= context->parameters[1] * context->parameters[0] / 12;
     }
 
-/*+-----------------------+
-  |LU-Decompose its matrix|
-  +-----------------------+*/
-
     for (i = segments + 2; --i >= 0;) {
         int j = segments + 2;
         for (; --j >= 0;)
-            pdLU[i * (segments + 2) + j] = pdMatrix[i * (segments + 3) + j];
-        pdb[i] = pdMatrix[i * (segments + 3) + segments + 2];
+            w->pdLU[i * (segments + 2) + j] = w->pdMatrix[i * (segments + 3) + j];
     }
 
 }
 
 
-/* Returns a triplet containing the next state, the applied action and the reward given the current state and action. */
+static void computeRightHand(model_context* context, swimmer_workspace* w, state *x) {
+
+    int i = 0;
+    const double coeff = 0.5 * context->parameters[1] / (segments * context->parameters[1]);
+    const int last = segments + 2;
+    double GDotx = 0.0;
+    double GDoty = 0.0;
+
+/*+----------------+
+  |ADot and ADotDot|
+  +----------------+*/
+
+    w->pdADotx[0] = 0.0;
+    w->pdADoty[0] = 0.0;
+
+    w->pdADotDotx[last] = 0.0;
+    w->pdADotDoty[last] = 0.0;
+    w->pdGDotDotx[last] = 0.0;
+    w->pdGDotDoty[last] = 0.0;
+
+    for (i = 1; i <= segments; i++) {
+        double c = w->pdCos[i - 1];
+        double s = w->pdSin[i - 1];
+        double thetaDot = x->thetaDot[i - 1];
+        const int line = i * (segments + 3);
+        const int prevLine = (i - 1) * (segments + 3);
+
+        w->pdADotx[i] = w->pdADotx[i - 1] - context->parameters[0] * thetaDot * s;
+        w->pdADoty[i] = w->pdADoty[i - 1] + context->parameters[0] * thetaDot * c;
+
+        w->pdADotDotx[line + last] = w->pdADotDotx[prevLine + last];
+        w->pdADotDoty[line + last] = w->pdADotDoty[prevLine + last];
+        w->pdADotDotx[line + last] += context->parameters[0] * thetaDot * thetaDot * c;
+        w->pdADotDoty[line + last] += context->parameters[0] * thetaDot * thetaDot * s;
+
+        GDotx += coeff * (w->pdADotx[i - 1] + w->pdADotx[i]);
+        GDoty += coeff * (w->pdADoty[i - 1] + w->pdADoty[i]);
+        w->pdGDotDotx[last] += coeff * (w->pdADotDotx[prevLine + last] + w->pdADotDotx[line + last]);
+        w->pdGDotDoty[last] += coeff * (w->pdADotDoty[prevLine + last] + w->pdADotDoty[line + last]);
+    }
+
+    for (i = 0; i <= segments; i++) {
+        w->pdADotx[i] += x->GDot[0] - GDotx;
+        w->pdADoty[i] += x->GDot[1] - GDoty;
+        w->pdADotDotx[i * (segments + 3) + last] -= w->pdGDotDotx[last];
+        w->pdADotDoty[i * (segments + 3) + last] -= w->pdGDotDoty[last];
+    }
+
+/*+-------------+
+  |Fill f arrays|
+  +-------------+*/
+
+    w->pdfx[last] = 0.0;
+    w->pdfy[last] = 0.0;
+
+    for (i = 1; i <= segments; i++) {
+        double c = w->pdCos[i - 1];
+        double s = w->pdSin[i - 1];
+        const int line = i * (segments + 3);
+        const int prevLine = (i - 1) * (segments + 3);
+        double F = -context->parameters[2] * context->parameters[0] * 0.5 * (-(w->pdADotx[i] + w->pdADotx[i - 1]) * s + (w->pdADoty[i] + w->pdADoty[i - 1]) * c);
+
+        w->pdfx[line + last] = w->pdfx[prevLine + last] + context->parameters[1] * 0.5 * (w->pdADotDotx[line + last] + w->pdADotDotx[prevLine + last]);
+        w->pdfy[line + last] = w->pdfy[prevLine + last] + context->parameters[1] * 0.5 * (w->pdADotDoty[line + last] + w->pdADotDoty[prevLine + last]);
+
+        w->pdfx[line + last] += -F * s;
+        w->pdfy[line + last] += F * c;
+    }
+
+/*+--------------------------------------+
+  |Compute the last column of the system |
+  +--------------------------------------+*/
+
+    w->pdMatrix[last] = w->pdfx[segments * (segments + 3) + last];
+    w->pdMatrix[last + segments + 3] = w->pdfy[segments * (segments + 3) + last];
+
+    for (i = 1; i <= segments; i++) {
+        double c = w->pdCos[i - 1];
+        double s = w->pdSin[i - 1];
+        double thetaDot = x->thetaDot[i - 1];
+        int matrixLine = (i + 1) * (segments + 3);
+        int line = i * (segments + 3);
+        int prevLine = (i - 1) * (segments + 3);
+
+        w->pdMatrix[matrixLine + last] = context->parameters[0] * 0.5 * (c * (w->pdfy[line + last] + w->pdfy[prevLine + last]) - s * (w->pdfx[line + last] + w->pdfx[prevLine + last]));
+        w->pdMatrix[matrixLine + last] += context->parameters[2] * thetaDot * context->parameters[0] * context->parameters[0] * context->parameters[0] / 12;
+    }
+
+    for (i = segments + 2; --i >= 0;)
+        w->pdb[i] = w->pdMatrix[i * (segments + 3) + segments + 2];
+
+}
+
+
+/*+--------------------------------------------------+
+  | Up to 5 dimensions of action the system is small |
+  | enough for a dedicated LU solver. Its size is a  |
+  | compile-time constant so the loops are unrolled  |
+  | and nothing is allocated. Bigger swimmers fall   |
+  | back on GSL, as do all of them when built with   |
+  | SWIMMER_USE_GSL to compare both solvers.         |
+  +--------------------------------------------------+*/
+
+#if (NUMBER_OF_DIMENSIONS_OF_ACTION <= 5) && !defined(SWIMMER_USE_GSL)
+#define USE_FIXED_SIZE_LU
+#endif
+
+#ifdef USE_FIXED_SIZE_LU
+
+#define SYSTEM_SIZE ((NUMBER_OF_DIMENSIONS_OF_ACTION + 1) + 2)
+
+/* In place LU decomposition with partial pivoting of the SYSTEM_SIZE*SYSTEM_SIZE matrix m. */
+/* perm[k] is the line swapped with the line k at the k-th step. */
+
+static void decomposeLU(double* m, int* perm) {
+
+    int k = 0;
+
+    for(; k < SYSTEM_SIZE; k++) {
+        int pivot = k;
+        double max = fabs(m[k * SYSTEM_SIZE + k]);
+        int i = k + 1;
+        int j = 0;
+
+        for(; i < SYSTEM_SIZE; i++) {
+            if(fabs(m[i * SYSTEM_SIZE + k]) > max) {
+                max = fabs(m[i * SYSTEM_SIZE + k]);
+                pivot = i;
+            }
+        }
 
-char nextStateReward(state* s, double* a, state** nextState,double* reward) {
+        perm[k] = pivot;
 
-    *nextState = copyState(s);
+        if(pivot != k) {
+            for(j = 0; j < SYSTEM_SIZE; j++) {
+                double tmp = m[k * SYSTEM_SIZE + j];
+                m[k * SYSTEM_SIZE + j] = m[pivot * SYSTEM_SIZE + j];
+                m[pivot * SYSTEM_SIZE + j] = tmp;
+            }
+        }
+
+        for(i = k + 1; i < SYSTEM_SIZE; i++) {
+            double l = m[i * SYSTEM_SIZE + k] / m[k * SYSTEM_SIZE + k];
+            m[i * SYSTEM_SIZE + k] = l;
+            for(j = k + 1; j < SYSTEM_SIZE; j++)
+                m[i * SYSTEM_SIZE + j] -= l * m[k * SYSTEM_SIZE + j];
+        }
+    }
+
+}
+
+
+/* Solves m.x = b where m and perm come from decomposeLU. b is overwritten. */
+
+static void solveLU(const double* m, const int* perm, double* b, double* x) {
+
+    int i = 0;
+
+    for(; i < SYSTEM_SIZE; i++) {
+        double tmp = b[i];
+        b[i] = b[perm[i]];
+        b[perm[i]] = tmp;
+    }
+
+    for(i = 0; i < SYSTEM_SIZE; i++) {
+        int j = 0;
+        x[i] = b[i];
+        for(; j < i; j++)
+            x[i] -= m[i * SYSTEM_SIZE + j] * x[j];
+    }
+
+    for(i = SYSTEM_SIZE; --i >= 0;) {
+        int j = i + 1;
+        for(; j < SYSTEM_SIZE; j++)
+            x[i] -= m[i * SYSTEM_SIZE + j] * x[j];
+        x[i] /= m[i * SYSTEM_SIZE + i];
+    }
+
+}
+
+#endif
+
+
+/* Returns the size in bytes of a state. */
+
+size_t stateSize() {
+
+    return sizeof(state);
+
+}
+
+
+/* Writes into nextState the next state given the current state and action and returns the reward. nextState must not be s. */
+
+char nextStateRewardIntoWithContext(model_context* context, state* s, double* a, state* nextState, double* reward) {
+
+    char isTerminal = 0;
+
+    nextStateRewardMultiWithContext(context, s, 1, a, &nextState, reward, &isTerminal);
+
+    return isTerminal;
+
+}
+
+
+/* Multi-action version of nextStateRewardInto. The left block of the system only depends on the angles, which evolve */
+/* with the thetaDot of s whatever the action, so it is built and factored once per sub-step and shared by the k actions. */
+
+void nextStateRewardMultiWithContext(model_context* context, state* s, unsigned int k, double* actions, state** nextStates, double* rewards, char* isTerminal) {
+
+    unsigned int j = 0;
+
+    for(; j < k; j++)
+        memcpy(nextStates[j], s, sizeof(state));
 
     if(s->isTerminal < 0) {
-        *reward = 0.0;
+        for(j = 0; j < k; j++) {
+            rewards[j] = 0.0;
+            isTerminal[j] = nextStates[j]->isTerminal;
+        }
     } else {
-        double deltaT = timeStep / 8.0;
+        swimmer_workspace w;
+        double deltaT = context->timeStep / 8.0;
         unsigned int t = 0;
+#ifdef USE_FIXED_SIZE_LU
+        int perm[SYSTEM_SIZE];
+#else
+        int signum = 0;
+        gsl_matrix_view MpdLU = gsl_matrix_view_array(w.pdLU, segments + 2, segments + 2);
+        gsl_permutation *perm = gsl_permutation_alloc(segments + 2);
+        gsl_vector_view vpdRH = gsl_vector_view_array(w.pdRH, segments + 2);
+        gsl_vector_view vpdSolution = gsl_vector_view_array(w.pdSolution, segments + 2);
+#endif
+
         for(; t < 8; t++) {
-            int i = segments + 2;
-        	int signum = 0;
-            gsl_matrix_view MpdLU;
-            gsl_permutation *perm = NULL;
-            gsl_vector_view vpdRH;
-            gsl_vector_view vpdSolution;
-
-            computeMatrix(*nextState);
-
-        	for (; --i >= 0;)
-        		pdRH[i] = pdb[i];
-
-        	for (i = 0; i < segments - 1; i++) {
-        		pdRH[i + 3] -= ((parameters[3] + parameters[3]) * a[i]) - parameters[3];
-	        	pdRH[i + 2] += ((parameters[3] + parameters[3]) * a[i]) - parameters[3];
-	        }
-
-            MpdLU = gsl_matrix_view_array(pdLU, segments + 2, segments + 2);
-            perm = gsl_permutation_alloc(segments + 2);
-            gsl_linalg_LU_decomp(&MpdLU.matrix, perm, &signum);
-            vpdRH = gsl_vector_view_array(pdRH, segments + 2);
-            vpdSolution = gsl_vector_view_array(pdSolution, segments + 2);
-            gsl_linalg_LU_solve(&MpdLU.matrix, perm, &vpdRH.vector, &vpdSolution.vector);
-
-            (*nextState)->G[0] += deltaT * (*nextState)->GDot[0];
-            (*nextState)->G[1] += deltaT * (*nextState)->GDot[1];
-
-            (*nextState)->GDot[0] += deltaT * pdSolution[0];
-            (*nextState)->GDot[1] += deltaT * pdSolution[1];
-
-            for(i = 0; i < segments; i++) {
-                (*nextState)->theta[i] += deltaT * s->thetaDot[i];
-                if((*nextState)->theta[i] > M_PIl)
-                    (*nextState)->theta[i] -= 2 * M_PIl;
-                if((*nextState)->theta[i] < -M_PIl)
-                    (*nextState)->theta[i] += 2 * M_PIl;
-                (*nextState)->thetaDot[i] += deltaT * pdSolution[i + 2];
+            for(j = 0; j < k; j++) {
+                state* nextState = nextStates[j];
+                double* a = actions + (j * NUMBER_OF_DIMENSIONS_OF_ACTION);
+                int i = segments + 2;
+
+                if(j == 0) {
+                    computeLeftBlock(context, &w, nextState);
+#ifdef USE_FIXED_SIZE_LU
+                    decomposeLU(w.pdLU, perm);
+#else
+                    gsl_linalg_LU_decomp(&MpdLU.matrix, perm, &signum);
+#endif
+                }
+
+                computeRightHand(context, &w, nextState);
+
+                for (; --i >= 0;)
+                    w.pdRH[i] = w.pdb[i];
+
+                for (i = 0; i < segments - 1; i++) {
+                    w.pdRH[i + 3] -= ((context->parameters[3] + context->parameters[3]) * a[i]) - context->parameters[3];
+                    w.pdRH[i + 2] += ((context->parameters[3] + context->parameters[3]) * a[i]) - context->parameters[3];
+                }
+
+#ifdef USE_FIXED_SIZE_LU
+                solveLU(w.pdLU, perm, w.pdRH, w.pdSolution);
+#else
+                gsl_linalg_LU_solve(&MpdLU.matrix, perm, &vpdRH.vector, &vpdSolution.vector);
+#endif
+
+                nextState->G[0] += deltaT * nextState->GDot[0];
+                nextState->G[1] += deltaT * nextState->GDot[1];
+
+                nextState->GDot[0] += deltaT * w.pdSolution[0];
+                nextState->GDot[1] += deltaT * w.pdSolution[1];
+
+                for(i = 0; i < segments; i++) {
+                    nextState->theta[i] += deltaT * s->thetaDot[i];
+                    if(nextState->theta[i] > M_PIl)
+                        nextState->theta[i] -= 2 * M_PIl;
+                    if(nextState->theta[i] < -M_PIl)
+                        nextState->theta[i] += 2 * M_PIl;
+                    nextState->thetaDot[i] += deltaT * w.pdSolution[i + 2];
+                }
+
+                nextState->AZero[0] += deltaT * w.pdADotx[0];
+                nextState->AZero[1] += deltaT * w.pdADoty[0];
             }
+        }
+
+#ifndef USE_FIXED_SIZE_LU
+        gsl_permutation_free(perm);
+#endif
 
-            (*nextState)->AZero[0] += deltaT * pdADotx[0];
-            (*nextState)->AZero[1] += deltaT * pdADoty[0];
+        for(j = 0; j < k; j++) {
+            rewards[j] = 1.0 - sqrt(pow(nextStates[j]->G[0] - context->parameters[4],2) + pow(nextStates[j]->G[1] - context->parameters[5],2)) / (context->parameters[6] * sqrt(2.0));
 
-            gsl_permutation_free(perm);
+            if(rewards[j] < 0.0)
+                rewards[j] = 0.0;
+            if(rewards[j] > 1.0)
+                rewards[j] = 1.0;
 
+            isTerminal[j] = nextStates[j]->isTerminal;
         }
+    }
 
-        *reward = 1.0 - sqrt(pow((*nextState)->G[0] - parameters[4],2) + pow((*nextState)->G[1] - parameters[5],2)) / (parameters[6] * sqrt(2.0));
+}
 
-        if(*reward < 0.0)
-            *reward = 0.0;
-        if(*reward > 1.0)
-            *reward = 1.0;
 
+/* Returns a triplet containing the next state, the applied action and the reward given the current state and action. */
+
+char nextStateRewardWithContext(model_context* context, state* s, double* a, state** nextState, double* reward) {
+
+    *nextState = (state*)calloc(1, sizeof(state));
+
+    return nextStateRewardIntoWithContext(context, s, a, *nextState, reward);
+
+}
 
 
+/* Batched version of nextStateRewardInto. The states are stepped one by one through nextStateRewardInto. */
+
+void nextStateRewardBatchWithContext(model_context* context, state_batch* batch, unsigned int n, double* actions, double* rewards, char* isTerminal) {
+
+    state nextState;
+    unsigned int i = 0;
+
+    memset(&nextState, 0, sizeof(state));
+
+    for(; i < n; i++) {
+        isTerminal[i] = nextStateRewardIntoWithContext(context, batch->states + i, actions + (i * NUMBER_OF_DIMENSIONS_OF_ACTION), &nextState, rewards + i);
+        memcpy(batch->states + i, &nextState, sizeof(state));
     }
 
-    return (*nextState)->isTerminal;
+}
+
+
+/* Returns an allocated batch of n states, each a copy of s. */
+
+state_batch* initStateBatch(unsigned int n, state* s) {
+
+    state_batch* batch = (state_batch*)malloc(sizeof(state_batch));
+    unsigned int i = 0;
+
+    batch->states = (state*)calloc(n, sizeof(state));
+
+    for(; i < n; i++)
+        memcpy(batch->states + i, s, sizeof(state));
+
+    return batch;
+
+}
+
+
+/* Copies s into the i-th state of the batch. */
+
+void setStateOfBatch(state_batch* batch, unsigned int i, state* s) {
+
+    memcpy(batch->states + i, s, sizeof(state));
+
+}
+
+
+/* Copies the i-th state of the batch into s. */
+
+void getStateOfBatch(state_batch* batch, unsigned int i, state* s) {
+
+    memcpy(s, batch->states + i, sizeof(state));
+
+}
+
+
+/* Free the batch */
+
+void freeStateBatch(state_batch* batch) {
+
+    free(batch->states);
+    free(batch);
 
 }
 
@@ -461,7 +757,7 @@ char nextStateReward(state* s, double* a, state** nextState,double* reward) {
 
 state* copyState(state* s) {
 
-    state* newState = (state*)malloc(sizeof(state));
+    state* newState = (state*)calloc(1, sizeof(state));
     memcpy(newState, s, sizeof(state));
 
     return newState;
@@ -46,4 +46,8 @@ struct state {
     char isTerminal;
 };
 
+struct state_batch {
+    state* states;                  /* Stepped one by one, nothing being vectorized for this model */
+};
+
 #endif
@@ -0,0 +1,560 @@
+/* Copyright or © or Copr. 2012, Jean-François Hren
+ *
+ * Author e-mail: jean-francois.hren@inria.fr
+ *
+ * This software is a computer program whose purpose is to control
+ * deterministic systems using optimistic planning.
+ *
+ * This software is governed by the CeCILL license under French law and
+ * abiding by the rules of distribution of free software.  You can  use, 
+ * modify and/ or redistribute the software under the terms of the CeCILL
+ * license as circulated by CEA, CNRS and INRIA at the following URL
+ * "http://www.cecill.info". 
+ *
+ * As a counterpart to the access to the source code and  rights to copy,
+ * modify and redistribute granted by the license, users are provided only
+ * with a limited warranty  and the software's author,  the holder of the
+ * economic rights,  and the successive licensors  have only  limited
+ * liability. 
+ *
+ * In this respect, the user's attention is drawn to the risks associated
+ * with loading,  using,  modifying and/or developing or reproducing the
+ * software by the user in light of its specific status of free software,
+ * that may mean  that it is complicated to manipulate,  and  that  also
+ * therefore means  that it is reserved for developers  and  experienced
+ * professionals having in-depth computer knowledge. Users are therefore
+ * encouraged to load and test the software's suitability as regards their
+ * requirements in conditions enabling the security of their systems and/or 
+ * data to be ensured and,  more generally, to use and operate it in the 
+ * same conditions as regards security. 
+ *
+ * The fact that you are presently reading this means that you have had
+ * knowledge of the CeCILL license and that you accept its terms.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include <argtable2.h>
+
+#include "../algorithms/deadline/deadline.h"
+#include "../algorithms/lipschitzian/lipschitzian.h"
+
+#define INITIAL_BOUND 32.0                                  /* The bound of the first subset */
+#define BOUND_STEP (1.0 / 16384.0)                          /* The decreases of the bounds are multiples of this step */
+#define DEEPEN_PROBABILITY (1.0 / 3.0)                      /* The probability that a selection only lowers the bound, without trisecting */
+#define NB_STRUCTURES 3                                     /* The 4-ary heap, a binary heap and the previous tree */
+
+
+/*+------------------------------------------+
+  | A subset as far as the frontier is       |
+  | concerned: its bound, the position it    |
+  | has in a heap and the links it has in    |
+  | the previous tree.                       |
+  +------------------------------------------+*/
+
+typedef struct frontier_node {
+
+    double bound;
+    unsigned int id;                                        /* The order of creation of the subset */
+    unsigned int frontierIndex;                             /* The position of this subset in the heap */
+
+    struct frontier_node* maxBoundedChild;                  /* The maximum bounded subset under this one in the tree */
+    struct frontier_node* father;
+    struct frontier_node* leftChild;
+    struct frontier_node* rightChild;
+
+} frontier_node;
+
+
+/*+------------------------------------------+
+  | One of the structures selecting the      |
+  | maximum bounded subset.                  |
+  +------------------------------------------+*/
+
+typedef struct {
+
+    unsigned int arity;                                     /* The number of children of a node of the heap, 0 for the tree */
+
+    frontier_node* nodes;                                   /* Every subset, in the order of creation */
+    unsigned int nbNodes;
+
+    frontier_node** frontier;                               /* The heap */
+    unsigned int frontierSize;
+    unsigned int maxFrontierSize;
+
+    frontier_node* nextNodeToAppendTo;                      /* Where the tree grows */
+    frontier_node* nextSubsetToDiscretize;                  /* The maximum bounded subset */
+
+} frontier;
+
+
+/*+------------------------------------------+
+  | The heap: the same sift up and sift down |
+  | as the frontier of lipschitzian.c, with  |
+  | the arity read at run time so that       |
+  | FRONTIER_ARITY can be compared with 2.   |
+  +------------------------------------------+*/
+
+/* Among equal bounds, the order of the tree, numbered level by level from the order of creation */
+static char isAbove(frontier_node* a, frontier_node* b) {
+
+    unsigned int nodeA = a->id + 1;
+    unsigned int nodeB = b->id + 1;
+    int depthA = 0;
+    int depthB = 0;
+
+    if(a->bound != b->bound)
+        return a->bound > b->bound;
+
+    depthA = ilogb(nodeA);
+    depthB = ilogb(nodeB);
+
+    if(depthA > depthB)
+        nodeA >>= depthA - depthB;
+    else
+        nodeB >>= depthB - depthA;
+
+    /* One is an ancestor of the other, both nodes being now the older one */
+    if(nodeA == nodeB)
+        return (a->id < b->id) == ((nodeA % 2) == 1);
+
+    /* At the same depth, the greater node is on the right of the first fork */
+    return nodeA > nodeB;
+
+}
+
+
+static void placeInFrontier(frontier* f, frontier_node* node, unsigned int index) {
+
+    f->frontier[index] = node;
+    node->frontierIndex = index;
+
+}
+
+
+static void siftUp(frontier* f, frontier_node* node) {
+
+    unsigned int index = node->frontierIndex;
+
+    while(index > 0) {
+        unsigned int parent = (index - 1) / f->arity;
+
+        if(!isAbove(node, f->frontier[parent]))
+            break;
+
+        placeInFrontier(f, f->frontier[parent], index);
+        index = parent;
+    }
+
+    placeInFrontier(f, node, index);
+
+}
+
+
+static void siftDown(frontier* f, frontier_node* node) {
+
+    unsigned int index = node->frontierIndex;
+
+    for(;;) {
+        unsigned int firstChild = (index * f->arity) + 1;
+        unsigned int lastChild = firstChild + f->arity < f->frontierSize ? firstChild + f->arity : f->frontierSize;
+        unsigned int maxChild = firstChild;
+        unsigned int i = firstChild + 1;
+
+        if(firstChild >= f->frontierSize)
+            break;
+
+        for(; i < lastChild; i++) {
+            if(isAbove(f->frontier[i], f->frontier[maxChild]))
+                maxChild = i;
+        }
+
+        if(!isAbove(f->frontier[maxChild], node))
+            break;
+
+        placeInFrontier(f, f->frontier[maxChild], index);
+        index = maxChild;
+    }
+
+    placeInFrontier(f, node, index);
+
+}
+
+
+static void pushIntoFrontier(frontier* f, frontier_node* node) {
+
+    if(f->frontierSize == f->maxFrontierSize) {
+        f->maxFrontierSize = f->maxFrontierSize == 0 ? INITIAL_FRONTIER_SIZE : f->maxFrontierSize * 2;
+        f->frontier = (frontier_node**)realloc(f->frontier, sizeof(frontier_node*) * f->maxFrontierSize);
+    }
+
+    placeInFrontier(f, node, f->frontierSize++);
+    siftUp(f, node);
+
+}
+
+
+/*+------------------------------------------+
+  | The tree the heap replaced: a binary     |
+  | tree filled in append order, each node   |
+  | knowing the maximum bounded one under    |
+  | it. Kept as it was in lipschitzian.c.    |
+  +------------------------------------------+*/
+
+static void propagateBound(frontier* f, frontier_node* startingPoint) {
+
+    frontier_node* crt = startingPoint;
+    while(crt != NULL) {
+        if(crt->rightChild != NULL) {
+            crt->maxBoundedChild = crt->rightChild;
+
+            if(crt->rightChild->maxBoundedChild != NULL) {
+                if(crt->rightChild->maxBoundedChild->bound > crt->maxBoundedChild->bound)
+                    crt->maxBoundedChild = crt->rightChild->maxBoundedChild;
+
+                if(crt->leftChild->maxBoundedChild->bound > crt->maxBoundedChild->bound)
+                    crt->maxBoundedChild = crt->leftChild->maxBoundedChild;
+            } else {
+                if((crt->leftChild->maxBoundedChild != NULL) && (crt->leftChild->maxBoundedChild->bound > crt->maxBoundedChild->bound))
+                    crt->maxBoundedChild = crt->leftChild->maxBoundedChild;
+            }
+
+            if(crt->leftChild->bound > crt->maxBoundedChild->bound)
+                crt->maxBoundedChild = crt->leftChild;
+        }
+
+        crt = crt->father;
+    }
+
+    if((f->nodes->maxBoundedChild != NULL) && (f->nodes->maxBoundedChild->bound > f->nodes->bound))
+        f->nextSubsetToDiscretize = f->nodes->maxBoundedChild;
+    else
+        f->nextSubsetToDiscretize = f->nodes;
+
+}
+
+
+static void appendToTree(frontier* f, frontier_node* discretized, frontier_node* left, frontier_node* right) {
+
+    frontier_node* crtNode = f->nextNodeToAppendTo->father;
+    frontier_node* prevNode = f->nextNodeToAppendTo;
+
+    f->nextNodeToAppendTo->leftChild = left;
+    f->nextNodeToAppendTo->rightChild = right;
+    left->father = f->nextNodeToAppendTo;
+    right->father = f->nextNodeToAppendTo;
+
+    propagateBound(f, f->nextNodeToAppendTo);
+    propagateBound(f, discretized);
+
+    while((crtNode != NULL) && (crtNode->rightChild == prevNode)) {
+        prevNode = crtNode;
+        crtNode = crtNode->father;
+    }
+
+    if(crtNode == NULL)
+        crtNode = f->nodes;
+    else
+        crtNode = crtNode->rightChild;
+
+    while(crtNode->leftChild != NULL)
+        crtNode = crtNode->leftChild;
+
+    f->nextNodeToAppendTo = crtNode;
+
+}
+
+
+/*+------------------------------------------+
+  | Operations of the planner on either      |
+  | structure.                               |
+  +------------------------------------------+*/
+
+static frontier_node* newNode(frontier* f, double bound) {
+
+    frontier_node* node = f->nodes + f->nbNodes;
+
+    node->bound = bound;
+    node->id = f->nbNodes++;
+    node->maxBoundedChild = NULL;
+    node->father = NULL;
+    node->leftChild = NULL;
+    node->rightChild = NULL;
+
+    return node;
+
+}
+
+
+static frontier* initFrontier(unsigned int arity, unsigned int maxNbNodes) {
+
+    frontier* f = (frontier*)malloc(sizeof(frontier));
+
+    f->arity = arity;
+    f->nodes = (frontier_node*)malloc(sizeof(frontier_node) * maxNbNodes);
+    f->nbNodes = 0;
+    f->frontier = NULL;
+    f->frontierSize = 0;
+    f->maxFrontierSize = 0;
+
+    f->nextSubsetToDiscretize = newNode(f, INITIAL_BOUND);
+    f->nextNodeToAppendTo = f->nextSubsetToDiscretize;
+
+    if(arity > 0)
+        pushIntoFrontier(f, f->nextSubsetToDiscretize);
+
+    return f;
+
+}
+
+
+static void uninitFrontier(frontier** f) {
+
+    free((*f)->nodes);
+    free((*f)->frontier);
+    free(*f);
+    *f = NULL;
+
+}
+
+
+/* The bound of the selected subset has been lowered */
+
+static void deepen(frontier* f) {
+
+    frontier_node* discretized = f->nextSubsetToDiscretize;
+
+    if(f->arity > 0) {
+        siftUp(f, discretized);
+        siftDown(f, discretized);
+        f->nextSubsetToDiscretize = f->frontier[0];
+    } else {
+        propagateBound(f, discretized);
+    }
+
+}
+
+
+/* The bound of the selected subset has been lowered and two new subsets have been created */
+
+static void trisect(frontier* f, double leftBound, double rightBound) {
+
+    frontier_node* discretized = f->nextSubsetToDiscretize;
+    frontier_node* left = newNode(f, leftBound);
+    frontier_node* right = newNode(f, rightBound);
+
+    if(f->arity > 0) {
+        siftUp(f, discretized);
+        siftDown(f, discretized);
+        pushIntoFrontier(f, left);
+        pushIntoFrontier(f, right);
+        f->nextSubsetToDiscretize = f->frontier[0];
+    } else {
+        appendToTree(f, discretized, left, right);
+    }
+
+}
+
+
+/* A linear congruential generator, so that every structure goes through the same bounds */
+
+static unsigned long long generator = 0;
+
+static double drawUniform() {
+
+    generator = (generator * 6364136223846793005ULL) + 1442695040888963407ULL;
+
+    return (generator >> 11) * (1.0 / 9007199254740992.0);
+
+}
+
+
+/* A decrease of a bound: a multiple of BOUND_STEP, so that subsets often end up with equal bounds */
+
+static double drawDecrease(unsigned int nbLevels) {
+
+    return (1 + (unsigned int)(drawUniform() * nbLevels)) * BOUND_STEP;
+
+}
+
+
+/* Lower the bound of the maximum bounded subset, trisecting it two times out of three */
+
+static void step(frontier* f, unsigned int nbLevels) {
+
+    double bound = f->nextSubsetToDiscretize->bound;
+
+    f->nextSubsetToDiscretize->bound = bound - drawDecrease(nbLevels);
+
+    if(drawUniform() < DEEPEN_PROBABILITY) {
+        deepen(f);
+    } else {
+        double leftBound = bound - drawDecrease(nbLevels);
+        double rightBound = bound - drawDecrease(nbLevels);
+        trisect(f, leftBound, rightBound);
+    }
+
+}
+
+
+/* Time the selections of one structure, printing the cost per selection between checkpoints of */
+/* 1, 2 and 5 times a power of ten subsets */
+
+static void timeStructure(unsigned int arity, unsigned int nbSubsets, unsigned int nbLevels, unsigned long seed) {
+
+    frontier* f = initFrontier(arity, nbSubsets + 2);
+    unsigned int mantissas[3] = {1, 2, 5};
+    unsigned int power = 10000;
+    unsigned int checkpointIndex = 0;
+    unsigned int nbSteps = 0;
+    double start = 0.0;
+
+    generator = seed;
+    start = deadline_now();
+
+    while(f->nbNodes < nbSubsets) {
+        step(f, nbLevels);
+        nbSteps++;
+
+        if((f->nbNodes >= (mantissas[checkpointIndex] * power)) || (f->nbNodes >= nbSubsets)) {
+            double elapsed = deadline_now() - start;
+
+            if(arity > 0)
+                printf("%u-ary heap", arity);
+            else
+                printf("tree      ");
+            printf("  %8u subsets: %7.1f ns per selection\n", f->nbNodes, (elapsed * 1e9) / nbSteps);
+
+            if(++checkpointIndex == 3) {
+                checkpointIndex = 0;
+                power *= 10;
+            }
+            nbSteps = 0;
+            start = deadline_now();
+        }
+    }
+
+    uninitFrontier(&f);
+
+}
+
+
+/* Select with the FRONTIER_ARITY heap and the tree side by side, and count the selections of */
+/* another subset, which the order of the ties in the heap is meant to rule out. firstDifference */
+/* receives the number of the first of them, nbSelections if there is none. */
+
+static unsigned int countTieOrderDifferences(unsigned int nbSubsets, unsigned int nbLevels, unsigned long seed, unsigned int* nbSelections, unsigned int* firstDifference) {
+
+    frontier* heap = initFrontier(FRONTIER_ARITY, nbSubsets + 2);
+    frontier* tree = initFrontier(0, nbSubsets + 2);
+    unsigned int nbDifferences = 0;
+
+    generator = seed;
+    *nbSelections = 0;
+
+    while(heap->nbNodes < nbSubsets) {
+        unsigned long long previousGenerator = generator;
+
+        if(heap->nextSubsetToDiscretize->bound != tree->nextSubsetToDiscretize->bound) {
+            printf("error: after %u selections, the heap selected a bound of %.17g and the tree one of %.17g\n", *nbSelections, heap->nextSubsetToDiscretize->bound, tree->nextSubsetToDiscretize->bound);
+            if(nbDifferences == 0)
+                *firstDifference = *nbSelections;
+            nbDifferences++;
+            break;
+        }
+
+        if(heap->nextSubsetToDiscretize->id != tree->nextSubsetToDiscretize->id) {
+            if(nbDifferences == 0)
+                *firstDifference = *nbSelections;
+            nbDifferences++;
+        }
+
+        step(heap, nbLevels);
+        generator = previousGenerator;
+        step(tree, nbLevels);
+
+        (*nbSelections)++;
+    }
+
+    if(nbDifferences == 0)
+        *firstDifference = *nbSelections;
+
+    uninitFrontier(&heap);
+    uninitFrontier(&tree);
+
+    return nbDifferences;
+
+}
+
+
+/* Replay the selections the lipschitzian planner makes in its frontier, with bounds drawn so that */
+/* ties are frequent, on the FRONTIER_ARITY heap, on a binary heap and on the tree the heap */
+/* replaced. Fails unless the heap selects the same subsets as the tree. */
+
+int main(int argc, char* argv[]) {
+
+    unsigned int nbSubsets = 0;
+    unsigned int nbLevels = 0;
+    unsigned long seed = 0;
+    unsigned int nbSelections = 0;
+    unsigned int nbDifferences = 0;
+    unsigned int firstDifference = 0;
+    unsigned int arities[NB_STRUCTURES] = {FRONTIER_ARITY, 2, 0};
+    unsigned int i = 0;
+
+    struct arg_int* n = arg_int0("n", NULL, "<n>", "The number of subsets reached (1000000 by default)");
+    struct arg_int* l = arg_int0(NULL, "levels", "<n>", "The number of possible decreases of a bound, fewer giving more ties (16 by default)");
+    struct arg_int* e = arg_int0(NULL, "seed", "<n>", "The seed of the bounds (1 by default)");
+    struct arg_end* end = arg_end(4);
+
+    void* argtable[4];
+
+    int nerrors = 0;
+
+    argtable[0] = n;
+    argtable[1] = l;
+    argtable[2] = e;
+    argtable[3] = end;
+
+    n->ival[0] = 1000000;
+    l->ival[0] = 16;
+    e->ival[0] = 1;
+
+    if(arg_nullcheck(argtable) != 0) {
+        printf("error: insufficient memory\n");
+        arg_freetable(argtable, 4);
+        return EXIT_FAILURE;
+    }
+
+    nerrors = arg_parse(argc, argv, argtable);
+
+    if(nerrors > 0) {
+        printf("%s:", argv[0]);
+        arg_print_syntax(stdout, argtable, "\n");
+        arg_print_errors(stdout, end, argv[0]);
+        arg_freetable(argtable, 4);
+        return EXIT_FAILURE;
+    }
+
+    nbSubsets = n->ival[0] > 1 ? n->ival[0] : 2;
+    nbLevels = l->ival[0] > 0 ? l->ival[0] : 1;
+    seed = e->ival[0] > 0 ? (unsigned long)e->ival[0] : 1;
+
+    arg_freetable(argtable, 4);
+
+    for(; i < NB_STRUCTURES; i++)
+        timeStructure(arities[i], nbSubsets, nbLevels, seed);
+
+    nbDifferences = countTieOrderDifferences(nbSubsets, nbLevels, seed, &nbSelections, &firstDifference);
+
+    if(nbDifferences > 0) {
+        printf("error: %u of %u selections took another subset in the %u-ary heap than in the tree, the first one being selection %u\n", nbDifferences, nbSelections, FRONTIER_ARITY, firstDifference);
+        return EXIT_FAILURE;
+    }
+
+    printf("The %u selections took the same subsets in the %u-ary heap as in the tree\n", nbSelections, FRONTIER_ARITY);
+
+    return EXIT_SUCCESS;
+
+}
@@ -108,6 +108,7 @@ double* parseDoubleList(char* str, unsigned int* nbItems) {
 
 int main(int argc, char* argv[]) {
 
+    model_context* context = NULL;
     double discountFactor = 0.9;
     FILE* initFileFd = NULL;
     double* setPoints = NULL;
@@ -160,6 +161,7 @@ int main(int argc, char* argv[]) {
 
     initGenerativeModelParameters();
     initGenerativeModel();
+    context = initModelContext();
 
     initFileFd = fopen(initFile->filename[0], "r");
     readFscanf = fscanf(initFileFd, "%u\n", &nbSetPoints);
@@ -178,7 +180,7 @@ int main(int argc, char* argv[]) {
     sprintf(str, "%s/%u_results_%s_%s.csv", where->filename[0], timestamp, z->sval[0], r->sval[0]);
     results = fopen(str, "w");
 
-    lipschitzian = lipschitzian_initInstance(NULL, discountFactor, 0.0);
+    lipschitzian = lipschitzian_initInstance(context, NULL, discountFactor, 0.0);
     
     for(i = 0; i < nbN; i++) {                                               /* Loop on the computational ressources */
         fprintf(results, "%u", ns[i]);
@@ -189,10 +191,10 @@ int main(int argc, char* argv[]) {
             unsigned int k = 0;
             double average = 0.0;
             lipschitzian->L = Ls[j];
-            state* crt = initState(); 
+            state* crt = initStateWithContext(context); 
             for(; k < nbSetPoints; k++) {                           /* Loop on the set points */
                 unsigned int l = 0;
-                parameters[10] = setPoints[k];
+                context->parameters[10] = setPoints[k];
 
                 lipschitzian_resetInstance(lipschitzian, crt);
                 for(; l < nbSteps; l++) {                               /* Loop on the step */
@@ -201,7 +203,7 @@ int main(int argc, char* argv[]) {
                     state* nextState = NULL;
 
                     double* optimalAction = lipschitzian_planning(lipschitzian, ns[i]);
-                    isTerminal = nextStateReward(crt, optimalAction, &nextState, &reward) < 0 ? 1 : 0;
+                    isTerminal = nextStateRewardWithContext(context, crt, optimalAction, &nextState, &reward) < 0 ? 1 : 0;
                     free(optimalAction);
                     freeState(crt);
                     crt = nextState;
@@ -235,6 +237,7 @@ int main(int argc, char* argv[]) {
     free(ns);
     free(Ls);
 
+    freeModelContext(context);
     freeGenerativeModel();
     freeGenerativeModelParameters();
 
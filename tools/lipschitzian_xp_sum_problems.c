@@ -135,6 +135,7 @@ double* parseDoubleList(char* str, unsigned int* nbItems) {
 
 int main(int argc, char* argv[]) {
 
+    model_context* context = NULL;
 #ifdef BALL
     double discountFactor = 0.9;
 #else
@@ -214,6 +215,7 @@ int main(int argc, char* argv[]) {
 
     initGenerativeModelParameters();
     initGenerativeModel();
+    context = initModelContext();
 
     initFileFd = fopen(initFile->filename[0], "r");
     readFscanf = fscanf(initFileFd, "%u\n", &nbInitialStates);
@@ -221,7 +223,7 @@ int main(int argc, char* argv[]) {
     
     for(; i < nbInitialStates; i++) {
         readFscanf = fscanf(initFileFd, "%s\n", str);
-        initialStates[i] = makeState(str);
+        initialStates[i] = makeStateWithContext(context, str);
     }
     fclose(initFileFd);
 
@@ -232,7 +234,7 @@ int main(int argc, char* argv[]) {
     sprintf(str, "%s/%u_results_%s_%s.csv", where->filename[0], timestamp, z->sval[0], r->sval[0]);
     results = fopen(str, "w");
 
-    lipschitzian = lipschitzian_initInstance(NULL, discountFactor, 0.0);
+    lipschitzian = lipschitzian_initInstance(context, NULL, discountFactor, 0.0);
     
     for(i = 0; i < nbN; i++) {                                               /* Loop on the computational ressources */
         fprintf(results, "%u", ns[i]);
@@ -255,7 +257,7 @@ int main(int argc, char* argv[]) {
                     state* nextState = NULL;
 
                     double* optimalAction = lipschitzian_planning(lipschitzian, ns[i]);
-                    isTerminal = nextStateReward(crt, optimalAction, &nextState, &reward) < 0 ? 1 : 0;
+                    isTerminal = nextStateRewardWithContext(context, crt, optimalAction, &nextState, &reward) < 0 ? 1 : 0;
                     free(optimalAction);
                     freeState(crt);
                     crt = nextState;
@@ -293,6 +295,7 @@ int main(int argc, char* argv[]) {
     free(ns);
     free(Ls);
 
+    freeModelContext(context);
     freeGenerativeModel();
     freeGenerativeModelParameters();
 
@@ -86,24 +86,29 @@ int main(int argc, char* argv[]) {
     FILE* outputFileFd = NULL;
     gsl_rng* rng = NULL;
     unsigned int nbStates = 0;
+    unsigned long seed = 0;
 
     struct arg_file* outputFile = arg_file1("o", NULL, "<file>", "The output file for the generated initial state");
     struct arg_int* n = arg_int1("n", NULL, "<n>", "The number of initial states to generate");
     struct arg_str* s = arg_str1(NULL, "intervals", "<s>", "The intervals for the initial states generation");
-    struct arg_end* end = arg_end(4);
+    struct arg_int* e = arg_int0(NULL, "seed", "<n>", "The seed of the generation, 0 to seed it from the clock");
+    struct arg_end* end = arg_end(5);
 
-    void* argtable[4];
+    void* argtable[5];
 
     int nerrors = 0;
 
     argtable[0] = outputFile;
     argtable[1] = n;
     argtable[2] = s;
-    argtable[3] = end;
+    argtable[3] = e;
+    argtable[4] = end;
+
+    e->ival[0] = 0;
 
     if(arg_nullcheck(argtable) != 0) {
         printf("error: insufficient memory\n");
-        arg_freetable(argtable, 4);
+        arg_freetable(argtable, 5);
         return EXIT_FAILURE;
     }
 
@@ -113,16 +118,17 @@ int main(int argc, char* argv[]) {
         printf("%s:", argv[0]);
         arg_print_syntax(stdout, argtable, "\n");
         arg_print_errors(stdout, end, argv[0]);
-        arg_freetable(argtable, 4);
+        arg_freetable(argtable, 5);
         return EXIT_FAILURE;
     }
 
     nbStates = n->ival[0];
+    seed = e->ival[0] > 0 ? (unsigned long)e->ival[0] : (unsigned long)time(NULL);
 
     intervals = parseIntervals(s->sval[0], &nbIntervals);
 
     rng = gsl_rng_alloc(gsl_rng_mt19937);
-    gsl_rng_set(rng, time(NULL));
+    gsl_rng_set(rng, seed);
 
     outputFileFd = fopen(outputFile->filename[0], "w");
     fprintf(outputFileFd, "%u\n", n->ival[0]);
@@ -137,7 +143,7 @@ int main(int argc, char* argv[]) {
     fclose(outputFileFd);
 	gsl_rng_free(rng);
     free(intervals);
-    arg_freetable(argtable, 4);
+    arg_freetable(argtable, 5);
 
     return EXIT_SUCCESS;
 
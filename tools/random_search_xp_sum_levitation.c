@@ -86,6 +86,7 @@ unsigned int* parseUnsignedIntList(char* str, unsigned int* nbItems) {
 
 int main(int argc, char* argv[]) {
 
+    model_context* context = NULL;
     double discountFactor = 0.9;
 
     FILE* initFileFd = NULL;
@@ -101,6 +102,7 @@ int main(int argc, char* argv[]) {
     unsigned int nbSteps = 0;
     unsigned int nbIterations = 0;
     unsigned int timestamp = time(NULL);
+    unsigned long seed = 0;
     int readFscanf = -1;
     random_search_instance* random_search = NULL;
 
@@ -110,10 +112,11 @@ int main(int argc, char* argv[]) {
     struct arg_str* r = arg_str1("n", NULL, "<s>", "List of ressources");
     struct arg_str* d = arg_str1("h", NULL, "<s>", "List of depth");
     struct arg_file* where = arg_file1(NULL, "where", "<file>", "Directory where we save the outputs");
-    struct arg_end* end = arg_end(7);
+    struct arg_int* e = arg_int0(NULL, "seed", "<n>", "The seed of the random draws of the planner and the problem, 0 to seed them from the clock");
+    struct arg_end* end = arg_end(8);
 
     int nerrors = 0;
-    void* argtable[7];
+    void* argtable[8];
 
     argtable[0] = initFile;
     argtable[1] = r;
@@ -121,11 +124,14 @@ int main(int argc, char* argv[]) {
     argtable[3] = s;
     argtable[4] = it;
     argtable[5] = where;
-    argtable[6] = end;
+    argtable[6] = e;
+    argtable[7] = end;
+
+    e->ival[0] = 0;
 
     if(arg_nullcheck(argtable) != 0) {
         printf("error: insufficient memory\n");
-        arg_freetable(argtable, 7);
+        arg_freetable(argtable, 8);
         return EXIT_FAILURE;
     }
 
@@ -135,12 +141,15 @@ int main(int argc, char* argv[]) {
         printf("%s:", argv[0]);
         arg_print_syntax(stdout, argtable, "\n");
         arg_print_errors(stdout, end, argv[0]);
-        arg_freetable(argtable, 7);
+        arg_freetable(argtable, 8);
         return EXIT_FAILURE;
     }
 
+    seed = e->ival[0] > 0 ? (unsigned long)e->ival[0] : 0;
+    setModelSeed(seed);
     initGenerativeModelParameters();
     initGenerativeModel();
+    context = initModelContext();
 
     initFileFd = fopen(initFile->filename[0], "r");
     readFscanf = fscanf(initFileFd, "%u\n", &nbSetPoints);
@@ -160,7 +169,8 @@ int main(int argc, char* argv[]) {
     sprintf(str, "%s/%u_results_random_search_%s.csv", where->filename[0], timestamp, r->sval[0]);
     results = fopen(str, "w");
 
-    random_search = random_search_initInstance(NULL, discountFactor);
+    random_search = random_search_initInstance(context, NULL, discountFactor);
+    random_search_setSeed(random_search, seed);
     h_max = h_max_crt_depth;
 
     for(i = 0; i < nbIterations; i++) {
@@ -172,7 +182,7 @@ int main(int argc, char* argv[]) {
             crtDepth = hs[j];
 
             for(; k < nbN; k++) {                                          /* Loop on the computational ressources */
-                state* crt = initState();
+                state* crt = initStateWithContext(context);
                 double average = 0.0;
                 unsigned int l = 0;
 
@@ -182,7 +192,7 @@ int main(int argc, char* argv[]) {
 
                 for(; l < nbSetPoints; l++) {                           /* Loop on the initial states */
                     unsigned int m = 0;
-                    parameters[10] = setPoints[l];
+                    context->parameters[10] = setPoints[l];
 
                     for(; m < nbSteps; m++) {                               /* Loop on the step */
                         char isTerminal = 0;
@@ -191,7 +201,7 @@ int main(int argc, char* argv[]) {
                         random_search_resetInstance(random_search, crt);
 
                         double* optimalAction = random_search_planning(random_search, ns[k]);
-                        isTerminal = nextStateReward(crt, optimalAction, &nextState, &reward) < 0 ? 1 : 0;
+                        isTerminal = nextStateRewardWithContext(context, crt, optimalAction, &nextState, &reward) < 0 ? 1 : 0;
                         freeState(crt);
                         crt = nextState;
                         average += reward;
@@ -222,10 +232,11 @@ int main(int argc, char* argv[]) {
  
     fclose(results);
 
-    arg_freetable(argtable, 7);
+    arg_freetable(argtable, 8);
 
     free(setPoints);
 
+    freeModelContext(context);
     freeGenerativeModel();
     freeGenerativeModelParameters();
 
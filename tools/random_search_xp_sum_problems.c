@@ -112,6 +112,7 @@ unsigned int* parseUnsignedIntList(char* str, unsigned int* nbItems) {
 
 int main(int argc, char* argv[]) {
 
+    model_context* context = NULL;
 #ifdef BALL
     double discountFactor = 0.9;
 #else
@@ -153,6 +154,7 @@ int main(int argc, char* argv[]) {
     unsigned int nbSteps = 0;
     unsigned int nbIterations = 1;
     unsigned int timestamp = time(NULL);
+    unsigned long seed = 0;
     int readFscanf = -1;
 
     random_search_instance* random_search = NULL;
@@ -163,10 +165,11 @@ int main(int argc, char* argv[]) {
     struct arg_int* s = arg_int1("s", NULL, "<n>", "Number of steps");
     struct arg_int* it = arg_int1("i", NULL, "<n>", "Number of iteration");
     struct arg_file* where = arg_file1(NULL, "where", "<file>", "Directory where we save the outputs");
-    struct arg_end* end = arg_end(7);
+    struct arg_int* e = arg_int0(NULL, "seed", "<n>", "The seed of the random draws of the planner and the problem, 0 to seed them from the clock");
+    struct arg_end* end = arg_end(8);
 
     int nerrors = 0;
-    void* argtable[7];
+    void* argtable[8];
 
     argtable[0] = initFile;
     argtable[1] = r;
@@ -174,11 +177,14 @@ int main(int argc, char* argv[]) {
     argtable[3] = s;
     argtable[4] = it;
     argtable[5] = where;
-    argtable[6] = end;
+    argtable[6] = e;
+    argtable[7] = end;
+
+    e->ival[0] = 0;
 
     if(arg_nullcheck(argtable) != 0) {
         printf("error: insufficient memory\n");
-        arg_freetable(argtable, 7);
+        arg_freetable(argtable, 8);
         return EXIT_FAILURE;
     }
 
@@ -188,12 +194,15 @@ int main(int argc, char* argv[]) {
         printf("%s:", argv[0]);
         arg_print_syntax(stdout, argtable, "\n");
         arg_print_errors(stdout, end, argv[0]);
-        arg_freetable(argtable, 7);
+        arg_freetable(argtable, 8);
         return EXIT_FAILURE;
     }
 
+    seed = e->ival[0] > 0 ? (unsigned long)e->ival[0] : 0;
+    setModelSeed(seed);
     initGenerativeModelParameters();
     initGenerativeModel();
+    context = initModelContext();
 
     initFileFd = fopen(initFile->filename[0], "r");
     readFscanf = fscanf(initFileFd, "%u\n", &n);
@@ -201,7 +210,7 @@ int main(int argc, char* argv[]) {
     
     for(; i < n; i++) {
         readFscanf = fscanf(initFileFd, "%s\n", str);
-        initialStates[i] = makeState(str);
+        initialStates[i] = makeStateWithContext(context, str);
     }
     fclose(initFileFd);
 
@@ -210,7 +219,8 @@ int main(int argc, char* argv[]) {
     ns = parseUnsignedIntList((char*)r->sval[0], &nbN);
     hs = parseUnsignedIntList((char*)d->sval[0], &nbH);
 
-    random_search = random_search_initInstance(NULL, discountFactor);
+    random_search = random_search_initInstance(context, NULL, discountFactor);
+    random_search_setSeed(random_search, seed);
     h_max = h_max_crt_depth;
 
     sprintf(str, "%s/%u_results_random_search_%s.csv", where->filename[0], timestamp,(char*)r->sval[0]);
@@ -240,7 +250,7 @@ int main(int argc, char* argv[]) {
 
                         random_search_resetInstance(random_search, crt);
                         optimalAction = random_search_planning(random_search, ns[k]);
-                        isTerminal = nextStateReward(crt, optimalAction, &nextState, &reward) < 0 ? 1 : 0;
+                        isTerminal = nextStateRewardWithContext(context, crt, optimalAction, &nextState, &reward) < 0 ? 1 : 0;
                         freeState(crt);
                         free(optimalAction);
                         crt = nextState;
@@ -271,7 +281,7 @@ int main(int argc, char* argv[]) {
 
     fclose(results);
 
-    arg_freetable(argtable, 7);
+    arg_freetable(argtable, 8);
 
     for(i = 0; i < n; i++)
         freeState(initialStates[i]);
@@ -280,6 +290,7 @@ int main(int argc, char* argv[]) {
 
     random_search_uninitInstance(&random_search);
 
+    freeModelContext(context);
     freeGenerativeModel();
     freeGenerativeModelParameters();
 
@@ -0,0 +1,318 @@
+/* Copyright or © or Copr. 2012, Jean-François Hren
+ *
+ * Author e-mail: jean-francois.hren@inria.fr
+ *
+ * This software is a computer program whose purpose is to control
+ * deterministic systems using optimistic planning.
+ *
+ * This software is governed by the CeCILL license under French law and
+ * abiding by the rules of distribution of free software.  You can  use, 
+ * modify and/ or redistribute the software under the terms of the CeCILL
+ * license as circulated by CEA, CNRS and INRIA at the following URL
+ * "http://www.cecill.info". 
+ *
+ * As a counterpart to the access to the source code and  rights to copy,
+ * modify and redistribute granted by the license, users are provided only
+ * with a limited warranty  and the software's author,  the holder of the
+ * economic rights,  and the successive licensors  have only  limited
+ * liability. 
+ *
+ * In this respect, the user's attention is drawn to the risks associated
+ * with loading,  using,  modifying and/or developing or reproducing the
+ * software by the user in light of its specific status of free software,
+ * that may mean  that it is complicated to manipulate,  and  that  also
+ * therefore means  that it is reserved for developers  and  experienced
+ * professionals having in-depth computer knowledge. Users are therefore
+ * encouraged to load and test the software's suitability as regards their
+ * requirements in conditions enabling the security of their systems and/or 
+ * data to be ensured and,  more generally, to use and operate it in the 
+ * same conditions as regards security. 
+ *
+ * The fact that you are presently reading this means that you have had
+ * knowledge of the CeCILL license and that you accept its terms.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <argtable2.h>
+
+#include "../algorithms/deadline/deadline.h"
+#include "../algorithms/arena/arena.h"
+#include "../algorithms/sequential_soo/sequential_soo.h"
+
+#define NB_CLOCK_CALIBRATIONS 100000                        /* The number of readings of the clock averaged to estimate its cost */
+
+
+/*+------------------------------------------+
+  | The link rule of this tool passes        |
+  | --wrap for malloc, realloc, free and the |
+  | arena entry points: every call from the  |
+  | other objects lands in the __wrap_       |
+  | functions below, which time the __real_  |
+  | ones while a planning step runs. Calls   |
+  | made from inside a timed one, like the   |
+  | mallocs of arena_alloc, are counted but  |
+  | not timed twice.                         |
+  +------------------------------------------+*/
+
+void* __real_malloc(size_t size);
+void* __real_realloc(void* block, size_t size);
+void __real_free(void* block);
+void* __real_arena_alloc(arena* memory, size_t size);
+void* __real_arena_realloc(arena* memory, void* block, size_t oldSize, size_t newSize);
+void __real_arena_free(arena* memory, void* block, size_t size);
+void __real_arena_reset(arena* memory);
+
+static char isTiming = 0;                                   /* Set while a planning step or a rebase runs */
+static unsigned int nesting = 0;                            /* The number of counted calls under way */
+static double systemTime = 0.0;                             /* Seconds spent in malloc, realloc and free outside the arena */
+static double arenaTime = 0.0;                              /* Seconds spent in the arena, its own mallocs included */
+static unsigned long nbSystemCalls = 0;                     /* Calls to malloc, realloc and free, from the arena included */
+static unsigned long nbArenaCalls = 0;                      /* Calls to the arena */
+static unsigned long nbTimedSystemCalls = 0;                /* Calls to malloc, realloc and free from outside the arena */
+static unsigned long nbTimedArenaCalls = 0;                 /* Calls to the arena that were timed, all of them */
+
+
+/* Return the time a call starts at, or a negative value if it is not timed */
+
+static double beginCall(unsigned long* nbCalls) {
+
+    if(!isTiming)
+        return -1.0;
+
+    (*nbCalls)++;
+
+    if(nesting++ > 0)
+        return -1.0;
+
+    return deadline_now();
+
+}
+
+
+static void endCall(double start, double* time, unsigned long* nbTimedCalls) {
+
+    if(!isTiming)
+        return;
+
+    nesting--;
+
+    if(start >= 0.0) {
+        *time += deadline_now() - start;
+        (*nbTimedCalls)++;
+    }
+
+}
+
+
+void* __wrap_malloc(size_t size) {
+
+    double start = beginCall(&nbSystemCalls);
+    void* block = __real_malloc(size);
+    endCall(start, &systemTime, &nbTimedSystemCalls);
+
+    return block;
+
+}
+
+
+void* __wrap_realloc(void* block, size_t size) {
+
+    double start = beginCall(&nbSystemCalls);
+    void* newBlock = __real_realloc(block, size);
+    endCall(start, &systemTime, &nbTimedSystemCalls);
+
+    return newBlock;
+
+}
+
+
+void __wrap_free(void* block) {
+
+    double start = beginCall(&nbSystemCalls);
+    __real_free(block);
+    endCall(start, &systemTime, &nbTimedSystemCalls);
+
+}
+
+
+void* __wrap_arena_alloc(arena* memory, size_t size) {
+
+    double start = beginCall(&nbArenaCalls);
+    void* block = __real_arena_alloc(memory, size);
+    endCall(start, &arenaTime, &nbTimedArenaCalls);
+
+    return block;
+
+}
+
+
+void* __wrap_arena_realloc(arena* memory, void* block, size_t oldSize, size_t newSize) {
+
+    double start = beginCall(&nbArenaCalls);
+    void* newBlock = __real_arena_realloc(memory, block, oldSize, newSize);
+    endCall(start, &arenaTime, &nbTimedArenaCalls);
+
+    return newBlock;
+
+}
+
+
+void __wrap_arena_free(arena* memory, void* block, size_t size) {
+
+    double start = beginCall(&nbArenaCalls);
+    __real_arena_free(memory, block, size);
+    endCall(start, &arenaTime, &nbTimedArenaCalls);
+
+}
+
+
+void __wrap_arena_reset(arena* memory) {
+
+    double start = beginCall(&nbArenaCalls);
+    __real_arena_reset(memory);
+    endCall(start, &arenaTime, &nbTimedArenaCalls);
+
+}
+
+
+/* The cost of a reading of the clock, taken off the allocator time once per reading */
+
+static double calibrateClock() {
+
+    unsigned int i = 0;
+    double start = deadline_now();
+
+    for(; i < NB_CLOCK_CALIBRATIONS; i++)
+        deadline_now();
+
+    return (deadline_now() - start) / NB_CLOCK_CALIBRATIONS;
+
+}
+
+
+/* Plan with sequential_soo_planning along a trajectory, rebasing after each step, and report the share */
+/* of the planning time spent allocating memory. */
+
+int main(int argc, char* argv[]) {
+
+    unsigned int i = 0;
+    unsigned int nbEvaluations = 0;
+    unsigned int h = 0;
+    unsigned int nbSteps = 0;
+    model_context* context = NULL;
+    state* crt = NULL;
+    sequential_soo_instance* instance = NULL;
+    double clockCost = 0.0;
+    double planningTime = 0.0;
+    double allocatorTime = 0.0;
+    double start = 0.0;
+    double sumOfRewards = 0.0;
+
+    struct arg_int* n = arg_int0("n", NULL, "<n>", "The number of evaluations of a planning step (100000 by default)");
+    struct arg_int* z = arg_int0("h", NULL, "<n>", "The length of the sequences (10 by default)");
+    struct arg_int* s = arg_int0("s", NULL, "<n>", "The number of steps (5 by default)");
+    struct arg_end* end = arg_end(4);
+
+    void* argtable[4];
+
+    int nerrors = 0;
+
+    argtable[0] = n;
+    argtable[1] = z;
+    argtable[2] = s;
+    argtable[3] = end;
+
+    n->ival[0] = 100000;
+    z->ival[0] = 10;
+    s->ival[0] = 5;
+
+    if(arg_nullcheck(argtable) != 0) {
+        printf("error: insufficient memory\n");
+        arg_freetable(argtable, 4);
+        return EXIT_FAILURE;
+    }
+
+    nerrors = arg_parse(argc, argv, argtable);
+
+    if(nerrors > 0) {
+        printf("%s:", argv[0]);
+        arg_print_syntax(stdout, argtable, "\n");
+        arg_print_errors(stdout, end, argv[0]);
+        arg_freetable(argtable, 4);
+        return EXIT_FAILURE;
+    }
+
+    nbEvaluations = n->ival[0] > 0 ? n->ival[0] : 1;
+    h = z->ival[0] > 0 ? z->ival[0] : 1;
+    nbSteps = s->ival[0] > 0 ? s->ival[0] : 1;
+
+    arg_freetable(argtable, 4);
+
+    clockCost = calibrateClock();
+
+    initGenerativeModelParameters();
+    initGenerativeModel();
+    context = initModelContext();
+
+    crt = initStateWithContext(context);
+
+    isTiming = 1;
+    start = deadline_now();
+    instance = sequential_soo_initInstance(context, crt, 0.95, h, 1);
+    planningTime += deadline_now() - start;
+    isTiming = 0;
+
+    for(; i < nbSteps; i++) {
+        double* optimalAction = NULL;
+        state* nextState = NULL;
+        double reward = 0.0;
+
+        isTiming = 1;
+        start = deadline_now();
+        optimalAction = sequential_soo_planning(instance, nbEvaluations);
+        planningTime += deadline_now() - start;
+        isTiming = 0;
+
+        printf("step %u: action %.17g, best sum of discounted rewards %.17g\n", i, optimalAction[0], instance->crtMaxSumOfDiscountedRewards);
+
+        nextStateRewardWithContext(context, crt, optimalAction, &nextState, &reward);
+        freeState(crt);
+        crt = nextState;
+        sumOfRewards += reward;
+        free(optimalAction);
+
+        isTiming = 1;
+        start = deadline_now();
+        sequential_soo_rebaseInstance(instance, crt);
+        planningTime += deadline_now() - start;
+        isTiming = 0;
+    }
+
+    isTiming = 1;
+    start = deadline_now();
+    sequential_soo_uninitInstance(&instance);
+    planningTime += deadline_now() - start;
+    isTiming = 0;
+
+    /* A timed call reads the clock twice: about one reading falls inside the time measured for */
+    /* the call, both fall inside the planning time */
+    systemTime -= nbTimedSystemCalls * clockCost;
+    arenaTime -= nbTimedArenaCalls * clockCost;
+    planningTime -= 2.0 * (nbTimedSystemCalls + nbTimedArenaCalls) * clockCost;
+    allocatorTime = systemTime + arenaTime;
+
+    printf("sum of rewards %.17g\n", sumOfRewards);
+    printf("%.3f s planning, %.1f ns per reading of the clock taken off\n", planningTime, clockCost * 1e9);
+    printf("%lu calls to the arena: %.3f s, its %lu mallocs and frees included\n", nbArenaCalls, arenaTime, nbSystemCalls - nbTimedSystemCalls);
+    printf("%lu calls to malloc, realloc and free outside the arena: %.3f s\n", nbTimedSystemCalls, systemTime);
+    printf("allocator: %.3f s, %.1f%% of the planning time\n", allocatorTime, (100.0 * allocatorTime) / planningTime);
+
+    freeState(crt);
+    freeModelContext(context);
+    freeGenerativeModel();
+    freeGenerativeModelParameters();
+
+    return EXIT_SUCCESS;
+
+}
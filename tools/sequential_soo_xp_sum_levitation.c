@@ -83,6 +83,7 @@ unsigned int* parseUnsignedIntList(char* str, unsigned int* nbItems) {
 
 int main(int argc, char* argv[]) {
 
+    model_context* context = NULL;
     double discountFactor = 0.9;
 
     FILE* initFileFd = NULL;
@@ -134,6 +135,7 @@ int main(int argc, char* argv[]) {
 
     initGenerativeModelParameters();
     initGenerativeModel();
+    context = initModelContext();
 
     initFileFd = fopen(initFile->filename[0], "r");
     readFscanf = fscanf(initFileFd, "%u\n", &nbSetPoints);
@@ -160,20 +162,20 @@ int main(int argc, char* argv[]) {
         unsigned int j = 0;
         for(; j < nbH; j++) {                                           /* Loop on the length of the sequences */
             unsigned int k = 0;
-            state* crt = initState();
+            state* crt = initStateWithContext(context);
             double average = 0.0;
             for(; k < nbSetPoints; k++) {                           /* Loop on the initial states */
                 unsigned int l = 0;
-                parameters[10] = setPoints[k];
+                context->parameters[10] = setPoints[k];
 
                 for(; l < nbSteps; l++) {                               /* Loop on the step */
                     char isTerminal = 0;
                     double reward = 0.0;
                     state* nextState = NULL;
-                    sequential_soo_instance* sequential_soo = sequential_soo_initInstance(crt, discountFactor, hs[j],1);
+                    sequential_soo_instance* sequential_soo = sequential_soo_initInstance(context, crt, discountFactor, hs[j],1);
 
                     double* optimalAction = sequential_soo_planning(sequential_soo, ns[i]);
-                    isTerminal = nextStateReward(crt, optimalAction, &nextState, &reward);
+                    isTerminal = nextStateRewardWithContext(context, crt, optimalAction, &nextState, &reward);
                     freeState(crt);
                     crt = nextState;
                     average += reward;
@@ -201,6 +203,7 @@ int main(int argc, char* argv[]) {
 
     free(setPoints);
 
+    freeModelContext(context);
     freeGenerativeModel();
     freeGenerativeModelParameters();
 
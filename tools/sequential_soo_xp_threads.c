@@ -0,0 +1,226 @@
+/* Copyright or © or Copr. 2012, Jean-François Hren
+ *
+ * Author e-mail: jean-francois.hren@inria.fr
+ *
+ * This software is a computer program whose purpose is to control
+ * deterministic systems using optimistic planning.
+ *
+ * This software is governed by the CeCILL license under French law and
+ * abiding by the rules of distribution of free software.  You can  use, 
+ * modify and/ or redistribute the software under the terms of the CeCILL
+ * license as circulated by CEA, CNRS and INRIA at the following URL
+ * "http://www.cecill.info". 
+ *
+ * As a counterpart to the access to the source code and  rights to copy,
+ * modify and redistribute granted by the license, users are provided only
+ * with a limited warranty  and the software's author,  the holder of the
+ * economic rights,  and the successive licensors  have only  limited
+ * liability. 
+ *
+ * In this respect, the user's attention is drawn to the risks associated
+ * with loading,  using,  modifying and/or developing or reproducing the
+ * software by the user in light of its specific status of free software,
+ * that may mean  that it is complicated to manipulate,  and  that  also
+ * therefore means  that it is reserved for developers  and  experienced
+ * professionals having in-depth computer knowledge. Users are therefore
+ * encouraged to load and test the software's suitability as regards their
+ * requirements in conditions enabling the security of their systems and/or 
+ * data to be ensured and,  more generally, to use and operate it in the 
+ * same conditions as regards security. 
+ *
+ * The fact that you are presently reading this means that you have had
+ * knowledge of the CeCILL license and that you accept its terms.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <argtable2.h>
+
+#include "../algorithms/sequential_soo/sequential_soo.h"
+
+
+/*+------------------------------------------+
+  | The steps of a run of the planner, its   |
+  | instance being rebased after each one    |
+  +------------------------------------------+*/
+
+typedef struct {
+
+    unsigned int nbSteps;                                   /* The steps taken, fewer than asked if a terminal state is reached */
+    double* actions;                                        /* The action chosen at each step, NUMBER_OF_DIMENSIONS_OF_ACTION per step */
+    double* values;                                         /* The best discounted sum of rewards found at each step */
+    state* finalState;                                      /* The state the run ends in */
+
+} soo_run;
+
+
+/*+------------------------------------------+
+  | Plan nbSteps steps from the initial      |
+  | state in batches of                      |
+  | nbTrajectoriesPerBatch trajectories      |
+  | simulated on nbThreads threads           |
+  +------------------------------------------+*/
+
+static void planRun(soo_run* run, model_context* context, double gamma, unsigned int H, unsigned int nbEvaluations, unsigned int nbSteps, unsigned int nbThreads, unsigned int nbTrajectoriesPerBatch) {
+
+    state* crtState = initStateWithContext(context);
+    sequential_soo_instance* instance = sequential_soo_initInstance(context, crtState, gamma, H, 0);
+    char isTerminal = 0;
+
+    sequential_soo_useThreads(instance, nbThreads, nbTrajectoriesPerBatch);
+
+    run->nbSteps = 0;
+    run->actions = (double*)malloc(sizeof(double) * NUMBER_OF_DIMENSIONS_OF_ACTION * nbSteps);
+    run->values = (double*)malloc(sizeof(double) * nbSteps);
+
+    while(!isTerminal && (run->nbSteps < nbSteps)) {
+        double* optimalAction = sequential_soo_planning(instance, nbEvaluations);
+        state* nextState = NULL;
+        double reward = 0.0;
+
+        memcpy(run->actions + (run->nbSteps * NUMBER_OF_DIMENSIONS_OF_ACTION), optimalAction, sizeof(double) * NUMBER_OF_DIMENSIONS_OF_ACTION);
+        run->values[run->nbSteps] = instance->crtMaxSumOfDiscountedRewards;
+        run->nbSteps++;
+
+        isTerminal = nextStateRewardWithContext(context, crtState, optimalAction, &nextState, &reward);
+        freeState(crtState);
+        crtState = nextState;
+        free(optimalAction);
+
+        sequential_soo_rebaseInstance(instance, crtState);
+    }
+
+    run->finalState = crtState;
+
+    sequential_soo_uninitInstance(&instance);
+
+}
+
+
+static void uninitRun(soo_run* run) {
+
+    free(run->actions);
+    free(run->values);
+    freeState(run->finalState);
+
+}
+
+
+/* Plan the same steps in batches on one thread then on 2, 4, ... up to nbThreads threads, */
+/* and fail unless every run chooses bit-identical actions and values. */
+
+int main(int argc, char* argv[]) {
+
+    unsigned int i = 0;
+    unsigned int nbEvaluations = 0;
+    unsigned int nbSteps = 0;
+    unsigned int H = 0;
+    unsigned int nbThreads = 0;
+    unsigned int nbTrajectoriesPerBatch = 0;
+    unsigned int nbDifferences = 0;
+    unsigned int nbThreadsOfRun = 0;
+    double gamma = 0.0;
+    model_context* context = NULL;
+    soo_run serialRun;
+
+    struct arg_int* n = arg_int0("n", NULL, "<n>", "The number of evaluations of each step (10000 by default)");
+    struct arg_int* s = arg_int0("s", NULL, "<n>", "The number of steps of each run (10 by default)");
+    struct arg_int* h = arg_int0("h", NULL, "<n>", "The length of the trajectories (10 by default)");
+    struct arg_dbl* g = arg_dbl0("g", NULL, "<d>", "The discount factor (0.9 by default)");
+    struct arg_int* w = arg_int0(NULL, "threads", "<n>", "The largest number of threads simulating the trajectories (16 by default)");
+    struct arg_int* k = arg_int0(NULL, "batch", "<n>", "The number of trajectories of a batch (16 by default)");
+    struct arg_end* end = arg_end(7);
+
+    void* argtable[7];
+
+    int nerrors = 0;
+
+    argtable[0] = n;
+    argtable[1] = s;
+    argtable[2] = h;
+    argtable[3] = g;
+    argtable[4] = w;
+    argtable[5] = k;
+    argtable[6] = end;
+
+    n->ival[0] = 10000;
+    s->ival[0] = 10;
+    h->ival[0] = 10;
+    g->dval[0] = 0.9;
+    w->ival[0] = 16;
+    k->ival[0] = 16;
+
+    if(arg_nullcheck(argtable) != 0) {
+        printf("error: insufficient memory\n");
+        arg_freetable(argtable, 7);
+        return EXIT_FAILURE;
+    }
+
+    nerrors = arg_parse(argc, argv, argtable);
+
+    if(nerrors > 0) {
+        printf("%s:", argv[0]);
+        arg_print_syntax(stdout, argtable, "\n");
+        arg_print_errors(stdout, end, argv[0]);
+        arg_freetable(argtable, 7);
+        return EXIT_FAILURE;
+    }
+
+    nbEvaluations = n->ival[0] > 0 ? n->ival[0] : 1;
+    nbSteps = s->ival[0] > 0 ? s->ival[0] : 1;
+    H = h->ival[0] > 0 ? h->ival[0] : 1;
+    gamma = g->dval[0];
+    nbThreads = w->ival[0] > 0 ? w->ival[0] : 1;
+    nbTrajectoriesPerBatch = k->ival[0] > 0 ? k->ival[0] : 1;
+
+    arg_freetable(argtable, 7);
+
+    initGenerativeModelParameters();
+    initGenerativeModel();
+    context = initModelContext();
+
+    planRun(&serialRun, context, gamma, H, nbEvaluations, nbSteps, 1, nbTrajectoriesPerBatch);
+
+    for(nbThreadsOfRun = 2; ; nbThreadsOfRun *= 2) {
+        soo_run threadedRun;
+
+        if(nbThreadsOfRun > nbThreads)
+            nbThreadsOfRun = nbThreads;
+
+        planRun(&threadedRun, context, gamma, H, nbEvaluations, nbSteps, nbThreadsOfRun, nbTrajectoriesPerBatch);
+
+        if(threadedRun.nbSteps != serialRun.nbSteps) {
+            printf("%u threads: %u steps instead of %u\n", nbThreadsOfRun, threadedRun.nbSteps, serialRun.nbSteps);
+            nbDifferences++;
+        } else {
+            for(i = 0; i < serialRun.nbSteps; i++) {
+                if((memcmp(serialRun.actions + (i * NUMBER_OF_DIMENSIONS_OF_ACTION), threadedRun.actions + (i * NUMBER_OF_DIMENSIONS_OF_ACTION), sizeof(double) * NUMBER_OF_DIMENSIONS_OF_ACTION) != 0) || (memcmp(serialRun.values + i, threadedRun.values + i, sizeof(double)) != 0)) {
+                    printf("step %u: %.17g on one thread, %.17g on %u threads\n", i, serialRun.values[i], threadedRun.values[i], nbThreadsOfRun);
+                    nbDifferences++;
+                }
+            }
+
+            if(memcmp(serialRun.finalState, threadedRun.finalState, stateSize()) != 0) {
+                printf("%u threads: the final state differs\n", nbThreadsOfRun);
+                nbDifferences++;
+            }
+        }
+
+        printf("%u evaluations, %u steps, batches of %u, %u threads: %u differences so far\n", nbEvaluations, serialRun.nbSteps, nbTrajectoriesPerBatch, nbThreadsOfRun, nbDifferences);
+
+        uninitRun(&threadedRun);
+
+        if(nbThreadsOfRun == nbThreads)
+            break;
+    }
+
+    uninitRun(&serialRun);
+
+    freeModelContext(context);
+    freeGenerativeModel();
+    freeGenerativeModelParameters();
+
+    return nbDifferences == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+
+}
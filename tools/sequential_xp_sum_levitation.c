@@ -78,6 +78,7 @@ unsigned int* parseUnsignedIntList(char* str, unsigned int* nbItems) {
 
 int main(int argc, char* argv[]) {
 
+    model_context* context = NULL;
     double discountFactor = 0.9;
 
     FILE* initFileFd = NULL;
@@ -129,6 +130,7 @@ int main(int argc, char* argv[]) {
 
     initGenerativeModelParameters();
     initGenerativeModel();
+    context = initModelContext();
 
     initFileFd = fopen(initFile->filename[0], "r");
     readFscanf = fscanf(initFileFd, "%u\n", &nbSetPoints);
@@ -154,21 +156,21 @@ int main(int argc, char* argv[]) {
         unsigned int j = 0;
         for(; j < nbH; j++) {                                           /* Loop on the length of the sequences */
             unsigned int k = 0;
-            state* crt1 = initState();
+            state* crt1 = initStateWithContext(context);
             state* crt2 = copyState(crt1);
             double averages[2] = {0.0,0.0};
             for(; k < nbSetPoints; k++) {                           /* Loop on the initial states */
                 unsigned int l = 0;
-                parameters[10] = setPoints[k];
+                context->parameters[10] = setPoints[k];
 
                 for(; l < nbSteps; l++) {                               /* Loop on the step */
                     char isTerminal = 0;
                     double reward = 0.0;
                     state* nextState = NULL;
-                    sequential_direct_instance* sequential_direct = sequential_direct_initInstance(crt1, discountFactor, hs[j],1);
+                    sequential_direct_instance* sequential_direct = sequential_direct_initInstance(context, crt1, discountFactor, hs[j],1);
 
                     double* optimalAction = sequential_direct_planning(sequential_direct, ns[i]);
-                    isTerminal = nextStateReward(crt1, optimalAction, &nextState, &reward) < 0 ? 1 : 0;
+                    isTerminal = nextStateRewardWithContext(context, crt1, optimalAction, &nextState, &reward) < 0 ? 1 : 0;
                     freeState(crt1);
                     crt1 = nextState;
                     averages[0] += reward;
@@ -183,10 +185,10 @@ int main(int argc, char* argv[]) {
                     char isTerminal = 0;
                     double reward = 0.0;
                     state* nextState = NULL;
-                    sequential_soo_instance* sequential_soo = sequential_soo_initInstance(crt2, discountFactor, hs[j],1);
+                    sequential_soo_instance* sequential_soo = sequential_soo_initInstance(context, crt2, discountFactor, hs[j],1);
 
                     double* optimalAction = sequential_soo_planning(sequential_soo, ns[i]);
-                    isTerminal = nextStateReward(crt2, optimalAction, &nextState, &reward);
+                    isTerminal = nextStateRewardWithContext(context, crt2, optimalAction, &nextState, &reward);
                     freeState(crt2);
                     crt2 = nextState;
                     averages[1] += reward;
@@ -216,6 +218,7 @@ int main(int argc, char* argv[]) {
 
     free(setPoints);
 
+    freeModelContext(context);
     freeGenerativeModel();
     freeGenerativeModelParameters();
 
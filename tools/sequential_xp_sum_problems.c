@@ -105,6 +105,7 @@ unsigned int* parseUnsignedIntList(char* str, unsigned int* nbItems) {
 
 int main(int argc, char* argv[]) {
 
+    model_context* context = NULL;
 #ifdef BALL
     double discountFactor = 0.9;
 #else
@@ -182,6 +183,7 @@ int main(int argc, char* argv[]) {
 
     initGenerativeModelParameters();
     initGenerativeModel();
+    context = initModelContext();
 
     initFileFd = fopen(initFile->filename[0], "r");
     readFscanf = fscanf(initFileFd, "%u\n", &nbInitialStates);
@@ -189,7 +191,7 @@ int main(int argc, char* argv[]) {
     
     for(; i < nbInitialStates; i++) {
         readFscanf = fscanf(initFileFd, "%s\n", str);
-        initialStates[i] = makeState(str);
+        initialStates[i] = makeStateWithContext(context, str);
     }
     fclose(initFileFd);
 
@@ -216,10 +218,10 @@ int main(int argc, char* argv[]) {
                     char isTerminal = 0;
                     double reward = 0.0;
                     state* nextState = NULL;
-                    sequential_direct_instance* sequential_direct = sequential_direct_initInstance(crt, discountFactor, hs[j],1);
+                    sequential_direct_instance* sequential_direct = sequential_direct_initInstance(context, crt, discountFactor, hs[j],1);
 
                     double* optimalAction = sequential_direct_planning(sequential_direct, ns[i]);
-                    isTerminal = nextStateReward(crt, optimalAction, &nextState, &reward) < 0 ? 1 : 0;
+                    isTerminal = nextStateRewardWithContext(context, crt, optimalAction, &nextState, &reward) < 0 ? 1 : 0;
                     freeState(crt);
                     crt = nextState;
                     averages[0] += reward;
@@ -236,10 +238,10 @@ int main(int argc, char* argv[]) {
                     char isTerminal = 0;
                     double reward = 0.0;
                     state* nextState = NULL;
-                    sequential_soo_instance* sequential_soo = sequential_soo_initInstance(crt, discountFactor, hs[j],1);
+                    sequential_soo_instance* sequential_soo = sequential_soo_initInstance(context, crt, discountFactor, hs[j],1);
 
                     double* optimalAction = sequential_soo_planning(sequential_soo, ns[i]);
-                    isTerminal = nextStateReward(crt, optimalAction, &nextState, &reward) < 0 ? 1 : 0;
+                    isTerminal = nextStateRewardWithContext(context, crt, optimalAction, &nextState, &reward) < 0 ? 1 : 0;
                     freeState(crt);
                     crt = nextState;
                     averages[1] += reward;
@@ -271,6 +273,7 @@ int main(int argc, char* argv[]) {
 
     free(initialStates);
 
+    freeModelContext(context);
     freeGenerativeModel();
     freeGenerativeModelParameters();
 
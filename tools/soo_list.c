@@ -0,0 +1,241 @@
+/* Copyright or © or Copr. 2012, Jean-François Hren
+ *
+ * Author e-mail: jean-francois.hren@inria.fr
+ *
+ * This software is a computer program whose purpose is to control
+ * deterministic systems using optimistic planning.
+ *
+ * This software is governed by the CeCILL license under French law and
+ * abiding by the rules of distribution of free software.  You can  use, 
+ * modify and/ or redistribute the software under the terms of the CeCILL
+ * license as circulated by CEA, CNRS and INRIA at the following URL
+ * "http://www.cecill.info". 
+ *
+ * As a counterpart to the access to the source code and  rights to copy,
+ * modify and redistribute granted by the license, users are provided only
+ * with a limited warranty  and the software's author,  the holder of the
+ * economic rights,  and the successive licensors  have only  limited
+ * liability. 
+ *
+ * In this respect, the user's attention is drawn to the risks associated
+ * with loading,  using,  modifying and/or developing or reproducing the
+ * software by the user in light of its specific status of free software,
+ * that may mean  that it is complicated to manipulate,  and  that  also
+ * therefore means  that it is reserved for developers  and  experienced
+ * professionals having in-depth computer knowledge. Users are therefore
+ * encouraged to load and test the software's suitability as regards their
+ * requirements in conditions enabling the security of their systems and/or 
+ * data to be ensured and,  more generally, to use and operate it in the 
+ * same conditions as regards security. 
+ *
+ * The fact that you are presently reading this means that you have had
+ * knowledge of the CeCILL license and that you accept its terms.
+ */
+
+#include "soo_list.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <float.h>
+
+static void plantTree(soo_list* instance) {
+
+    unsigned int i = 0;
+    instance->list = (soo_list_depth*)arena_alloc(instance->memory, sizeof(soo_list_depth));
+    instance->list->depth = 0;
+    instance->list->list = NULL;
+    instance->list->last = NULL;
+    instance->list->next = NULL;
+    instance->list->prev = NULL;
+    instance->crtMax = -DBL_MAX;
+    instance->crtDepth = instance->list;
+    instance->crtMaxValue = -DBL_MAX;
+    instance->t = 0;
+    instance->depthToAddTheLeaves = instance->list;
+    instance->leavesToBeAdded = (soo_list_leaf*)arena_alloc(instance->memory, sizeof(soo_list_leaf));
+    instance->leavesToBeAdded->value = 0.0;
+    for(; i < NUMBER_OF_DIMENSIONS_OF_ACTION; i++) {
+        instance->crtMaxLeaf[i] = 0.5;
+        instance->leavesToBeAdded->centerPosition[i] = 0.5;
+    }
+    instance->leavesToBeAdded->next = NULL;
+    instance->leavesToBeAdded->prev = NULL;
+
+}
+
+
+soo_list* soo_list_init(unsigned int(*hMax)(unsigned int)) {
+
+    soo_list* newInstance = (soo_list*)malloc(sizeof(soo_list));
+    newInstance->hMax = hMax;
+    newInstance->memory = arena_init(SOO_LIST_SLAB_SIZE);
+    plantTree(newInstance);
+
+    return newInstance;
+
+}
+
+
+/* Drop the whole tree at once and start over from the center, the memory
+   already obtained being kept for the new tree. */
+void soo_list_reset(soo_list* instance) {
+
+    arena_reset(instance->memory);
+    plantTree(instance);
+
+}
+
+
+double* soo_list_getAnAction(soo_list* instance) {
+
+    if(instance->leavesToBeAdded == NULL) {
+        unsigned int hMax = instance->hMax(instance->t);
+        soo_list_depth* crtDepth = instance->crtDepth;
+        soo_list_leaf* selectedLeaf = NULL;
+        double shift = 0.0;
+        unsigned int dimensionToCut = 0;
+
+        while((crtDepth != NULL) && (crtDepth->depth <= hMax) && (crtDepth->list->value < instance->crtMax))
+            crtDepth = crtDepth->next;
+
+        if((crtDepth == NULL) || (crtDepth->depth > hMax))
+            crtDepth = instance->list;
+
+        selectedLeaf = crtDepth->list;
+        dimensionToCut = crtDepth->depth % NUMBER_OF_DIMENSIONS_OF_ACTION;
+        shift = 1.0 / pow(3, crtDepth->depth + 1);
+
+        if(((crtDepth->next == NULL) || (crtDepth->next->depth != (crtDepth->depth + 1))) && (crtDepth->list->next == NULL)) {
+            crtDepth->depth++;
+            instance->depthToAddTheLeaves = crtDepth;
+            instance->crtDepth = crtDepth;
+            if(crtDepth->prev != NULL)
+                instance->crtMax = crtDepth->prev->list->value;
+            else
+                instance->crtMax = -DBL_MAX;
+        } else {
+            crtDepth->list = selectedLeaf->next;
+            if(crtDepth->list != NULL)
+                crtDepth->list->prev = NULL;
+
+            if((crtDepth->next == NULL) || (crtDepth->next->depth != (crtDepth->depth + 1))) {
+                soo_list_depth* newDepth = (soo_list_depth*)arena_alloc(instance->memory, sizeof(soo_list_depth));
+                newDepth->depth = crtDepth->depth+1;
+
+                newDepth->prev = crtDepth;
+                newDepth->next = crtDepth->next;
+                crtDepth->next = newDepth;
+                if(newDepth->next != NULL)
+                    newDepth->next->prev = newDepth;
+
+                newDepth->list = selectedLeaf;
+                newDepth->last = selectedLeaf;
+                selectedLeaf->next = NULL;
+                selectedLeaf->prev = NULL;
+
+                instance->depthToAddTheLeaves = newDepth;
+                instance->crtDepth = newDepth;
+                instance->crtMax = crtDepth->list->value;
+            } else {
+                soo_list_leaf* crtLeaf = crtDepth->next->last;
+                soo_list_leaf* nextLeaf = NULL;
+
+                while((crtLeaf != NULL) && (crtLeaf->value < selectedLeaf->value)) {
+                    nextLeaf = crtLeaf;
+                    crtLeaf = crtLeaf->prev;
+                }
+
+                if(nextLeaf == NULL)
+                    crtDepth->next->last = selectedLeaf;
+                else
+                    nextLeaf->prev = selectedLeaf;
+                selectedLeaf->next = nextLeaf;
+
+                if(crtLeaf == NULL)
+                    crtDepth->next->list = selectedLeaf;
+                else
+                    crtLeaf->next = selectedLeaf;
+                selectedLeaf->prev = crtLeaf;
+
+                instance->depthToAddTheLeaves = crtDepth->next;
+                instance->crtDepth = crtDepth->next;
+                if(crtDepth->list == NULL) {
+                    if(crtDepth->prev == NULL) {
+                        instance->crtMax = -DBL_MAX;
+                        instance->list = crtDepth->next;
+                        instance->list->prev = NULL;
+                    } else {
+                        instance->crtMax = crtDepth->prev->list->value;
+                        crtDepth->prev->next = crtDepth->next;
+                        crtDepth->next->prev = crtDepth->prev;
+                    }
+                    arena_free(instance->memory, crtDepth, sizeof(soo_list_depth));
+                } else {
+                    instance->crtMax = crtDepth->list->value;
+                }
+            }
+        }
+
+        instance->leavesToBeAdded = (soo_list_leaf*)arena_alloc(instance->memory, sizeof(soo_list_leaf));
+        instance->leavesToBeAdded->value = 0.0;
+        memcpy(instance->leavesToBeAdded->centerPosition, selectedLeaf->centerPosition, sizeof(double) * NUMBER_OF_DIMENSIONS_OF_ACTION);
+        instance->leavesToBeAdded->centerPosition[dimensionToCut] -= shift;
+        instance->leavesToBeAdded->prev = NULL;
+
+        instance->leavesToBeAdded->next = (soo_list_leaf*)arena_alloc(instance->memory, sizeof(soo_list_leaf));
+        instance->leavesToBeAdded->next->value = 0.0;
+        memcpy(instance->leavesToBeAdded->next->centerPosition, selectedLeaf->centerPosition, sizeof(double) * NUMBER_OF_DIMENSIONS_OF_ACTION);
+        instance->leavesToBeAdded->next->centerPosition[dimensionToCut] += shift;
+        instance->leavesToBeAdded->next->next = NULL;
+        instance->leavesToBeAdded->next->prev = NULL;
+
+    }
+
+    return instance->leavesToBeAdded->centerPosition; 
+
+}
+
+
+void soo_list_updateValue(soo_list* instance, double value) {
+
+    soo_list_leaf* leafToAdd = instance->leavesToBeAdded;
+    soo_list_leaf* crtLeaf = instance->depthToAddTheLeaves->last;
+    soo_list_leaf* nextLeaf = NULL;
+
+    leafToAdd->value = value;
+    instance->leavesToBeAdded = leafToAdd->next;
+    instance->t++;
+
+    while((crtLeaf != NULL) && (crtLeaf->value < leafToAdd->value)) {
+        nextLeaf = crtLeaf;
+        crtLeaf = crtLeaf->prev;
+    }
+
+    if(nextLeaf == NULL)
+        instance->depthToAddTheLeaves->last = leafToAdd;
+    else
+        nextLeaf->prev = leafToAdd;
+    leafToAdd->next = nextLeaf;
+
+    if(crtLeaf == NULL)
+        instance->depthToAddTheLeaves->list = leafToAdd;
+    else
+        crtLeaf->next = leafToAdd;
+    leafToAdd->prev = crtLeaf;
+
+    if(leafToAdd->value > instance->crtMaxValue) {
+        instance->crtMaxValue = leafToAdd->value;
+        memcpy(instance->crtMaxLeaf, leafToAdd->centerPosition, sizeof(double) * NUMBER_OF_DIMENSIONS_OF_ACTION);
+    }
+
+}
+
+
+void soo_list_uninit(soo_list** instance) {
+
+    arena_uninit(&(*instance)->memory);
+    free(*instance);
+    *instance = NULL;
+
+}
@@ -0,0 +1,80 @@
+/* Copyright or © or Copr. 2012, Jean-François Hren
+ *
+ * Author e-mail: jean-francois.hren@inria.fr
+ *
+ * This software is a computer program whose purpose is to control
+ * deterministic systems using optimistic planning.
+ *
+ * This software is governed by the CeCILL license under French law and
+ * abiding by the rules of distribution of free software.  You can  use, 
+ * modify and/ or redistribute the software under the terms of the CeCILL
+ * license as circulated by CEA, CNRS and INRIA at the following URL
+ * "http://www.cecill.info". 
+ *
+ * As a counterpart to the access to the source code and  rights to copy,
+ * modify and redistribute granted by the license, users are provided only
+ * with a limited warranty  and the software's author,  the holder of the
+ * economic rights,  and the successive licensors  have only  limited
+ * liability. 
+ *
+ * In this respect, the user's attention is drawn to the risks associated
+ * with loading,  using,  modifying and/or developing or reproducing the
+ * software by the user in light of its specific status of free software,
+ * that may mean  that it is complicated to manipulate,  and  that  also
+ * therefore means  that it is reserved for developers  and  experienced
+ * professionals having in-depth computer knowledge. Users are therefore
+ * encouraged to load and test the software's suitability as regards their
+ * requirements in conditions enabling the security of their systems and/or 
+ * data to be ensured and,  more generally, to use and operate it in the 
+ * same conditions as regards security. 
+ *
+ * The fact that you are presently reading this means that you have had
+ * knowledge of the CeCILL license and that you accept its terms.
+ */
+
+#ifndef SOO_LIST_H
+#define SOO_LIST_H
+
+#include "../algorithms/arena/arena.h"
+
+/* The SOO selection as it was before the depths were indexed in an array and */
+/* their leaves kept in heaps: sorted linked lists of depths and of leaves. */
+/* Kept as a reference for soo_xp_differential only. */
+
+#define SOO_LIST_SLAB_SIZE 65536     /* Leaves and depths are taken from slabs of this size */
+
+typedef struct soo_list_leaf_rec {
+    double value;
+    double centerPosition[NUMBER_OF_DIMENSIONS_OF_ACTION];
+    struct soo_list_leaf_rec* next;
+    struct soo_list_leaf_rec* prev;
+} soo_list_leaf;
+
+typedef struct soo_list_depth_rec {
+    unsigned int depth;
+    soo_list_leaf* list;
+    soo_list_leaf* last;
+    struct soo_list_depth_rec* next;
+    struct soo_list_depth_rec* prev;
+} soo_list_depth;
+
+typedef struct {
+    soo_list_depth* list;
+    soo_list_depth* depthToAddTheLeaves;
+    soo_list_leaf* leavesToBeAdded;
+    soo_list_depth* crtDepth;
+    double crtMax;
+    double crtMaxLeaf[NUMBER_OF_DIMENSIONS_OF_ACTION];
+    double crtMaxValue;
+    unsigned int t;
+    unsigned int(*hMax)(unsigned int);
+    arena* memory;              /* Holds the leaves and the depths, released at once */
+} soo_list;
+
+soo_list* soo_list_init(unsigned int(*hMax)(unsigned int));
+double* soo_list_getAnAction(soo_list* instance);
+void soo_list_updateValue(soo_list* instance, double value);
+void soo_list_reset(soo_list* instance);
+void soo_list_uninit(soo_list** instance);
+
+#endif
@@ -0,0 +1,231 @@
+/* Copyright or © or Copr. 2012, Jean-François Hren
+ *
+ * Author e-mail: jean-francois.hren@inria.fr
+ *
+ * This software is a computer program whose purpose is to control
+ * deterministic systems using optimistic planning.
+ *
+ * This software is governed by the CeCILL license under French law and
+ * abiding by the rules of distribution of free software.  You can  use, 
+ * modify and/ or redistribute the software under the terms of the CeCILL
+ * license as circulated by CEA, CNRS and INRIA at the following URL
+ * "http://www.cecill.info". 
+ *
+ * As a counterpart to the access to the source code and  rights to copy,
+ * modify and redistribute granted by the license, users are provided only
+ * with a limited warranty  and the software's author,  the holder of the
+ * economic rights,  and the successive licensors  have only  limited
+ * liability. 
+ *
+ * In this respect, the user's attention is drawn to the risks associated
+ * with loading,  using,  modifying and/or developing or reproducing the
+ * software by the user in light of its specific status of free software,
+ * that may mean  that it is complicated to manipulate,  and  that  also
+ * therefore means  that it is reserved for developers  and  experienced
+ * professionals having in-depth computer knowledge. Users are therefore
+ * encouraged to load and test the software's suitability as regards their
+ * requirements in conditions enabling the security of their systems and/or 
+ * data to be ensured and,  more generally, to use and operate it in the 
+ * same conditions as regards security. 
+ *
+ * The fact that you are presently reading this means that you have had
+ * knowledge of the CeCILL license and that you accept its terms.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <argtable2.h>
+
+#include "../algorithms/sequential_soo/soo.h"
+#include "soo_list.h"
+
+#define NB_H_MAX 5                                          /* The number of hMax functions tried */
+#define NB_VALUE_KINDS 4                                    /* The number of ways of drawing the values tried */
+#define RESET_PROBABILITY 0.0005                            /* The probability of resetting both instances after an evaluation */
+
+
+static unsigned int hMaxSqrt(unsigned int n) {
+
+    return (unsigned int)sqrt(n);
+
+}
+
+
+static unsigned int hMaxCbrt(unsigned int n) {
+
+    return (unsigned int)cbrt(n);
+
+}
+
+
+static unsigned int hMaxFour(unsigned int n) {
+
+    (void)n;
+    return 4;
+
+}
+
+
+static unsigned int hMaxUnbounded(unsigned int n) {
+
+    (void)n;
+    return 100000;
+
+}
+
+
+/* A bound going up and down, which moves the current depth back and forth */
+
+static unsigned int hMaxSawtooth(unsigned int n) {
+
+    return (n / 7) % 13;
+
+}
+
+
+static unsigned int (*hMaxFunctions[NB_H_MAX])(unsigned int) = {hMaxSqrt, hMaxCbrt, hMaxFour, hMaxUnbounded, hMaxSawtooth};
+
+
+/* A linear congruential generator, so that a failing trial can be replayed from its number alone */
+
+static unsigned long long generator = 0;
+
+static double drawUniform() {
+
+    generator = (generator * 6364136223846793005ULL) + 1442695040888963407ULL;
+
+    return (generator >> 11) * (1.0 / 9007199254740992.0);
+
+}
+
+
+/*+------------------------------------------+
+  | Draw the value of an action. The kinds   |
+  | are: a few values only, so ties abound;  |
+  | uniform values; a smooth function; and   |
+  | plateaus mixed with an oscillation.      |
+  +------------------------------------------+*/
+
+static double drawValue(unsigned int kind, double* action, unsigned int step) {
+
+    double value = 0.0;
+    unsigned int i = 1;
+
+    switch(kind) {
+        case 0:
+            value = floor(drawUniform() * 4.0) / 4.0;
+            break;
+        case 1:
+            value = drawUniform();
+            break;
+        case 2:
+            value = -fabs(action[0] - 0.3) * (1.0 + (0.1 * step));
+            for(; i < NUMBER_OF_DIMENSIONS_OF_ACTION; i++)
+                value -= fabs(action[i] - 0.7);
+            break;
+        default:
+            value = drawUniform() < 0.5 ? 0.0 : sin(37.0 * action[0]);
+            break;
+    }
+
+    return value;
+
+}
+
+
+/* Feed the heap-based SOO and the linked-list one the same values over randomized trials, */
+/* and fail at the first action on which they differ. */
+
+int main(int argc, char* argv[]) {
+
+    unsigned int trial = 0;
+    unsigned int nbTrials = 0;
+    unsigned int maxNbSteps = 0;
+    unsigned long seed = 0;
+    unsigned long long nbEvaluations = 0;
+
+    struct arg_int* n = arg_int0("n", NULL, "<n>", "The number of trials (400 by default)");
+    struct arg_int* s = arg_int0("s", NULL, "<n>", "The maximum number of evaluations of a trial (20000 by default)");
+    struct arg_int* e = arg_int0(NULL, "seed", "<n>", "Added to the trial number to seed a trial (0 by default)");
+    struct arg_end* end = arg_end(4);
+
+    void* argtable[4];
+
+    int nerrors = 0;
+
+    argtable[0] = n;
+    argtable[1] = s;
+    argtable[2] = e;
+    argtable[3] = end;
+
+    n->ival[0] = 400;
+    s->ival[0] = 20000;
+    e->ival[0] = 0;
+
+    if(arg_nullcheck(argtable) != 0) {
+        printf("error: insufficient memory\n");
+        arg_freetable(argtable, 4);
+        return EXIT_FAILURE;
+    }
+
+    nerrors = arg_parse(argc, argv, argtable);
+
+    if(nerrors > 0) {
+        printf("%s:", argv[0]);
+        arg_print_syntax(stdout, argtable, "\n");
+        arg_print_errors(stdout, end, argv[0]);
+        arg_freetable(argtable, 4);
+        return EXIT_FAILURE;
+    }
+
+    nbTrials = n->ival[0] > 0 ? n->ival[0] : 1;
+    maxNbSteps = s->ival[0] > 0 ? s->ival[0] : 1;
+    seed = e->ival[0] > 0 ? (unsigned long)e->ival[0] : 0;
+
+    arg_freetable(argtable, 4);
+
+    for(; trial < nbTrials; trial++) {
+        unsigned int kind = trial % NB_VALUE_KINDS;
+        unsigned int hMaxIndex = (trial / NB_VALUE_KINDS) % NB_H_MAX;
+        unsigned int nbSteps = 0;
+        unsigned int step = 0;
+        soo* heaps = soo_init(hMaxFunctions[hMaxIndex]);
+        soo_list* lists = soo_list_init(hMaxFunctions[hMaxIndex]);
+
+        generator = ((seed + trial) * 2654435761ULL) + 1;
+        nbSteps = 1 + (unsigned int)(drawUniform() * maxNbSteps);
+
+        for(; step < nbSteps; step++) {
+            double* action = soo_getAnAction(heaps);
+            double* reference = soo_list_getAnAction(lists);
+            double value = 0.0;
+
+            if(memcmp(action, reference, sizeof(double) * NUMBER_OF_DIMENSIONS_OF_ACTION) != 0) {
+                printf("trial %lu, evaluation %u, values of kind %u, hMax %u: %.17g instead of %.17g\n", seed + trial, step, kind, hMaxIndex, action[0], reference[0]);
+                soo_uninit(&heaps);
+                soo_list_uninit(&lists);
+                return EXIT_FAILURE;
+            }
+
+            value = drawValue(kind, action, step);
+            soo_updateValue(heaps, value);
+            soo_list_updateValue(lists, value);
+            nbEvaluations++;
+
+            if(drawUniform() < RESET_PROBABILITY) {
+                soo_reset(heaps);
+                soo_list_reset(lists);
+            }
+        }
+
+        soo_uninit(&heaps);
+        soo_list_uninit(&lists);
+    }
+
+    printf("%u trials, %llu evaluations: the heaps select the same actions as the linked lists\n", nbTrials, nbEvaluations);
+
+    return EXIT_SUCCESS;
+
+}
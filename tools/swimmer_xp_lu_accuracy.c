@@ -0,0 +1,228 @@
+/* Copyright or © or Copr. 2012, Jean-François Hren
+ *
+ * Author e-mail: jean-francois.hren@inria.fr
+ *
+ * This software is a computer program whose purpose is to control
+ * deterministic systems using optimistic planning.
+ *
+ * This software is governed by the CeCILL license under French law and
+ * abiding by the rules of distribution of free software.  You can  use, 
+ * modify and/ or redistribute the software under the terms of the CeCILL
+ * license as circulated by CEA, CNRS and INRIA at the following URL
+ * "http://www.cecill.info". 
+ *
+ * As a counterpart to the access to the source code and  rights to copy,
+ * modify and redistribute granted by the license, users are provided only
+ * with a limited warranty  and the software's author,  the holder of the
+ * economic rights,  and the successive licensors  have only  limited
+ * liability. 
+ *
+ * In this respect, the user's attention is drawn to the risks associated
+ * with loading,  using,  modifying and/or developing or reproducing the
+ * software by the user in light of its specific status of free software,
+ * that may mean  that it is complicated to manipulate,  and  that  also
+ * therefore means  that it is reserved for developers  and  experienced
+ * professionals having in-depth computer knowledge. Users are therefore
+ * encouraged to load and test the software's suitability as regards their
+ * requirements in conditions enabling the security of their systems and/or 
+ * data to be ensured and,  more generally, to use and operate it in the 
+ * same conditions as regards security. 
+ *
+ * The fact that you are presently reading this means that you have had
+ * knowledge of the CeCILL license and that you accept its terms.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include <argtable2.h>
+#include <gsl/gsl_rng.h>
+
+#include "../problems/swimmer/swimmer.h"
+
+#define NB_VALUES (6 + (2 * (NUMBER_OF_DIMENSIONS_OF_ACTION + 1))) /* The number of doubles making up a state */
+#define NB_CHECKPOINTS 10                                          /* The number of points of the rollout written and compared */
+
+
+/*+------------------------------------------+
+  | Copy the doubles making up a state into  |
+  | values                                   |
+  +------------------------------------------+*/
+
+static void packState(state* s, double* values) {
+
+    unsigned int i = 0;
+
+    values[0] = s->AZero[0];
+    values[1] = s->AZero[1];
+    values[2] = s->G[0];
+    values[3] = s->G[1];
+    values[4] = s->GDot[0];
+    values[5] = s->GDot[1];
+
+    for(; i < (NUMBER_OF_DIMENSIONS_OF_ACTION + 1); i++) {
+        values[6 + i] = s->theta[i];
+        values[6 + NUMBER_OF_DIMENSIONS_OF_ACTION + 1 + i] = s->thetaDot[i];
+    }
+
+}
+
+
+/* Run a long rollout of the swimmer with seeded random actions and write, at NB_CHECKPOINTS */
+/* points, the sum of rewards and the state. Given the file written by the build with the */
+/* other LU solver, print how far both rollouts drift apart instead. */
+
+int main(int argc, char* argv[]) {
+
+    unsigned int i = 0;
+    unsigned int nbSteps = 0;
+    unsigned int period = 0;
+    unsigned long seed = 0;
+    model_context* context = NULL;
+    gsl_rng* rng = NULL;
+    state* crtState = NULL;
+    state* nextState = NULL;
+    double action[NUMBER_OF_DIMENSIONS_OF_ACTION];
+    double values[NB_VALUES];
+    double reward = 0.0;
+    double sumOfRewards = 0.0;
+    FILE* outputFileFd = NULL;
+    FILE* referenceFileFd = NULL;
+    int status = EXIT_SUCCESS;
+
+    struct arg_int* s = arg_int0("s", NULL, "<n>", "The number of steps of the rollout (200000 by default)");
+    struct arg_int* e = arg_int0(NULL, "seed", "<n>", "The seed of the actions (1 by default)");
+    struct arg_file* o = arg_file0("o", NULL, "<file>", "The file where the checkpoints are written");
+    struct arg_file* r = arg_file0(NULL, "reference", "<file>", "A file written by the other solver to compare with");
+    struct arg_end* end = arg_end(5);
+
+    void* argtable[5];
+
+    int nerrors = 0;
+
+    argtable[0] = s;
+    argtable[1] = e;
+    argtable[2] = o;
+    argtable[3] = r;
+    argtable[4] = end;
+
+    s->ival[0] = 200000;
+    e->ival[0] = 1;
+
+    if(arg_nullcheck(argtable) != 0) {
+        printf("error: insufficient memory\n");
+        arg_freetable(argtable, 5);
+        return EXIT_FAILURE;
+    }
+
+    nerrors = arg_parse(argc, argv, argtable);
+
+    if((nerrors > 0) || ((o->count == 0) && (r->count == 0))) {
+        printf("%s:", argv[0]);
+        arg_print_syntax(stdout, argtable, "\n");
+        arg_print_errors(stdout, end, argv[0]);
+        arg_freetable(argtable, 5);
+        return EXIT_FAILURE;
+    }
+
+    nbSteps = s->ival[0] > 0 ? s->ival[0] : 1;
+    seed = e->ival[0] > 0 ? (unsigned long)e->ival[0] : 1;
+    period = nbSteps >= NB_CHECKPOINTS ? nbSteps / NB_CHECKPOINTS : 1;
+
+    if(o->count > 0)
+        outputFileFd = fopen(o->filename[0], "w");
+    if(r->count > 0)
+        referenceFileFd = fopen(r->filename[0], "r");
+
+    arg_freetable(argtable, 5);
+
+    if(((outputFileFd == NULL) && (referenceFileFd == NULL))) {
+        printf("error: cannot open the files\n");
+        return EXIT_FAILURE;
+    }
+
+    initGenerativeModelParameters();
+    initGenerativeModel();
+    context = initModelContext();
+
+    rng = gsl_rng_alloc(gsl_rng_mt19937);
+    gsl_rng_set(rng, seed);
+
+    crtState = initStateWithContext(context);
+    nextState = copyState(crtState);
+
+    if(referenceFileFd != NULL)
+        printf("step, max difference of the state, difference of the sum of rewards\n");
+
+    for(i = 1; i <= nbSteps; i++) {
+        state* tmp = crtState;
+        unsigned int j = 0;
+
+        for(; j < NUMBER_OF_DIMENSIONS_OF_ACTION; j++)
+            action[j] = gsl_rng_uniform(rng);
+
+        nextStateRewardIntoWithContext(context, crtState, action, nextState, &reward);
+        sumOfRewards += reward;
+
+        crtState = nextState;
+        nextState = tmp;
+
+        if(((i % period) != 0) && (i != nbSteps))
+            continue;
+
+        packState(crtState, values);
+
+        if(outputFileFd != NULL) {
+            fprintf(outputFileFd, "%u %.17g", i, sumOfRewards);
+            for(j = 0; j < NB_VALUES; j++)
+                fprintf(outputFileFd, " %.17g", values[j]);
+            fprintf(outputFileFd, "\n");
+        }
+
+        if(referenceFileFd != NULL) {
+            unsigned int step = 0;
+            double referenceSum = 0.0;
+            double maxDifference = 0.0;
+
+            if((fscanf(referenceFileFd, "%u %lf", &step, &referenceSum) != 2) || (step != i)) {
+                printf("error: the reference does not match the rollout at step %u\n", i);
+                status = EXIT_FAILURE;
+                break;
+            }
+
+            for(j = 0; j < NB_VALUES; j++) {
+                double referenceValue = 0.0;
+
+                if(fscanf(referenceFileFd, "%lf", &referenceValue) != 1) {
+                    printf("error: the reference state is cut short at step %u\n", i);
+                    status = EXIT_FAILURE;
+                    break;
+                }
+
+                if(fabs(values[j] - referenceValue) > maxDifference)
+                    maxDifference = fabs(values[j] - referenceValue);
+            }
+
+            if(status == EXIT_FAILURE)
+                break;
+
+            printf("%u, %g, %g\n", i, maxDifference, fabs(sumOfRewards - referenceSum));
+        }
+    }
+
+    if(outputFileFd != NULL)
+        fclose(outputFileFd);
+    if(referenceFileFd != NULL)
+        fclose(referenceFileFd);
+
+    freeState(crtState);
+    freeState(nextState);
+    gsl_rng_free(rng);
+
+    freeModelContext(context);
+    freeGenerativeModel();
+    freeGenerativeModelParameters();
+
+    return status;
+
+}
@@ -0,0 +1,144 @@
+/* Copyright or © or Copr. 2012, Jean-François Hren
+ *
+ * Author e-mail: jean-francois.hren@inria.fr
+ *
+ * This software is a computer program whose purpose is to control
+ * deterministic systems using optimistic planning.
+ *
+ * This software is governed by the CeCILL license under French law and
+ * abiding by the rules of distribution of free software.  You can  use, 
+ * modify and/ or redistribute the software under the terms of the CeCILL
+ * license as circulated by CEA, CNRS and INRIA at the following URL
+ * "http://www.cecill.info". 
+ *
+ * As a counterpart to the access to the source code and  rights to copy,
+ * modify and redistribute granted by the license, users are provided only
+ * with a limited warranty  and the software's author,  the holder of the
+ * economic rights,  and the successive licensors  have only  limited
+ * liability. 
+ *
+ * In this respect, the user's attention is drawn to the risks associated
+ * with loading,  using,  modifying and/or developing or reproducing the
+ * software by the user in light of its specific status of free software,
+ * that may mean  that it is complicated to manipulate,  and  that  also
+ * therefore means  that it is reserved for developers  and  experienced
+ * professionals having in-depth computer knowledge. Users are therefore
+ * encouraged to load and test the software's suitability as regards their
+ * requirements in conditions enabling the security of their systems and/or 
+ * data to be ensured and,  more generally, to use and operate it in the 
+ * same conditions as regards security. 
+ *
+ * The fact that you are presently reading this means that you have had
+ * knowledge of the CeCILL license and that you accept its terms.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <argtable2.h>
+#include <gsl/gsl_rng.h>
+
+#include "../algorithms/deadline/deadline.h"
+#include "../problems/swimmer/swimmer.h"
+
+#define NB_STARTING_STATES 1024                             /* The transitions start from these states in turn */
+
+
+/* Time the transitions of the swimmer from states spread along a random rollout. */
+/* Linked once with swimmer_<n>.o and once with swimmer_gsl_<n>.o to compare the */
+/* dedicated LU solver with GSL, which takes most of a transition. */
+
+int main(int argc, char* argv[]) {
+
+    unsigned int i = 0;
+    unsigned int nbTransitions = 0;
+    unsigned long seed = 0;
+    model_context* context = NULL;
+    gsl_rng* rng = NULL;
+    state* startingStates[NB_STARTING_STATES];
+    double* actions = NULL;
+    state* nextState = NULL;
+    double reward = 0.0;
+    double sumOfRewards = 0.0;
+    double start = 0.0;
+    double elapsed = 0.0;
+
+    struct arg_int* n = arg_int0("n", NULL, "<n>", "The number of transitions timed (1000000 by default)");
+    struct arg_int* e = arg_int0(NULL, "seed", "<n>", "The seed of the states and actions (1 by default)");
+    struct arg_end* end = arg_end(3);
+
+    void* argtable[3];
+
+    int nerrors = 0;
+
+    argtable[0] = n;
+    argtable[1] = e;
+    argtable[2] = end;
+
+    n->ival[0] = 1000000;
+    e->ival[0] = 1;
+
+    if(arg_nullcheck(argtable) != 0) {
+        printf("error: insufficient memory\n");
+        arg_freetable(argtable, 3);
+        return EXIT_FAILURE;
+    }
+
+    nerrors = arg_parse(argc, argv, argtable);
+
+    if(nerrors > 0) {
+        printf("%s:", argv[0]);
+        arg_print_syntax(stdout, argtable, "\n");
+        arg_print_errors(stdout, end, argv[0]);
+        arg_freetable(argtable, 3);
+        return EXIT_FAILURE;
+    }
+
+    nbTransitions = n->ival[0] > 0 ? n->ival[0] : 1;
+    seed = e->ival[0] > 0 ? (unsigned long)e->ival[0] : 1;
+
+    arg_freetable(argtable, 3);
+
+    initGenerativeModelParameters();
+    initGenerativeModel();
+    context = initModelContext();
+
+    rng = gsl_rng_alloc(gsl_rng_mt19937);
+    gsl_rng_set(rng, seed);
+
+    actions = (double*)malloc(sizeof(double) * NUMBER_OF_DIMENSIONS_OF_ACTION * NB_STARTING_STATES);
+    for(i = 0; i < (NUMBER_OF_DIMENSIONS_OF_ACTION * NB_STARTING_STATES); i++)
+        actions[i] = gsl_rng_uniform(rng);
+
+    startingStates[0] = initStateWithContext(context);
+    for(i = 1; i < NB_STARTING_STATES; i++)
+        nextStateRewardWithContext(context, startingStates[i - 1], actions + ((i - 1) * NUMBER_OF_DIMENSIONS_OF_ACTION), startingStates + i, &reward);
+
+    nextState = copyState(startingStates[0]);
+
+    start = deadline_now();
+
+    for(i = 0; i < nbTransitions; i++) {
+        unsigned int j = i % NB_STARTING_STATES;
+
+        nextStateRewardIntoWithContext(context, startingStates[j], actions + (j * NUMBER_OF_DIMENSIONS_OF_ACTION), nextState, &reward);
+        sumOfRewards += reward;
+    }
+
+    elapsed = deadline_now() - start;
+
+    /* The sum keeps the transitions from being optimized away and tells both solvers apart if they disagree */
+    printf("%u segments, %u transitions: %.1f ns per transition (sum of rewards %.17g)\n", NUMBER_OF_DIMENSIONS_OF_ACTION + 1, nbTransitions, (elapsed * 1e9) / nbTransitions, sumOfRewards);
+
+    for(i = 0; i < NB_STARTING_STATES; i++)
+        freeState(startingStates[i]);
+    freeState(nextState);
+    free(actions);
+    gsl_rng_free(rng);
+
+    freeModelContext(context);
+    freeGenerativeModel();
+    freeGenerativeModelParameters();
+
+    return EXIT_SUCCESS;
+
+}
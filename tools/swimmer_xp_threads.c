@@ -0,0 +1,227 @@
+/* Copyright or © or Copr. 2012, Jean-François Hren
+ *
+ * Author e-mail: jean-francois.hren@inria.fr
+ *
+ * This software is a computer program whose purpose is to control
+ * deterministic systems using optimistic planning.
+ *
+ * This software is governed by the CeCILL license under French law and
+ * abiding by the rules of distribution of free software.  You can  use, 
+ * modify and/ or redistribute the software under the terms of the CeCILL
+ * license as circulated by CEA, CNRS and INRIA at the following URL
+ * "http://www.cecill.info". 
+ *
+ * As a counterpart to the access to the source code and  rights to copy,
+ * modify and redistribute granted by the license, users are provided only
+ * with a limited warranty  and the software's author,  the holder of the
+ * economic rights,  and the successive licensors  have only  limited
+ * liability. 
+ *
+ * In this respect, the user's attention is drawn to the risks associated
+ * with loading,  using,  modifying and/or developing or reproducing the
+ * software by the user in light of its specific status of free software,
+ * that may mean  that it is complicated to manipulate,  and  that  also
+ * therefore means  that it is reserved for developers  and  experienced
+ * professionals having in-depth computer knowledge. Users are therefore
+ * encouraged to load and test the software's suitability as regards their
+ * requirements in conditions enabling the security of their systems and/or 
+ * data to be ensured and,  more generally, to use and operate it in the 
+ * same conditions as regards security. 
+ *
+ * The fact that you are presently reading this means that you have had
+ * knowledge of the CeCILL license and that you accept its terms.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <argtable2.h>
+#include <gsl/gsl_rng.h>
+
+#include "../algorithms/worker_pool/worker_pool.h"
+#include "../problems/swimmer/swimmer.h"
+
+
+/*+------------------------------------------+
+  | The rollouts of a run, one per swimmer   |
+  +------------------------------------------+*/
+
+typedef struct {
+
+    model_context* context;                                 /* The parameters shared by every swimmer */
+    unsigned int nbSteps;                                   /* The length of a rollout */
+    unsigned long seed;                                     /* The actions of the i-th swimmer are drawn from seed + i */
+    state** finalStates;                                    /* The state each swimmer ends in */
+    double* sumsOfRewards;                                  /* The sum of the rewards of each swimmer */
+
+} swimmer_run;
+
+
+/*+------------------------------------------+
+  | Step the index-th swimmer from the       |
+  | initial state with actions drawn from    |
+  | its own generator                        |
+  +------------------------------------------+*/
+
+static void rolloutTask(void* data, unsigned int index) {
+
+    swimmer_run* run = (swimmer_run*)data;
+    gsl_rng* rng = gsl_rng_alloc(gsl_rng_mt19937);
+    state* crtState = initStateWithContext(run->context);
+    state* nextState = copyState(crtState);
+    double action[NUMBER_OF_DIMENSIONS_OF_ACTION];
+    double reward = 0.0;
+    unsigned int i = 0;
+
+    gsl_rng_set(rng, run->seed + index);
+    run->sumsOfRewards[index] = 0.0;
+
+    for(; i < run->nbSteps; i++) {
+        state* tmp = crtState;
+        unsigned int j = 0;
+
+        for(; j < NUMBER_OF_DIMENSIONS_OF_ACTION; j++)
+            action[j] = gsl_rng_uniform(rng);
+
+        nextStateRewardIntoWithContext(run->context, crtState, action, nextState, &reward);
+        run->sumsOfRewards[index] += reward;
+
+        crtState = nextState;
+        nextState = tmp;
+    }
+
+    memcpy(run->finalStates[index], crtState, stateSize());
+
+    freeState(crtState);
+    freeState(nextState);
+    gsl_rng_free(rng);
+
+}
+
+
+/*+------------------------------------------+
+  | Prepare a run of nbSwimmers rollouts     |
+  +------------------------------------------+*/
+
+static void initRun(swimmer_run* run, model_context* context, unsigned int nbSwimmers, unsigned int nbSteps, unsigned long seed) {
+
+    unsigned int i = 0;
+
+    run->context = context;
+    run->nbSteps = nbSteps;
+    run->seed = seed;
+    run->finalStates = (state**)malloc(sizeof(state*) * nbSwimmers);
+    run->sumsOfRewards = (double*)malloc(sizeof(double) * nbSwimmers);
+
+    for(; i < nbSwimmers; i++)
+        run->finalStates[i] = initStateWithContext(context);
+
+}
+
+
+static void uninitRun(swimmer_run* run, unsigned int nbSwimmers) {
+
+    unsigned int i = 0;
+
+    for(; i < nbSwimmers; i++)
+        freeState(run->finalStates[i]);
+
+    free(run->finalStates);
+    free(run->sumsOfRewards);
+
+}
+
+
+/* Step the same swimmers on the calling thread then on nbThreads threads at once, */
+/* and fail unless both runs give bit-identical states and rewards. */
+
+int main(int argc, char* argv[]) {
+
+    unsigned int i = 0;
+    unsigned int nbSwimmers = 0;
+    unsigned int nbSteps = 0;
+    unsigned int nbThreads = 0;
+    unsigned int nbDifferences = 0;
+    unsigned long seed = 0;
+    model_context* context = NULL;
+    worker_pool* pool = NULL;
+    swimmer_run serialRun;
+    swimmer_run threadedRun;
+
+    struct arg_int* n = arg_int0("n", NULL, "<n>", "The number of swimmers (64 by default)");
+    struct arg_int* s = arg_int0("s", NULL, "<n>", "The number of steps of each swimmer (1000 by default)");
+    struct arg_int* w = arg_int0(NULL, "threads", "<n>", "The number of threads stepping the swimmers (16 by default)");
+    struct arg_int* e = arg_int0(NULL, "seed", "<n>", "The seed of the actions (1 by default)");
+    struct arg_end* end = arg_end(5);
+
+    void* argtable[5];
+
+    int nerrors = 0;
+
+    argtable[0] = n;
+    argtable[1] = s;
+    argtable[2] = w;
+    argtable[3] = e;
+    argtable[4] = end;
+
+    n->ival[0] = 64;
+    s->ival[0] = 1000;
+    w->ival[0] = 16;
+    e->ival[0] = 1;
+
+    if(arg_nullcheck(argtable) != 0) {
+        printf("error: insufficient memory\n");
+        arg_freetable(argtable, 5);
+        return EXIT_FAILURE;
+    }
+
+    nerrors = arg_parse(argc, argv, argtable);
+
+    if(nerrors > 0) {
+        printf("%s:", argv[0]);
+        arg_print_syntax(stdout, argtable, "\n");
+        arg_print_errors(stdout, end, argv[0]);
+        arg_freetable(argtable, 5);
+        return EXIT_FAILURE;
+    }
+
+    nbSwimmers = n->ival[0] > 0 ? n->ival[0] : 1;
+    nbSteps = s->ival[0] > 0 ? s->ival[0] : 1;
+    nbThreads = w->ival[0] > 0 ? w->ival[0] : 1;
+    seed = e->ival[0] > 0 ? (unsigned long)e->ival[0] : 1;
+
+    arg_freetable(argtable, 5);
+
+    initGenerativeModelParameters();
+    initGenerativeModel();
+    context = initModelContext();
+
+    initRun(&serialRun, context, nbSwimmers, nbSteps, seed);
+    initRun(&threadedRun, context, nbSwimmers, nbSteps, seed);
+
+    for(i = 0; i < nbSwimmers; i++)
+        rolloutTask(&serialRun, i);
+
+    pool = worker_pool_init(nbThreads);
+    worker_pool_run(pool, rolloutTask, &threadedRun, nbSwimmers);
+    worker_pool_uninit(&pool);
+
+    for(i = 0; i < nbSwimmers; i++) {
+        if((memcmp(serialRun.finalStates[i], threadedRun.finalStates[i], stateSize()) != 0) || (memcmp(serialRun.sumsOfRewards + i, threadedRun.sumsOfRewards + i, sizeof(double)) != 0)) {
+            printf("swimmer %u: %.17g on one thread, %.17g on %u threads\n", i, serialRun.sumsOfRewards[i], threadedRun.sumsOfRewards[i], nbThreads);
+            nbDifferences++;
+        }
+    }
+
+    printf("%u segments, %u swimmers, %u steps, %u threads: %u differences\n", NUMBER_OF_DIMENSIONS_OF_ACTION + 1, nbSwimmers, nbSteps, nbThreads, nbDifferences);
+
+    uninitRun(&serialRun, nbSwimmers);
+    uninitRun(&threadedRun, nbSwimmers);
+
+    freeModelContext(context);
+    freeGenerativeModel();
+    freeGenerativeModelParameters();
+
+    return nbDifferences == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+
+}
@@ -2,11 +2,25 @@ CC_OPTIONS := -O3
 USE_SDL := 1
 CC := gcc
 FLAGS := -W -Wall $(CC_OPTIONS) -ansi -std=c99 -pedantic -Werror
-LIBS := -lm$(if $(USE_SDL), /usr/lib/libSDL_gfx.so -lSDL -lSDLmain) -largtable2 -lgsl -lgslcblas
+LIBS := -lm$(if $(USE_SDL), /usr/lib/libSDL_gfx.so -lSDL -lSDLmain) -largtable2 -lgsl -lgslcblas -lpthread
+#Routes the calls to the allocators through the timing wrappers of sequential_soo_xp_allocator (GNU ld)
+ALLOCATOR_WRAPS := -Wl,--wrap=malloc,--wrap=realloc,--wrap=free,--wrap=arena_alloc,--wrap=arena_realloc,--wrap=arena_free,--wrap=arena_reset
 BIN_DIR := ../bin
 OBJ_DIR := ../obj
 
-all: $(addprefix $(BIN_DIR)/lipschitzian_xp_sum_,$(PROBLEMS)) $(addprefix $(BIN_DIR)/sequential_xp_sum_,$(PROBLEMS)) $(addprefix $(BIN_DIR)/sequential_soo_xp_sum_,$(PROBLEMS)) $(addprefix $(BIN_DIR)/random_search_xp_sum_,$(PROBLEMS)) $(foreach i,2 3 4 5,$(BIN_DIR)/lipschitzian_xp_sum_$i_swimmer $(BIN_DIR)/sequential_xp_sum_$i_swimmer $(BIN_DIR)/sequential_soo_xp_sum_$i_swimmer $(BIN_DIR)/random_search_xp_sum_$i_swimmer) $(BIN_DIR)/problems_xp_initial_states
+all: $(addprefix $(BIN_DIR)/lipschitzian_xp_sum_,$(PROBLEMS)) $(addprefix $(BIN_DIR)/sequential_xp_sum_,$(PROBLEMS)) $(addprefix $(BIN_DIR)/sequential_soo_xp_sum_,$(PROBLEMS)) $(addprefix $(BIN_DIR)/random_search_xp_sum_,$(PROBLEMS)) $(addprefix $(BIN_DIR)/sequential_soo_xp_allocator_,$(PROBLEMS)) $(addprefix $(BIN_DIR)/sequential_soo_xp_threads_,$(PROBLEMS)) $(foreach i,2 3 4 5,$(BIN_DIR)/lipschitzian_xp_sum_$i_swimmer $(BIN_DIR)/sequential_xp_sum_$i_swimmer $(BIN_DIR)/sequential_soo_xp_sum_$i_swimmer $(BIN_DIR)/random_search_xp_sum_$i_swimmer) $(BIN_DIR)/problems_xp_initial_states $(BIN_DIR)/lipschitzian_xp_frontier $(foreach i,2 3 4 5,$(BIN_DIR)/swimmer_xp_threads_$i $(BIN_DIR)/swimmer_xp_lu_timing_$i $(BIN_DIR)/swimmer_xp_lu_timing_gsl_$i $(BIN_DIR)/swimmer_xp_lu_accuracy_$i $(BIN_DIR)/swimmer_xp_lu_accuracy_gsl_$i) $(foreach i,1 2 3,$(BIN_DIR)/soo_xp_differential_$i $(BIN_DIR)/direct_xp_differential_$i)
+
+.PHONY: check
+
+#Fails unless swimmers stepped on 16 threads end bit-identical to the same swimmers stepped on one,
+#unless the batched sequential SOO plans the same on 1 to 16 threads,
+#or unless the SOO heaps, the DIRECT upper hull and the lipschitzian frontier select the same as the code they replaced
+check: $(foreach i,2 3 4 5,$(BIN_DIR)/swimmer_xp_threads_$i) $(foreach p,cart_pole double_cart_pole,$(BIN_DIR)/sequential_soo_xp_threads_$p) $(foreach i,1 2 3,$(BIN_DIR)/soo_xp_differential_$i $(BIN_DIR)/direct_xp_differential_$i) $(BIN_DIR)/lipschitzian_xp_frontier
+	$(foreach i,2 3 4 5,$(BIN_DIR)/swimmer_xp_threads_$i --threads 16 &&) true
+	$(foreach p,cart_pole double_cart_pole,$(BIN_DIR)/sequential_soo_xp_threads_$p --threads 16 &&) true
+	$(foreach i,1 2 3,$(BIN_DIR)/soo_xp_differential_$i &&) true
+	$(foreach i,1 2 3,$(BIN_DIR)/direct_xp_differential_$i &&) true
+	$(BIN_DIR)/lipschitzian_xp_frontier -n 100000
 
 $(BIN_DIR)/problems_xp_initial_states: $(OBJ_DIR)/problems_xp_initial_states.o
 	$(CC) $(FLAGS) $(LIBS) $< -o $@
@@ -14,16 +28,28 @@ $(BIN_DIR)/problems_xp_initial_states: $(OBJ_DIR)/problems_xp_initial_states.o
 $(OBJ_DIR)/problems_xp_initial_states.o: problems_xp_initial_states.c
 	$(CC) -c $(FLAGS) $< -o $@
 
-$(BIN_DIR)/lipschitzian_xp_sum_double_cart_pole: $(OBJ_DIR)/lipschitzian_xp_sum_double_cart_pole.o $(OBJ_DIR)/lipschitzian_2.o $(OBJ_DIR)/double_cart_pole.o
+$(BIN_DIR)/lipschitzian_xp_frontier: $(OBJ_DIR)/deadline.o $(OBJ_DIR)/lipschitzian_xp_frontier.o
 	$(CC) $(FLAGS) $(LIBS) $^ -o $@
 
-$(BIN_DIR)/random_search_xp_sum_double_cart_pole: $(OBJ_DIR)/random_search_xp_sum_double_cart_pole.o $(OBJ_DIR)/random_search_2.o $(OBJ_DIR)/double_cart_pole.o
+$(OBJ_DIR)/lipschitzian_xp_frontier.o: lipschitzian_xp_frontier.c ../algorithms/lipschitzian/lipschitzian.h
+	$(CC) -c $(FLAGS) -DNUMBER_OF_DIMENSIONS_OF_ACTION=1 $< -o $@
+
+$(BIN_DIR)/lipschitzian_xp_sum_double_cart_pole: $(OBJ_DIR)/deadline.o $(OBJ_DIR)/discount_powers.o $(OBJ_DIR)/worker_pool.o $(OBJ_DIR)/lipschitzian_xp_sum_double_cart_pole.o $(OBJ_DIR)/lipschitzian_2.o $(OBJ_DIR)/arena.o $(OBJ_DIR)/transition_cache.o $(OBJ_DIR)/double_cart_pole.o $(OBJ_DIR)/generative_model.o
 	$(CC) $(FLAGS) $(LIBS) $^ -o $@
 
-$(BIN_DIR)/sequential_xp_sum_double_cart_pole: $(OBJ_DIR)/sequential_xp_sum_double_cart_pole.o $(OBJ_DIR)/soo_2.o $(OBJ_DIR)/sequential_soo_2.o $(OBJ_DIR)/direct_2.o $(OBJ_DIR)/sequential_direct_2.o $(OBJ_DIR)/double_cart_pole.o
+$(BIN_DIR)/random_search_xp_sum_double_cart_pole: $(OBJ_DIR)/deadline.o $(OBJ_DIR)/discount_powers.o $(OBJ_DIR)/worker_pool.o $(OBJ_DIR)/random_search_xp_sum_double_cart_pole.o $(OBJ_DIR)/random_search_2.o $(OBJ_DIR)/double_cart_pole.o $(OBJ_DIR)/generative_model.o
 	$(CC) $(FLAGS) $(LIBS) $^ -o $@
 
-$(BIN_DIR)/sequential_soo_xp_sum_double_cart_pole: $(OBJ_DIR)/sequential_soo_xp_sum_double_cart_pole.o $(OBJ_DIR)/soo_2.o $(OBJ_DIR)/sequential_soo_2.o $(OBJ_DIR)/double_cart_pole.o
+$(BIN_DIR)/sequential_xp_sum_double_cart_pole: $(OBJ_DIR)/deadline.o $(OBJ_DIR)/worker_pool.o $(OBJ_DIR)/arena.o $(OBJ_DIR)/box_geometry.o $(OBJ_DIR)/sequential_xp_sum_double_cart_pole.o $(OBJ_DIR)/soo_2.o $(OBJ_DIR)/sequential_soo_2.o $(OBJ_DIR)/direct_2.o $(OBJ_DIR)/sequential_direct_2.o $(OBJ_DIR)/double_cart_pole.o $(OBJ_DIR)/generative_model.o
+	$(CC) $(FLAGS) $(LIBS) $^ -o $@
+
+$(BIN_DIR)/sequential_soo_xp_sum_double_cart_pole: $(OBJ_DIR)/deadline.o $(OBJ_DIR)/worker_pool.o $(OBJ_DIR)/arena.o $(OBJ_DIR)/box_geometry.o $(OBJ_DIR)/sequential_soo_xp_sum_double_cart_pole.o $(OBJ_DIR)/soo_2.o $(OBJ_DIR)/sequential_soo_2.o $(OBJ_DIR)/double_cart_pole.o $(OBJ_DIR)/generative_model.o
+	$(CC) $(FLAGS) $(LIBS) $^ -o $@
+
+$(BIN_DIR)/sequential_soo_xp_allocator_double_cart_pole: $(OBJ_DIR)/deadline.o $(OBJ_DIR)/worker_pool.o $(OBJ_DIR)/arena.o $(OBJ_DIR)/box_geometry.o $(OBJ_DIR)/sequential_soo_xp_allocator_2.o $(OBJ_DIR)/soo_2.o $(OBJ_DIR)/sequential_soo_2.o $(OBJ_DIR)/double_cart_pole.o $(OBJ_DIR)/generative_model.o
+	$(CC) $(FLAGS) $(LIBS) $(ALLOCATOR_WRAPS) $^ -o $@
+
+$(BIN_DIR)/sequential_soo_xp_threads_double_cart_pole: $(OBJ_DIR)/deadline.o $(OBJ_DIR)/worker_pool.o $(OBJ_DIR)/arena.o $(OBJ_DIR)/box_geometry.o $(OBJ_DIR)/sequential_soo_xp_threads_2.o $(OBJ_DIR)/soo_2.o $(OBJ_DIR)/sequential_soo_2.o $(OBJ_DIR)/double_cart_pole.o $(OBJ_DIR)/generative_model.o
 	$(CC) $(FLAGS) $(LIBS) $^ -o $@
 
 .SECONDARY: #Marked as secondary file that should not be deleted because of the chaining of implicit rule
@@ -51,6 +77,33 @@ $(OBJ_DIR)/sequential_xp_sum_double_cart_pole.o: sequential_xp_sum_problems.c
 $(OBJ_DIR)/sequential_soo_xp_sum_double_cart_pole.o: sequential_soo_xp_sum_problems.c
 	$(CC) -c $(FLAGS) -DDOUBLE_CART_POLE -DNUMBER_OF_DIMENSIONS_OF_ACTION=2 $< -o $@
 
+$(OBJ_DIR)/swimmer_xp_threads_%.o: swimmer_xp_threads.c
+	$(CC) -c $(FLAGS) -DNUMBER_OF_DIMENSIONS_OF_ACTION=$* $< -o $@
+
+$(OBJ_DIR)/soo_list_%.o: soo_list.c soo_list.h
+	$(CC) -c $(FLAGS) -DNUMBER_OF_DIMENSIONS_OF_ACTION=$* $< -o $@
+
+$(OBJ_DIR)/soo_xp_differential_%.o: soo_xp_differential.c soo_list.h
+	$(CC) -c $(FLAGS) -DNUMBER_OF_DIMENSIONS_OF_ACTION=$* $< -o $@
+
+$(OBJ_DIR)/direct_scan_%.o: direct_scan.c direct_scan.h
+	$(CC) -c $(FLAGS) -DNUMBER_OF_DIMENSIONS_OF_ACTION=$* $< -o $@
+
+$(OBJ_DIR)/direct_xp_differential_%.o: direct_xp_differential.c direct_scan.h
+	$(CC) -c $(FLAGS) -DNUMBER_OF_DIMENSIONS_OF_ACTION=$* $< -o $@
+
+$(OBJ_DIR)/sequential_soo_xp_allocator_%.o: sequential_soo_xp_allocator.c
+	$(CC) -c $(FLAGS) -DNUMBER_OF_DIMENSIONS_OF_ACTION=$* $< -o $@
+
+$(OBJ_DIR)/sequential_soo_xp_threads_%.o: sequential_soo_xp_threads.c
+	$(CC) -c $(FLAGS) -DNUMBER_OF_DIMENSIONS_OF_ACTION=$* $< -o $@
+
+$(OBJ_DIR)/swimmer_xp_lu_timing_%.o: swimmer_xp_lu_timing.c
+	$(CC) -c $(FLAGS) -DNUMBER_OF_DIMENSIONS_OF_ACTION=$* $< -o $@
+
+$(OBJ_DIR)/swimmer_xp_lu_accuracy_%.o: swimmer_xp_lu_accuracy.c
+	$(CC) -c $(FLAGS) -DNUMBER_OF_DIMENSIONS_OF_ACTION=$* $< -o $@
+
 $(OBJ_DIR)/lipschitzian_xp_sum_swimmer_%.o: lipschitzian_xp_sum_problems.c
 	$(CC) -c $(FLAGS) -DSWIMMER -DNUMBER_OF_DIMENSIONS_OF_ACTION=$* $< -o $@
 
@@ -76,26 +129,54 @@ $(OBJ_DIR)/sequential_soo_xp_sum_%.o: sequential_soo_xp_sum_problems.c
 	$(CC) -c $(FLAGS) -D$(shell echo $* | tr a-z A-Z) -DNUMBER_OF_DIMENSIONS_OF_ACTION=1 $< -o $@
 
 .SECONDEXPANSION:
-$(BIN_DIR)/lipschitzian_xp_sum_%_swimmer: $(OBJ_DIR)/lipschitzian_xp_sum_swimmer_$$*.o $(OBJ_DIR)/lipschitzian_%.o $(OBJ_DIR)/swimmer_$$*.o
+$(BIN_DIR)/swimmer_xp_threads_%: $(OBJ_DIR)/worker_pool.o $(OBJ_DIR)/swimmer_xp_threads_$$*.o $(OBJ_DIR)/swimmer_$$*.o $(OBJ_DIR)/generative_model.o
 	$(CC) $(FLAGS) $(LIBS) $^ -o $@
 
-$(BIN_DIR)/random_search_xp_sum_%_swimmer: $(OBJ_DIR)/random_search_xp_sum_swimmer_$$*.o $(OBJ_DIR)/random_search_%.o $(OBJ_DIR)/swimmer_$$*.o
+$(BIN_DIR)/soo_xp_differential_%: $(OBJ_DIR)/arena.o $(OBJ_DIR)/box_geometry.o $(OBJ_DIR)/soo_xp_differential_$$*.o $(OBJ_DIR)/soo_list_$$*.o $(OBJ_DIR)/soo_$$*.o
 	$(CC) $(FLAGS) $(LIBS) $^ -o $@
 
-$(BIN_DIR)/sequential_xp_sum_%_swimmer: $(OBJ_DIR)/sequential_xp_sum_swimmer_$$*.o $(OBJ_DIR)/soo_%.o $(OBJ_DIR)/sequential_soo_%.o $(OBJ_DIR)/direct_%.o $(OBJ_DIR)/sequential_direct_%.o $(OBJ_DIR)/swimmer_$$*.o
+$(BIN_DIR)/direct_xp_differential_%: $(OBJ_DIR)/box_geometry.o $(OBJ_DIR)/direct_xp_differential_$$*.o $(OBJ_DIR)/direct_scan_$$*.o $(OBJ_DIR)/direct_$$*.o
 	$(CC) $(FLAGS) $(LIBS) $^ -o $@
 
-$(BIN_DIR)/sequential_soo_xp_sum_%_swimmer: $(OBJ_DIR)/sequential_soo_xp_sum_swimmer_$$*.o $(OBJ_DIR)/soo_%.o $(OBJ_DIR)/sequential_soo_%.o $(OBJ_DIR)/swimmer_$$*.o
+#The same tools linked with the dedicated LU solver of the swimmer and with GSL
+$(BIN_DIR)/swimmer_xp_lu_timing_gsl_%: $(OBJ_DIR)/deadline.o $(OBJ_DIR)/swimmer_xp_lu_timing_$$*.o $(OBJ_DIR)/swimmer_gsl_$$*.o $(OBJ_DIR)/generative_model.o
 	$(CC) $(FLAGS) $(LIBS) $^ -o $@
 
-$(BIN_DIR)/lipschitzian_xp_sum_%: $(OBJ_DIR)/lipschitzian_xp_sum_$$*.o $(OBJ_DIR)/lipschitzian_1.o $(OBJ_DIR)/$$*.o
+$(BIN_DIR)/swimmer_xp_lu_timing_%: $(OBJ_DIR)/deadline.o $(OBJ_DIR)/swimmer_xp_lu_timing_$$*.o $(OBJ_DIR)/swimmer_$$*.o $(OBJ_DIR)/generative_model.o
 	$(CC) $(FLAGS) $(LIBS) $^ -o $@
 
-$(BIN_DIR)/random_search_xp_sum_%: $(OBJ_DIR)/random_search_xp_sum_$$*.o $(OBJ_DIR)/random_search_1.o $(OBJ_DIR)/$$*.o
+$(BIN_DIR)/swimmer_xp_lu_accuracy_gsl_%: $(OBJ_DIR)/swimmer_xp_lu_accuracy_$$*.o $(OBJ_DIR)/swimmer_gsl_$$*.o $(OBJ_DIR)/generative_model.o
 	$(CC) $(FLAGS) $(LIBS) $^ -o $@
 
-$(BIN_DIR)/sequential_xp_sum_%: $(OBJ_DIR)/sequential_xp_sum_$$*.o $(OBJ_DIR)/soo_1.o $(OBJ_DIR)/sequential_soo_1.o $(OBJ_DIR)/direct_1.o $(OBJ_DIR)/sequential_direct_1.o $(OBJ_DIR)/$$*.o
+$(BIN_DIR)/swimmer_xp_lu_accuracy_%: $(OBJ_DIR)/swimmer_xp_lu_accuracy_$$*.o $(OBJ_DIR)/swimmer_$$*.o $(OBJ_DIR)/generative_model.o
 	$(CC) $(FLAGS) $(LIBS) $^ -o $@
 
-$(BIN_DIR)/sequential_soo_xp_sum_%: $(OBJ_DIR)/sequential_soo_xp_sum_$$*.o $(OBJ_DIR)/soo_1.o $(OBJ_DIR)/sequential_soo_1.o $(OBJ_DIR)/$$*.o
+$(BIN_DIR)/lipschitzian_xp_sum_%_swimmer: $(OBJ_DIR)/deadline.o $(OBJ_DIR)/discount_powers.o $(OBJ_DIR)/worker_pool.o $(OBJ_DIR)/lipschitzian_xp_sum_swimmer_$$*.o $(OBJ_DIR)/lipschitzian_%.o $(OBJ_DIR)/arena.o $(OBJ_DIR)/transition_cache.o $(OBJ_DIR)/swimmer_$$*.o $(OBJ_DIR)/generative_model.o
+	$(CC) $(FLAGS) $(LIBS) $^ -o $@
+
+$(BIN_DIR)/random_search_xp_sum_%_swimmer: $(OBJ_DIR)/deadline.o $(OBJ_DIR)/discount_powers.o $(OBJ_DIR)/worker_pool.o $(OBJ_DIR)/random_search_xp_sum_swimmer_$$*.o $(OBJ_DIR)/random_search_%.o $(OBJ_DIR)/swimmer_$$*.o $(OBJ_DIR)/generative_model.o
+	$(CC) $(FLAGS) $(LIBS) $^ -o $@
+
+$(BIN_DIR)/sequential_xp_sum_%_swimmer: $(OBJ_DIR)/deadline.o $(OBJ_DIR)/worker_pool.o $(OBJ_DIR)/arena.o $(OBJ_DIR)/box_geometry.o $(OBJ_DIR)/sequential_xp_sum_swimmer_$$*.o $(OBJ_DIR)/soo_%.o $(OBJ_DIR)/sequential_soo_%.o $(OBJ_DIR)/direct_%.o $(OBJ_DIR)/sequential_direct_%.o $(OBJ_DIR)/swimmer_$$*.o $(OBJ_DIR)/generative_model.o
+	$(CC) $(FLAGS) $(LIBS) $^ -o $@
+
+$(BIN_DIR)/sequential_soo_xp_sum_%_swimmer: $(OBJ_DIR)/deadline.o $(OBJ_DIR)/worker_pool.o $(OBJ_DIR)/arena.o $(OBJ_DIR)/box_geometry.o $(OBJ_DIR)/sequential_soo_xp_sum_swimmer_$$*.o $(OBJ_DIR)/soo_%.o $(OBJ_DIR)/sequential_soo_%.o $(OBJ_DIR)/swimmer_$$*.o $(OBJ_DIR)/generative_model.o
+	$(CC) $(FLAGS) $(LIBS) $^ -o $@
+
+$(BIN_DIR)/lipschitzian_xp_sum_%: $(OBJ_DIR)/deadline.o $(OBJ_DIR)/discount_powers.o $(OBJ_DIR)/worker_pool.o $(OBJ_DIR)/lipschitzian_xp_sum_$$*.o $(OBJ_DIR)/lipschitzian_1.o $(OBJ_DIR)/arena.o $(OBJ_DIR)/transition_cache.o $(OBJ_DIR)/$$*.o $(OBJ_DIR)/generative_model.o
+	$(CC) $(FLAGS) $(LIBS) $^ -o $@
+
+$(BIN_DIR)/random_search_xp_sum_%: $(OBJ_DIR)/deadline.o $(OBJ_DIR)/discount_powers.o $(OBJ_DIR)/worker_pool.o $(OBJ_DIR)/random_search_xp_sum_$$*.o $(OBJ_DIR)/random_search_1.o $(OBJ_DIR)/$$*.o $(OBJ_DIR)/generative_model.o
+	$(CC) $(FLAGS) $(LIBS) $^ -o $@
+
+$(BIN_DIR)/sequential_xp_sum_%: $(OBJ_DIR)/deadline.o $(OBJ_DIR)/worker_pool.o $(OBJ_DIR)/arena.o $(OBJ_DIR)/box_geometry.o $(OBJ_DIR)/sequential_xp_sum_$$*.o $(OBJ_DIR)/soo_1.o $(OBJ_DIR)/sequential_soo_1.o $(OBJ_DIR)/direct_1.o $(OBJ_DIR)/sequential_direct_1.o $(OBJ_DIR)/$$*.o $(OBJ_DIR)/generative_model.o
+	$(CC) $(FLAGS) $(LIBS) $^ -o $@
+
+$(BIN_DIR)/sequential_soo_xp_sum_%: $(OBJ_DIR)/deadline.o $(OBJ_DIR)/worker_pool.o $(OBJ_DIR)/arena.o $(OBJ_DIR)/box_geometry.o $(OBJ_DIR)/sequential_soo_xp_sum_$$*.o $(OBJ_DIR)/soo_1.o $(OBJ_DIR)/sequential_soo_1.o $(OBJ_DIR)/$$*.o $(OBJ_DIR)/generative_model.o
+	$(CC) $(FLAGS) $(LIBS) $^ -o $@
+
+$(BIN_DIR)/sequential_soo_xp_allocator_%: $(OBJ_DIR)/deadline.o $(OBJ_DIR)/worker_pool.o $(OBJ_DIR)/arena.o $(OBJ_DIR)/box_geometry.o $(OBJ_DIR)/sequential_soo_xp_allocator_1.o $(OBJ_DIR)/soo_1.o $(OBJ_DIR)/sequential_soo_1.o $(OBJ_DIR)/$$*.o $(OBJ_DIR)/generative_model.o
+	$(CC) $(FLAGS) $(LIBS) $(ALLOCATOR_WRAPS) $^ -o $@
+
+$(BIN_DIR)/sequential_soo_xp_threads_%: $(OBJ_DIR)/deadline.o $(OBJ_DIR)/worker_pool.o $(OBJ_DIR)/arena.o $(OBJ_DIR)/box_geometry.o $(OBJ_DIR)/sequential_soo_xp_threads_1.o $(OBJ_DIR)/soo_1.o $(OBJ_DIR)/sequential_soo_1.o $(OBJ_DIR)/$$*.o $(OBJ_DIR)/generative_model.o
 	$(CC) $(FLAGS) $(LIBS) $^ -o $@